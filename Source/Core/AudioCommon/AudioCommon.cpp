@@ -155,7 +155,14 @@ namespace AudioCommon
 	{
 		if (soundStream)
 		{
-			soundStream->GetMixer()->SetThrottle(SConfig::GetInstance().m_Framelimit == 2);
+			CMixer* pMixer = soundStream->GetMixer();
+			pMixer->SetThrottle(SConfig::GetInstance().m_Framelimit == 2);
+
+			const Resampler::Quality quality = SConfig::GetInstance().m_DSPSincResampling ?
+				Resampler::QUALITY_SINC : Resampler::QUALITY_LINEAR;
+			pMixer->SetResampleQuality(CMixer::CHANNEL_DMA, quality);
+			pMixer->SetResampleQuality(CMixer::CHANNEL_STREAMING, quality);
+
 			soundStream->SetVolume(SConfig::GetInstance().m_Volume);
 		}
 	}
@@ -2,10 +2,12 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+
 #include "AudioCommon/AudioCommon.h"
 #include "AudioCommon/Mixer.h"
-#include "Common/Atomic.h"
-#include "Common/CPUDetect.h"
+#include "Common/MathUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/HW/AudioInterface.h"
@@ -14,144 +16,218 @@
 // UGLINESS
 #include "Core/PowerPC/PowerPC.h"
 
-#if _M_SSE >= 0x301 && !(defined __GNUC__ && !defined __SSSE3__)
-#include <tmmintrin.h>
-#endif
-
 // Executed from sound stream thread
-unsigned int CMixer::Mix(short* samples, unsigned int numSamples, bool consider_framelimit)
+void CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, bool consider_framelimit)
 {
-	if (!samples)
-		return 0;
-
-	std::lock_guard<std::mutex> lk(m_csMixing);
+	const u32 available = AvailableSamples();
+	const u32 input_sample_rate = m_input_sample_rate;
 
-	if (PowerPC::GetState() != PowerPC::CPU_RUNNING)
-	{
-		// Silence
-		memset(samples, 0, numSamples * 4);
-		return numSamples;
-	}
-
-	unsigned int currentSample = 0;
-
-	// Cache access in non-volatile variable
-	// This is the only function changing the read value, so it's safe to
-	// cache it locally although it's written here.
-	// The writing pointer will be modified outside, but it will only increase,
-	// so we will just ignore new written data while interpolating.
-	// Without this cache, the compiler wouldn't be allowed to optimize the
-	// interpolation loop.
-	u32 indexR = Common::AtomicLoad(m_indexR);
-	u32 indexW = Common::AtomicLoad(m_indexW);
-
-	float numLeft = ((indexW - indexR) & INDEX_MASK) / 2;
+	float numLeft = (float)available;
 	m_numLeftI = (numLeft + m_numLeftI*(CONTROL_AVG-1)) / CONTROL_AVG;
 	float offset = (m_numLeftI - LOW_WATERMARK) * CONTROL_FACTOR;
 	if (offset > MAX_FREQ_SHIFT) offset = MAX_FREQ_SHIFT;
 	if (offset < -MAX_FREQ_SHIFT) offset = -MAX_FREQ_SHIFT;
 
 	//render numleft sample pairs to samples[]
-	//advance indexR with sample position
+	//advance the read position with sample position
 	//remember fractional offset
 
 	u32 framelimit = SConfig::GetInstance().m_Framelimit;
-	float aid_sample_rate = AudioInterface::GetAIDSampleRate() + offset;
+	float aid_sample_rate = input_sample_rate + offset * input_sample_rate / 32000.0f;
 	if (consider_framelimit && framelimit > 2)
 	{
 		aid_sample_rate = aid_sample_rate * (framelimit - 1) * 5 / VideoInterface::TargetRefreshRate;
 	}
 
-	static u32 frac = 0;
-	const u32 ratio = (u32)( 65536.0f * aid_sample_rate / (float)m_sampleRate );
+	const u32 ratio = (u32)( 65536.0f * aid_sample_rate / (float)m_mixer->m_sampleRate );
 
 	if (ratio > 0x10000)
 		ERROR_LOG(AUDIO, "ratio out of range");
 
-	for (; currentSample < numSamples*2 && ((indexW-indexR) & INDEX_MASK) > 2; currentSample+=2) {
-		u32 indexR2 = indexR + 2; //next sample
+	// Copy the frames this call can reach behind the history, converted to
+	// native (L, R) frames. The producer may keep pushing meanwhile; that data
+	// is picked up on the next call.
+	const u64 reach = (((u64)m_frac + (u64)ratio * numSamples) >> 16) + Resampler::SINC_TAPS;
+	const u32 count = (u32)std::min<u64>(available, reach);
+	m_history.resize((Resampler::SINC_HISTORY + count) * 2);
+	short* in = &m_history[Resampler::SINC_HISTORY * 2];
+	m_ring.Peek(in, count * 2);
+	if (m_dma_format)
+	{
+		u32* frames = (u32*)in;
+		for (u32 i = 0; i < count; i++)
+			frames[i] = Common::swap32(frames[i]);
+	}
 
-		s16 l1 = Common::swap16(m_buffer[indexR & INDEX_MASK]); //current
-		s16 l2 = Common::swap16(m_buffer[indexR2 & INDEX_MASK]); //next
-		int sampleL = ((l1 << 16) + (l2 - l1) * (u16)frac)  >> 16;
-		samples[currentSample+1] = sampleL;
+	const Resampler::Volume volume = m_volume;
+	u32 pos = m_frac;
+	u32 mixed;
+	if (m_quality == Resampler::QUALITY_SINC)
+	{
+		// Band limit to the output rate when downsampling
+		const float cutoff = std::min(1.0f, (float)m_mixer->m_sampleRate / input_sample_rate);
+		if (m_sinc_table.cutoff != cutoff)
+			Resampler::BuildSincTable(m_sinc_table, cutoff);
+		mixed = Resampler::MixSinc(samples, numSamples, in, count, pos, ratio, volume, m_sinc_table);
+	}
+	else
+	{
+		mixed = Resampler::MixLinear(samples, numSamples, in, count, pos, ratio, volume);
+	}
 
-		s16 r1 = Common::swap16(m_buffer[(indexR + 1) & INDEX_MASK]); //current
-		s16 r2 = Common::swap16(m_buffer[(indexR2 + 1) & INDEX_MASK]); //next
-		int sampleR = ((r1 << 16) + (r2 - r1) * (u16)frac)  >> 16;
-		samples[currentSample] = sampleR;
+	const u32 consumed = std::min(pos >> 16, count);
+	m_frac = pos & 0xffff;
 
-		frac += ratio;
-		indexR += 2 * (u16)(frac >> 16);
-		frac &= 0xffff;
+	// Padding
+	if (mixed < numSamples)
+	{
+		m_underruns++;
+
+		// Hold the last frame before the read position, which may be history
+		const int last = (int)consumed - 1;
+		const int s[2] = {
+			in[last * 2] * (int)volume.left >> 8,
+			in[last * 2 + 1] * (int)volume.right >> 8,
+		};
+		for (u32 i = mixed * 2; i < numSamples * 2; i += 2)
+		{
+			int l = samples[i] + s[0];
+			int r = samples[i + 1] + s[1];
+			MathUtil::Clamp(&l, -32768, 32767);
+			MathUtil::Clamp(&r, -32768, 32767);
+			samples[i] = l;
+			samples[i + 1] = r;
+		}
 	}
 
-	// Padding
-	unsigned short s[2];
-	s[0] = Common::swap16(m_buffer[(indexR - 1) & INDEX_MASK]);
-	s[1] = Common::swap16(m_buffer[(indexR - 2) & INDEX_MASK]);
-	for (; currentSample < numSamples*2; currentSample+=2)
+	// Keep the frames before the new read position for the next call
+	memmove(&m_history[0], &m_history[consumed * 2], Resampler::SINC_HISTORY * 2 * sizeof(short));
+
+	// Hand the consumed samples back to the producer
+	m_ring.Pop(consumed * 2);
+}
+
+unsigned int CMixer::Mix(short* samples, unsigned int numSamples, bool consider_framelimit)
+{
+	if (!samples)
+		return 0;
+
+	// The lock is only contended while the emulation is paused and locked, so
+	// output silence instead of stalling the audio thread.
+	std::unique_lock<std::mutex> lk(m_csMixing, std::try_to_lock);
+
+	// Silence
+	memset(samples, 0, numSamples * 4);
+
+	if (!lk.owns_lock() || PowerPC::GetState() != PowerPC::CPU_RUNNING)
+		return numSamples;
+
+	m_dma_mixer.SetInputSampleRate(AudioInterface::GetAIDSampleRate());
+	m_dma_mixer.Mix(samples, numSamples, consider_framelimit);
+
+	// The DTK music is decoded on demand. Topping its fifo up to the low
+	// watermark keeps the rate control of that fifo neutral.
+	const unsigned int ais_sample_rate = AudioInterface::GetAISSampleRate();
+	const unsigned int wanted = std::max<unsigned int>(LOW_WATERMARK,
+		numSamples * ais_sample_rate / m_sampleRate + Resampler::SINC_TAPS + 1);
+	unsigned int left_volume, right_volume;
+	AudioInterface::GetStreamingVolume(left_volume, right_volume);
+	m_streaming_mixer.SetInputSampleRate(ais_sample_rate);
+	m_streaming_mixer.SetVolume(left_volume, right_volume);
+	for (unsigned int available = m_streaming_mixer.AvailableSamples(); available < wanted;)
 	{
-		samples[currentSample] = s[0];
-		samples[currentSample+1] = s[1];
+		short pcm[256 * 2];
+		const unsigned int count = std::min<unsigned int>(256, wanted - available);
+		AudioInterface::Callback_GetStreaming(pcm, count);
+		m_streaming_mixer.PushSamples(pcm, count);
+		available += count;
 	}
+	m_streaming_mixer.Mix(samples, numSamples, false);
 
-	// Flush cached variable
-	Common::AtomicStore(m_indexR, indexR);
+	m_wiimote_speaker_mixer.Mix(samples, numSamples, consider_framelimit);
 
-	// Add the DTK Music
-	// Re-sampling is done inside
-	AudioInterface::Callback_GetStreaming(samples, numSamples, m_sampleRate);
 	if (m_logAudio)
 		g_wave_writer.AddStereoSamples(samples, numSamples);
 
 	return numSamples;
 }
 
+bool CMixer::MixerFifo::PushSamples(const short* samples, unsigned int num_samples)
+{
+	// AyuanX: Actual re-sampling work has been moved to sound thread
+	// to alleviate the workload on main thread
+	// and we simply store raw data here to make fast mem copy.
+	// The samples are dropped if there is not enough free space.
+	return m_ring.Push(samples, num_samples * 2);
+}
 
-void CMixer::PushSamples(const short *samples, unsigned int num_samples)
+void CMixer::MixerFifo::SetVolume(unsigned int left, unsigned int right)
 {
-	// Cache access in non-volatile variable
-	// indexR isn't allowed to cache in the audio throttling loop as it
-	// needs to get updates to not deadlock.
-	u32 indexW = Common::AtomicLoad(m_indexW);
+	m_volume.left = std::min(left, 256u);
+	m_volume.right = std::min(right, 256u);
+}
 
+void CMixer::PushSamples(const short *samples, unsigned int num_samples)
+{
 	if (m_throttle)
 	{
 		// The auto throttle function. This loop will put a ceiling on the CPU MHz.
-		while (num_samples * 2 + ((indexW - Common::AtomicLoad(m_indexR)) & INDEX_MASK) >= MAX_SAMPLES * 2)
+		while (!m_dma_mixer.HasSpace(num_samples))
 		{
 			if (*PowerPC::GetStatePtr() != PowerPC::CPU_RUNNING || soundStream->IsMuted())
 				break;
 			// Shortcut key for Throttle Skipping
 			if (Core::GetIsFramelimiterTempDisabled())
 				break;
-			SLEEP(1);
+			// Backends without their own thread mix from Update(), so only
+			// sleep until the audio thread frees space or a short timeout.
 			soundStream->Update();
+			m_dma_mixer.WaitForSpace(num_samples);
 		}
 	}
 
-	// Check if we have enough free space
-	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (num_samples * 2 + ((indexW - Common::AtomicLoad(m_indexR)) & INDEX_MASK) >= MAX_SAMPLES * 2)
-		return;
+	m_dma_mixer.PushSamples(samples, num_samples);
+}
+
+void CMixer::PushWiimoteSpeakerSamples(const short* samples, unsigned int num_samples, unsigned int sample_rate)
+{
+	m_wiimote_speaker_mixer.SetInputSampleRate(sample_rate);
 
-	// AyuanX: Actual re-sampling work has been moved to sound thread
-	// to alleviate the workload on main thread
-	// and we simply store raw data here to make fast mem copy
-	int over_bytes = num_samples * 4 - (MAX_SAMPLES * 2 - (indexW & INDEX_MASK)) * sizeof(short);
-	if (over_bytes > 0)
+	short stereo[256 * 2];
+	while (num_samples)
 	{
-		memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4 - over_bytes);
-		memcpy(&m_buffer[0], samples + (num_samples * 4 - over_bytes) / sizeof(short), over_bytes);
+		const unsigned int count = std::min(num_samples, 256u);
+		for (unsigned int i = 0; i < count; i++)
+			stereo[i * 2] = stereo[i * 2 + 1] = samples[i];
+
+		if (!m_wiimote_speaker_mixer.PushSamples(stereo, count))
+			break;
+
+		samples += count;
+		num_samples -= count;
 	}
-	else
+}
+
+CMixer::MixerFifo& CMixer::GetChannel(MixerChannel channel)
+{
+	switch (channel)
 	{
-		memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4);
+	case CHANNEL_STREAMING:
+		return m_streaming_mixer;
+	case CHANNEL_WIIMOTE_SPEAKER:
+		return m_wiimote_speaker_mixer;
+	case CHANNEL_DMA:
+	default:
+		return m_dma_mixer;
 	}
+}
 
-	Common::AtomicAdd(m_indexW, num_samples * 2);
-
-	return;
+void CMixer::SetResampleQuality(MixerChannel channel, Resampler::Quality quality)
+{
+	GetChannel(channel).SetQuality(quality);
 }
 
+void CMixer::SetVolume(MixerChannel channel, unsigned int left, unsigned int right)
+{
+	GetChannel(channel).SetVolume(left, right);
+}
@@ -5,13 +5,15 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
+#include "AudioCommon/Resampler.h"
 #include "AudioCommon/WaveFile.h"
+#include "Common/RingBuffer.h"
 #include "Common/StdMutex.h"
 
 // 16 bit Stereo
 #define MAX_SAMPLES     (1024 * 2) // 64ms
-#define INDEX_MASK      (MAX_SAMPLES * 2 - 1)
 
 #define LOW_WATERMARK   1280 // 40 ms
 #define MAX_FREQ_SHIFT  200  // per 32000 Hz
@@ -27,16 +29,15 @@ public:
 		, m_bits(16)
 		, m_channels(2)
 		, m_logAudio(0)
-		, m_indexW(0)
-		, m_indexR(0)
-		, m_numLeftI(0.0f)
+		, m_throttle(false)
+		, m_dma_mixer(this, DACSampleRate, true)
+		, m_streaming_mixer(this, AISampleRate, false)
+		, m_wiimote_speaker_mixer(this, 6000, false)
 	{
 		// AyuanX: The internal (Core & DSP) sample rate is fixed at 32KHz
 		// So when AI/DAC sample rate differs than 32KHz, we have to do re-sampling
 		m_sampleRate = BackendSampleRate;
 
-		memset(m_buffer, 0, sizeof(m_buffer));
-
 		INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized (AISampleRate:%i, DACSampleRate:%i)", AISampleRate, DACSampleRate);
 	}
 
@@ -47,8 +48,22 @@ public:
 
 	// Called from main thread
 	virtual void PushSamples(const short* samples, unsigned int num_samples);
+	// Mono samples at sample_rate, dropped if the fifo is full
+	void PushWiimoteSpeakerSamples(const short* samples, unsigned int num_samples, unsigned int sample_rate);
 	unsigned int GetSampleRate() const {return m_sampleRate;}
 
+	// Input channels, each resampled and mixed separately
+	enum MixerChannel
+	{
+		CHANNEL_DMA,
+		CHANNEL_STREAMING,
+		CHANNEL_WIIMOTE_SPEAKER,
+	};
+
+	void SetResampleQuality(MixerChannel channel, Resampler::Quality quality);
+	// 256 == unity
+	void SetVolume(MixerChannel channel, unsigned int left, unsigned int right);
+
 	void SetThrottle(bool use) { m_throttle = use;}
 
 
@@ -86,7 +101,62 @@ public:
 	float GetCurrentSpeed() const { return m_speed; }
 	void UpdateSpeed(volatile float val) { m_speed = val; }
 
+	// Number of Mix() calls that ran out of DMA samples and had to pad them
+	u32 GetUnderrunCount() const { return m_dma_mixer.GetUnderrunCount(); }
+
 protected:
+	class MixerFifo : NonCopyable
+	{
+	public:
+		// dma_format: the samples are big endian with the channels in (R, L)
+		// order, like the AI DMA data. Otherwise they are native (L, R).
+		MixerFifo(CMixer* mixer, unsigned int sample_rate, bool dma_format)
+			: m_mixer(mixer)
+			, m_input_sample_rate(sample_rate)
+			, m_dma_format(dma_format)
+			, m_quality(Resampler::QUALITY_LINEAR)
+			, m_frac(0)
+			, m_numLeftI(0.0f)
+			, m_underruns(0)
+			, m_history(Resampler::SINC_HISTORY * 2)
+		{
+			m_volume.left = m_volume.right = 256;
+			m_sinc_table.cutoff = 0.0f;
+		}
+
+		// Called from the emulation thread
+		bool PushSamples(const short* samples, unsigned int num_samples);
+		bool HasSpace(unsigned int num_samples) const { return m_ring.Space() >= num_samples * 2; }
+		bool WaitForSpace(unsigned int num_samples) { return m_ring.WaitForSpace(num_samples * 2, std::chrono::milliseconds(1)); }
+		unsigned int AvailableSamples() const { return m_ring.Size() / 2; }
+
+		// Called from the audio thread. Adds numSamples resampled frames to samples.
+		void Mix(short* samples, unsigned int numSamples, bool consider_framelimit);
+
+		void SetInputSampleRate(unsigned int rate) { m_input_sample_rate = rate; }
+		void SetVolume(unsigned int left, unsigned int right);
+		void SetQuality(Resampler::Quality quality) { m_quality = quality; }
+		u32 GetUnderrunCount() const { return m_underruns; }
+
+	private:
+		CMixer* m_mixer;
+		Common::RingBuffer<short, MAX_SAMPLES * 2> m_ring;
+		volatile unsigned int m_input_sample_rate;
+		bool m_dma_format;
+		volatile Resampler::Quality m_quality;
+		Resampler::Volume m_volume;
+
+		// Audio thread only
+		u32 m_frac;
+		float m_numLeftI;
+		u32 m_underruns;
+		// The last SINC_HISTORY consumed frames followed by the frames being resampled
+		std::vector<short> m_history;
+		Resampler::SincTable m_sinc_table;
+	};
+
+	MixerFifo& GetChannel(MixerChannel channel);
+
 	unsigned int m_sampleRate;
 	unsigned int m_aiSampleRate;
 	unsigned int m_dacSampleRate;
@@ -99,12 +169,11 @@ protected:
 
 	bool m_throttle;
 
-	short m_buffer[MAX_SAMPLES * 2];
-	volatile u32 m_indexW;
-	volatile u32 m_indexR;
+	MixerFifo m_dma_mixer;
+	MixerFifo m_streaming_mixer;
+	MixerFifo m_wiimote_speaker_mixer;
 
 	std::mutex m_csMixing;
-	float m_numLeftI;
 
 	volatile float m_speed; // Current rate of the emulation (1.0 = 100% speed)
 private:
@@ -0,0 +1,174 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cmath>
+
+#include "AudioCommon/Resampler.h"
+#include "Common/Common.h"
+#include "Common/MathUtil.h"
+
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace Resampler
+{
+
+// Interpolation weights are 1.14 fixed point so that a pair of them times a
+// full scale sample still fits the 32 bit lanes of pmaddwd.
+static const int WEIGHT_SHIFT = 14;
+
+static inline s16 AddSaturated(s16 a, int b)
+{
+	int sum = a + b;
+	MathUtil::Clamp(&sum, -32768, 32767);
+	return (s16)sum;
+}
+
+u32 MixLinear(s16* out, u32 out_frames, const s16* in, u32 in_frames, u32& pos, u32 step, const Volume& volume)
+{
+	u32 i = 0;
+
+#ifdef _M_X86
+	// Two output frames per iteration. Each 64 bit load fetches the two input
+	// frames around one output frame, which are then regrouped per channel so
+	// pmaddwd can weight and sum them in one go.
+	for (; i + 2 <= out_frames; i += 2)
+	{
+		const u32 pos1 = pos + step;
+		const u32 idx0 = pos >> 16;
+		const u32 idx1 = pos1 >> 16;
+		if (idx1 + 1 >= in_frames)
+			break;
+
+		const int w0 = (pos & 0xFFFF) >> (16 - WEIGHT_SHIFT);
+		const int w1 = (pos1 & 0xFFFF) >> (16 - WEIGHT_SHIFT);
+		const __m128i weights = _mm_setr_epi16(
+			((1 << WEIGHT_SHIFT) - w0) * volume.left >> 8, w0 * volume.left >> 8,
+			((1 << WEIGHT_SHIFT) - w0) * volume.right >> 8, w0 * volume.right >> 8,
+			((1 << WEIGHT_SHIFT) - w1) * volume.left >> 8, w1 * volume.left >> 8,
+			((1 << WEIGHT_SHIFT) - w1) * volume.right >> 8, w1 * volume.right >> 8);
+
+		__m128i frames = _mm_unpacklo_epi64(
+			_mm_loadl_epi64((const __m128i*)&in[idx0 * 2]),
+			_mm_loadl_epi64((const __m128i*)&in[idx1 * 2]));
+		frames = _mm_shufflelo_epi16(frames, _MM_SHUFFLE(3, 1, 2, 0));
+		frames = _mm_shufflehi_epi16(frames, _MM_SHUFFLE(3, 1, 2, 0));
+
+		__m128i mixed = _mm_srai_epi32(_mm_madd_epi16(frames, weights), WEIGHT_SHIFT);
+		mixed = _mm_packs_epi32(mixed, mixed);
+		_mm_storel_epi64((__m128i*)&out[i * 2], _mm_adds_epi16(_mm_loadl_epi64((const __m128i*)&out[i * 2]), mixed));
+
+		pos = pos1 + step;
+	}
+#endif
+
+	for (; i < out_frames; i++)
+	{
+		const u32 idx = pos >> 16;
+		if (idx + 1 >= in_frames)
+			break;
+
+		const int w = (pos & 0xFFFF) >> (16 - WEIGHT_SHIFT);
+		const int l = (in[idx * 2] * (((1 << WEIGHT_SHIFT) - w) * (int)volume.left >> 8) +
+		               in[idx * 2 + 2] * (w * (int)volume.left >> 8)) >> WEIGHT_SHIFT;
+		const int r = (in[idx * 2 + 1] * (((1 << WEIGHT_SHIFT) - w) * (int)volume.right >> 8) +
+		               in[idx * 2 + 3] * (w * (int)volume.right >> 8)) >> WEIGHT_SHIFT;
+		out[i * 2] = AddSaturated(out[i * 2], l);
+		out[i * 2 + 1] = AddSaturated(out[i * 2 + 1], r);
+
+		pos += step;
+	}
+
+	return i;
+}
+
+// Position of tap k inside one phase of SincTable::coefs
+static inline u32 SincCoefIndex(u32 k)
+{
+	return (k / 4) * 8 + ((k / 2) & 1) * 4 + (k & 1);
+}
+
+void BuildSincTable(SincTable& table, float cutoff)
+{
+	table.cutoff = cutoff;
+
+	for (u32 phase = 0; phase < SINC_PHASES; phase++)
+	{
+		double h[SINC_TAPS];
+		double sum = 0.0;
+		for (u32 k = 0; k < SINC_TAPS; k++)
+		{
+			// Distance of tap k from the output position, in input frames
+			const double x = (double)k - SINC_HISTORY - (double)phase / SINC_PHASES;
+			const double t = M_PI * cutoff * x;
+			const double sinc = t == 0.0 ? 1.0 : sin(t) / t;
+			// Blackman window spanning all taps
+			const double window = 0.42 + 0.5 * cos(M_PI * x / (SINC_TAPS / 2)) + 0.08 * cos(2.0 * M_PI * x / (SINC_TAPS / 2));
+			h[k] = sinc * window;
+			sum += h[k];
+		}
+
+		// Normalize each phase to unity DC gain
+		for (u32 k = 0; k < SINC_TAPS; k++)
+		{
+			const s16 coef = (s16)floor(h[k] / sum * (1 << WEIGHT_SHIFT) + 0.5);
+			table.coefs[phase][SincCoefIndex(k)] = coef;
+			table.coefs[phase][SincCoefIndex(k) + 2] = coef;
+		}
+	}
+}
+
+u32 MixSinc(s16* out, u32 out_frames, const s16* in, u32 in_frames, u32& pos, u32 step, const Volume& volume, const SincTable& table)
+{
+	u32 i = 0;
+	for (; i < out_frames; i++)
+	{
+		const u32 idx = pos >> 16;
+		if (idx + SINC_TAPS - SINC_HISTORY > in_frames)
+			break;
+
+		const s16* frames = &in[((s32)idx - SINC_HISTORY) * 2];
+		const s16* coefs = table.coefs[(pos >> 8) & (SINC_PHASES - 1)];
+		int l, r;
+
+#ifdef _M_X86
+		// Four input frames per load, regrouped per channel like in MixLinear.
+		__m128i acc = _mm_setzero_si128();
+		for (u32 k = 0; k < SINC_TAPS; k += 4)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)&frames[k * 2]);
+			v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+			v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(v, _mm_loadu_si128((const __m128i*)&coefs[k * 2])));
+		}
+		acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+		acc = _mm_srai_epi32(acc, WEIGHT_SHIFT);
+		l = _mm_cvtsi128_si32(acc);
+		r = _mm_cvtsi128_si32(_mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 1, 1, 1)));
+#else
+		l = r = 0;
+		for (u32 k = 0; k < SINC_TAPS; k++)
+		{
+			l += frames[k * 2] * coefs[SincCoefIndex(k)];
+			r += frames[k * 2 + 1] * coefs[SincCoefIndex(k)];
+		}
+		l >>= WEIGHT_SHIFT;
+		r >>= WEIGHT_SHIFT;
+#endif
+
+		out[i * 2] = AddSaturated(out[i * 2], l * (int)volume.left >> 8);
+		out[i * 2 + 1] = AddSaturated(out[i * 2 + 1], r * (int)volume.right >> 8);
+
+		pos += step;
+	}
+
+	return i;
+}
+
+}  // namespace Resampler
@@ -0,0 +1,61 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Stereo sample rate conversion kernels used by the mixer.
+//
+// All functions work on interleaved, native endian s16 stereo frames and add
+// their output to what is already in the destination buffer, saturating at
+// the s16 range, so several sources can be mixed into the same buffer.
+// The read position is a 16.16 fixed point frame index into the input and is
+// advanced by step for every output frame.
+
+#include "Common/CommonTypes.h"
+
+namespace Resampler
+{
+
+enum Quality
+{
+	QUALITY_LINEAR = 0,
+	QUALITY_SINC,
+};
+
+// Per channel gain, 256 == unity
+struct Volume
+{
+	u32 left;
+	u32 right;
+};
+
+// Linear interpolation between neighbouring frames. Reads in[0, in_frames).
+// Returns the number of frames written, which is less than out_frames when
+// the input runs out.
+u32 MixLinear(s16* out, u32 out_frames, const s16* in, u32 in_frames, u32& pos, u32 step, const Volume& volume);
+
+// Windowed sinc interpolation over SINC_TAPS input frames. Besides
+// in[0, in_frames) this reads SINC_HISTORY frames before in[0].
+enum
+{
+	SINC_TAPS = 16,
+	SINC_HISTORY = SINC_TAPS / 2 - 1,
+	SINC_PHASES = 256,
+};
+
+struct SincTable
+{
+	float cutoff;
+	// Coefficients in 1.14 fixed point, per phase laid out as pairs of taps
+	// repeated for both channels: h0 h1 h0 h1 h2 h3 h2 h3 ...
+	s16 coefs[SINC_PHASES][SINC_TAPS * 2];
+};
+
+// cutoff is the pass band edge relative to the input Nyquist frequency,
+// min(1, output rate / input rate) for an anti-aliased conversion.
+void BuildSincTable(SincTable& table, float cutoff);
+
+u32 MixSinc(s16* out, u32 out_frames, const s16* in, u32 in_frames, u32& pos, u32 step, const Volume& volume, const SincTable& table);
+
+}  // namespace Resampler
@@ -13,8 +13,11 @@
 // - Zero backwards/forwards compatibility
 // - Serialization code for anything complex has to be manually written.
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <set>
@@ -47,6 +50,103 @@ struct LinkedListItem : public T
 	LinkedListItem<T> *next;
 };
 
+// Growable output for a single pass PointerWrap::MODE_WRITE.
+// Small values are appended into owned chunks. Large blocks may be added by reference:
+// their contents are fetched through a callback when the sink is read, which lets the
+// owner hand out memory that is protected by copy-on-write instead of copying it.
+class PointerWrapSink
+{
+public:
+	// Copies size bytes starting at offset within the referenced block to dst.
+	typedef std::function<void(u8* dst, size_t offset, size_t size)> ReadFunc;
+
+	PointerWrapSink() : m_size(0) {}
+	~PointerWrapSink() { Clear(); }
+
+	void Append(const void* data, size_t size)
+	{
+		if (m_chunks.empty() || m_chunks.back().read ||
+		    m_chunks.back().data.capacity() - m_chunks.back().data.size() < size)
+		{
+			m_chunks.push_back(Chunk());
+			m_chunks.back().data.reserve(std::max<size_t>(size, CHUNK_SIZE));
+		}
+
+		std::vector<u8>& data_chunk = m_chunks.back().data;
+		const u8* bytes = static_cast<const u8*>(data);
+		data_chunk.insert(data_chunk.end(), bytes, bytes + size);
+		m_chunks.back().size = data_chunk.size();
+		m_size += size;
+	}
+
+	void AppendReference(size_t size, ReadFunc read)
+	{
+		m_chunks.push_back(Chunk());
+		m_chunks.back().read = read;
+		m_chunks.back().size = size;
+		m_size += size;
+	}
+
+	// Called once the sink is cleared, e.g. to drop the copy-on-write protection of referenced blocks.
+	void AddReleaseCallback(std::function<void()> release)
+	{
+		m_release.push_back(release);
+	}
+
+	size_t Size() const { return m_size; }
+
+	// Copies size bytes of the serialized data starting at offset to dst.
+	void Read(size_t offset, size_t size, u8* dst) const
+	{
+		for (const Chunk& chunk : m_chunks)
+		{
+			if (size == 0)
+				break;
+
+			if (offset >= chunk.size)
+			{
+				offset -= chunk.size;
+				continue;
+			}
+
+			const size_t len = std::min(size, chunk.size - offset);
+			if (chunk.read)
+				chunk.read(dst, offset, len);
+			else
+				memcpy(dst, &chunk.data[offset], len);
+
+			dst += len;
+			size -= len;
+			offset = 0;
+		}
+	}
+
+	void Clear()
+	{
+		for (auto& release : m_release)
+			release();
+		m_release.clear();
+		m_chunks.clear();
+		m_size = 0;
+	}
+
+private:
+	enum { CHUNK_SIZE = 1024 * 1024 };
+
+	struct Chunk
+	{
+		Chunk() : size(0) {}
+
+		std::vector<u8> data;
+		ReadFunc read;
+		size_t size;
+	};
+
+	std::vector<Chunk> m_chunks;
+	std::vector<std::function<void()>> m_release;
+	size_t m_size;
+};
+
 // Wrapper class
 class PointerWrap
 {
@@ -63,11 +163,15 @@ public:
 	Mode mode;
 
 public:
-	PointerWrap(u8 **ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
+	PointerWrap(u8 **ptr_, Mode mode_) : ptr(ptr_), mode(mode_), sink(nullptr), sink_ptr(nullptr) {}
+
+	// Writes everything into sink in a single pass, no MODE_MEASURE pass needed.
+	explicit PointerWrap(PointerWrapSink* sink_) : ptr(&sink_ptr), mode(MODE_WRITE), sink(sink_), sink_ptr(nullptr) {}
 
 	void SetMode(Mode mode_) { mode = mode_; }
 	Mode GetMode() const { return mode; }
 	u8** GetPPtr() { return ptr; }
+	PointerWrapSink* GetSink() const { return mode == MODE_WRITE ? sink : nullptr; }
 
 	template <typename K, class V>
 	void Do(std::map<K, V>& x)
@@ -172,6 +276,13 @@ public:
 	template <typename T>
 	void DoArray(T* x, u32 count)
 	{
+		// Same layout as doing each element, but without going through DoVoid per element.
+		if (std::is_arithmetic<T>::value)
+		{
+			DoVoid((void*)x, count * sizeof(T));
+			return;
+		}
+
 		for (u32 i = 0; i != count; ++i)
 			Do(x[i]);
 	}
@@ -306,9 +417,36 @@ private:
 
 	void DoVoid(void *data, u32 size)
 	{
-		for (u32 i = 0; i != size; ++i)
-			DoByte(reinterpret_cast<u8*>(data)[i]);
+		switch (mode)
+		{
+		case MODE_READ:
+			memcpy(data, *ptr, size);
+			break;
+
+		case MODE_WRITE:
+			if (sink)
+				sink->Append(data, size);
+			else
+				memcpy(*ptr, data, size);
+			break;
+
+		case MODE_MEASURE:
+			break;
+
+		case MODE_VERIFY:
+			for (u32 i = 0; i != size; ++i)
+				DoByte(reinterpret_cast<u8*>(data)[i]);
+			return;
+
+		default:
+			break;
+		}
+
+		*ptr += size;
 	}
+
+	PointerWrapSink* sink;
+	u8* sink_ptr;
 };
 
 class CChunkFileReader
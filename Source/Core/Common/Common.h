@@ -149,6 +149,16 @@ private:
 #  define _M_SSE 0x402
 #endif
 
+// GCC and clang can build single functions for SSSE3 in files compiled for an older baseline.
+// Only call FUNCTION_TARGET_SSSE3 functions after checking cpu_info.bSSSE3.
+#if _M_SSE >= 0x301
+#  define _M_SSSE3_FUNCTIONS 1
+#  define FUNCTION_TARGET_SSSE3
+#elif defined __GNUC__ && _M_X86
+#  define _M_SSSE3_FUNCTIONS 1
+#  define FUNCTION_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+
 // Host communication.
 enum HOST_COMM
 {
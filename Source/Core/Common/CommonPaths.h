@@ -100,6 +100,7 @@
 
 #define DSP_IROM    "dsp_rom.bin"
 #define DSP_COEF    "dsp_coef.bin"
+#define DSP_JIT_CACHE_FILE "dsp_jit_blocks.bin"
 
 #define GC_IPL      "IPL.bin"
 #define GC_SRAM     "SRAM.raw"
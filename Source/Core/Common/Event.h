@@ -7,11 +7,15 @@
 // other tasks.
 // * Set(): triggers the event and wakes up the waiting thread.
 // * Wait(): waits for the event to be triggered.
+// * WaitFor(timeout): like Wait(), but gives up after timeout. Returns whether
+//                     the event was triggered.
 // * Reset(): tries to reset the event before the waiting thread sees it was
 //            triggered. Usually a bad idea.
 
 #pragma once
 
+#include <chrono>
+
 #ifdef _WIN32
 #include <concrt.h>
 #endif
@@ -47,6 +51,19 @@ public:
 		m_flag.Clear();
 	}
 
+	template <class Rep, class Period>
+	bool WaitFor(const std::chrono::duration<Rep, Period>& timeout)
+	{
+		if (m_flag.TestAndClear())
+			return true;
+
+		std::unique_lock<std::mutex> lk(m_mutex);
+		if (!m_condvar.wait_for(lk, timeout, [&]{ return m_flag.IsSet(); }))
+			return false;
+		m_flag.Clear();
+		return true;
+	}
+
 	void Reset()
 	{
 		// no other action required, since wait loops on
@@ -66,6 +83,17 @@ class Event final
 public:
 	void Set() { m_event.set(); }
 	void Wait() { m_event.wait(); m_event.reset(); }
+
+	template <class Rep, class Period>
+	bool WaitFor(const std::chrono::duration<Rep, Period>& timeout)
+	{
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+		if (m_event.wait((unsigned int)ms) == concurrency::COOPERATIVE_WAIT_TIMEOUT)
+			return false;
+		m_event.reset();
+		return true;
+	}
+
 	void Reset() { m_event.reset(); }
 
 private:
@@ -411,6 +411,19 @@ u64 GetSize(const std::string &filename)
 	return 0;
 }
 
+u64 GetModificationTime(const std::string &filename)
+{
+	struct stat64 buf;
+#ifdef _WIN32
+	if (_tstat64(UTF8ToTStr(filename).c_str(), &buf) == 0)
+#else
+	if (stat64(filename.c_str(), &buf) == 0)
+#endif
+		return buf.st_mtime;
+
+	return 0;
+}
+
 // Overloaded GetSize, accepts file descriptor
 u64 GetSize(const int fd)
 {
@@ -75,6 +75,10 @@ bool IsDirectory(const std::string &filename);
 // Returns the size of filename (64bit)
 u64 GetSize(const std::string &filename);
 
+// Returns the last modification time of filename in seconds since the epoch,
+// 0 if it can't be determined
+u64 GetModificationTime(const std::string &filename);
+
 // Overloaded GetSize, accepts file descriptor
 u64 GetSize(const int fd);
 
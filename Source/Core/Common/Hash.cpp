@@ -3,13 +3,18 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+
+#include "Common/CPUDetect.h"
 #include "Common/Hash.h"
 #if _M_SSE >= 0x402
-#include "Common/CPUDetect.h"
 #include <nmmintrin.h>
 #endif
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
 
-static u64 (*ptrHashFunction)(const u8 *src, int len, u32 samples) = &GetMurmurHash3;
+static u64 (*ptrHashFunction)(const u8 *src, int len, u32 samples) = &GetMultiStreamHash;
 
 // uint32_t
 // WARNING - may read one more byte!
@@ -492,6 +497,183 @@ u64 GetHashHiresTexture(const u8 *src, int len, u32 samples)
 }
 #endif
 
+//-----------------------------------------------------------------------------
+// Multi-stream hash for hashing whole textures. The data is read in 64 byte
+// stripes, each 64 bit word of a stripe going into its own accumulator, so
+// the eight streams don't depend on each other and the SSE2 version handles
+// them two at a time. The accumulate and scramble steps are the ones of XXH3.
+// Both versions give the same hashes.
+
+static const u32 STRIPE_SIZE = 64;
+// The accumulators are scrambled after this many stripes, so bits from the
+// high halves keep making it into the multiplications
+static const u32 STRIPES_PER_SCRAMBLE = 16;
+static const u32 STREAM_PRIME32 = 0x9E3779B1;
+
+static const u64 s_stream_keys[8] = {
+	0xbe4ba423396cfeb8, 0x1cad21f72c81017c, 0xdb979083e96dd4de, 0x1f67b3b7a4a44072,
+	0x78e5c0cc4ee679cb, 0x2172ffcc7dd05a82, 0x8e2443f7744608b8, 0x4c263a81e69035e0,
+};
+
+static const u64 s_stream_init[8] = {
+	0x00000000C2B2AE3D, 0x9E3779B185EBCA87, 0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9,
+	0x85EBCA77C2B2AE63, 0x0000000085EBCA77, 0x27D4EB2F165667C5, 0x000000009E3779B1,
+};
+
+static inline u32 GetStripeStep(int len, u32 samples)
+{
+	u32 Step = len / STRIPE_SIZE;
+	if (samples == 0) samples = std::max(Step, 1u);
+	Step = Step / samples;
+	if (Step < 1) Step = 1;
+	return Step;
+}
+
+static inline u64 AvalancheStreams(u64 h)
+{
+	h ^= h >> 37;
+	h *= 0x165667919E3779F9;
+	h ^= h >> 32;
+	return h;
+}
+
+static u64 MergeStreams(const u64* acc, int len)
+{
+	u64 h = (u64)len * 0x9E3779B185EBCA87;
+	for (int i = 0; i < 8; i++)
+		h = AvalancheStreams(h ^ (acc[i] * 0xC2B2AE3D27D4EB4F + i));
+	return h;
+}
+
+static inline void AccumulateStripe(u64* acc, const u8* stripe)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		u64 data;
+		memcpy(&data, stripe + i * 8, sizeof(data));
+		const u64 key = data ^ s_stream_keys[i];
+		acc[i ^ 1] += data;
+		acc[i] += (key & 0xffffffff) * (key >> 32);
+	}
+}
+
+static inline void ScrambleStreams(u64* acc)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		acc[i] ^= acc[i] >> 47;
+		acc[i] ^= s_stream_keys[i];
+		acc[i] *= STREAM_PRIME32;
+	}
+}
+
+u64 GetMultiStreamHash(const u8 *src, int len, u32 samples)
+{
+	const u32 Step = GetStripeStep(len, samples);
+	const u32 nstripes = len / STRIPE_SIZE;
+
+	u64 acc[8];
+	memcpy(acc, s_stream_init, sizeof(acc));
+
+	u32 count = 0;
+	for (u32 i = 0; i < nstripes; i += Step)
+	{
+		AccumulateStripe(acc, src + i * STRIPE_SIZE);
+		if (++count % STRIPES_PER_SCRAMBLE == 0)
+			ScrambleStreams(acc);
+	}
+
+	if (len % STRIPE_SIZE)
+	{
+		u8 tail[STRIPE_SIZE] = {};
+		memcpy(tail, src + nstripes * STRIPE_SIZE, len % STRIPE_SIZE);
+		AccumulateStripe(acc, tail);
+	}
+
+	return MergeStreams(acc, len);
+}
+
+#ifdef _M_X86
+static inline void AccumulateStripeSSE2(__m128i* acc, const u8* stripe, const __m128i* keys)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		const __m128i data = _mm_loadu_si128((const __m128i*)stripe + i);
+		const __m128i key = _mm_xor_si128(data, keys[i]);
+		// low times high 32 bits of each key word
+		const __m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(3, 3, 1, 1)));
+		acc[i] = _mm_add_epi64(acc[i], _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2)));
+		acc[i] = _mm_add_epi64(acc[i], product);
+	}
+}
+
+static inline void ScrambleStreamsSSE2(__m128i* acc, const __m128i* keys)
+{
+	const __m128i prime = _mm_set1_epi32(STREAM_PRIME32);
+	for (int i = 0; i < 4; i++)
+	{
+		__m128i a = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+		a = _mm_xor_si128(a, keys[i]);
+		const __m128i lo = _mm_mul_epu32(a, prime);
+		const __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+		acc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+	}
+}
+#endif
+
+u64 GetMultiStreamHashSSE2(const u8 *src, int len, u32 samples)
+{
+#ifdef _M_X86
+	const u32 Step = GetStripeStep(len, samples);
+	const u32 nstripes = len / STRIPE_SIZE;
+
+	__m128i keys[4], acc[4];
+	for (int i = 0; i < 4; i++)
+	{
+		keys[i] = _mm_loadu_si128((const __m128i*)s_stream_keys + i);
+		acc[i] = _mm_loadu_si128((const __m128i*)s_stream_init + i);
+	}
+
+	if (Step == 1)
+	{
+		u32 i = 0;
+		for (; i + STRIPES_PER_SCRAMBLE <= nstripes; i += STRIPES_PER_SCRAMBLE)
+		{
+			const u8* block = src + i * STRIPE_SIZE;
+			for (u32 j = 0; j < STRIPES_PER_SCRAMBLE; j++)
+				AccumulateStripeSSE2(acc, block + j * STRIPE_SIZE, keys);
+			ScrambleStreamsSSE2(acc, keys);
+		}
+		for (; i < nstripes; i++)
+			AccumulateStripeSSE2(acc, src + i * STRIPE_SIZE, keys);
+	}
+	else
+	{
+		u32 count = 0;
+		for (u32 i = 0; i < nstripes; i += Step)
+		{
+			AccumulateStripeSSE2(acc, src + i * STRIPE_SIZE, keys);
+			if (++count % STRIPES_PER_SCRAMBLE == 0)
+				ScrambleStreamsSSE2(acc, keys);
+		}
+	}
+
+	if (len % STRIPE_SIZE)
+	{
+		u8 tail[STRIPE_SIZE] = {};
+		memcpy(tail, src + nstripes * STRIPE_SIZE, len % STRIPE_SIZE);
+		AccumulateStripeSSE2(acc, tail, keys);
+	}
+
+	u64 result[8];
+	for (int i = 0; i < 4; i++)
+		_mm_storeu_si128((__m128i*)result + i, acc[i]);
+	return MergeStreams(result, len);
+#else
+	return GetMultiStreamHash(src, len, samples);
+#endif
+}
+
 u64 GetHash64(const u8 *src, int len, u32 samples)
 {
 	return ptrHashFunction(src, len, samples);
@@ -504,15 +686,15 @@ void SetHash64Function(bool useHiresTextures)
 	{
 		ptrHashFunction = &GetHashHiresTexture;
 	}
-#if _M_SSE >= 0x402
-	else if (cpu_info.bSSE4_2 && !useHiresTextures) // sse crc32 version
+#ifdef _M_X86
+	else if (cpu_info.bSSE2)
 	{
-		ptrHashFunction = &GetCRC32;
+		ptrHashFunction = &GetMultiStreamHashSSE2;
 	}
 #endif
 	else
 	{
-		ptrHashFunction = &GetMurmurHash3;
+		ptrHashFunction = &GetMultiStreamHash;
 	}
 }
 
@@ -0,0 +1,144 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include "Common/StringUtil.h"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "Common/MappedFile.h"
+
+namespace File
+{
+
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+	, m_open(false)
+#ifdef _WIN32
+	, m_mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFile(UTF8ToTStr(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	m_size = size.QuadPart;
+
+	if (m_size != 0)
+	{
+		m_mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping)
+			m_data = (const u8*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	CloseHandle(file);
+
+	if (m_size != 0 && !m_data)
+	{
+		ERROR_LOG(COMMON, "MappedFile: Failed to map %s: %s", filename.c_str(), GetLastErrorMsg());
+		Close();
+		return false;
+	}
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat buf;
+	if (fstat(fd, &buf) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	m_size = buf.st_size;
+
+	if (m_size > std::numeric_limits<size_t>::max())
+	{
+		// doesn't fit into the address space
+		close(fd);
+		m_size = 0;
+		return false;
+	}
+
+	if (m_size != 0)
+	{
+		void* data = mmap(nullptr, (size_t)m_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			ERROR_LOG(COMMON, "MappedFile: Failed to map %s: %s", filename.c_str(), GetLastErrorMsg());
+			close(fd);
+			m_size = 0;
+			return false;
+		}
+		m_data = (const u8*)data;
+	}
+	// the mapping stays valid without the descriptor
+	close(fd);
+#endif
+
+	m_open = true;
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	if (m_data)
+		munmap((void*)m_data, (size_t)m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
+
+void MappedFile::Prefetch(u64 offset, u64 size) const
+{
+	if (offset >= m_size)
+		return;
+	size = std::min(size, m_size - offset);
+
+#ifdef _WIN32
+	// PrefetchVirtualMemory needs Windows 8, until then the first access
+	// faults the pages in
+#else
+	// madvise wants a page aligned start
+	const u64 page_offset = offset % sysconf(_SC_PAGESIZE);
+	madvise((void*)(m_data + offset - page_offset), (size_t)(size + page_offset), MADV_WILLNEED);
+#endif
+}
+
+}  // namespace
@@ -0,0 +1,42 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/Common.h"
+
+namespace File
+{
+
+// Read-only view of a whole file in memory
+class MappedFile : public NonCopyable
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_open; }
+	// nullptr for an empty file
+	const u8* GetData() const { return m_data; }
+	u64 GetSize() const { return m_size; }
+
+	// Starts reading the given range into memory in the background, so that
+	// touching it later doesn't wait for the disk
+	void Prefetch(u64 offset, u64 size) const;
+
+private:
+	const u8* m_data;
+	u64 m_size;
+	bool m_open;
+#ifdef _WIN32
+	void* m_mapping;
+#endif
+};
+
+}  // namespace
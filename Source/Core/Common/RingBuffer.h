@@ -0,0 +1,119 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Lock-free single producer, single consumer ring buffer of a fixed power of
+// two size. One thread may Push() while another Peek()s and Pop()s at the same
+// time without any locking. The read and write indices run freely and wrap
+// around at 2^32, so Size() stays correct even when the buffer is full.
+// The producer can block in WaitForSpace() until the consumer has freed enough
+// room, instead of polling.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Common/Atomic.h"
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+
+namespace Common
+{
+
+template <typename T, u32 N>
+class RingBuffer
+{
+	static_assert(N != 0 && (N & (N - 1)) == 0, "RingBuffer size must be a power of two");
+
+public:
+	RingBuffer() : m_read(0), m_write(0)
+	{
+		memset(m_data, 0, sizeof(m_data));
+	}
+
+	static u32 Capacity() { return N; }
+
+	// Number of elements ready to be read.
+	u32 Size() const
+	{
+		return Common::AtomicLoadAcquire(m_write) - Common::AtomicLoadAcquire(m_read);
+	}
+
+	// Number of elements that can be pushed without overwriting unread data.
+	u32 Space() const { return N - Size(); }
+
+	// Producer side. Either stores all count elements or nothing and returns false.
+	bool Push(const T* values, u32 count)
+	{
+		const u32 write = Common::AtomicLoad(m_write);
+		if (count > N - (write - Common::AtomicLoadAcquire(m_read)))
+			return false;
+
+		const u32 start = write & MASK;
+		const u32 first = std::min(count, N - start);
+		memcpy(&m_data[start], values, first * sizeof(T));
+		memcpy(&m_data[0], values + first, (count - first) * sizeof(T));
+
+		Common::AtomicStoreRelease(m_write, write + count);
+		return true;
+	}
+
+	// Producer side. Waits until count elements fit or timeout has passed,
+	// returns whether they fit.
+	template <class Rep, class Period>
+	bool WaitForSpace(u32 count, const std::chrono::duration<Rep, Period>& timeout)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (Space() < count)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			if (now >= deadline)
+				return false;
+			m_space.WaitFor(deadline - now);
+		}
+		return true;
+	}
+
+	// Consumer side. Element at offset from the read position; offset may be
+	// negative to look at the most recently popped elements.
+	T Peek(s32 offset) const
+	{
+		return m_data[(Common::AtomicLoad(m_read) + offset) & MASK];
+	}
+
+	// Consumer side. Copies the first count elements, which must not exceed
+	// Size(), without removing them.
+	void Peek(T* values, u32 count) const
+	{
+		const u32 start = Common::AtomicLoad(m_read) & MASK;
+		const u32 first = std::min(count, N - start);
+		memcpy(values, &m_data[start], first * sizeof(T));
+		memcpy(values + first, &m_data[0], (count - first) * sizeof(T));
+	}
+
+	// Consumer side. Discards count elements, which must not exceed Size().
+	void Pop(u32 count)
+	{
+		Common::AtomicStoreRelease(m_read, Common::AtomicLoad(m_read) + count);
+		m_space.Set();
+	}
+
+	// Only safe while neither side is running.
+	void Clear()
+	{
+		m_read = m_write = 0;
+		memset(m_data, 0, sizeof(m_data));
+	}
+
+private:
+	enum : u32 { MASK = N - 1 };
+
+	T m_data[N];
+	volatile u32 m_read;
+	volatile u32 m_write;
+	Common::Event m_space;
+};
+
+}  // namespace Common
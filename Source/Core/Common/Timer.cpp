@@ -10,6 +10,9 @@
 #include <mmsystem.h>
 #include <sys/timeb.h>
 #include <windows.h>
+#elif defined __APPLE__
+#include <mach/mach_time.h>
+#include <sys/time.h>
 #else
 #include <sys/time.h>
 #endif
@@ -32,6 +35,26 @@ u32 Timer::GetTimeMs()
 #endif
 }
 
+// Monotonic time in microseconds, from an arbitrary starting point
+u64 Timer::GetTimeUs()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, time;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&time);
+	return (u64)(time.QuadPart / freq.QuadPart * 1000000 + time.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+#elif defined __APPLE__
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0)
+		mach_timebase_info(&timebase);
+	return mach_absolute_time() * timebase.numer / timebase.denom / 1000;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (u64)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+#endif
+}
+
 // --------------------------------------------
 // Initiate, Start, Stop, and Update the time
 // --------------------------------------------
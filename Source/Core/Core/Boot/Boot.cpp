@@ -39,6 +39,7 @@ void CBoot::Load_FST(bool _bIsWii)
 		return;
 
 	// copy first 20 bytes of disc to start of Mem 1
+	Memory::MarkRangeWritten(0x80000000, 0x20);
 	VolumeHandler::ReadToPtr(Memory::GetPointer(0x80000000), 0, 0x20);
 
 	// copy of game id
@@ -56,6 +57,7 @@ void CBoot::Load_FST(bool _bIsWii)
 	Memory::Write_U32(arenaHigh, 0x00000034);
 
 	// load FST
+	Memory::MarkRangeWritten(arenaHigh, fstSize);
 	VolumeHandler::ReadToPtr(Memory::GetPointer(arenaHigh), fstOffset, fstSize);
 	Memory::Write_U32(arenaHigh, 0x00000038);
 	Memory::Write_U32(maxFstSize, 0x0000003c);
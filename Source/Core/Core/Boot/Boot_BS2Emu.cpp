@@ -91,6 +91,7 @@ bool CBoot::EmulatedBS2_GC()
 		INFO_LOG(BOOT, "GC BS2: Not running apploader!");
 		return false;
 	}
+	Memory::MarkRangeWritten(0x81200000, iAppLoaderSize);
 	VolumeHandler::ReadToPtr(Memory::GetPointer(0x81200000), iAppLoaderOffset + 0x20, iAppLoaderSize);
 
 	// Setup pointers like real BS2 does
@@ -318,6 +319,7 @@ bool CBoot::EmulatedBS2_Wii()
 	// values as the game boots. This location keep the 4 byte ID for as long
 	// as the game is running. The 6 byte ID at 0x00 is overwritten sometime
 	// after this check during booting.
+	Memory::MarkRangeWritten(0x3180, 4);
 	VolumeHandler::ReadToPtr(Memory::GetPointer(0x3180), 0, 4);
 
 	// Execute the apploader
@@ -358,6 +360,7 @@ bool CBoot::EmulatedBS2_Wii()
 			ERROR_LOG(BOOT, "Invalid apploader. Probably your image is corrupted.");
 			return false;
 		}
+		Memory::MarkRangeWritten(0x81200000, iAppLoaderSize);
 		VolumeHandler::ReadToPtr(Memory::GetPointer(0x81200000), iAppLoaderOffset + 0x20, iAppLoaderSize);
 
 		//call iAppLoaderEntry
@@ -110,6 +110,7 @@ static const struct
 	{ "UndoSaveState",       351 /* WXK_F12 */,   4 /* wxMOD_SHIFT */ },
 	{ "SaveStateFile",       0,                   0 /* wxMOD_NONE */ },
 	{ "LoadStateFile",       0,                   0 /* wxMOD_NONE */ },
+	{ "Rewind",              0,                   0 /* wxMOD_NONE */ },
 };
 
 SConfig::SConfig()
@@ -268,7 +269,11 @@ void SConfig::SaveSettings()
 	ini.Set("Core", "RunCompareServer", m_LocalCoreStartupParameter.bRunCompareServer);
 	ini.Set("Core", "RunCompareClient", m_LocalCoreStartupParameter.bRunCompareClient);
 	ini.Set("Core", "FrameLimit",       m_Framelimit);
+	ini.Set("Core", "LogFramePacing",   m_LogFramePacing);
 	ini.Set("Core", "FrameSkip",        m_FrameSkip);
+	ini.Set("Core", "StateCompression", m_SaveStateCompression);
+	ini.Set("Core", "RewindInterval",   m_RewindInterval);
+	ini.Set("Core", "RewindMemory",     m_RewindMemory);
 
 	// GFX Backend
 	ini.Set("Core", "GFXBackend", m_LocalCoreStartupParameter.m_strVideoBackend);
@@ -279,6 +284,8 @@ void SConfig::SaveSettings()
 
 	// DSP
 	ini.Set("DSP", "EnableJIT", m_DSPEnableJIT);
+	ini.Set("DSP", "ThreadRunAhead", m_DSPThreadRunAhead);
+	ini.Set("DSP", "SincResampling", m_DSPSincResampling);
 	ini.Set("DSP", "DumpAudio", m_DumpAudio);
 	ini.Set("DSP", "Backend", sBackend);
 	ini.Set("DSP", "Volume", m_Volume);
@@ -443,9 +450,14 @@ void SConfig::LoadSettings()
 		ini.Get("Core", "VBeam",                     &m_LocalCoreStartupParameter.bVBeamSpeedHack,   false);
 		ini.Get("Core", "SyncGPU",                   &m_LocalCoreStartupParameter.bSyncGPU,          false);
 		ini.Get("Core", "FastDiscSpeed",             &m_LocalCoreStartupParameter.bFastDiscSpeed,    false);
+		ini.Get("Core", "DVDTrace",                  &m_LocalCoreStartupParameter.bDVDTrace,         false);
 		ini.Get("Core", "DCBZ",                      &m_LocalCoreStartupParameter.bDCBZOFF,          false);
 		ini.Get("Core", "FrameLimit",                &m_Framelimit,                                  1); // auto frame limit by default
+		ini.Get("Core", "LogFramePacing",            &m_LogFramePacing,                              false);
 		ini.Get("Core", "FrameSkip",                 &m_FrameSkip,                                   0);
+		ini.Get("Core", "StateCompression",          &m_SaveStateCompression,                        0u); // LZO
+		ini.Get("Core", "RewindInterval",            &m_RewindInterval,                              0u);
+		ini.Get("Core", "RewindMemory",              &m_RewindMemory,                                256u);
 
 		// GFX Backend
 		ini.Get("Core", "GFXBackend",  &m_LocalCoreStartupParameter.m_strVideoBackend, "");
@@ -456,6 +468,8 @@ void SConfig::LoadSettings()
 
 		// DSP
 		ini.Get("DSP", "EnableJIT", &m_DSPEnableJIT, true);
+		ini.Get("DSP", "ThreadRunAhead", &m_DSPThreadRunAhead, 0u);
+		ini.Get("DSP", "SincResampling", &m_DSPSincResampling, false);
 		ini.Get("DSP", "DumpAudio", &m_DumpAudio, false);
 	#if defined __linux__ && HAVE_ALSA
 		ini.Get("DSP", "Backend", &sBackend, BACKEND_ALSA);
@@ -50,6 +50,7 @@ struct SConfig : NonCopyable
 	int m_InterfaceLanguage;
 	// framelimit choose
 	unsigned int m_Framelimit;
+	bool m_LogFramePacing; // append per-second frame pacing statistics to Logs/framepacing.txt
 	// other interface settings
 	bool m_InterfaceToolbar;
 	bool m_InterfaceStatusbar;
@@ -89,9 +90,14 @@ struct SConfig : NonCopyable
 	bool m_ShowLag;
 	std::string m_strMovieAuthor;
 	unsigned int m_FrameSkip;
+	u32 m_SaveStateCompression;
+	u32 m_RewindInterval; // video fields between rewind snapshots, 0 = rewind disabled
+	u32 m_RewindMemory;   // MiB
 
 	// DSP settings
 	bool m_DSPEnableJIT;
+	u32 m_DSPThreadRunAhead; // DSP cycles the LLE thread may trail the CPU by, 0 = lockstep
+	bool m_DSPSincResampling; // windowed sinc instead of linear resampling for DMA and streaming audio
 	bool m_DumpAudio;
 	int m_Volume;
 	std::string sBackend;
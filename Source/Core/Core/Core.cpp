@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <cctype>
+#include <cmath>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -14,9 +15,11 @@
 #include "Common/Common.h"
 #include "Common/CommonPaths.h"
 #include "Common/CPUDetect.h"
+#include "Common/FileUtil.h"
 #include "Common/LogManager.h"
 #include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
+#include "Common/StdMutex.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
@@ -87,6 +90,8 @@ std::thread g_EmuThread;
 static std::thread g_cpu_thread;
 static bool g_requestRefreshInfo = false;
 static int g_pauseAndLockDepth = 0;
+// Only one thread at a time may hold the PauseAndLock lock.
+static std::recursive_mutex g_pauseAndLockMutex;
 
 SCoreStartupParameter g_CoreStartupParameter;
 static bool IsFramelimiterTempDisabled = false;
@@ -301,7 +306,14 @@ void CpuThread()
 
 	#if _M_X86_64 || _M_ARM_32
 	if (_CoreParameter.bFastmem)
+	{
 		EMM::InstallExceptionHandler(); // Let's run under memory watch
+
+		// The exception handler only catches faults from the CPU thread on OS X
+		#if _M_X86_64 && !defined(__APPLE__)
+		Memory::EnableWriteTracking();
+		#endif
+	}
 	#endif
 
 	if (!g_stateFileName.empty())
@@ -426,6 +438,9 @@ void EmuThread()
 	// Load GCM/DOL/ELF whatever ... we boot with the interpreter core
 	PowerPC::SetMode(PowerPC::MODE_INTERPRETER);
 
+	if (_CoreParameter.bDVDTrace)
+		VolumeHandler::StartTrace(File::GetUserPath(D_DUMP_IDX) + _CoreParameter.GetUniqueID() + ".dvdtrace");
+
 	CBoot::BootUp();
 
 	// Setup our core, but can't use dynarec if we are compare server
@@ -510,6 +525,7 @@ void EmuThread()
 	g_bHwInit = false;
 	INFO_LOG(CONSOLE, "%s", StopMessage(false, "Shutting down HW").c_str());
 	HW::Shutdown();
+	VolumeHandler::StopTrace();
 	INFO_LOG(CONSOLE, "%s", StopMessage(false, "HW shutdown").c_str());
 	Pad::Shutdown();
 	Wiimote::Shutdown();
@@ -593,24 +609,41 @@ void RequestRefreshInfo()
 
 bool PauseAndLock(bool doLock, bool unpauseOnUnlock)
 {
+	if (doLock)
+		g_pauseAndLockMutex.lock();
+
 	// let's support recursive locking to simplify things on the caller's side,
 	// and let's do it at this outer level in case the individual systems don't support it.
-	if (doLock ? g_pauseAndLockDepth++ : --g_pauseAndLockDepth)
-		return true;
+	bool wasUnpaused = true;
+	if (!(doLock ? g_pauseAndLockDepth++ : --g_pauseAndLockDepth))
+	{
+		// first pause or unpause the cpu
+		wasUnpaused = CCPU::PauseAndLock(doLock, unpauseOnUnlock);
+		ExpansionInterface::PauseAndLock(doLock, unpauseOnUnlock);
 
-	// first pause or unpause the cpu
-	bool wasUnpaused = CCPU::PauseAndLock(doLock, unpauseOnUnlock);
-	ExpansionInterface::PauseAndLock(doLock, unpauseOnUnlock);
+		// audio has to come after cpu, because cpu thread can wait for audio thread (m_throttle).
+		AudioCommon::PauseAndLock(doLock, unpauseOnUnlock);
+		DSP::GetDSPEmulator()->PauseAndLock(doLock, unpauseOnUnlock);
 
-	// audio has to come after cpu, because cpu thread can wait for audio thread (m_throttle).
-	AudioCommon::PauseAndLock(doLock, unpauseOnUnlock);
-	DSP::GetDSPEmulator()->PauseAndLock(doLock, unpauseOnUnlock);
+		// video has to come after cpu, because cpu thread can wait for video thread (s_efbAccessRequested).
+		g_video_backend->PauseAndLock(doLock, unpauseOnUnlock);
+	}
 
-	// video has to come after cpu, because cpu thread can wait for video thread (s_efbAccessRequested).
-	g_video_backend->PauseAndLock(doLock, unpauseOnUnlock);
+	if (!doLock)
+		g_pauseAndLockMutex.unlock();
 	return wasUnpaused;
 }
 
+bool TryPauseAndLock(bool* wasUnpaused)
+{
+	if (!g_pauseAndLockMutex.try_lock())
+		return false;
+
+	*wasUnpaused = PauseAndLock(true);
+	g_pauseAndLockMutex.unlock();
+	return true;
+}
+
 // Apply Frame Limit and Display FPS info
 // This should only be called from VI
 void VideoThrottle()
@@ -678,6 +711,7 @@ void UpdateTitle()
 	float FPS = (float) (Common::AtomicLoad(DrawnFrame) * 1000.0 / ElapseTime);
 	float VPS = (float) (DrawnVideo * 1000.0 / ElapseTime);
 	float Speed = (float) (DrawnVideo * (100 * 1000.0) / (VideoInterface::TargetRefreshRate * ElapseTime));
+	SystemTimers::FramePacingStats pacing = SystemTimers::TakeFramePacingStats();
 
 	// Settings are shown the same for both extended and summary info
 	std::string SSettings = StringFromFormat("%s %s | %s | %s", cpu_core_base->GetName(), _CoreParameter.bCPUThread ? "DC" : "SC",
@@ -717,6 +751,12 @@ void UpdateTitle()
 					SystemTimers::GetTicksPerSecond() / 1000000,
 					_CoreParameter.bSkipIdle ? "~" : "",
 					TicksPercentage);
+
+			SFPS += StringFromFormat(" | Frame: %.2f ms +/- %.2f (max %.2f), %u missed",
+					pacing.mean_frame_ms,
+					std::sqrt(pacing.frame_variance),
+					pacing.max_frame_ms,
+					pacing.missed_deadlines);
 		}
 	}
 	// This is our final "frame counter" string
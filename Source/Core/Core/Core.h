@@ -81,4 +81,8 @@ void UpdateTitle();
 // the return value of the first call should be passed in as the second argument of the second call.
 bool PauseAndLock(bool doLock, bool unpauseOnUnlock=true);
 
+// like PauseAndLock(true), but returns false instead of waiting if another thread holds the lock.
+// for the CPU thread, which must not wait for a thread that is itself waiting for the CPU to pause.
+bool TryPauseAndLock(bool* wasUnpaused);
+
 }  // namespace
@@ -2,7 +2,16 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+
 #include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPInterpreter.h"
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPTables.h"
@@ -12,6 +21,28 @@ namespace DSPAnalyzer {
 // Holds data about all instructions in RAM.
 u8 code_flags[ISPACE];
 
+struct UCodeInfo
+{
+	std::vector<u8> code_flags;  // empty if only the entry points are known
+	std::set<u16> entry_points;
+	u64 last_used = 0;
+};
+
+// Keyed by a hash of IRAM
+static std::map<u64, UCodeInfo> s_ucodes;
+static u64 s_current_ucode;
+static u64 s_use_count;
+
+// Every distinct IRAM content along a multi-part ucode upload gets an entry,
+// so only keep this many of them, dropping the least recently used, and full
+// analysis results for fewer still. The cache file holds the same entries.
+static const size_t MAX_CACHED_UCODES = 128;
+static const size_t MAX_CACHED_ANALYSES = 32;
+static size_t s_num_cached_analyses;
+
+static const u32 CACHE_FILE_MAGIC = 0x4B4C4244; // "DBLK"
+static const u32 CACHE_FILE_VERSION = 1;
+
 // Good candidates for idle skipping is mail wait loops. If we're time slicing
 // between the main CPU and the DSP, if the DSP runs into one of these, it might
 // as well give up its time slice immediately, after executing once.
@@ -150,11 +181,120 @@ void AnalyzeRange(int start_addr, int end_addr)
 	INFO_LOG(DSPLLE, "Finished analysis.");
 }
 
+static void EvictLeastRecentlyUsed()
+{
+	while (s_ucodes.size() > MAX_CACHED_UCODES)
+	{
+		auto oldest = s_ucodes.end();
+		for (auto it = s_ucodes.begin(); it != s_ucodes.end(); ++it)
+		{
+			if (it->first != s_current_ucode && (oldest == s_ucodes.end() || it->second.last_used < oldest->second.last_used))
+				oldest = it;
+		}
+
+		if (!oldest->second.code_flags.empty())
+			s_num_cached_analyses--;
+		s_ucodes.erase(oldest);
+	}
+}
+
 void Analyze()
 {
+	s_current_ucode = GetMurmurHash3((const u8*)g_dsp.iram, DSP_IRAM_BYTE_SIZE, 0);
+	UCodeInfo& ucode = s_ucodes[s_current_ucode];
+	ucode.last_used = ++s_use_count;
+	EvictLeastRecentlyUsed();
+	if (!ucode.code_flags.empty())
+	{
+		INFO_LOG(DSPLLE, "Reusing analysis of ucode %016llx", (unsigned long long)s_current_ucode);
+		memcpy(code_flags, ucode.code_flags.data(), sizeof(code_flags));
+		return;
+	}
+
 	Reset();
 	AnalyzeRange(0x0000, 0x1000);  // IRAM
 	AnalyzeRange(0x8000, 0x9000);  // IROM
+
+	if (s_num_cached_analyses < MAX_CACHED_ANALYSES)
+	{
+		ucode.code_flags.assign(code_flags, code_flags + ISPACE);
+		s_num_cached_analyses++;
+	}
+}
+
+void AddBlockEntryPoint(u16 addr)
+{
+	s_ucodes[s_current_ucode].entry_points.insert(addr);
+}
+
+std::vector<u16> GetBlockEntryPoints()
+{
+	const std::set<u16>& entry_points = s_ucodes[s_current_ucode].entry_points;
+	return std::vector<u16>(entry_points.begin(), entry_points.end());
+}
+
+void LoadCache(const std::string& filename)
+{
+	File::IOFile file(filename, "rb");
+	u32 header[2];
+	if (!file.ReadArray(header, 2) || header[0] != CACHE_FILE_MAGIC || header[1] != CACHE_FILE_VERSION)
+		return;
+
+	// Most recently used first
+	std::vector<std::pair<u64, std::vector<u16>>> records;
+	u64 hash;
+	u32 count;
+	while (records.size() < MAX_CACHED_UCODES && file.ReadArray(&hash, 1) && file.ReadArray(&count, 1) && count <= ISPACE)
+	{
+		std::vector<u16> entry_points(count);
+		if (count && !file.ReadArray(entry_points.data(), count))
+			break;
+
+		records.emplace_back(hash, std::move(entry_points));
+	}
+
+	for (auto it = records.rbegin(); it != records.rend(); ++it)
+	{
+		UCodeInfo& ucode = s_ucodes[it->first];
+		ucode.entry_points.insert(it->second.begin(), it->second.end());
+		ucode.last_used = ++s_use_count;
+	}
+	EvictLeastRecentlyUsed();
+}
+
+void SaveCache(const std::string& filename)
+{
+	File::IOFile file(filename, "wb");
+	const u32 header[2] = { CACHE_FILE_MAGIC, CACHE_FILE_VERSION };
+	file.WriteArray(header, 2);
+
+	std::vector<std::pair<u64, u64>> by_use;  // last use, hash
+	for (const auto& ucode : s_ucodes)
+	{
+		if (!ucode.second.entry_points.empty())
+			by_use.emplace_back(ucode.second.last_used, ucode.first);
+	}
+	std::sort(by_use.rbegin(), by_use.rend());
+	if (by_use.size() > MAX_CACHED_UCODES)
+		by_use.resize(MAX_CACHED_UCODES);
+
+	for (const auto& use : by_use)
+	{
+		const std::set<u16>& ucode_entry_points = s_ucodes[use.second].entry_points;
+		const u32 count = (u32)ucode_entry_points.size();
+		const std::vector<u16> entry_points(ucode_entry_points.begin(), ucode_entry_points.end());
+		file.WriteArray(&use.second, 1);
+		file.WriteArray(&count, 1);
+		file.WriteArray(entry_points.data(), count);
+	}
+}
+
+void ClearCache()
+{
+	s_ucodes.clear();
+	s_current_ucode = 0;
+	s_use_count = 0;
+	s_num_cached_analyses = 0;
 }
 
 }  // namespace
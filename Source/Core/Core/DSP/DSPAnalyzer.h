@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "Core/DSP/DSPInterpreter.h"
 
 // Basic code analysis.
@@ -35,6 +38,21 @@ extern u8 code_flags[ISPACE];
 // all old analysis away. Luckily the entire address space is only 64K code
 // words and the actual code space 8K instructions in total, so we can do
 // some pretty expensive analysis if necessary.
+// Games load the same few ucodes over and over, so the results are kept for
+// every IRAM content seen and reused when the same code is loaded again.
 void Analyze();
 
+// The JIT reports the blocks it compiles for the current IRAM contents. The next
+// time the same ucode is loaded it can compile them up front instead of stalling
+// on each one as it is first reached.
+void AddBlockEntryPoint(u16 addr);
+std::vector<u16> GetBlockEntryPoints();
+
+// Block entry points survive restarts through this file in the user cache directory.
+// Only the most recently used ucodes are kept, in memory and in the file.
+void LoadCache(const std::string& filename);
+void SaveCache(const std::string& filename);
+// Forgets every ucode, at the end of each session
+void ClearCache();
+
 }  // namespace
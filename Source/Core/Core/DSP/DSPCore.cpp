@@ -24,6 +24,7 @@
    ====================================================================*/
 
 #include "Common/Common.h"
+#include "Common/CommonPaths.h"
 #include "Common/Event.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
@@ -202,7 +203,10 @@ bool DSPCore_Init(const std::string& irom_filename, const std::string& coef_file
 
 	// Initialize JIT, if necessary
 	if (bUsingJIT)
+	{
+		DSPAnalyzer::LoadCache(File::GetUserPath(D_CACHE_IDX) + DSP_JIT_CACHE_FILE);
 		dspjit = new DSPEmitter();
+	}
 
 	core_state = DSPCORE_RUNNING;
 	return true;
@@ -216,9 +220,11 @@ void DSPCore_Shutdown()
 	core_state = DSPCORE_STOP;
 
 	if (dspjit) {
+		DSPAnalyzer::SaveCache(File::GetUserPath(D_CACHE_IDX) + DSP_JIT_CACHE_FILE);
 		delete dspjit;
 		dspjit = nullptr;
 	}
+	DSPAnalyzer::ClearCache();
 	DSPCore_FreeMemoryPages();
 }
 
@@ -293,6 +299,37 @@ void DSPCore_CheckExceptions()
 	}
 }
 
+static void CompileUnresolvedJumps()
+{
+	bool retry = true;
+
+	while (retry)
+	{
+		retry = false;
+		for (u16 i = 0x0000; i < 0xffff; ++i)
+		{
+			if (!dspjit->unresolvedJumps[i].empty())
+			{
+				u16 addrToCompile = dspjit->unresolvedJumps[i].front();
+				dspjit->Compile(addrToCompile);
+				if (!dspjit->unresolvedJumps[i].empty())
+					retry = true;
+			}
+		}
+	}
+}
+
+// Compiles the blocks the JIT needed the last time the ucode now in IRAM was loaded.
+static void CompileKnownBlocks()
+{
+	for (u16 addr : DSPAnalyzer::GetBlockEntryPoints())
+	{
+		if (dspjit->blockSize[addr] == 0)
+			dspjit->Compile(addr);
+	}
+	CompileUnresolvedJumps();
+}
+
 // Delegate to JIT or interpreter as appropriate.
 // Handle state changes and stepping.
 int DSPCore_RunCycles(int cycles)
@@ -311,7 +348,10 @@ int DSPCore_RunCycles(int cycles)
 		pExecAddr();
 
 		if (g_dsp.reset_dspjit_codespace)
+		{
 			dspjit->ClearIRAMandDSPJITCodespaceReset();
+			CompileKnownBlocks();
+		}
 
 		return cyclesLeft;
 	}
@@ -370,23 +410,7 @@ void DSPCore_Step()
 void CompileCurrent()
 {
 	dspjit->Compile(g_dsp.pc);
-
-	bool retry = true;
-
-	while (retry)
-	{
-		retry = false;
-		for (u16 i = 0x0000; i < 0xffff; ++i)
-		{
-			if (!dspjit->unresolvedJumps[i].empty())
-			{
-				u16 addrToCompile = dspjit->unresolvedJumps[i].front();
-				dspjit->Compile(addrToCompile);
-				if (!dspjit->unresolvedJumps[i].empty())
-					retry = true;
-			}
-		}
-	}
+	CompileUnresolvedJumps();
 }
 
 u16 DSPCore_ReadRegister(int reg)
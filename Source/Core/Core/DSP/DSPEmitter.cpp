@@ -203,6 +203,7 @@ void DSPEmitter::Compile(u16 start_addr)
 	// Remember the current block address for later
 	startAddr = start_addr;
 	unresolvedJumps[start_addr].clear();
+	DSPAnalyzer::AddBlockEntryPoint(start_addr);
 
 	const u8 *entryPoint = AlignCode16();
 
@@ -50,8 +50,9 @@ This file mainly deals with the [Drive I/F], however [AIDFR] controls
   TODO maybe the files should be merged?
 */
 
+#include <algorithm>
+
 #include "Common/Common.h"
-#include "Common/MathUtil.h"
 
 #include "Core/CoreTiming.h"
 #include "Core/HW/AudioInterface.h"
@@ -280,106 +281,37 @@ void Callback_GetSampleRate(unsigned int &_AISampleRate, unsigned int &_DACSampl
 
 // Callback for the disc streaming
 // WARNING - called from audio thread
-unsigned int Callback_GetStreaming(short* _pDestBuffer, unsigned int _numSamples, unsigned int _sampleRate)
+void Callback_GetStreaming(short* _pDestBuffer, unsigned int _numSamples)
 {
-	if (m_Control.PSTAT && !CCPU::IsStepping())
+	if (!m_Control.PSTAT || CCPU::IsStepping())
 	{
-		static int pos = 0;
-		static short pcm[NGCADPCM::SAMPLES_PER_BLOCK*2];
-		const int lvolume = m_Volume.left;
-		const int rvolume = m_Volume.right;
-
-		if (g_AISSampleRate == 48000 && _sampleRate == 32000)
-		{
-			_dbg_assert_msg_(AUDIO_INTERFACE, !(_numSamples & 1), "Number of Samples: %i must be even!", _numSamples);
-			_numSamples = _numSamples * 3 / 2;
-		}
-
-		int pcm_l = 0, pcm_r = 0;
-		for (unsigned int i = 0; i < _numSamples; i++)
-		{
-			if (pos == 0)
-				ReadStreamBlock(pcm);
-
-			if (g_AISSampleRate == 48000 && _sampleRate == 32000) //downsample 48>32
-			{
-				if (i % 3)
-				{
-					pcm_l = (((pcm_l + (int)pcm[pos*2]) / 2  * lvolume) >> 8) + (int)(*_pDestBuffer);
-					MathUtil::Clamp(&pcm_l, -32767, 32767);
-					*_pDestBuffer++ = pcm_l;
-
-					pcm_r = (((pcm_r + (int)pcm[pos*2+1]) / 2 * rvolume) >> 8) + (int)(*_pDestBuffer);
-					MathUtil::Clamp(&pcm_r, -32767, 32767);
-					*_pDestBuffer++ = pcm_r;
-				}
-				pcm_l = pcm[pos*2];
-				pcm_r = pcm[pos*2+1];
-
-				pos++;
-			}
-			else if (g_AISSampleRate == 32000 && _sampleRate == 48000) //upsample 32>48
-			{
-				//starts with one sample of 0
-				const u32 ratio = (u32)( 65536.0f * 32000.0f / (float)_sampleRate );
-				static u32 frac = 0;
-
-				static s16 l1 = 0;
-				static s16 l2 = 0;
-
-				if (frac >= 0x10000 || frac == 0)
-				{
-					frac &= 0xffff;
-
-					l1 = l2;           //current
-					l2 = pcm[pos * 2]; //next
-				}
-
-				pcm_l = ((l1 << 16) + (l2 - l1) * (u16)frac)  >> 16;
-				pcm_r = ((l1 << 16) + (l2 - l1) * (u16)frac)  >> 16;
-
-
-				pcm_l = (pcm_l * lvolume >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_l, -32767, 32767);
-				*_pDestBuffer++ = pcm_l;
-
-				pcm_r = (pcm_r * lvolume >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_r, -32767, 32767);
-				*_pDestBuffer++ = pcm_r;
+		memset(_pDestBuffer, 0, _numSamples * 4);
+		return;
+	}
 
-				frac += ratio;
-				pos += frac >> 16;
+	static int pos = 0;
+	static short pcm[NGCADPCM::SAMPLES_PER_BLOCK*2];
 
-			}
-			else //1:1 no resampling
-			{
-				pcm_l = (((int)pcm[pos*2] * lvolume) >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_l, -32767, 32767);
-				*_pDestBuffer++ = pcm_l;
+	while (_numSamples)
+	{
+		if (pos == 0)
+			ReadStreamBlock(pcm);
 
-				pcm_r = (((int)pcm[pos*2+1] * rvolume) >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_r, -32767, 32767);
-				*_pDestBuffer++ = pcm_r;
+		const unsigned int count = std::min<unsigned int>(_numSamples, NGCADPCM::SAMPLES_PER_BLOCK - pos);
+		memcpy(_pDestBuffer, &pcm[pos*2], count * 4);
+		_pDestBuffer += count * 2;
+		_numSamples -= count;
 
-				pos++;
-			}
-
-			if (pos == NGCADPCM::SAMPLES_PER_BLOCK)
-				pos = 0;
-		}
-	}
-	else
-	{
-		// Don't overwrite existed sample data
-		/*
-		for (unsigned int i = 0; i < _numSamples * 2; i++)
-		{
-			_pDestBuffer[i] = 0; //silence!
-		}
-		*/
+		pos += count;
+		if (pos == NGCADPCM::SAMPLES_PER_BLOCK)
+			pos = 0;
 	}
+}
 
-	return _numSamples;
+void GetStreamingVolume(unsigned int& left, unsigned int& right)
+{
+	left = m_Volume.left;
+	right = m_Volume.right;
 }
 
 // WARNING - called from audio thread
@@ -416,6 +348,11 @@ unsigned int GetAIDSampleRate()
 	return g_AIDSampleRate;
 }
 
+unsigned int GetAISSampleRate()
+{
+	return g_AISSampleRate;
+}
+
 void Update(u64 userdata, int cyclesLate)
 {
 	if (m_Control.PSTAT)
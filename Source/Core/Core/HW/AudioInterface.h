@@ -24,10 +24,15 @@ void Update(u64 userdata, int cyclesLate);
 
 // Called by DSP emulator
 void Callback_GetSampleRate(unsigned int &_AISampleRate, unsigned int &_DACSampleRate);
-unsigned int Callback_GetStreaming(short* _pDestBuffer, unsigned int _numSamples, unsigned int _sampleRate = 48000);
+// Called by the mixer from the audio thread. Decodes _numSamples stereo
+// streaming samples at the AIS rate, or silence while streaming is stopped.
+void Callback_GetStreaming(short* _pDestBuffer, unsigned int _numSamples);
+// Streaming audio volume, 0-255 per channel
+void GetStreamingVolume(unsigned int& left, unsigned int& right);
 
 // Get the audio rates (48000 or 32000 only)
 unsigned int GetAIDSampleRate();
+unsigned int GetAISSampleRate();
 
 void GenerateAISInterrupt();
 
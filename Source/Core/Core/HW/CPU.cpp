@@ -134,12 +134,17 @@ void CCPU::Break()
 bool CCPU::PauseAndLock(bool doLock, bool unpauseOnUnlock)
 {
 	bool wasUnpaused = !IsStepping();
+
+	// The CPU thread is busy with the caller already. Pausing and restarting it would only
+	// race with the UI changing its state, e.g. undo a concurrent Stop().
+	if (Core::IsCPUThread())
+		return wasUnpaused;
+
 	if (doLock)
 	{
 		// we can't use EnableStepping, that would causes deadlocks with both audio and video
 		PowerPC::Pause();
-		if (!Core::IsCPUThread())
-			m_csCpuOccupied.lock();
+		m_csCpuOccupied.lock();
 	}
 	else
 	{
@@ -149,8 +154,7 @@ bool CCPU::PauseAndLock(bool doLock, bool unpauseOnUnlock)
 			m_StepEvent.Set();
 		}
 
-		if (!Core::IsCPUThread())
-			m_csCpuOccupied.unlock();
+		m_csCpuOccupied.unlock();
 	}
 	return wasUnpaused;
 }
@@ -537,6 +537,8 @@ void Do_ARAM_DMA()
 		g_arDMA.ARAddr &= 0x3ffffff;
 		g_arDMA.MMAddr &= 0x3ffffff;
 
+		Memory::MarkRangeWritten(g_arDMA.MMAddr, g_arDMA.Cnt.count);
+
 		if (g_arDMA.ARAddr < g_ARAM.size)
 		{
 			while (g_arDMA.Cnt.count)
@@ -12,6 +12,7 @@
 #include "Common/LogManager.h"
 #include "Common/StdMutex.h"
 #include "Common/StdThread.h"
+#include "Common/Timer.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -34,6 +35,8 @@ DSPLLE::DSPLLE()
 {
 	m_bIsRunning = false;
 	m_cycle_count = 0;
+	m_run_ahead = 0;
+	memset(&m_thread_stats, 0, sizeof(m_thread_stats));
 }
 
 Common::Event dspEvent;
@@ -86,19 +89,23 @@ void DSPLLE::dsp_thread(DSPLLE *dsp_lle)
 
 	while (dsp_lle->m_bIsRunning)
 	{
-		int cycles = (int)dsp_lle->m_cycle_count;
+		u32 cycles = Common::AtomicLoad(dsp_lle->m_cycle_count);
 		if (cycles > 0)
 		{
-			std::lock_guard<std::mutex> lk(dsp_lle->m_csDSPThreadActive);
-			if (dspjit)
 			{
-				DSPCore_RunCycles(cycles);
+				std::lock_guard<std::mutex> lk(dsp_lle->m_csDSPThreadActive);
+				if (dspjit)
+				{
+					DSPCore_RunCycles(cycles);
+				}
+				else
+				{
+					DSPInterpreter::RunCyclesThread(cycles);
+				}
 			}
-			else
-			{
-				DSPInterpreter::RunCyclesThread(cycles);
-			}
-			Common::AtomicStore(dsp_lle->m_cycle_count, 0);
+			// The CPU may have handed over more cycles in the meantime
+			Common::AtomicAdd(dsp_lle->m_cycle_count, 0 - cycles);
+			ppcEvent.Set();
 		}
 		else
 		{
@@ -129,6 +136,10 @@ bool DSPLLE::Initialize(void *hWnd, bool bWii, bool bDSPThread)
 	DSPCore_Reset();
 
 	m_bIsRunning = true;
+	m_cycle_count = 0;
+	m_run_ahead = SConfig::GetInstance().m_DSPThreadRunAhead;
+	memset(&m_thread_stats, 0, sizeof(m_thread_stats));
+	m_thread_stats.mail_hash = 2166136261u;
 
 	InitInstructionTable();
 
@@ -142,6 +153,14 @@ bool DSPLLE::Initialize(void *hWnd, bool bWii, bool bDSPThread)
 
 void DSPLLE::DSP_StopSoundStream()
 {
+	if (m_bDSPThread)
+	{
+		NOTICE_LOG(DSPLLE, "DSP thread: %u window waits (%llu us), %u mailbox syncs (%llu us)",
+		           m_thread_stats.window_waits, (unsigned long long)m_thread_stats.window_wait_us,
+		           m_thread_stats.mail_syncs, (unsigned long long)m_thread_stats.mail_sync_us);
+	}
+	NOTICE_LOG(DSPLLE, "DSP mail trace: %u mails, hash %08x", m_thread_stats.mails, m_thread_stats.mail_hash);
+
 	DSPInterpreter::Stop();
 	m_bIsRunning = false;
 	if (m_bDSPThread)
@@ -157,8 +176,33 @@ void DSPLLE::Shutdown()
 	DSPCore_Shutdown();
 }
 
+// Blocks the CPU thread until the DSP thread has at most max_pending_cycles left to run.
+void DSPLLE::WaitForDSPThread(u32 max_pending_cycles, u32& waits, u64& wait_us)
+{
+	if (Common::AtomicLoad(m_cycle_count) <= max_pending_cycles)
+		return;
+
+	const u64 start = Common::Timer::GetTimeUs();
+	while (m_bIsRunning && Common::AtomicLoad(m_cycle_count) > max_pending_cycles)
+		ppcEvent.Wait();
+
+	waits++;
+	wait_us += Common::Timer::GetTimeUs() - start;
+}
+
+// With run-ahead the DSP thread trails the CPU, so before the CPU exchanges mail or
+// raises an interrupt the DSP has to catch up to where the inline DSP would be.
+void DSPLLE::SyncDSPThread()
+{
+	if (m_bDSPThread && m_run_ahead)
+		WaitForDSPThread(0, m_thread_stats.mail_syncs, m_thread_stats.mail_sync_us);
+}
+
 u16 DSPLLE::DSP_WriteControlRegister(u16 _uFlag)
 {
+	if (_uFlag & 2)
+		SyncDSPThread();
+
 	DSPInterpreter::WriteCR(_uFlag);
 
 	// Check if the CPU has set an external interrupt (CR_EXTERNAL_INT)
@@ -187,6 +231,11 @@ u16 DSPLLE::DSP_ReadControlRegister()
 
 u16 DSPLLE::DSP_ReadMailBoxHigh(bool _CPUMailbox)
 {
+	// The CPU is polling, either for the DSP to take its mail or for mail from the DSP
+	const u32 mail = gdsp_mbox_peek(_CPUMailbox ? GDSP_MBOX_CPU : GDSP_MBOX_DSP);
+	if (_CPUMailbox == ((mail & 0x80000000) != 0))
+		SyncDSPThread();
+
 	if (_CPUMailbox)
 		return gdsp_mbox_read_h(GDSP_MBOX_CPU);
 	else
@@ -197,8 +246,14 @@ u16 DSPLLE::DSP_ReadMailBoxLow(bool _CPUMailbox)
 {
 	if (_CPUMailbox)
 		return gdsp_mbox_read_l(GDSP_MBOX_CPU);
-	else
-		return gdsp_mbox_read_l(GDSP_MBOX_DSP);
+
+	const u32 mail = gdsp_mbox_peek(GDSP_MBOX_DSP);
+	if (mail & 0x80000000)
+	{
+		m_thread_stats.mails++;
+		m_thread_stats.mail_hash = (m_thread_stats.mail_hash ^ mail) * 16777619;
+	}
+	return gdsp_mbox_read_l(GDSP_MBOX_DSP);
 }
 
 void DSPLLE::DSP_WriteMailBoxHigh(bool _CPUMailbox, u16 _uHighMail)
@@ -217,6 +272,7 @@ void DSPLLE::DSP_WriteMailBoxHigh(bool _CPUMailbox, u16 _uHighMail)
 		}
 #endif
 
+		SyncDSPThread();
 		gdsp_mbox_write_h(GDSP_MBOX_CPU, _uHighMail);
 	}
 	else
@@ -229,6 +285,7 @@ void DSPLLE::DSP_WriteMailBoxLow(bool _CPUMailbox, u16 _uLowMail)
 {
 	if (_CPUMailbox)
 	{
+		SyncDSPThread();
 		gdsp_mbox_write_l(GDSP_MBOX_CPU, _uLowMail);
 	}
 	else
@@ -269,11 +326,11 @@ void DSPLLE::DSP_Update(int cycles)
 	}
 	else
 	{
-		// Wait for dsp thread to complete its cycle. Note: this logic should be thought through.
-		ppcEvent.Wait();
-		Common::AtomicStore(m_cycle_count, dsp_cycles);
+		// Let the DSP thread trail by at most m_run_ahead cycles. With no run-ahead this waits
+		// for it to finish the previous slice, so both run the same slices in lockstep.
+		WaitForDSPThread(m_run_ahead, m_thread_stats.window_waits, m_thread_stats.window_wait_us);
+		Common::AtomicAdd(m_cycle_count, dsp_cycles);
 		dspEvent.Set();
-
 	}
 }
 
@@ -31,13 +31,29 @@ public:
 	virtual void DSP_StopSoundStream() override;
 	virtual u32 DSP_UpdateRate() override;
 
+	struct ThreadStats
+	{
+		u32 window_waits;     // CPU waits because the DSP thread fell a full window behind
+		u64 window_wait_us;
+		u32 mail_syncs;       // CPU waits for the DSP thread at mailbox and interrupt accesses
+		u64 mail_sync_us;
+		u32 mails;            // DSP mails read by the CPU, and a hash of their values, to
+		u32 mail_hash;        // compare a threaded run against the single-threaded path
+	};
+	const ThreadStats& GetThreadStats() const { return m_thread_stats; }
+
 private:
 	static void dsp_thread(DSPLLE* lpParameter);
 
+	void WaitForDSPThread(u32 max_pending_cycles, u32& waits, u64& wait_us);
+	void SyncDSPThread();
+
 	std::thread m_hDSPThread;
 	std::mutex m_csDSPThreadActive;
 	bool m_bWii;
 	bool m_bDSPThread;
 	bool m_bIsRunning;
-	volatile u32 m_cycle_count;
+	volatile u32 m_cycle_count; // DSP cycles handed to the DSP thread that it has not run yet
+	u32 m_run_ahead;
+	ThreadStats m_thread_stats;
 };
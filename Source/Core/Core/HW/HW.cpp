@@ -56,6 +56,10 @@ namespace HW
 
 	void Shutdown()
 	{
+		// Waits for the threads which still read RAM snapshots of a savestate or rewind snapshot,
+		// so it has to come before Memory::Shutdown
+		State::Shutdown();
+
 		SystemTimers::Shutdown();
 		CCPU::Shutdown();
 		ExpansionInterface::Shutdown();
@@ -71,7 +75,6 @@ namespace HW
 			WII_IPC_HLE_Interface::Shutdown();
 		}
 
-		State::Shutdown();
 		CoreTiming::Shutdown();
 	}
 
@@ -158,6 +158,8 @@ void Init()
 	else
 		InitMMIO(mmio_mapping);
 
+	ResetWriteTracking();
+
 	INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p (mirrors at 0 @ %p, 0x80000000 @ %p , 0xC0000000 @ %p)",
 		m_pRAM, m_pPhysicalRAM, m_pVirtualCachedRAM, m_pVirtualUncachedRAM);
 	m_IsInitialized = true;
@@ -166,14 +168,29 @@ void Init()
 void DoState(PointerWrap &p)
 {
 	bool wii = SConfig::GetInstance().m_LocalCoreStartupParameter.bWii;
-	p.DoArray(m_pPhysicalRAM, RAM_SIZE);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		MarkAllPagesWritten();
+
+	// When writing into a sink, RAM and EXRAM are only referenced. A copy-on-write snapshot
+	// keeps their current contents readable until the sink is done with them.
+	PointerWrapSink* sink = p.GetSink();
+	const bool snapshot = sink && BeginRAMSnapshot();
+	if (snapshot)
+		sink->AddReleaseCallback(EndRAMSnapshot);
+
+	if (snapshot)
+		sink->AppendReference(RAM_SIZE, [](u8* dst, size_t offset, size_t size) { ReadRAMSnapshot(false, (u32)offset, dst, (u32)size); });
+	else
+		p.DoArray(m_pPhysicalRAM, RAM_SIZE);
 	//p.DoArray(m_pVirtualEFB, EFB_SIZE);
 	p.DoArray(m_pVirtualL1Cache, L1_CACHE_SIZE);
 	p.DoMarker("Memory RAM");
 	if (bFakeVMEM)
 		p.DoArray(m_pVirtualFakeVMEM, FAKEVMEM_SIZE);
 	p.DoMarker("Memory FakeVMEM");
-	if (wii)
+	if (wii && snapshot)
+		sink->AppendReference(EXRAM_SIZE, [](u8* dst, size_t offset, size_t size) { ReadRAMSnapshot(true, (u32)offset, dst, (u32)size); });
+	else if (wii)
 		p.DoArray(m_pEXRAM, EXRAM_SIZE);
 	p.DoMarker("Memory EXRAM");
 }
@@ -181,6 +198,7 @@ void DoState(PointerWrap &p)
 void Shutdown()
 {
 	m_IsInitialized = false;
+	ResetWriteTracking();
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
 	if (bFakeVMEM) flags |= MV_FAKE_VMEM;
@@ -193,6 +211,8 @@ void Shutdown()
 
 void Clear()
 {
+	MarkAllPagesWritten();
+
 	if (m_pRAM)
 		memset(m_pRAM, 0, RAM_SIZE);
 	if (m_pL1Cache)
@@ -218,6 +238,7 @@ u32 Read_Instruction(const u32 em_address)
 
 void WriteBigEData(const u8 *_pData, const u32 _Address, const size_t _iSize)
 {
+	MarkRangeWritten(_Address, (u32)_iSize);
 	memcpy(GetPointer(_Address), _pData, _iSize);
 }
 
@@ -226,6 +247,7 @@ void Memset(const u32 _Address, const u8 _iValue, const u32 _iLength)
 	u8 *ptr = GetPointer(_Address);
 	if (ptr != nullptr)
 	{
+		MarkRangeWritten(_Address, _iLength);
 		memset(ptr,_iValue,_iLength);
 	}
 	else
@@ -242,6 +264,7 @@ void DMA_LCToMemory(const u32 _MemAddr, const u32 _CacheAddr, const u32 _iNumBlo
 
 	if ((dst != nullptr) && (src != nullptr) && (_MemAddr & 3) == 0 && (_CacheAddr & 3) == 0)
 	{
+		MarkRangeWritten(_MemAddr, 32 * _iNumBlocks);
 		memcpy(dst, src, 32 * _iNumBlocks);
 	}
 	else
@@ -138,6 +138,31 @@ void DMA_LCToMemory(const u32 _iMemAddr, const u32 _iCacheAddr, const u32 _iNumB
 void DMA_MemoryToLC(const u32 _iCacheAddr, const u32 _iMemAddr, const u32 _iNumBlocks);
 void Memset(const u32 _Address, const u8 _Data, const u32 _iLength);
 
+// Page-granular write tracking for caches that depend on the contents of emulated RAM.
+// TrackRange() write-protects the host pages backing a range and returns a generation number,
+// HasRangeChanged() then tells whether any of these pages has been written after that generation.
+// Writes (CPU stores, DMA, host code) are caught through the fastmem exception handler, so tracking
+// only works once EnableWriteTracking() has been called; until then every range is reported as changed.
+// Code which writes to emulated RAM from within a system call (e.g. fread) must call MarkRangeWritten()
+// beforehand, since the kernel fails such writes instead of raising an exception.
+void EnableWriteTracking();
+bool IsWriteTrackingEnabled();
+u64 TrackRange(const u32 _Address, const u32 _iLength);
+bool HasRangeChanged(const u32 _Address, const u32 _iLength, const u64 _Generation);
+void MarkRangeWritten(const u32 _Address, const u32 _iLength);
+bool HandleWriteTrackingFault(const u8* _pHostAddress);
+// For Init(), Shutdown(), Clear() and DoState(): untrack every page, optionally marking it written.
+void ResetWriteTracking();
+void MarkAllPagesWritten();
+
+// Copy-on-write snapshot of RAM and EXRAM, built on write tracking. While it is active, the
+// first write to each page saves the page's old contents, so ReadRAMSnapshot() keeps returning
+// memory as it was at BeginRAMSnapshot(). Only one snapshot can be active at a time;
+// BeginRAMSnapshot() returns false if one already is or write tracking isn't enabled.
+bool BeginRAMSnapshot();
+void ReadRAMSnapshot(bool exram, u32 offset, u8* dst, u32 size);
+void EndRAMSnapshot();
+
 // TLB functions
 void SDRUpdated();
 enum XCheckTLBFlag
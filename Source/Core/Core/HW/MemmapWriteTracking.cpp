@@ -0,0 +1,360 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Write tracking and RAM snapshots, see Memmap.h. This only needs the views
+// of RAM and EXRAM from the rest of the memory map.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/Common.h"
+#include "Common/Flag.h"
+#include "Common/MemoryUtil.h"
+
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+
+namespace Memory
+{
+
+// Defined in Memmap.cpp
+extern u8 *m_pPhysicalRAM;
+extern u8 *m_pVirtualCachedRAM;
+extern u8 *m_pVirtualUncachedRAM;
+extern u8 *m_pPhysicalEXRAM;
+extern u8 *m_pVirtualCachedEXRAM;
+extern u8 *m_pVirtualUncachedEXRAM;
+
+// =================================
+// Write tracking
+// ----------------
+enum
+{
+	TRACKING_PAGE_SHIFT = 12,
+};
+
+// Stamp of a page which isn't write-protected, i.e. which may be modified at any time.
+// Compares greater than any generation handed out by TrackRange.
+static const u64 PAGE_WRITABLE = ~0ULL;
+
+struct TrackedRegion
+{
+	u8** views[4];
+	u32 size;
+	u64* stamps; // generation at which each page got write-protected, or PAGE_WRITABLE
+
+	// Copy-on-write snapshot: pages are copied here before they're made writable again.
+	u8* snapshot;
+	bool* snapshot_saved;
+};
+
+static u64 s_ram_page_stamps[RAM_SIZE >> TRACKING_PAGE_SHIFT];
+static u64 s_exram_page_stamps[EXRAM_SIZE >> TRACKING_PAGE_SHIFT];
+
+static TrackedRegion s_tracked_regions[] =
+{
+	{{&m_pRAM, &m_pPhysicalRAM, &m_pVirtualCachedRAM, &m_pVirtualUncachedRAM}, RAM_SIZE, s_ram_page_stamps, nullptr, nullptr},
+	{{&m_pEXRAM, &m_pPhysicalEXRAM, &m_pVirtualCachedEXRAM, &m_pVirtualUncachedEXRAM}, EXRAM_SIZE, s_exram_page_stamps, nullptr, nullptr},
+};
+
+static bool s_write_tracking_enabled = false;
+static u64 s_write_generation = 0;
+// Also taken from within the exception handler, so this can't be a mutex.
+static Common::Flag s_write_tracking_lock;
+
+static void LockWriteTracking()
+{
+	while (!s_write_tracking_lock.TestAndSet())
+	{
+	}
+}
+
+static void UnlockWriteTracking()
+{
+	s_write_tracking_lock.Clear();
+}
+
+static void SetPagesWritable(const TrackedRegion& region, u32 first_page, u32 num_pages, bool writable)
+{
+	for (unsigned int i = 0; i < ArraySize(region.views); ++i)
+	{
+		u8* view = *region.views[i];
+
+		// On 32-bit, mirrors share a single view
+		bool duplicate = false;
+		for (unsigned int j = 0; j < i; ++j)
+			duplicate |= (*region.views[j] == view);
+		if (!view || duplicate)
+			continue;
+
+		u8* ptr = view + (first_page << TRACKING_PAGE_SHIFT);
+		if (writable)
+			UnWriteProtectMemory(ptr, num_pages << TRACKING_PAGE_SHIFT);
+		else
+			WriteProtectMemory(ptr, num_pages << TRACKING_PAGE_SHIFT);
+	}
+}
+
+// Returns the region backing the given range and its page span, or nullptr if the range isn't tracked.
+static TrackedRegion* GetTrackedRegion(const u32 _Address, const u32 _iLength, u32* first_page, u32* last_page)
+{
+	TrackedRegion* region;
+	switch (_Address >> 28)
+	{
+	case 0x0:
+	case 0x8:
+	case 0xc:
+		region = &s_tracked_regions[0];
+		break;
+
+	case 0x1:
+	case 0x9:
+	case 0xd:
+		if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
+			return nullptr;
+		region = &s_tracked_regions[1];
+		break;
+
+	default:
+		return nullptr;
+	}
+
+	const u32 offset = _Address & 0x0FFFFFFF;
+	if (_iLength == 0 || offset >= region->size || _iLength > region->size - offset)
+		return nullptr;
+
+	*first_page = offset >> TRACKING_PAGE_SHIFT;
+	*last_page = (offset + _iLength - 1) >> TRACKING_PAGE_SHIFT;
+	return region;
+}
+
+// Must be called with the write tracking lock held.
+static void ProtectPages(const TrackedRegion& region, u32 first_page, u32 last_page, u64 generation)
+{
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		if (region.stamps[page] != PAGE_WRITABLE)
+			continue;
+
+		// Protect whole runs of pages at once
+		u32 run_end = page;
+		while (run_end < last_page && region.stamps[run_end + 1] == PAGE_WRITABLE)
+			++run_end;
+
+		std::fill(region.stamps + page, region.stamps + run_end + 1, generation);
+		SetPagesWritable(region, page, run_end - page + 1, false);
+		page = run_end;
+	}
+}
+
+static void MarkPagesWritten(const TrackedRegion& region, u32 first_page, u32 last_page)
+{
+	LockWriteTracking();
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		if (region.stamps[page] == PAGE_WRITABLE)
+			continue;
+
+		// Unprotect whole runs of pages at once
+		u32 run_end = page;
+		while (run_end < last_page && region.stamps[run_end + 1] != PAGE_WRITABLE)
+			++run_end;
+
+		if (region.snapshot)
+		{
+			for (u32 i = page; i <= run_end; ++i)
+			{
+				if (region.snapshot_saved[i])
+					continue;
+				const u32 offset = i << TRACKING_PAGE_SHIFT;
+				memcpy(region.snapshot + offset, *region.views[0] + offset, 1 << TRACKING_PAGE_SHIFT);
+				region.snapshot_saved[i] = true;
+			}
+		}
+
+		std::fill(region.stamps + page, region.stamps + run_end + 1, PAGE_WRITABLE);
+		SetPagesWritable(region, page, run_end - page + 1, true);
+		page = run_end;
+	}
+	UnlockWriteTracking();
+}
+
+void MarkAllPagesWritten()
+{
+	if (!s_write_tracking_enabled)
+		return;
+
+	for (const TrackedRegion& region : s_tracked_regions)
+	{
+		if (*region.views[0])
+			MarkPagesWritten(region, 0, (region.size >> TRACKING_PAGE_SHIFT) - 1);
+	}
+}
+
+static bool s_snapshot_active = false;
+static u64 s_snapshot_generation;
+
+void EndRAMSnapshot()
+{
+	LockWriteTracking();
+	for (TrackedRegion& region : s_tracked_regions)
+	{
+		if (!region.snapshot)
+			continue;
+		FreeMemoryPages(region.snapshot, region.size);
+		delete[] region.snapshot_saved;
+		region.snapshot = nullptr;
+		region.snapshot_saved = nullptr;
+
+		// Pages which were only protected for the snapshot and haven't been written yet would otherwise
+		// keep faulting on the next write. Ranges tracked since then just see them as changed.
+		const u32 num_pages = region.size >> TRACKING_PAGE_SHIFT;
+		for (u32 page = 0; page < num_pages; ++page)
+		{
+			if (region.stamps[page] != s_snapshot_generation)
+				continue;
+
+			u32 run_end = page;
+			while (run_end + 1 < num_pages && region.stamps[run_end + 1] == s_snapshot_generation)
+				++run_end;
+
+			std::fill(region.stamps + page, region.stamps + run_end + 1, PAGE_WRITABLE);
+			SetPagesWritable(region, page, run_end - page + 1, true);
+			page = run_end;
+		}
+	}
+	s_snapshot_active = false;
+	UnlockWriteTracking();
+}
+
+bool BeginRAMSnapshot()
+{
+	if (!s_write_tracking_enabled || s_snapshot_active)
+		return false;
+
+	LockWriteTracking();
+	const u64 generation = s_write_generation++;
+	s_snapshot_generation = generation;
+	for (TrackedRegion& region : s_tracked_regions)
+	{
+		if (!*region.views[0])
+			continue;
+
+		// Only pages which actually get written before the snapshot ends take up memory here.
+		const u32 num_pages = region.size >> TRACKING_PAGE_SHIFT;
+		region.snapshot = (u8*)AllocateMemoryPages(region.size);
+		region.snapshot_saved = new bool[num_pages]();
+		ProtectPages(region, 0, num_pages - 1, generation);
+	}
+	s_snapshot_active = true;
+	UnlockWriteTracking();
+	return true;
+}
+
+void ReadRAMSnapshot(bool exram, u32 offset, u8* dst, u32 size)
+{
+	const TrackedRegion& region = s_tracked_regions[exram ? 1 : 0];
+	while (size)
+	{
+		const u32 page = offset >> TRACKING_PAGE_SHIFT;
+		const u32 len = std::min(size, ((page + 1) << TRACKING_PAGE_SHIFT) - offset);
+
+		// While the lock is held, nobody can make the page writable.
+		LockWriteTracking();
+		const u8* src = region.snapshot_saved[page] ? region.snapshot : *region.views[0];
+		memcpy(dst, src + offset, len);
+		UnlockWriteTracking();
+
+		dst += len;
+		offset += len;
+		size -= len;
+	}
+}
+
+void ResetWriteTracking()
+{
+	if (s_snapshot_active)
+		EndRAMSnapshot();
+	s_write_tracking_enabled = false;
+	s_write_generation = 0;
+	for (const TrackedRegion& region : s_tracked_regions)
+		std::fill(region.stamps, region.stamps + (region.size >> TRACKING_PAGE_SHIFT), PAGE_WRITABLE);
+}
+
+void EnableWriteTracking()
+{
+	// Init has reset the page stamps already, unless tracking is used without it
+	if (!s_write_tracking_enabled)
+		ResetWriteTracking();
+	s_write_tracking_enabled = true;
+}
+
+bool IsWriteTrackingEnabled()
+{
+	return s_write_tracking_enabled;
+}
+
+u64 TrackRange(const u32 _Address, const u32 _iLength)
+{
+	u32 first_page, last_page;
+	TrackedRegion* region = GetTrackedRegion(_Address, _iLength, &first_page, &last_page);
+	if (!s_write_tracking_enabled || !region)
+		return 0;
+
+	LockWriteTracking();
+	const u64 generation = s_write_generation++;
+	ProtectPages(*region, first_page, last_page, generation);
+	UnlockWriteTracking();
+
+	return generation;
+}
+
+bool HasRangeChanged(const u32 _Address, const u32 _iLength, const u64 _Generation)
+{
+	u32 first_page, last_page;
+	TrackedRegion* region = GetTrackedRegion(_Address, _iLength, &first_page, &last_page);
+	if (!s_write_tracking_enabled || !region)
+		return true;
+
+	for (u32 page = first_page; page <= last_page; ++page)
+	{
+		if (region->stamps[page] > _Generation)
+			return true;
+	}
+
+	return false;
+}
+
+void MarkRangeWritten(const u32 _Address, const u32 _iLength)
+{
+	u32 first_page, last_page;
+	TrackedRegion* region = GetTrackedRegion(_Address, _iLength, &first_page, &last_page);
+	if (s_write_tracking_enabled && region)
+		MarkPagesWritten(*region, first_page, last_page);
+}
+
+// Called from the exception handler, on whichever thread caused the fault.
+bool HandleWriteTrackingFault(const u8* _pHostAddress)
+{
+	if (!s_write_tracking_enabled)
+		return false;
+
+	for (const TrackedRegion& region : s_tracked_regions)
+	{
+		for (u8** view : region.views)
+		{
+			if (!*view || _pHostAddress < *view || _pHostAddress >= *view + region.size)
+				continue;
+
+			// If the page is writable already, another thread has handled a fault on it in the meantime.
+			const u32 page = (u32)(_pHostAddress - *view) >> TRACKING_PAGE_SHIFT;
+			MarkPagesWritten(region, page, page);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+}  // namespace Memory
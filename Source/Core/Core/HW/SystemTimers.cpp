@@ -56,8 +56,14 @@ IPC_HLE_PERIOD: For the Wiimote this is the call schedule:
 			CWII_IPC_HLE_WiiMote::Update()
 */
 
+#include <algorithm>
+#include <mutex>
+#include <string>
+
 #include "Common/Atomic.h"
 #include "Common/Common.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
 
@@ -232,28 +238,131 @@ void PatchEngineCallback(u64 userdata, int cyclesLate)
 	CoreTiming::ScheduleEvent(VideoInterface::GetTicksPerFrame() - cyclesLate, et_PatchEngine);
 }
 
-void ThrottleCallback(u64 last_time, int cyclesLate)
+// Sleeps are only accurate to about a millisecond, so the throttle sleeps until
+// this long before its deadline and spins for the rest.
+static const u64 THROTTLE_SPIN_US = 2000;
+
+// If the emulation falls further behind than this (40 ms for one frame on 25 fps
+// games), the throttle gives up catching up and starts pacing from the current time.
+static const u64 THROTTLE_MAX_FALLBACK_US = 40000;
+
+// Frame pacing stats are taken from other threads than the CPU thread
+static std::mutex s_pacing_lock;
+static u64 s_last_frame_time;
+static u32 s_pacing_frames;
+static u32 s_pacing_missed;
+static double s_pacing_sum;
+static double s_pacing_sum_sq;
+static double s_pacing_max;
+static File::IOFile s_pacing_file;
+
+static void WaitUntil(u64 deadline)
+{
+	u64 now = Common::Timer::GetTimeUs();
+	if (deadline > now + THROTTLE_SPIN_US)
+		Common::SleepCurrentThread((int)((deadline - now - THROTTLE_SPIN_US) / 1000));
+
+	while (Common::Timer::GetTimeUs() < deadline)
+		Common::YieldCPU();
+}
+
+static void RecordFrameTime(u64 time, bool missed)
 {
-	u32 time = Common::Timer::GetTimeMs();
+	std::lock_guard<std::mutex> lk(s_pacing_lock);
+	if (missed)
+		s_pacing_missed++;
+	if (s_last_frame_time != 0)
+	{
+		double frame_ms = (time - s_last_frame_time) / 1000.0;
+		s_pacing_frames++;
+		s_pacing_sum += frame_ms;
+		s_pacing_sum_sq += frame_ms * frame_ms;
+		s_pacing_max = std::max(s_pacing_max, frame_ms);
+	}
+	s_last_frame_time = time;
+}
+
+static void ResetFramePacingStats()
+{
+	s_pacing_frames = 0;
+	s_pacing_missed = 0;
+	s_pacing_sum = 0;
+	s_pacing_sum_sq = 0;
+	s_pacing_max = 0;
+}
+
+FramePacingStats TakeFramePacingStats()
+{
+	FramePacingStats stats = {};
+	std::lock_guard<std::mutex> lk(s_pacing_lock);
+	stats.frames = s_pacing_frames;
+	stats.missed_deadlines = s_pacing_missed;
+	stats.max_frame_ms = s_pacing_max;
+	if (s_pacing_frames != 0)
+	{
+		stats.mean_frame_ms = s_pacing_sum / s_pacing_frames;
+		stats.frame_variance = std::max(0.0, s_pacing_sum_sq / s_pacing_frames - stats.mean_frame_ms * stats.mean_frame_ms);
+	}
 
-	int diff = (u32)last_time - time;
+	ResetFramePacingStats();
+
+	if (SConfig::GetInstance().m_LogFramePacing)
+	{
+		if (!s_pacing_file.IsOpen())
+			s_pacing_file.Open(File::GetUserPath(D_LOGS_IDX) + "framepacing.txt", "w");
+
+		std::string line = StringFromFormat("%u %u %.3f %.3f %.3f\n", stats.frames, stats.missed_deadlines,
+			stats.mean_frame_ms, stats.frame_variance, stats.max_frame_ms);
+		s_pacing_file.WriteBytes(line.data(), line.size());
+	}
+
+	return stats;
+}
+
+// Paces emulation against a deadline for every emulated video field. userdata is
+// the deadline in nanoseconds of Common::Timer::GetTimeUs, so that the frame
+// period doesn't get truncated to whole microseconds.
+void ThrottleCallback(u64 deadline, int cyclesLate)
+{
+	const u64 now = Common::Timer::GetTimeUs() * 1000;
 	const SConfig& config = SConfig::GetInstance();
 	bool frame_limiter = config.m_Framelimit && config.m_Framelimit != 2 && !Core::GetIsFramelimiterTempDisabled();
-	u32 next_event = GetTicksPerSecond()/1000;
-	if (SConfig::GetInstance().m_Framelimit > 2)
+
+	u32 target_fps = VideoInterface::TargetRefreshRate;
+	if (config.m_Framelimit > 2)
+		target_fps = (config.m_Framelimit - 1) * 5;
+	if (target_fps == 0)
+		target_fps = 60;
+
+	u32 next_event = VideoInterface::GetTicksPerFrame();
+	if (next_event == 0)
+		next_event = GetTicksPerSecond() / 60;
+
+	// The next deadline is normally up to one period ahead, more than that only
+	// happens for deadlines from another session, restored with a save state.
+	const u64 period = 1000000000 / target_fps;
+	const u64 max_fallback = THROTTLE_MAX_FALLBACK_US * 1000;
+	bool missed = false;
+	if (!frame_limiter || deadline + max_fallback < now || deadline > now + period + max_fallback)
 	{
-		next_event = next_event * (SConfig::GetInstance().m_Framelimit - 1) * 5 / VideoInterface::TargetRefreshRate;
+		if (frame_limiter && deadline + max_fallback < now)
+		{
+			DEBUG_LOG(COMMON, "system too slow, %llu us skipped", (unsigned long long)((now - deadline - max_fallback) / 1000));
+			missed = true;
+		}
+		deadline = now;
 	}
-
-	const int max_fallback = 40; // 40 ms for one frame on 25 fps games
-	if (frame_limiter && abs(diff) > max_fallback)
+	else if (deadline < now)
 	{
-		DEBUG_LOG(COMMON, "system too %s, %d ms skipped", diff<0 ? "slow" : "fast", abs(diff) - max_fallback);
-		last_time = time - max_fallback;
+		missed = true;
 	}
-	else if (frame_limiter && diff > 0)
-		Common::SleepCurrentThread(diff);
-	CoreTiming::ScheduleEvent(next_event - cyclesLate, et_Throttle, last_time + 1);
+	else
+	{
+		WaitUntil(deadline / 1000);
+	}
+
+	RecordFrameTime(Common::Timer::GetTimeUs(), missed);
+	CoreTiming::ScheduleEvent(next_event - cyclesLate, et_Throttle, deadline + period);
 }
 
 // split from Init to break a circular dependency between VideoInterface::Init and SystemTimers::Init
@@ -307,7 +416,9 @@ void Init()
 	CoreTiming::ScheduleEvent(0, et_DSP);
 	CoreTiming::ScheduleEvent(VideoInterface::GetTicksPerFrame(), et_SI);
 	CoreTiming::ScheduleEvent(AUDIO_DMA_PERIOD, et_AudioDMA);
-	CoreTiming::ScheduleEvent(0, et_Throttle, Common::Timer::GetTimeMs());
+	s_last_frame_time = 0;
+	ResetFramePacingStats();
+	CoreTiming::ScheduleEvent(0, et_Throttle, Common::Timer::GetTimeUs() * 1000);
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bSyncGPU)
 		CoreTiming::ScheduleEvent(CP_PERIOD, et_CP);
 
@@ -319,6 +430,7 @@ void Init()
 
 void Shutdown()
 {
+	s_pacing_file.Close();
 	Common::Timer::RestoreResolution();
 }
 
@@ -34,4 +34,17 @@ u32 GetFakeDecrementer();
 void TimeBaseSet();
 u64 GetFakeTimeBase();
 
+struct FramePacingStats
+{
+	u32 frames;
+	u32 missed_deadlines;    // frames that reached the throttle after their deadline
+	double mean_frame_ms;
+	double frame_variance;   // ms^2
+	double max_frame_ms;
+};
+
+// Returns the frame pacing measured since the previous call and starts a new
+// measurement. Appends the result to Logs/framepacing.txt if LogFramePacing is set.
+FramePacingStats TakeFramePacingStats();
+
 }
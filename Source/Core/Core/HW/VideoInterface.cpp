@@ -557,6 +557,7 @@ static void EndField()
 {
 	g_video_backend->Video_EndField();
 	Core::VideoThrottle();
+	State::RewindFieldUpdate();
 }
 
 // Purpose: Send VI interrupt when triggered
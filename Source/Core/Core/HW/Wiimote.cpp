@@ -147,14 +147,10 @@ unsigned int GetAttached()
 // ___________________________________________________________________________
 // Function: DoState
 // Purpose:  Saves/load state
-// input/output: ptr: [Description Needed]
-// input: mode        [Description needed]
+// input/output: p: the state being loaded or saved
 //
-void DoState(u8 **ptr, PointerWrap::Mode mode)
+void DoState(PointerWrap& p)
 {
-	// TODO:
-
-	PointerWrap p(ptr, mode);
 	for (unsigned int i=0; i<MAX_BBMOTES; ++i)
 		((WiimoteEmu::Wiimote*)g_plugin.controllers[i])->DoState(p);
 }
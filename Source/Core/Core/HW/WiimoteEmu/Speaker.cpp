@@ -2,6 +2,10 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include "AudioCommon/AudioCommon.h"
+#include "AudioCommon/Mixer.h"
+#include "Common/Common.h"
+#include "Core/ConfigManager.h"
 #include "Core/HW/WiimoteEmu/WiimoteEmu.h"
 
 //#define WIIMOTE_SPEAKER_DUMP
@@ -66,14 +70,20 @@ void Wiimote::SpeakerData(wm_speaker_data* sd)
 {
 	// TODO consider using static max size instead of new
 	s16 *samples = new s16[sd->length * 2];
+	unsigned int num_samples = 0;
+	unsigned int sample_rate_dividend = 0;
+	unsigned int volume_divisor = 1;
 
 	if (m_reg_speaker.format == 0x40)
 	{
 		// 8 bit PCM
 		for (int i = 0; i < sd->length; ++i)
 		{
-			samples[i] = (s16)(s8)sd->data[i];
+			samples[i] = (s16)(s8)sd->data[i] << 8;
 		}
+		num_samples = sd->length;
+		sample_rate_dividend = 12000000;
+		volume_divisor = 0xff;
 	}
 	else if (m_reg_speaker.format == 0x00)
 	{
@@ -83,6 +93,19 @@ void Wiimote::SpeakerData(wm_speaker_data* sd)
 			samples[i * 2] = adpcm_yamaha_expand_nibble(m_adpcm_state, (sd->data[i] >> 4) & 0xf);
 			samples[i * 2 + 1] = adpcm_yamaha_expand_nibble(m_adpcm_state, sd->data[i] & 0xf);
 		}
+		num_samples = sd->length * 2;
+		sample_rate_dividend = 6000000;
+		volume_divisor = 0x7f;
+	}
+
+	const u16 sample_rate = Common::swap16(m_reg_speaker.sample_rate);
+	if (soundStream && num_samples && sample_rate && SConfig::GetInstance().m_WiimoteEnableSpeaker &&
+	    m_status.speaker && !m_speaker_mute)
+	{
+		CMixer* mixer = soundStream->GetMixer();
+		const unsigned int volume = m_reg_speaker.volume * 256 / volume_divisor;
+		mixer->SetVolume(CMixer::CHANNEL_WIIMOTE_SPEAKER, volume, volume);
+		mixer->PushWiimoteSpeakerSamples(samples, num_samples, sample_rate_dividend / sample_rate);
 	}
 
 #ifdef WIIMOTE_SPEAKER_DUMP
@@ -370,6 +370,7 @@ void WiiSocket::Update(bool read, bool write, bool except)
 					}
 					case IOCTLV_NET_SSL_READ:
 					{
+						Memory::MarkRangeWritten(BufferIn2, BufferInSize2);
 						int ret = ssl_read(&CWII_IPC_HLE_Device_net_ssl::_SSL[sslID].ctx, Memory::GetPointer(BufferIn2), BufferInSize2);
 #ifdef DEBUG_SSL
 						if (ret > 0)
@@ -481,6 +482,8 @@ void WiiSocket::Update(bool read, bool write, bool except)
 					}
 #endif
 					socklen_t addrlen = sizeof(sockaddr_in);
+					// recvfrom fails instead of faulting on write-tracked pages
+					Memory::MarkRangeWritten(BufferOut, BufferOutSize);
 					int ret = recvfrom(fd, data, data_len, flags,
 									BufferOutSize2 ? (struct sockaddr*) &local_name : nullptr,
 									BufferOutSize2 ? &addrlen : nullptr);
@@ -52,13 +52,18 @@ NetPlayClient::~NetPlayClient()
 	{
 		m_do_loop = false;
 		m_thread.join();
+		if (m_udp_thread.joinable())
+			m_udp_thread.join();
 	}
 }
 
 // called from ---GUI--- thread
-NetPlayClient::NetPlayClient(const std::string& address, const u16 port, NetPlayUI* dialog, const std::string& name) : m_dialog(dialog), m_is_running(false), m_do_loop(true)
+NetPlayClient::NetPlayClient(const std::string& address, const u16 port, NetPlayUI* dialog, const std::string& name, bool use_udp)
+	: m_dialog(dialog), m_is_running(false), m_do_loop(true), m_use_udp(use_udp), m_server_address(address), m_server_port(port)
 {
 	m_target_buffer_size = 20;
+	for (u32& seq : m_pad_seq_received)
+		seq = 0;
 	ClearBuffers();
 
 	is_connected = false;
@@ -118,6 +123,21 @@ NetPlayClient::NetPlayClient(const std::string& address, const u16 port, NetPlay
 
 			m_selector.Add(m_socket);
 			m_thread = std::thread(std::mem_fn(&NetPlayClient::ThreadFunc), this);
+
+			// SFML can't bind to a free port of the system's choosing. The
+			// server's port plus our player id is unique among the players of
+			// this server, even if several run on the same machine.
+			if (m_use_udp && !m_udp_socket.Bind(port + m_pid))
+			{
+				WARN_LOG(NETPLAY, "Couldn't bind UDP port %d, using TCP only", port + m_pid);
+				m_use_udp = false;
+			}
+
+			if (m_use_udp)
+			{
+				SendUDPHello();
+				m_udp_thread = std::thread(std::mem_fn(&NetPlayClient::UDPThreadFunc), this);
+			}
 		}
 	}
 	else
@@ -209,12 +229,10 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	case NP_MSG_PAD_DATA :
 		{
 			PadMapping map = 0;
-			NetPad np;
-			packet >> map >> np.nHi >> np.nLo;
+			NetPadState state;
+			packet >> map >> state.seq >> state.hi >> state.lo;
 
-			// trusting server for good map value (>=0 && <4)
-			// add to pad buffer
-			m_pad_buffer[map].Push(np);
+			OnPadData(map, state);
 		}
 		break;
 
@@ -235,6 +253,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 			// trusting server for good map value (>=0 && <4)
 			// add to wiimote buffer
 			m_wiimote_buffer[(unsigned)map].Push(nw);
+			m_wiimote_event.Set();
 		}
 		break;
 
@@ -277,6 +296,18 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 			g_NetPlaySettings.m_EXIDevice[1] = (TEXIDevices) tmp;
 			}
 
+			{
+			// the server numbers pad states from 0 again for the new game
+			std::lock_guard<std::recursive_mutex> lkpad(m_crit.pad);
+			for (u32& seq : m_pad_seq_received)
+				seq = 0;
+			}
+
+			// the hello sent on connecting can arrive before the server has
+			// added us to its player list
+			if (m_use_udp)
+				SendUDPHello();
+
 			m_dialog->OnMsgStartGame();
 		}
 		break;
@@ -292,6 +323,9 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 			PanicAlertT("Other client disconnected while game is running!! NetPlay is disabled. You manually stop the game.");
 			std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
 			m_is_running = false;
+			// wake the CPU thread, which holds the netplay lock while waiting
+			m_pad_event.Set();
+			m_wiimote_event.Set();
 			NetPlay_Disable();
 		}
 		break;
@@ -307,6 +341,11 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 
 			std::lock_guard<std::recursive_mutex> lks(m_crit.send);
 			m_socket.Send(spac);
+
+			// keeps the server's idea of our UDP port current, in case the
+			// first hello got lost or a NAT mapping changed
+			if (m_use_udp)
+				SendUDPHello();
 		}
 		break;
 
@@ -351,6 +390,8 @@ void NetPlayClient::ThreadFunc()
 			//case sf::Socket::Disconnected :
 			default :
 				m_is_running = false;
+				m_pad_event.Set();
+				m_wiimote_event.Set();
 				NetPlay_Disable();
 				m_dialog->AppendChat("< LOST CONNECTION TO SERVER >");
 				PanicAlertT("Lost connection to server!");
@@ -365,6 +406,81 @@ void NetPlayClient::ThreadFunc()
 	return;
 }
 
+// called from ---UDP--- thread
+void NetPlayClient::UDPThreadFunc()
+{
+	sf::SelectorUDP selector;
+	selector.Add(m_udp_socket);
+
+	while (m_do_loop)
+	{
+		if (selector.Wait(0.01f))
+		{
+			sf::Packet rpac;
+			sf::IPAddress sender;
+			unsigned short port;
+			if (m_udp_socket.Receive(rpac, sender, port) == sf::Socket::Done &&
+			    sender == m_server_address && port == m_server_port)
+			{
+				OnUDPData(rpac);
+			}
+		}
+	}
+
+	m_udp_socket.Close();
+}
+
+// called from ---UDP--- thread
+void NetPlayClient::OnUDPData(sf::Packet& packet)
+{
+	MessageId mid;
+	PlayerId pid;
+	u32 game;
+	PadMapping map;
+	u8 count;
+	packet >> mid >> pid >> game >> map >> count;
+
+	if (!packet || mid != NP_MSG_PAD_DATA || map < 0 || map >= 4 || count > NETPLAY_UDP_REDUNDANCY)
+		return;
+
+	// datagrams can be late enough to belong to the previous game
+	{
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+	if (game != m_current_game)
+		return;
+	}
+
+	for (u8 i = 0; i < count; i++)
+	{
+		NetPadState state;
+		packet >> state.seq >> state.hi >> state.lo;
+		if (!packet)
+			return;
+		OnPadData(map, state);
+	}
+}
+
+// called from ---NETPLAY--- and ---UDP--- threads
+void NetPlayClient::OnPadData(const PadMapping map, const NetPadState& state)
+{
+	std::lock_guard<std::recursive_mutex> lkpad(m_crit.pad);
+
+	// Every state arrives over TCP, and over UDP up to
+	// NETPLAY_UDP_REDUNDANCY times more. Only take the next one in order.
+	if (state.seq != m_pad_seq_received[map])
+		return;
+	m_pad_seq_received[map]++;
+
+	NetPad np;
+	np.nHi = state.hi;
+	np.nLo = state.lo;
+
+	// trusting server for good map value (>=0 && <4)
+	// add to pad buffer
+	m_pad_buffer[map].Push(np);
+	m_pad_event.Set();
+}
+
 // called from ---GUI--- thread
 void NetPlayClient::GetPlayerList(std::string& list, std::vector<int>& pid_list)
 {
@@ -429,14 +545,46 @@ void NetPlayClient::SendChatMessage(const std::string& msg)
 // called from ---CPU--- thread
 void NetPlayClient::SendPadState(const PadMapping in_game_pad, const NetPad& np)
 {
+	NetPadState state;
+	state.seq = m_pad_seq_sent[in_game_pad]++;
+	state.hi = np.nHi;
+	state.lo = np.nLo;
+
 	// send to server
 	sf::Packet spac;
 	spac << (MessageId)NP_MSG_PAD_DATA;
 	spac << in_game_pad;
-	spac << np.nHi << np.nLo;
+	spac << state.seq << state.hi << state.lo;
 
 	std::lock_guard<std::recursive_mutex> lks(m_crit.send);
 	m_socket.Send(spac);
+
+	if (m_use_udp)
+	{
+		std::deque<NetPadState>& history = m_pad_history[in_game_pad];
+		history.push_back(state);
+		if (history.size() > NETPLAY_UDP_REDUNDANCY)
+			history.pop_front();
+
+		sf::Packet upac;
+		upac << (MessageId)NP_MSG_PAD_DATA;
+		upac << m_pid << m_current_game << in_game_pad << (u8)history.size();
+		for (const NetPadState& s : history)
+			upac << s.seq << s.hi << s.lo;
+
+		m_udp_socket.Send(upac, m_server_address, m_server_port);
+	}
+}
+
+// called from ---GUI--- and ---NETPLAY--- threads
+void NetPlayClient::SendUDPHello()
+{
+	sf::Packet spac;
+	spac << (MessageId)NP_MSG_UDP_HELLO;
+	spac << m_pid;
+
+	std::lock_guard<std::recursive_mutex> lks(m_crit.send);
+	m_udp_socket.Send(spac, m_server_address, m_server_port);
 }
 
 // called from ---CPU--- thread
@@ -554,6 +702,9 @@ void NetPlayClient::ClearBuffers()
 
 		while (m_wiimote_buffer[i].Size())
 			m_wiimote_buffer[i].Pop();
+
+		m_pad_seq_sent[i] = 0;
+		m_pad_history[i].clear();
 	}
 }
 
@@ -614,8 +765,8 @@ bool NetPlayClient::GetNetPads(const u8 pad_nb, const SPADStatus* const pad_stat
 		if (!m_is_running)
 			return false;
 
-		// TODO: use a condition instead of sleeping
-		Common::SleepCurrentThread(1);
+		// wait for the netplay thread to push some data
+		m_pad_event.Wait();
 	}
 
 	SPADStatus tmp;
@@ -688,10 +839,11 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size)
 
 	while (previousSize[_number] == size && !m_wiimote_buffer[_number].Pop(nw))
 	{
-		// wait for receiving thread to push some data
-		Common::SleepCurrentThread(1);
 		if (false == m_is_running)
 			return false;
+
+		// wait for receiving thread to push some data
+		m_wiimote_event.Wait();
 	}
 
 	// Use a blank input, since we may not have any valid input.
@@ -714,9 +866,9 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size)
 		{
 			while (!m_wiimote_buffer[_number].Pop(nw))
 			{
-				Common::SleepCurrentThread(1);
 				if (false == m_is_running)
 					return false;
+				m_wiimote_event.Wait();
 			}
 			++tries;
 			if (tries > m_target_buffer_size * 200 / 120)
@@ -750,6 +902,8 @@ bool NetPlayClient::StopGame()
 	m_dialog->AppendChat(" -- STOPPING GAME -- ");
 
 	m_is_running = false;
+	m_pad_event.Set();
+	m_wiimote_event.Set();
 	NetPlay_Disable();
 
 	// stop game
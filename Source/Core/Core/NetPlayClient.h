@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <queue>
@@ -13,6 +14,7 @@
 
 #include "Common/Common.h"
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
 #include "Common/FifoQueue.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
@@ -61,8 +63,12 @@ class NetPlayClient
 {
 public:
 	void ThreadFunc();
+	void UDPThreadFunc();
 
-	NetPlayClient(const std::string& address, const u16 port, NetPlayUI* dialog, const std::string& name);
+	// With use_udp, pad states are also sent and received over UDP, on the
+	// same port number as the server's TCP port, which saves the
+	// retransmission delay when a TCP segment gets lost.
+	NetPlayClient(const std::string& address, const u16 port, NetPlayUI* dialog, const std::string& name, bool use_udp = false);
 	~NetPlayClient();
 
 	void GetPlayerList(std::string& list, std::vector<int>& pid_list);
@@ -93,11 +99,18 @@ protected:
 		std::recursive_mutex game;
 		// lock order
 		std::recursive_mutex players, send;
+		// received pad sequence numbers, taken on its own
+		std::recursive_mutex pad;
 	} m_crit;
 
 	Common::FifoQueue<NetPad>     m_pad_buffer[4];
 	Common::FifoQueue<NetWiimote> m_wiimote_buffer[4];
 
+	// Set by the netplay threads after pushing to the buffers above, and when
+	// the game stops, so the CPU thread can wait instead of polling
+	Common::Event m_pad_event;
+	Common::Event m_wiimote_event;
+
 	NetPlayUI*    m_dialog;
 	sf::SocketTCP m_socket;
 	std::thread   m_thread;
@@ -122,10 +135,26 @@ private:
 	void UpdateDevices();
 	void SendPadState(const PadMapping in_game_pad, const NetPad& np);
 	void SendWiimoteState(const PadMapping in_game_pad, const NetWiimote& nw);
+	void SendUDPHello();
+	void OnPadData(const PadMapping map, const NetPadState& state);
 	unsigned int OnData(sf::Packet& packet);
+	void OnUDPData(sf::Packet& packet);
 
 	PlayerId m_pid;
 	std::map<PlayerId, Player> m_players;
+
+	bool          m_use_udp;
+	sf::SocketUDP m_udp_socket;
+	std::thread   m_udp_thread;
+	sf::IPAddress m_server_address;
+	u16           m_server_port;
+
+	// next sequence number expected from the server, per in-game pad
+	u32 m_pad_seq_received[4];
+	// CPU thread only: next sequence number to send and the most recently
+	// sent states, per in-game pad
+	u32 m_pad_seq_sent[4];
+	std::deque<NetPadState> m_pad_history[4];
 };
 
 void NetPlay_Enable(NetPlayClient* const np);
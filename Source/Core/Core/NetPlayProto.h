@@ -28,10 +28,25 @@ struct Rpt : public std::vector<u8>
 
 typedef std::vector<u8> NetWiimote;
 
-#define NETPLAY_VERSION  "Dolphin NetPlay 2014-01-08"
+// One pad state as sent over the wire. seq counts the states of each in-game
+// pad from the start of the game, so a state arriving over both TCP and UDP
+// is only used once.
+struct NetPadState
+{
+	u32 seq;
+	u32 hi;
+	u32 lo;
+};
+
+#define NETPLAY_VERSION  "Dolphin NetPlay 2014-06-20"
 
 const int NETPLAY_INITIAL_GCTIME = 1272737767;
 
+// Number of most recent pad states repeated in every UDP pad datagram, so a
+// lost datagram is covered by the next one. TCP still carries every state and
+// fills in anything longer.
+const unsigned int NETPLAY_UDP_REDUNDANCY = 4;
+
 
 // messages
 enum
@@ -44,6 +59,7 @@ enum
 	NP_MSG_PAD_DATA         = 0x60,
 	NP_MSG_PAD_MAPPING      = 0x61,
 	NP_MSG_PAD_BUFFER       = 0x62,
+	NP_MSG_UDP_HELLO        = 0x63,
 
 	NP_MSG_WIIMOTE_DATA     = 0x70,
 	NP_MSG_WIIMOTE_MAPPING  = 0x71,
@@ -13,6 +13,8 @@ NetPlayServer::~NetPlayServer()
 		m_do_loop = false;
 		m_thread.join();
 		m_socket.Close();
+		if (m_udp_thread.joinable())
+			m_udp_thread.join();
 	}
 
 #ifdef USE_UPNP
@@ -28,6 +30,7 @@ NetPlayServer::NetPlayServer(const u16 port) : is_connected(false), m_is_running
 {
 	memset(m_pad_map, -1, sizeof(m_pad_map));
 	memset(m_wiimote_map, -1, sizeof(m_wiimote_map));
+	memset(m_pad_seq, 0, sizeof(m_pad_seq));
 	if (m_socket.Listen(port))
 	{
 		is_connected = true;
@@ -35,6 +38,12 @@ NetPlayServer::NetPlayServer(const u16 port) : is_connected(false), m_is_running
 		m_selector.Add(m_socket);
 		m_thread = std::thread(std::mem_fn(&NetPlayServer::ThreadFunc), this);
 		m_target_buffer_size = 20;
+
+		// UDP is optional, clients fall back to TCP only if this fails
+		if (m_udp_socket.Bind(port))
+			m_udp_thread = std::thread(std::mem_fn(&NetPlayServer::UDPThreadFunc), this);
+		else
+			WARN_LOG(NETPLAY, "Couldn't bind UDP port %d, pad data will only be relayed over TCP", port);
 	}
 }
 
@@ -71,12 +80,13 @@ void NetPlayServer::ThreadFunc()
 			if (ready_socket == m_socket)
 			{
 				sf::SocketTCP accept_socket;
-				m_socket.Accept(accept_socket);
+				sf::IPAddress accept_address;
+				m_socket.Accept(accept_socket, &accept_address);
 
 				unsigned int error;
 				{
 				std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
-				error = OnConnect(accept_socket);
+				error = OnConnect(accept_socket, accept_address);
 				}
 
 				if (error)
@@ -118,8 +128,124 @@ void NetPlayServer::ThreadFunc()
 		player_entry.second.socket.Close();
 }
 
+// called from ---UDP--- thread
+void NetPlayServer::UDPThreadFunc()
+{
+	sf::SelectorUDP selector;
+	selector.Add(m_udp_socket);
+
+	while (m_do_loop)
+	{
+		if (selector.Wait(0.01f))
+		{
+			sf::Packet rpac;
+			sf::IPAddress sender;
+			unsigned short port;
+			if (m_udp_socket.Receive(rpac, sender, port) == sf::Socket::Done)
+				OnUDPData(rpac, sender, port);
+		}
+	}
+
+	m_udp_socket.Close();
+}
+
+// called from ---UDP--- thread
+void NetPlayServer::OnUDPData(sf::Packet& packet, const sf::IPAddress& sender, unsigned short port)
+{
+	MessageId mid;
+	PlayerId pid;
+	packet >> mid >> pid;
+	if (!packet)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+
+	// Datagrams are easy to spoof, so only accept them from the address the
+	// player's TCP connection comes from. Bad ones are dropped, not kicked.
+	Client* player = nullptr;
+	for (auto& p : m_players)
+	{
+		if (p.second.pid == pid && p.second.address == sender)
+			player = &p.second;
+	}
+	if (!player)
+		return;
+
+	switch (mid)
+	{
+	case NP_MSG_UDP_HELLO :
+		{
+			std::lock_guard<std::recursive_mutex> lks(m_crit.send);
+			player->udp_port = port;
+		}
+		break;
+
+	case NP_MSG_PAD_DATA :
+		{
+			u32 game;
+			PadMapping map;
+			u8 count;
+			packet >> game >> map >> count;
+
+			if (!packet || port != player->udp_port || game != m_current_game)
+				break;
+			if (map < 0 || map >= 4 || m_pad_map[map] != player->pid || count > NETPLAY_UDP_REDUNDANCY)
+				break;
+
+			for (u8 i = 0; i < count; i++)
+			{
+				NetPadState state;
+				packet >> state.seq >> state.hi >> state.lo;
+				if (!packet)
+					break;
+				OnPadData(*player, map, state);
+			}
+		}
+		break;
+
+	default :
+		break;
+	}
+}
+
+// called from ---NETPLAY--- and ---UDP--- threads
+void NetPlayServer::OnPadData(const Client& player, const PadMapping map, const NetPadState& state)
+{
+	std::lock_guard<std::recursive_mutex> lks(m_crit.send);
+
+	// the same state can come in over TCP and several UDP datagrams,
+	// relay each one once
+	if (state.seq != m_pad_seq[map])
+		return;
+	m_pad_seq[map]++;
+
+	std::deque<NetPadState>& history = m_pad_history[map];
+	history.push_back(state);
+	if (history.size() > NETPLAY_UDP_REDUNDANCY)
+		history.pop_front();
+
+	// Relay to clients
+	sf::Packet spac;
+	spac << (MessageId)NP_MSG_PAD_DATA;
+	spac << map << state.seq << state.hi << state.lo;
+	SendToClients(spac, player.pid);
+
+	sf::Packet upac;
+	upac << (MessageId)NP_MSG_PAD_DATA;
+	upac << (PlayerId)0 << m_current_game << map << (u8)history.size();
+	for (const NetPadState& s : history)
+		upac << s.seq << s.hi << s.lo;
+
+	for (auto& p : m_players)
+	{
+		const Client& client = p.second;
+		if (client.pid && client.pid != player.pid && client.udp_port)
+			m_udp_socket.Send(upac, client.address, client.udp_port);
+	}
+}
+
 // called from ---NETPLAY--- thread
-unsigned int NetPlayServer::OnConnect(sf::SocketTCP& socket)
+unsigned int NetPlayServer::OnConnect(sf::SocketTCP& socket, const sf::IPAddress& address)
 {
 	sf::Packet rpac;
 	// TODO: make this not hang / check if good packet
@@ -144,6 +270,8 @@ unsigned int NetPlayServer::OnConnect(sf::SocketTCP& socket)
 
 	Client player;
 	player.socket = socket;
+	player.address = address;
+	player.udp_port = 0;
 	rpac >> player.revision;
 	rpac >> player.name;
 
@@ -392,21 +520,15 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, sf::SocketTCP& socket)
 				break;
 
 			PadMapping map = 0;
-			int hi, lo;
-			packet >> map >> hi >> lo;
+			NetPadState state;
+			packet >> map >> state.seq >> state.hi >> state.lo;
 
 			// If the data is not from the correct player,
 			// then disconnect them.
-			if (m_pad_map[map] != player.pid)
+			if (map < 0 || map >= 4 || m_pad_map[map] != player.pid)
 				return 1;
 
-			// Relay to clients
-			sf::Packet spac;
-			spac << (MessageId)NP_MSG_PAD_DATA;
-			spac << map << hi << lo;
-
-			std::lock_guard<std::recursive_mutex> lks(m_crit.send);
-			SendToClients(spac, player.pid);
+			OnPadData(player, map, state);
 		}
 		break;
 
@@ -538,6 +660,16 @@ bool NetPlayServer::StartGame(const std::string &path)
 	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
 	m_current_game = Common::Timer::GetTimeMs();
 
+	{
+	// pad states are numbered from 0 for every game
+	std::lock_guard<std::recursive_mutex> lks(m_crit.send);
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		m_pad_seq[i] = 0;
+		m_pad_history[i].clear();
+	}
+	}
+
 	// no change, just update with clients
 	AdjustPadBufferSize(m_target_buffer_size);
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <queue>
@@ -22,7 +23,10 @@ class NetPlayServer
 {
 public:
 	void ThreadFunc();
+	void UDPThreadFunc();
 
+	// Listens for TCP connections on port, and for UDP pad data from the
+	// clients that use it on the same port number
 	NetPlayServer(const u16 port);
 	~NetPlayServer();
 
@@ -58,12 +62,18 @@ private:
 		sf::SocketTCP socket;
 		u32 ping;
 		u32 current_game;
+
+		sf::IPAddress address;
+		// 0 until the client has said hello over UDP
+		unsigned short udp_port;
 	};
 
 	void SendToClients(sf::Packet& packet, const PlayerId skip_pid = 0);
-	unsigned int OnConnect(sf::SocketTCP& socket);
+	unsigned int OnConnect(sf::SocketTCP& socket, const sf::IPAddress& address);
 	unsigned int OnDisconnect(sf::SocketTCP& socket);
 	unsigned int OnData(sf::Packet& packet, sf::SocketTCP& socket);
+	void OnUDPData(sf::Packet& packet, const sf::IPAddress& sender, unsigned short port);
+	void OnPadData(const Client& player, const PadMapping map, const NetPadState& state);
 	void UpdatePadMapping();
 	void UpdateWiimoteMapping();
 
@@ -79,6 +89,11 @@ private:
 	PadMapping      m_pad_map[4];
 	PadMapping      m_wiimote_map[4];
 
+	// Next sequence number to relay and the most recently relayed states, per
+	// in-game pad. Protected by m_crit.send.
+	u32             m_pad_seq[4];
+	std::deque<NetPadState> m_pad_history[4];
+
 	std::map<sf::SocketTCP, Client> m_players;
 
 	struct
@@ -94,6 +109,9 @@ private:
 	std::thread m_thread;
 	sf::Selector<sf::SocketTCP> m_selector;
 
+	sf::SocketUDP m_udp_socket;
+	std::thread m_udp_thread;
+
 #ifdef USE_UPNP
 	static void mapPortThread(const u16 port);
 	static void unmapPortThread();
@@ -186,6 +186,8 @@ void Jit64::Init()
 	code_block.m_gpa = &js.gpa;
 	code_block.m_fpa = &js.fpa;
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
+	if (Core::g_CoreStartupParameter.bSkipIdle)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_IDLE);
 }
 
 void Jit64::ClearCache()
@@ -339,6 +341,15 @@ void Jit64::WriteExceptionExit()
 	JMP(asm_routines.dispatcher, true);
 }
 
+// Exit for a branch the analyzer marked as closing a busy wait loop: skip ahead to the next
+// event, which is the only thing that can end the loop, and take any interrupt it raised.
+void Jit64::WriteIdleExit(u32 destination)
+{
+	ABI_CallFunctionC((void *)&PowerPC::OnIdleLoop, js.blockStart);
+	MOV(32, M(&PC), Imm32(destination));
+	WriteExceptionExit();
+}
+
 void Jit64::WriteExternalExceptionExit()
 {
 	Cleanup();
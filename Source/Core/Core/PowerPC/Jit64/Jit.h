@@ -92,6 +92,7 @@ public:
 	void WriteExit(u32 destination);
 	void WriteExitDestInEAX();
 	void WriteExceptionExit();
+	void WriteIdleExit(u32 destination);
 	void WriteExternalExceptionExit();
 	void WriteRfiExitDestInEAX();
 	void WriteCallInterpreter(UGeckoInstruction _inst);
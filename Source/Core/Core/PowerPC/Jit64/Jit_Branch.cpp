@@ -83,11 +83,13 @@ void Jit64::bx(UGeckoInstruction inst)
 	if (inst.LK)
 		AND(32, M(&PowerPC::ppcState.cr), Imm32(~(0xFF000000)));
 #endif
+	if (js.op->branchIsIdleLoop)
+	{
+		WriteIdleExit(destination);
+		return;
+	}
 	if (destination == js.compilerPC)
 	{
-		//PanicAlert("Idle loop detected at %08x", destination);
-		// CALL(ProtectFunction(&CoreTiming::Idle, 0));
-		// JMP(Asm::testExceptions, true);
 		// make idle loops go faster
 		js.downcountAmount += 8;
 	}
@@ -135,7 +137,10 @@ void Jit64::bcx(UGeckoInstruction inst)
 
 	gpr.Flush(FLUSH_MAINTAIN_STATE);
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
-	WriteExit(destination);
+	if (js.op->branchIsIdleLoop)
+		WriteIdleExit(destination);
+	else
+		WriteExit(destination);
 
 	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
 		SetJumpTarget( pConditionDontBranch );
@@ -537,6 +537,72 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	}
 }
 
+// Returns true if code[index] is a branch back to the start of the block that closes a
+// busy wait loop: every instruction before it is an integer op or a plain load, and no
+// register carries a value from one iteration to the next. Such a loop computes the same
+// result on every pass until something outside the CPU changes the memory it polls.
+static bool IsBusyWaitLoop(CodeBlock *block, CodeOp *code, u32 index)
+{
+	const UGeckoInstruction inst = code[index].inst;
+	u32 destination;
+	if (inst.OPCD == 18)
+	{
+		// bx
+		if (inst.LK)
+			return false;
+		if (inst.AA)
+			destination = SignExt26(inst.LI << 2);
+		else
+			destination = code[index].address + SignExt26(inst.LI << 2);
+	}
+	else if (inst.OPCD == 16)
+	{
+		// bcx, loops counting down CTR end on their own
+		if (inst.LK || (inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+			return false;
+		if (inst.AA)
+			destination = SignExt16(inst.BD << 2);
+		else
+			destination = code[index].address + SignExt16(inst.BD << 2);
+	}
+	else
+	{
+		return false;
+	}
+
+	if (destination != block->m_address)
+		return false;
+
+	u32 read = 0;
+	u32 written = 0;
+	for (u32 i = 0; i < index; i++)
+	{
+		const CodeOp &op = code[i];
+		if (op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_LOAD)
+			return false;
+		if (op.opinfo->flags & (FL_READ_CA | FL_EVIL))
+			return false;
+
+		for (s8 reg : op.regsIn)
+		{
+			if (reg >= 0 && !(written & (1 << reg)))
+				read |= 1 << reg;
+		}
+		for (s8 reg : op.regsOut)
+		{
+			if (reg < 0)
+				continue;
+			// Overwriting a register the loop reads on entry (a counter, a pointer that is
+			// advanced) makes the next pass different.
+			if (read & (1 << reg))
+				return false;
+			written |= 1 << reg;
+		}
+	}
+
+	return true;
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize)
 {
 	// Clear block stats
@@ -741,6 +807,15 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 		code[i].wantsPS1 = wantsPS1;
 	}
 	block->m_num_instructions = num_inst;
+
+	if (HasOption(OPTION_BRANCH_IDLE))
+	{
+		for (u32 i = 0; i < num_inst; i++)
+		{
+			if (code[i].opinfo->type == OPTYPE_BRANCH)
+				code[i].branchIsIdleLoop = IsBusyWaitLoop(block, code, i);
+		}
+	}
 	return address;
 }
 
@@ -38,6 +38,7 @@ struct CodeOp //16B
 	bool outputCR1;
 	bool outputPS1;
 	bool skip;  // followed BL-s for example
+	bool branchIsIdleLoop; // branches back to the start of a side-effect-free polling loop
 };
 
 struct BlockStats
@@ -165,6 +166,11 @@ public:
 		// Requires JIT support to work.
 		// XXX: NOT COMPLETE
 		OPTION_FORWARD_JUMP = (1 << 3),
+
+		// Mark branches that close a busy wait loop.
+		// The loop is polling memory that only changes when the next event runs, so the
+		// JIT can skip straight to that event instead of spinning until it is due.
+		OPTION_BRANCH_IDLE = (1 << 4),
 	};
 
 
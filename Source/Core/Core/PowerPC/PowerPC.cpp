@@ -2,12 +2,17 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 #include "Common/Atomic.h"
 #include "Common/ChunkFile.h"
 #include "Common/Common.h"
 #include "Common/FPURoundMode.h"
 #include "Common/MathUtil.h"
 
+#include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/Host.h"
@@ -39,6 +44,15 @@ BreakPoints breakpoints;
 MemChecks memchecks;
 PPCDebugInterface debug_interface;
 
+struct IdleLoopStats
+{
+	u32 hits;
+	u64 skipped_cycles;
+};
+
+// Busy wait loops the JIT skipped, keyed by the address of the loop
+static std::map<u32, IdleLoopStats> s_idle_loops;
+
 u32 CompactCR()
 {
 	u32 new_cr = ppcState.cr_fast[0] << 28;
@@ -128,6 +142,7 @@ void Init(int cpu_core)
 
 	ResetRegisters();
 	PPCTables::InitTables(cpu_core);
+	s_idle_loops.clear();
 
 	// We initialize the interpreter because
 	// it is used on boot and code window independently.
@@ -163,8 +178,29 @@ void Init(int cpu_core)
 	ppcState.iCache.Init();
 }
 
+static void ReportIdleLoops()
+{
+	if (s_idle_loops.empty())
+		return;
+
+	std::vector<std::pair<u32, IdleLoopStats>> loops(s_idle_loops.begin(), s_idle_loops.end());
+	std::sort(loops.begin(), loops.end(), [](const std::pair<u32, IdleLoopStats>& a, const std::pair<u32, IdleLoopStats>& b) {
+		return a.second.skipped_cycles > b.second.skipped_cycles;
+	});
+
+	NOTICE_LOG(POWERPC, "Idle loops skipped in %s:", SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID().c_str());
+	for (const auto& loop : loops)
+	{
+		NOTICE_LOG(POWERPC, "  %08x: %u times, %llu cycles (%.1f s)", loop.first, loop.second.hits,
+		           (unsigned long long)loop.second.skipped_cycles,
+		           (double)loop.second.skipped_cycles / SystemTimers::GetTicksPerSecond());
+	}
+}
+
 void Shutdown()
 {
+	ReportIdleLoops();
+	s_idle_loops.clear();
 	JitInterface::Shutdown();
 	interpreter->Shutdown();
 	cpu_core_base = nullptr;
@@ -515,6 +551,16 @@ void OnIdleIL()
 	CoreTiming::Idle();
 }
 
+void OnIdleLoop(u32 address)
+{
+	const u64 idle_ticks = CoreTiming::GetIdleTicks();
+	CoreTiming::Idle();
+
+	IdleLoopStats& stats = s_idle_loops[address];
+	stats.hits++;
+	stats.skipped_cycles += CoreTiming::GetIdleTicks() - idle_ticks;
+}
+
 }  // namespace
 
 
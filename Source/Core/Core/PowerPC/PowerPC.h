@@ -104,6 +104,8 @@ void ExpandCR(u32 cr);
 
 void OnIdle(u32 _uThreadAddr);
 void OnIdleIL();
+// Called by the JIT when a busy wait loop starting at address is about to spin again
+void OnIdleLoop(u32 address);
 
 void UpdatePerformanceMonitor(u32 cycles, u32 num_load_stores, u32 num_fp_inst);
 
@@ -2,10 +2,12 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <deque>
 #include <lzo/lzo1x.h>
 
 #include "Common/Common.h"
 #include "Common/Event.h"
+#include "Common/Flag.h"
 #include "Common/StdMutex.h"
 #include "Common/StdThread.h"
 #include "Common/StringUtil.h"
@@ -15,7 +17,9 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
 #include "Core/State.h"
+#include "Core/StateCompression.h"
 #include "Core/HW/CPU.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/HW.h"
@@ -30,30 +34,13 @@
 namespace State
 {
 
-#if defined(__LZO_STRICT_16BIT)
-static const u32 IN_LEN = 8 * 1024u;
-#elif defined(LZO_ARCH_I086) && !defined(LZO_HAVE_MM_HUGE_ARRAY)
-static const u32 IN_LEN = 60 * 1024u;
-#else
-static const u32 IN_LEN = 128 * 1024u;
-#endif
-
-static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
-
-static unsigned char __LZO_MMODEL out[OUT_LEN];
-
-#define HEAP_ALLOC(var, size) \
-	lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
-
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
-
 static std::string g_last_filename;
 
 static CallbackFunc g_onAfterLoadCb = nullptr;
 
 // Temporary undo state buffer
 static std::vector<u8> g_undo_load_buffer;
-static std::vector<u8> g_current_buffer;
+static PointerWrapSink g_current_buffer;
 static int g_loadDepth = 0;
 
 static std::mutex g_cs_undo_load_buffer;
@@ -105,7 +92,7 @@ void DoState(PointerWrap &p)
 	p.DoMarker("video_backend");
 
 	if (Core::g_CoreStartupParameter.bWii)
-		Wiimote::DoState(p.GetPPtr(), p.GetMode());
+		Wiimote::DoState(p);
 	p.DoMarker("Wiimote");
 
 	PowerPC::DoState(p);
@@ -133,16 +120,14 @@ void SaveToBuffer(std::vector<u8>& buffer)
 {
 	bool wasUnpaused = Core::PauseAndLock(true);
 
-	u8* ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-
+	PointerWrapSink sink;
+	PointerWrap p(&sink);
 	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-	buffer.resize(buffer_size);
 
-	ptr = &buffer[0];
-	p.SetMode(PointerWrap::MODE_WRITE);
-	DoState(p);
+	buffer.resize(sink.Size());
+	if (!buffer.empty())
+		sink.Read(0, buffer.size(), &buffer[0]);
+	sink.Clear();
 
 	Core::PauseAndLock(false, wasUnpaused);
 }
@@ -203,9 +188,10 @@ std::map<double, int> GetSavedStates()
 
 struct CompressAndDumpState_args
 {
-	std::vector<u8>* buffer_vector;
+	PointerWrapSink* buffer_sink;
 	std::mutex* buffer_mutex;
 	std::string filename;
+	u32 codec;
 	bool wait;
 };
 
@@ -215,8 +201,8 @@ void CompressAndDumpState(CompressAndDumpState_args save_args)
 	if (!save_args.wait)
 		g_compressAndDumpStateSyncEvent.Set();
 
-	const u8* const buffer_data = &(*(save_args.buffer_vector))[0];
-	const size_t buffer_size = (save_args.buffer_vector)->size();
+	PointerWrapSink& buffer_sink = *save_args.buffer_sink;
+	const size_t buffer_size = buffer_sink.Size();
 	std::string& filename = save_args.filename;
 
 	// For easy debugging
@@ -245,6 +231,7 @@ void CompressAndDumpState(CompressAndDumpState_args save_args)
 	if (!f)
 	{
 		Core::DisplayMessage("Could not save state", 2000);
+		buffer_sink.Clear();
 		g_compressAndDumpStateSyncEvent.Set();
 		return;
 	}
@@ -259,39 +246,27 @@ void CompressAndDumpState(CompressAndDumpState_args save_args)
 
 	if (header.size != 0) // non-zero header size means the state is compressed
 	{
-		lzo_uint i = 0;
-		while (true)
+		std::vector<u8> compressed;
+		if (CompressStateData(save_args.codec, buffer_size,
+			[&](size_t offset, size_t size, u8* dst) { buffer_sink.Read(offset, size, dst); }, compressed))
 		{
-			lzo_uint32 cur_len = 0;
-			lzo_uint out_len = 0;
-
-			if ((i + IN_LEN) >= buffer_size)
-			{
-				cur_len = (lzo_uint32)(buffer_size - i);
-			}
-			else
-			{
-				cur_len = IN_LEN;
-			}
-
-			if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-				PanicAlertT("Internal LZO Error - compression failed");
-
-			// The size of the data to write is 'out_len'
-			f.WriteArray((lzo_uint32*)&out_len, 1);
-			f.WriteBytes(out, out_len);
-
-			if (cur_len != IN_LEN)
-				break;
-
-			i += cur_len;
+			f.WriteBytes(&compressed[0], compressed.size());
 		}
 	}
 	else // uncompressed
 	{
-		f.WriteBytes(buffer_data, buffer_size);
+		std::vector<u8> in(IN_LEN);
+		for (size_t i = 0; i < buffer_size; i += IN_LEN)
+		{
+			const size_t cur_len = std::min<size_t>(IN_LEN, buffer_size - i);
+			buffer_sink.Read(i, cur_len, &in[0]);
+			f.WriteBytes(&in[0], cur_len);
+		}
 	}
 
+	// Also drops the copy-on-write protection of memory referenced by the state.
+	buffer_sink.Clear();
+
 	Core::DisplayMessage(StringFromFormat("Saved State to %s", filename.c_str()), 2000);
 	g_compressAndDumpStateSyncEvent.Set();
 }
@@ -301,18 +276,12 @@ void SaveAs(const std::string& filename, bool wait)
 	// Pause the core while we save the state
 	bool wasUnpaused = Core::PauseAndLock(true);
 
-	// Measure the size of the buffer.
-	u8 *ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-	// Then actually do the write.
+	// Write the state in a single pass. Large memory blocks are only referenced, the save thread
+	// copies them out while the emulator is already running again.
+	PointerWrap p(&g_current_buffer);
 	{
 		std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-		g_current_buffer.resize(buffer_size);
-		ptr = &g_current_buffer[0];
-		p.SetMode(PointerWrap::MODE_WRITE);
+		g_current_buffer.Clear();
 		DoState(p);
 	}
 
@@ -321,9 +290,10 @@ void SaveAs(const std::string& filename, bool wait)
 		Core::DisplayMessage("Saving State...", 1000);
 
 		CompressAndDumpState_args save_args;
-		save_args.buffer_vector = &g_current_buffer;
+		save_args.buffer_sink = &g_current_buffer;
 		save_args.buffer_mutex = &g_cs_current_buffer;
 		save_args.filename = filename;
+		save_args.codec = (SConfig::GetInstance().m_SaveStateCompression == COMPRESSION_ZLIB) ? COMPRESSION_ZLIB : COMPRESSION_LZO;
 		save_args.wait = wait;
 
 		Flush();
@@ -336,6 +306,8 @@ void SaveAs(const std::string& filename, bool wait)
 	{
 		// someone aborted the save by changing the mode?
 		Core::DisplayMessage("Unable to Save : Internal DoState Error", 4000);
+		std::lock_guard<std::mutex> lk(g_cs_current_buffer);
+		g_current_buffer.Clear();
 	}
 
 	// Resume the core and disable stepping
@@ -382,29 +354,16 @@ void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data)
 	{
 		Core::DisplayMessage("Decompressing State...", 500);
 
-		buffer.resize(header.size);
-
-		lzo_uint i = 0;
-		while (true)
+		const size_t data_size = (size_t)(f.GetSize() - sizeof(StateHeader));
+		std::vector<u8> data(data_size);
+		if (data_size == 0 || !f.ReadBytes(&data[0], data_size))
 		{
-			lzo_uint32 cur_len = 0;  // number of bytes to read
-			lzo_uint new_len = 0;  // number of bytes to write
-
-			if (!f.ReadArray(&cur_len, 1))
-				break;
-
-			f.ReadBytes(out, cur_len);
-			const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-			if (res != LZO_E_OK)
-			{
-				// This doesn't seem to happen anymore.
-				PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-					"Try loading the state again", res, i, new_len);
-				return;
-			}
-
-			i += new_len;
+			PanicAlert("wtf? reading bytes: %i", (int)data_size);
+			return;
 		}
+
+		if (!DecompressStateData(data, header.size, buffer))
+			return;
 	}
 	else // uncompressed
 	{
@@ -515,22 +474,306 @@ void VerifyAt(const std::string& filename)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
+// The newest rewind snapshot is kept uncompressed. Every older one is stored as its XOR with the
+// next newer snapshot, LZO compressed in IN_LEN chunks. Chunks which didn't change between the two
+// snapshots are left empty, so memory which stays the same costs nothing.
+struct RewindEntry
+{
+	u32 size;
+	size_t compressed_size;
+	std::vector<std::vector<u8>> chunks;
+};
+
+static std::mutex g_cs_rewind;
+static std::deque<RewindEntry> g_rewind_history; // oldest first
+static std::vector<u8> g_rewind_newest;
+static size_t g_rewind_history_size; // compressed bytes in g_rewind_history
+static RewindStats g_rewind_stats;
+
+static int ev_Rewind;
+static u32 g_rewind_fields;
+static PointerWrapSink g_rewind_sink;
+static std::thread g_rewind_thread;
+static Common::Flag g_rewind_busy;
+
+// dst = src ^ other[offset, offset + size), with other zero-extended past its end
+static void XorChunk(u8* dst, const u8* src, const std::vector<u8>& other, size_t offset, size_t size)
+{
+	const size_t overlap = (offset < other.size()) ? std::min(size, other.size() - offset) : 0;
+	for (size_t i = 0; i < overlap; i++)
+		dst[i] = src[i] ^ other[offset + i];
+	memcpy(dst + overlap, src + overlap, size - overlap);
+}
+
+// Must be called with g_cs_rewind held.
+static void UpdateRewindStats()
+{
+	g_rewind_stats.num_snapshots = g_rewind_newest.empty() ? 0 : (u32)g_rewind_history.size() + 1;
+	g_rewind_stats.memory_used = g_rewind_history_size + g_rewind_newest.size();
+	g_rewind_stats.memory_budget = (u64)SConfig::GetInstance().m_RewindMemory << 20;
+	g_rewind_stats.uncompressed_size = g_rewind_newest.size();
+	for (const RewindEntry& entry : g_rewind_history)
+		g_rewind_stats.uncompressed_size += entry.size;
+}
+
+static void CompressRewindSnapshot(u64 capture_us)
+{
+	Common::SetCurrentThreadName("Rewind thread");
+	const u64 start = Common::Timer::GetTimeUs();
+
+	// Also ends the copy-on-write snapshot of RAM as early as possible.
+	std::vector<u8> state(g_rewind_sink.Size());
+	g_rewind_sink.Read(0, state.size(), &state[0]);
+	g_rewind_sink.Clear();
+
+	// Only this thread and Rewind(), which waits for it, change g_rewind_newest.
+	const std::vector<u8>& older = g_rewind_newest;
+	RewindEntry entry;
+	entry.size = (u32)older.size();
+	entry.compressed_size = 0;
+	entry.chunks.resize((older.size() + IN_LEN - 1) / IN_LEN);
+
+	RunWorkers(entry.chunks.size(), [&](size_t first, size_t stride)
+	{
+		std::vector<u8> delta(IN_LEN);
+		std::vector<u64> wrkmem;
+
+		for (size_t i = first; i < entry.chunks.size(); i += stride)
+		{
+			const size_t offset = i * IN_LEN;
+			const u32 cur_len = (u32)std::min<size_t>(IN_LEN, older.size() - offset);
+			if (offset + cur_len <= state.size() && !memcmp(&older[offset], &state[offset], cur_len))
+				continue;
+
+			XorChunk(&delta[0], &older[offset], state, offset, cur_len);
+			CompressChunk(COMPRESSION_LZO, &delta[0], cur_len, entry.chunks[i], wrkmem);
+			entry.chunks[i].shrink_to_fit();
+		}
+	});
+
+	for (const std::vector<u8>& chunk : entry.chunks)
+		entry.compressed_size += chunk.size();
+
+	{
+		std::lock_guard<std::mutex> lk(g_cs_rewind);
+		if (!g_rewind_newest.empty())
+		{
+			g_rewind_history_size += entry.compressed_size;
+			g_rewind_history.push_back(std::move(entry));
+		}
+		g_rewind_newest.swap(state);
+
+		// Stay within the memory budget by forgetting the oldest snapshots
+		const u64 budget = (u64)SConfig::GetInstance().m_RewindMemory << 20;
+		while (!g_rewind_history.empty() && g_rewind_history_size + g_rewind_newest.size() > budget)
+		{
+			g_rewind_history_size -= g_rewind_history.front().compressed_size;
+			g_rewind_history.pop_front();
+		}
+
+		g_rewind_stats.last_capture_us = capture_us;
+		g_rewind_stats.last_compress_us = Common::Timer::GetTimeUs() - start;
+		UpdateRewindStats();
+	}
+
+	g_rewind_busy.Clear();
+}
+
+static void RewindCallback(u64 userdata, int cyclesLate)
+{
+	// Rather skip a snapshot than stall the emulator while the previous one is still being compressed,
+	// or wait for another thread that is just pausing the emulator, and thereby the CPU thread.
+	bool wasUnpaused;
+	if (g_rewind_busy.IsSet() || !Core::TryPauseAndLock(&wasUnpaused))
+	{
+		std::lock_guard<std::mutex> lk(g_cs_rewind);
+		g_rewind_stats.dropped++;
+		return;
+	}
+
+	const u64 start = Common::Timer::GetTimeUs();
+	if (g_rewind_thread.joinable())
+		g_rewind_thread.join();
+
+	// RAM is only referenced, the rewind thread copies it out while the emulator is running again.
+	PointerWrap p(&g_rewind_sink);
+	DoState(p);
+
+	if (p.GetMode() == PointerWrap::MODE_WRITE)
+	{
+		g_rewind_busy.Set();
+		g_rewind_thread = std::thread(CompressRewindSnapshot, Common::Timer::GetTimeUs() - start);
+	}
+	else
+	{
+		g_rewind_sink.Clear();
+	}
+
+	Core::PauseAndLock(false, wasUnpaused);
+}
+
+void RewindFieldUpdate()
+{
+	const u32 interval = SConfig::GetInstance().m_RewindInterval;
+	if (interval == 0 || ++g_rewind_fields < interval)
+		return;
+	g_rewind_fields = 0;
+
+	// Rewinding would desync movies and netplay
+	if (Movie::IsRecordingInput() || Movie::IsPlayingInput() || NetPlay::IsNetPlayRunning())
+		return;
+
+	// We're within the VI event here. Take the snapshot from an event of its own, after the VI event
+	// has rescheduled itself, so that the snapshot includes it.
+	CoreTiming::ScheduleEvent(0, ev_Rewind);
+}
+
+// Must be called with g_cs_rewind held and the rewind thread finished.
+static void DropNewestRewindSnapshot()
+{
+	if (g_rewind_history.empty())
+	{
+		std::vector<u8>().swap(g_rewind_newest);
+		return;
+	}
+
+	const RewindEntry& entry = g_rewind_history.back();
+	std::vector<u8> older(entry.size);
+	std::vector<u8> chunk_ok(entry.chunks.size());
+
+	RunWorkers(entry.chunks.size(), [&](size_t first, size_t stride)
+	{
+		std::vector<u8> delta(IN_LEN);
+		for (size_t i = first; i < entry.chunks.size(); i += stride)
+		{
+			const size_t offset = i * IN_LEN;
+			const u32 cur_len = (u32)std::min<size_t>(IN_LEN, entry.size - offset);
+			if (entry.chunks[i].empty())
+			{
+				memcpy(&older[offset], &g_rewind_newest[offset], cur_len);
+				chunk_ok[i] = true;
+				continue;
+			}
+
+			chunk_ok[i] = DecompressChunk(COMPRESSION_LZO, &entry.chunks[i][0], (u32)entry.chunks[i].size(), &delta[0], cur_len);
+			XorChunk(&older[offset], &delta[0], g_rewind_newest, offset, cur_len);
+		}
+	});
+
+	if (std::find(chunk_ok.begin(), chunk_ok.end(), 0) != chunk_ok.end())
+	{
+		// Nothing older can be restored without this snapshot
+		PanicAlertT("Internal error - decompressing the rewind history failed");
+		g_rewind_history.clear();
+		g_rewind_history_size = 0;
+		std::vector<u8>().swap(g_rewind_newest);
+		return;
+	}
+
+	g_rewind_newest.swap(older);
+	g_rewind_history_size -= entry.compressed_size;
+	g_rewind_history.pop_back();
+}
+
+bool Rewind()
+{
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	// The snapshot being compressed right now is the newest one
+	if (g_rewind_thread.joinable())
+		g_rewind_thread.join();
+
+	bool rewound = false;
+	{
+		std::lock_guard<std::mutex> lk(g_cs_rewind);
+		if (!g_rewind_newest.empty())
+		{
+			u8* ptr = &g_rewind_newest[0];
+			PointerWrap p(&ptr, PointerWrap::MODE_READ);
+			DoState(p);
+			rewound = (p.GetMode() == PointerWrap::MODE_READ);
+
+			DropNewestRewindSnapshot();
+			UpdateRewindStats();
+		}
+
+		if (rewound)
+			Core::DisplayMessage(StringFromFormat("Rewound (%u snapshots left, %u of %u MiB, %.1fx compressed)",
+				g_rewind_stats.num_snapshots, (u32)(g_rewind_stats.memory_used >> 20), (u32)(g_rewind_stats.memory_budget >> 20),
+				(double)g_rewind_stats.uncompressed_size / std::max<u64>(g_rewind_stats.memory_used, 1)), 2000);
+		else
+			Core::DisplayMessage("Nothing to rewind", 1000);
+	}
+
+	g_rewind_fields = 0;
+
+	Core::PauseAndLock(false, wasUnpaused);
+	return rewound;
+}
+
+void ClearRewindHistory()
+{
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	if (g_rewind_thread.joinable())
+		g_rewind_thread.join();
+
+	{
+		std::lock_guard<std::mutex> lk(g_cs_rewind);
+		g_rewind_history.clear();
+		g_rewind_history_size = 0;
+		std::vector<u8>().swap(g_rewind_newest);
+		UpdateRewindStats();
+	}
+
+	Core::DisplayMessage("Cleared the rewind history", 1000);
+	Core::PauseAndLock(false, wasUnpaused);
+}
+
+void GetRewindStats(RewindStats& stats)
+{
+	std::lock_guard<std::mutex> lk(g_cs_rewind);
+	stats = g_rewind_stats;
+}
 
 void Init()
 {
 	if (lzo_init() != LZO_E_OK)
 		PanicAlertT("Internal LZO Error - lzo_init() failed");
+
+	ev_Rewind = CoreTiming::RegisterEvent("RewindSnapshot", RewindCallback);
+	g_rewind_fields = 0;
 }
 
 void Shutdown()
 {
 	Flush();
 
+	if (g_rewind_thread.joinable())
+		g_rewind_thread.join();
+
+	{
+		std::lock_guard<std::mutex> lk(g_cs_rewind);
+		if (g_rewind_stats.num_snapshots || g_rewind_stats.dropped)
+		{
+			NOTICE_LOG(CONSOLE, "Rewind history: %u snapshots in %u of %u MiB (%.1fx compressed), last one paused for %u us "
+				"and took %u us to compress, %u dropped",
+				g_rewind_stats.num_snapshots, (u32)(g_rewind_stats.memory_used >> 20), (u32)(g_rewind_stats.memory_budget >> 20),
+				(double)g_rewind_stats.uncompressed_size / std::max<u64>(g_rewind_stats.memory_used, 1),
+				(u32)g_rewind_stats.last_capture_us, (u32)g_rewind_stats.last_compress_us, g_rewind_stats.dropped);
+		}
+
+		g_rewind_history.clear();
+		g_rewind_history_size = 0;
+		std::vector<u8>().swap(g_rewind_newest);
+		g_rewind_stats = RewindStats();
+	}
+
 	// swapping with an empty vector, rather than clear()ing
 	// this gives a better guarantee to free the allocated memory right NOW (as opposed to, actually, never)
 	{
 		std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-		std::vector<u8>().swap(g_current_buffer);
+		g_current_buffer.Clear();
 	}
 
 	{
@@ -27,6 +27,13 @@ void Init();
 
 void Shutdown();
 
+// Codecs for compressed states, see SConfig::m_SaveStateCompression
+enum
+{
+	COMPRESSION_LZO = 0,  // fast
+	COMPRESSION_ZLIB = 1, // smaller files
+};
+
 void EnableCompression(bool compression);
 
 bool ReadHeader(const std::string& filename, StateHeader& header);
@@ -56,6 +63,26 @@ void UndoLoadState();
 // wait until previously scheduled savestate event (if any) is done
 void Flush();
 
+// In-memory rewind history. Every SConfig::m_RewindInterval video fields a snapshot is taken,
+// delta compressed against the previous one on another thread and kept within m_RewindMemory.
+struct RewindStats
+{
+	u32 num_snapshots;     // how many times Rewind() can go back
+	u64 memory_used;       // bytes held by the history
+	u64 memory_budget;
+	u64 uncompressed_size; // bytes the same snapshots would take as full states
+	u64 last_capture_us;   // how long the emulator was paused for the newest snapshot
+	u64 last_compress_us;  // how long delta compressing the newest snapshot took
+	u32 dropped;           // snapshots skipped because the previous one was still being compressed
+};
+
+// Called by VideoInterface at the end of every field
+void RewindFieldUpdate();
+// Loads the newest snapshot and drops it from the history, so that repeated calls step further back
+bool Rewind();
+void ClearRewindHistory();
+void GetRewindStats(RewindStats& stats);
+
 // for calling back into UI code without introducing a dependency on it in core
 typedef void(*CallbackFunc)(void);
 void SetOnAfterLoadCallback(CallbackFunc callback);
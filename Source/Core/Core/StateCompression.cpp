@@ -0,0 +1,259 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <lzo/lzo1x.h>
+#include <zlib.h>
+
+#include "Common/Common.h"
+#include "Common/StdThread.h"
+
+#include "Core/State.h"
+#include "Core/StateCompression.h"
+
+namespace State
+{
+
+#if defined(__LZO_STRICT_16BIT)
+const u32 IN_LEN = 8 * 1024u;
+#elif defined(LZO_ARCH_I086) && !defined(LZO_HAVE_MM_HUGE_ARRAY)
+const u32 IN_LEN = 60 * 1024u;
+#else
+const u32 IN_LEN = 128 * 1024u;
+#endif
+
+// Compressed states used to be a plain chain of [u32 length][LZO data] chunks. Newer ones start
+// with this header instead, which can't be mistaken for a chunk length as those never exceed
+// IN_LEN + IN_LEN / 16 + 64 + 3.
+static const u32 COMPRESSED_STATE_MAGIC = 0x43545344; // "DSTC"
+static const u32 COMPRESSED_STATE_VERSION = 1;
+
+struct CompressedStateHeader
+{
+	u32 magic;
+	u32 version;
+	u32 codec;
+	u32 chunk_size;
+	u32 num_chunks;
+	// followed by num_chunks u32 compressed chunk sizes, then the chunk data
+};
+
+struct CompressedChunk
+{
+	size_t offset;
+	u32 size;
+};
+
+void RunWorkers(size_t count, const std::function<void(size_t, size_t)>& worker)
+{
+	if (count == 0)
+		return;
+
+	const size_t num_workers = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < num_workers; i++)
+		threads.push_back(std::thread(worker, i, num_workers));
+
+	worker(0, num_workers);
+
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+void CompressChunk(u32 codec, const u8* src, u32 src_len, std::vector<u8>& dst, std::vector<u64>& wrkmem)
+{
+	if (codec == COMPRESSION_ZLIB)
+	{
+		uLongf dst_len = compressBound(src_len);
+		dst.resize(dst_len);
+		if (compress2(&dst[0], &dst_len, src, src_len, Z_DEFAULT_COMPRESSION) != Z_OK)
+			dst_len = 0;
+		dst.resize(dst_len);
+	}
+	else
+	{
+		if (wrkmem.empty())
+			wrkmem.resize((LZO1X_1_MEM_COMPRESS + sizeof(u64) - 1) / sizeof(u64));
+
+		lzo_uint dst_len = src_len + (src_len / 16) + 64 + 3;
+		dst.resize(dst_len);
+		if (lzo1x_1_compress(src, src_len, &dst[0], &dst_len, &wrkmem[0]) != LZO_E_OK)
+			dst_len = 0;
+		dst.resize(dst_len);
+	}
+}
+
+bool DecompressChunk(u32 codec, const u8* src, u32 src_len, u8* dst, u32 dst_len)
+{
+	if (codec == COMPRESSION_ZLIB)
+	{
+		uLongf len = dst_len;
+		return uncompress(dst, &len, src, src_len) == Z_OK && len == dst_len;
+	}
+	else
+	{
+		lzo_uint len = dst_len;
+		return lzo1x_decompress_safe(src, src_len, dst, &len, nullptr) == LZO_E_OK && len == dst_len;
+	}
+}
+
+// Locates the compressed chunks of a state file (the data after the StateHeader).
+static bool ReadChunkTable(const std::vector<u8>& data, u32& codec, u32& chunk_size, std::vector<CompressedChunk>& chunks)
+{
+	CompressedStateHeader compressed_header = {};
+	if (data.size() >= sizeof(compressed_header))
+		memcpy(&compressed_header, &data[0], sizeof(compressed_header));
+
+	size_t pos = 0;
+	CompressedChunk chunk;
+	if (compressed_header.magic == COMPRESSED_STATE_MAGIC)
+	{
+		if (compressed_header.version > COMPRESSED_STATE_VERSION ||
+		    compressed_header.codec > COMPRESSION_ZLIB || compressed_header.chunk_size == 0)
+			return false;
+
+		codec = compressed_header.codec;
+		chunk_size = compressed_header.chunk_size;
+
+		pos = sizeof(compressed_header);
+		if ((data.size() - pos) / sizeof(u32) < compressed_header.num_chunks)
+			return false;
+
+		const u8* sizes = &data[pos];
+		pos += compressed_header.num_chunks * sizeof(u32);
+		for (u32 i = 0; i < compressed_header.num_chunks; i++)
+		{
+			memcpy(&chunk.size, sizes + i * sizeof(u32), sizeof(u32));
+			if (chunk.size > data.size() - pos)
+				return false;
+
+			chunk.offset = pos;
+			chunks.push_back(chunk);
+			pos += chunk.size;
+		}
+	}
+	else
+	{
+		// Old format: LZO compressed IN_LEN chunks, each prefixed with its compressed size
+		codec = COMPRESSION_LZO;
+		chunk_size = IN_LEN;
+
+		while (data.size() - pos >= sizeof(u32))
+		{
+			memcpy(&chunk.size, &data[pos], sizeof(u32));
+			pos += sizeof(u32);
+			if (chunk.size > data.size() - pos)
+				return false;
+
+			chunk.offset = pos;
+			chunks.push_back(chunk);
+			pos += chunk.size;
+		}
+	}
+
+	return true;
+}
+
+bool CompressStateData(u32 codec, size_t size, const std::function<void(size_t, size_t, u8*)>& read, std::vector<u8>& out)
+{
+	const u32 num_chunks = (u32)((size + IN_LEN - 1) / IN_LEN);
+	std::vector<std::vector<u8>> chunks(num_chunks);
+
+	// The chunks are independent of each other, so compress them on all cores
+	RunWorkers(num_chunks, [&](size_t first, size_t stride)
+	{
+		std::vector<u8> in(IN_LEN);
+		std::vector<u64> wrkmem;
+
+		for (size_t i = first; i < num_chunks; i += stride)
+		{
+			const u32 cur_len = (u32)std::min<size_t>(IN_LEN, size - i * IN_LEN);
+			read(i * IN_LEN, cur_len, &in[0]);
+			CompressChunk(codec, &in[0], cur_len, chunks[i], wrkmem);
+		}
+	});
+
+	CompressedStateHeader compressed_header;
+	compressed_header.magic = COMPRESSED_STATE_MAGIC;
+	compressed_header.version = COMPRESSED_STATE_VERSION;
+	compressed_header.codec = codec;
+	compressed_header.chunk_size = IN_LEN;
+	compressed_header.num_chunks = num_chunks;
+
+	size_t total = sizeof(compressed_header) + num_chunks * sizeof(u32);
+	for (const std::vector<u8>& chunk : chunks)
+	{
+		// Compressing non-empty data never produces an empty chunk
+		if (chunk.empty())
+		{
+			PanicAlertT("Internal error - compressing the state failed");
+			return false;
+		}
+		total += chunk.size();
+	}
+
+	out.resize(total);
+	u8* dst = &out[0];
+	memcpy(dst, &compressed_header, sizeof(compressed_header));
+	dst += sizeof(compressed_header);
+	for (const std::vector<u8>& chunk : chunks)
+	{
+		const u32 chunk_size = (u32)chunk.size();
+		memcpy(dst, &chunk_size, sizeof(u32));
+		dst += sizeof(u32);
+	}
+	for (const std::vector<u8>& chunk : chunks)
+	{
+		memcpy(dst, chunk.data(), chunk.size());
+		dst += chunk.size();
+	}
+
+	return true;
+}
+
+bool DecompressStateData(const std::vector<u8>& data, u32 size, std::vector<u8>& out)
+{
+	u32 codec, chunk_size;
+	std::vector<CompressedChunk> chunks;
+	if (!ReadChunkTable(data, codec, chunk_size, chunks) || (u64)chunks.size() * chunk_size < size)
+	{
+		PanicAlertT("The state file is corrupted or was saved by a newer version");
+		return false;
+	}
+
+	out.resize(size);
+
+	std::vector<u8> chunk_ok(chunks.size());
+	RunWorkers(chunks.size(), [&](size_t first, size_t stride)
+	{
+		for (size_t i = first; i < chunks.size(); i += stride)
+		{
+			// Old states end with an empty chunk if their size is a multiple of IN_LEN
+			const u64 offset = (u64)i * chunk_size;
+			if (offset >= size)
+			{
+				chunk_ok[i] = true;
+				continue;
+			}
+
+			const u32 cur_len = (u32)std::min<u64>(chunk_size, size - offset);
+			chunk_ok[i] = DecompressChunk(codec, data.data() + chunks[i].offset, chunks[i].size, &out[(size_t)offset], cur_len);
+		}
+	});
+
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		if (!chunk_ok[i])
+		{
+			PanicAlertT("Internal error - decompressing chunk %u of the state failed\n"
+				"Try loading the state again", (u32)i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,38 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// The chunked container compressed save states are stored in after their StateHeader,
+// and the helpers shared with the rewind history.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace State
+{
+
+// Size of the uncompressed chunks
+extern const u32 IN_LEN;
+
+// Runs worker(first, stride) on all available cores. Together the workers cover the items
+// [0, count) when each one handles first, first + stride, first + 2 * stride, ...
+void RunWorkers(size_t count, const std::function<void(size_t, size_t)>& worker);
+
+// wrkmem is the LZO work memory of the calling thread, it gets allocated on first use.
+// dst ends up empty if compression failed.
+void CompressChunk(u32 codec, const u8* src, u32 src_len, std::vector<u8>& dst, std::vector<u64>& wrkmem);
+bool DecompressChunk(u32 codec, const u8* src, u32 src_len, u8* dst, u32 dst_len);
+
+// Compresses size bytes into the container, on all cores. read(offset, size, dst) copies
+// the uncompressed data out, it gets called from several threads at once.
+bool CompressStateData(u32 codec, size_t size, const std::function<void(size_t, size_t, u8*)>& read, std::vector<u8>& out);
+
+// Decompresses the container into size bytes. Also takes states from before the container,
+// which are a plain chain of [u32 length][LZO data] chunks.
+bool DecompressStateData(const std::vector<u8>& data, u32 size, std::vector<u8>& out);
+
+}
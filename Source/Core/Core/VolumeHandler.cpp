@@ -2,13 +2,19 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
+#include "Core/CoreTiming.h"
 #include "Core/VolumeHandler.h"
+#include "Core/HW/SystemTimers.h"
+#include "DiscIO/DVDTrace.h"
 #include "DiscIO/VolumeCreator.h"
 
 namespace VolumeHandler
 {
 
 DiscIO::IVolume* g_pVolume = nullptr;
+static DiscIO::TraceWriter s_trace;
 
 DiscIO::IVolume *GetVolume()
 {
@@ -28,6 +34,37 @@ void EjectVolume()
 	}
 }
 
+// Gets the reader started on what booting reads first: the apploader, the
+// main executable and the file system table. Cold starts would otherwise wait
+// for the disk on each of them in turn.
+static void PrefetchBootData()
+{
+	const u32 shift = IsWii() ? 2 : 0;
+
+	const u64 apploader_offset = 0x2440;
+	g_pVolume->Prefetch(apploader_offset, 0x20 + Read32(apploader_offset + 0x14) + Read32(apploader_offset + 0x18));
+
+	// the header of the main executable has the offsets and sizes of its 7 text
+	// and 11 data sections
+	const u64 dol_offset = (u64)Read32(0x0420) << shift;
+	u32 dol_header[0x40];
+	if (g_pVolume->Read(dol_offset, sizeof(dol_header), (u8*)dol_header))
+	{
+		u64 dol_size = sizeof(dol_header);
+		for (int i = 0; i < 18; i++)
+		{
+			const u64 section_end = (u64)Common::swap32(dol_header[i]) + Common::swap32(dol_header[0x24 + i]);
+			dol_size = std::max(dol_size, section_end);
+		}
+		if (dol_offset + dol_size <= g_pVolume->GetSize())
+			g_pVolume->Prefetch(dol_offset, dol_size);
+	}
+
+	const u64 fst_offset = (u64)Read32(0x0424) << shift;
+	const u64 fst_size = (u64)Read32(0x0428) << shift;
+	g_pVolume->Prefetch(fst_offset, fst_size);
+}
+
 bool SetVolumeName(const std::string& _rFullPath)
 {
 	if (g_pVolume)
@@ -38,6 +75,9 @@ bool SetVolumeName(const std::string& _rFullPath)
 
 	g_pVolume = DiscIO::CreateVolumeFromFilename(_rFullPath);
 
+	if (g_pVolume != nullptr && !DiscIO::IsVolumeWadFile(g_pVolume))
+		PrefetchBootData();
+
 	return (g_pVolume != nullptr);
 }
 
@@ -56,6 +96,9 @@ u32 Read32(u64 _Offset)
 {
 	if (g_pVolume != nullptr)
 	{
+		// Boot and the BS2 emulation read the disc header through this
+		if (s_trace.IsOpen())
+			s_trace.Record(CoreTiming::GetTicks(), _Offset, 4, DiscIO::TraceEntry::VOLUME);
 		u32 Temp;
 		g_pVolume->Read(_Offset, 4, (u8*)&Temp);
 		return Common::swap32(Temp);
@@ -67,6 +110,8 @@ bool ReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength)
 {
 	if (g_pVolume != nullptr && ptr)
 	{
+		if (s_trace.IsOpen())
+			s_trace.Record(CoreTiming::GetTicks(), _dwOffset, (u32)_dwLength, DiscIO::TraceEntry::VOLUME);
 		g_pVolume->Read(_dwOffset, _dwLength, ptr);
 		return true;
 	}
@@ -77,12 +122,24 @@ bool RAWReadToPtr( u8* ptr, u64 _dwOffset, u64 _dwLength )
 {
 	if (g_pVolume != nullptr && ptr)
 	{
+		if (s_trace.IsOpen())
+			s_trace.Record(CoreTiming::GetTicks(), _dwOffset, (u32)_dwLength, DiscIO::TraceEntry::RAW);
 		g_pVolume->RAWRead(_dwOffset, _dwLength, ptr);
 		return true;
 	}
 	return false;
 }
 
+void StartTrace(const std::string& filename)
+{
+	s_trace.Open(filename, SystemTimers::GetTicksPerSecond());
+}
+
+void StopTrace()
+{
+	s_trace.Close();
+}
+
 bool IsValid()
 {
 	return (g_pVolume != nullptr);
@@ -23,6 +23,10 @@ u32 Read32(u64 _Offset);
 bool ReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength);
 bool RAWReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength);
 
+// Records every read from the volume to a DVD access trace, see DiscIO/DVDTrace.h
+void StartTrace(const std::string& filename);
+void StopTrace();
+
 bool IsValid();
 bool IsWii();
 
@@ -43,6 +43,10 @@ void print_trace(const char * msg)
 
 bool DoFault(u64 bad_address, SContext *ctx)
 {
+	// Writes to write-tracked pages can come from any thread, not just from JIT code.
+	if (Memory::HandleWriteTrackingFault((const u8*)bad_address))
+		return true;
+
 	if (!JitInterface::IsInCodeSpace((u8*) ctx->CTX_PC))
 	{
 		// Let's not prevent debugging.
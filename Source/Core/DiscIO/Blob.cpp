@@ -11,6 +11,7 @@
 #include "Common/FileUtil.h"
 
 #include "DiscIO/Blob.h"
+#include "DiscIO/CachedBlob.h"
 #include "DiscIO/CISOBlob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DriveBlob.h"
@@ -119,6 +120,11 @@ bool SectorReader::ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8 *
 }
 
 IBlobReader* CreateBlobReader(const std::string& filename)
+{
+	return CreateBlobReader(filename, true);
+}
+
+IBlobReader* CreateBlobReader(const std::string& filename, bool cached)
 {
 	if (cdio_is_cdrom(filename))
 		return DriveReader::Create(filename);
@@ -126,15 +132,19 @@ IBlobReader* CreateBlobReader(const std::string& filename)
 	if (!File::Exists(filename))
 		return nullptr;
 
+	// These read block by block with a seek for each one, going through a
+	// cache takes many small reads off them
+	IBlobReader* reader = nullptr;
 	if (IsWbfsBlob(filename))
-		return WbfsFileReader::Create(filename);
+		reader = WbfsFileReader::Create(filename);
+	else if (IsCISOBlob(filename))
+		reader = CISOFileReader::Create(filename);
+	if (reader)
+		return cached ? new CachedBlobReader(reader) : reader;
 
 	if (IsCompressedBlob(filename))
 		return CompressedBlobReader::Create(filename);
 
-	if (IsCISOBlob(filename))
-		return CISOFileReader::Create(filename);
-
 	// Still here? Assume plain file - since we know it exists due to the File::Exists check above.
 	return PlainFileReader::Create(filename);
 }
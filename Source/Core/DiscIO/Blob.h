@@ -29,6 +29,9 @@ public:
 	virtual u64 GetDataSize() const = 0;
 	// NOT thread-safe - can't call this from multiple threads.
 	virtual bool Read(u64 offset, u64 size, u8* out_ptr) = 0;
+	// Hint that the range is going to be read soon. Readers that can fetch it
+	// in the background start doing so, the others ignore it.
+	virtual void Prefetch(u64 offset, u64 size) {}
 
 protected:
 	IBlobReader() {}
@@ -64,12 +67,30 @@ public:
 };
 
 // Factory function - examines the path to choose the right type of IBlobReader, and returns one.
+// Formats which read block by block (WBFS, CISO) are wrapped in a CachedBlobReader unless cached is false.
 IBlobReader* CreateBlobReader(const std::string& filename);
+IBlobReader* CreateBlobReader(const std::string& filename, bool cached);
 
 typedef void (*CompressCB)(const char *text, float percent, void* arg);
 
+struct CompressStats
+{
+	u64 time_us;
+	u64 data_size;
+	u64 compressed_size;
+	int threads;
+	// Share of the time each stage of the pipeline was busy, compression is
+	// averaged over its threads
+	float read_busy;
+	float compress_busy;
+	float write_busy;
+};
+
+// Blocks are read by one thread, scrubbed and compressed by num_threads
+// threads (0 for one per core) and written in order by the calling thread,
+// which is also the one that calls callback.
 bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u32 sub_type = 0, int sector_size = 16384,
-		CompressCB callback = nullptr, void *arg = nullptr);
+		CompressCB callback = nullptr, void *arg = nullptr, int num_threads = 0, CompressStats* stats = nullptr);
 bool DecompressBlobToFile(const std::string& infile, const std::string& outfile,
 		CompressCB callback = nullptr, void *arg = nullptr);
 
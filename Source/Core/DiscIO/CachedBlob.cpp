@@ -0,0 +1,242 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/Thread.h"
+#include "DiscIO/CachedBlob.h"
+
+namespace DiscIO
+{
+
+// How many blocks after a sequential read get read ahead, and how many at
+// most are fetched with one read of the wrapped reader
+static const u64 READ_AHEAD_BLOCKS = 8;
+static const u64 MAX_BLOCKS_PER_READ = 16;
+
+CachedBlobReader::CachedBlobReader(IBlobReader* reader, u32 block_size, u32 num_blocks)
+	: m_reader(reader)
+	, m_data_size(reader->GetDataSize())
+	, m_block_size(block_size)
+	, m_num_blocks(std::max<u32>(num_blocks, 2 * READ_AHEAD_BLOCKS))
+	, m_last_block((u64)-2)
+	, m_read_ahead_next(0)
+	, m_read_ahead_end(0)
+	, m_stop(false)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_num_data_blocks = (m_data_size + m_block_size - 1) / m_block_size;
+	m_read_ahead_thread = std::thread(&CachedBlobReader::ReadAheadThread, this);
+}
+
+CachedBlobReader::~CachedBlobReader()
+{
+	{
+		std::lock_guard<std::mutex> lk(m_lock);
+		m_stop = true;
+	}
+	m_read_ahead_event.notify_one();
+	m_read_ahead_thread.join();
+
+	const u64 blocks = m_stats.hits + m_stats.misses;
+	INFO_LOG(DISCIO, "Block cache: %llu reads, %llu of %llu blocks cached (%llu read ahead), %llu host reads of %llu MiB",
+		(unsigned long long)m_stats.reads, (unsigned long long)m_stats.hits, (unsigned long long)blocks,
+		(unsigned long long)m_stats.read_ahead, (unsigned long long)m_stats.host_reads,
+		(unsigned long long)(m_stats.host_bytes >> 20));
+
+	delete m_reader;
+}
+
+void CachedBlobReader::Insert(u64 block, const u8* data)
+{
+	if (IsCached(block))
+		return;
+
+	// reuse the least recently used block's memory once the cache is full
+	if (m_lru.size() >= m_num_blocks)
+	{
+		m_entries.erase(m_lru.back().block);
+		m_lru.splice(m_lru.begin(), m_lru, std::prev(m_lru.end()));
+	}
+	else
+	{
+		m_lru.emplace_front();
+		m_lru.front().data.resize(m_block_size);
+	}
+
+	CacheEntry& entry = m_lru.front();
+	entry.block = block;
+	memcpy(&entry.data[0], data, (size_t)std::min<u64>(m_block_size, m_data_size - block * m_block_size));
+	m_entries[block] = m_lru.begin();
+}
+
+u64 CachedBlobReader::GetBlocksSize(u64 first, u64 end) const
+{
+	return std::min(end * m_block_size, m_data_size) - first * m_block_size;
+}
+
+bool CachedBlobReader::ReadBlocks(u64 first, u64 end, std::vector<u8>* buffer)
+{
+	buffer->resize((size_t)(end - first) * m_block_size);
+	return m_reader->Read(first * m_block_size, GetBlocksSize(first, end), &(*buffer)[0]);
+}
+
+bool CachedBlobReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
+{
+	// reads past the end behave however the wrapped reader makes them behave
+	if (nbytes == 0 || offset + nbytes > m_data_size)
+	{
+		std::lock_guard<std::mutex> lk(m_reader_lock);
+		return m_reader->Read(offset, nbytes, out_ptr);
+	}
+
+	const u64 first = offset / m_block_size;
+	const u64 last = (offset + nbytes - 1) / m_block_size;
+
+	std::unique_lock<std::mutex> lk(m_lock);
+	m_stats.reads++;
+
+	u64 block = first;
+	while (block <= last)
+	{
+		const u8* data;
+		u64 blocks_read = 1;
+
+		auto entry = m_entries.find(block);
+		if (entry != m_entries.end())
+		{
+			m_lru.splice(m_lru.begin(), m_lru, entry->second);
+			data = &entry->second->data[0];
+			m_stats.hits++;
+		}
+		else
+		{
+			lk.unlock();
+			std::unique_lock<std::mutex> reader_lk(m_reader_lock);
+			lk.lock();
+			// the read-ahead thread may have just fetched it
+			if (IsCached(block))
+				continue;
+
+			// everything up to the next cached block in one go
+			u64 end = block + 1;
+			while (end <= last && end - block < MAX_BLOCKS_PER_READ && !IsCached(end))
+				end++;
+
+			lk.unlock();
+			const bool success = ReadBlocks(block, end, &m_read_buffer);
+			reader_lk.unlock();
+			lk.lock();
+			m_stats.host_reads++;
+			m_stats.host_bytes += GetBlocksSize(block, end);
+			if (!success)
+				return false;
+
+			blocks_read = end - block;
+			m_stats.misses += blocks_read;
+			for (u64 i = 0; i < blocks_read; i++)
+				Insert(block + i, &m_read_buffer[(size_t)(i * m_block_size)]);
+			data = &m_read_buffer[0];
+		}
+
+		// the part of the blocks the read wants
+		const u64 start = std::max(block * m_block_size, offset);
+		const u64 stop = std::min((block + blocks_read) * m_block_size, offset + nbytes);
+		memcpy(out_ptr + (start - offset), data + (start - block * m_block_size), (size_t)(stop - start));
+		block += blocks_read;
+	}
+
+	if (first == m_last_block || first == m_last_block + 1)
+		QueueReadAhead(last + 1, last + 1 + READ_AHEAD_BLOCKS);
+	m_last_block = last;
+	return true;
+}
+
+void CachedBlobReader::Prefetch(u64 offset, u64 size)
+{
+	if (size == 0 || offset >= m_data_size)
+		return;
+
+	// don't let the prefetched blocks push each other out
+	const u64 first = offset / m_block_size;
+	const u64 end = std::min((offset + size - 1) / m_block_size + 1, first + m_num_blocks / 2);
+
+	std::lock_guard<std::mutex> lk(m_lock);
+	QueueReadAhead(first, end);
+}
+
+void CachedBlobReader::QueueReadAhead(u64 first, u64 end)
+{
+	end = std::min(end, m_num_data_blocks);
+	if (first >= end)
+		return;
+
+	// carry on with the current range when this continues it
+	if (first <= m_read_ahead_end && end >= m_read_ahead_next)
+	{
+		m_read_ahead_next = std::max(m_read_ahead_next, first);
+		m_read_ahead_end = std::max(m_read_ahead_end, end);
+	}
+	else
+	{
+		m_read_ahead_next = first;
+		m_read_ahead_end = end;
+	}
+	m_read_ahead_event.notify_one();
+}
+
+void CachedBlobReader::ReadAheadThread()
+{
+	Common::SetCurrentThreadName("Disc read-ahead");
+
+	std::unique_lock<std::mutex> lk(m_lock);
+	while (true)
+	{
+		m_read_ahead_event.wait(lk, [this] { return m_stop || m_read_ahead_next < m_read_ahead_end; });
+		if (m_stop)
+			return;
+
+		const u64 block = m_read_ahead_next;
+		if (IsCached(block))
+		{
+			m_read_ahead_next++;
+			continue;
+		}
+
+		u64 end = block + 1;
+		while (end < m_read_ahead_end && end - block < MAX_BLOCKS_PER_READ && !IsCached(end))
+			end++;
+		m_read_ahead_next = end;
+
+		lk.unlock();
+		bool success;
+		{
+			std::lock_guard<std::mutex> reader_lk(m_reader_lock);
+			success = ReadBlocks(block, end, &m_read_ahead_buffer);
+		}
+		lk.lock();
+		m_stats.host_reads++;
+		m_stats.host_bytes += GetBlocksSize(block, end);
+		if (!success)
+			continue;
+
+		m_stats.read_ahead += end - block;
+		for (u64 i = block; i < end; i++)
+			Insert(i, &m_read_ahead_buffer[(size_t)((i - block) * m_block_size)]);
+	}
+}
+
+CachedBlobReader::Stats CachedBlobReader::GetStats()
+{
+	std::lock_guard<std::mutex> lk(m_lock);
+	return m_stats;
+}
+
+}  // namespace
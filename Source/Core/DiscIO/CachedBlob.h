@@ -0,0 +1,104 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Block cache for blob readers whose reads are expensive to split up, like
+// WBFS and CISO which turn every request into one seek and read per block of
+// their own. The image is cached in fixed size blocks, the blocks missing for
+// a read are fetched with a single read of the wrapped reader, and sequential
+// reads get the blocks after them read ahead on a background thread.
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Blob.h"
+
+namespace DiscIO
+{
+
+class CachedBlobReader : public IBlobReader
+{
+public:
+	enum
+	{
+		// a multiple of the Wii cluster size
+		DEFAULT_BLOCK_SIZE = 0x20000,
+		// 32 MiB
+		DEFAULT_NUM_BLOCKS = 256,
+	};
+
+	struct Stats
+	{
+		u64 reads;
+		// blocks the reads found in the cache or had to fetch
+		u64 hits;
+		u64 misses;
+		// blocks fetched by the read-ahead thread
+		u64 read_ahead;
+		// reads of the wrapped reader, and how much they read
+		u64 host_reads;
+		u64 host_bytes;
+	};
+
+	// Takes ownership of reader
+	CachedBlobReader(IBlobReader* reader, u32 block_size = DEFAULT_BLOCK_SIZE, u32 num_blocks = DEFAULT_NUM_BLOCKS);
+	~CachedBlobReader();
+
+	u64 GetDataSize() const override { return m_data_size; }
+	u64 GetRawSize() const override { return m_reader->GetRawSize(); }
+	bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
+	void Prefetch(u64 offset, u64 size) override;
+
+	Stats GetStats();
+
+private:
+	struct CacheEntry
+	{
+		u64 block;
+		std::vector<u8> data;
+	};
+	typedef std::list<CacheEntry> LRUList;
+
+	// These expect m_lock to be held
+	bool IsCached(u64 block) const { return m_entries.find(block) != m_entries.end(); }
+	void Insert(u64 block, const u8* data);
+	void QueueReadAhead(u64 first, u64 end);
+
+	// Reads blocks [first, end) from the wrapped reader, with m_reader_lock held
+	bool ReadBlocks(u64 first, u64 end, std::vector<u8>* buffer);
+	u64 GetBlocksSize(u64 first, u64 end) const;
+	void ReadAheadThread();
+
+	IBlobReader* m_reader;
+	// the wrapped reader isn't thread safe
+	std::mutex m_reader_lock;
+	u64 m_data_size;
+	u32 m_block_size;
+	u32 m_num_blocks;
+	u64 m_num_data_blocks;
+
+	std::mutex m_lock;
+	// most recently used first
+	LRUList m_lru;
+	std::unordered_map<u64, LRUList::iterator> m_entries;
+	Stats m_stats;
+	u64 m_last_block;
+	std::vector<u8> m_read_buffer;
+
+	std::thread m_read_ahead_thread;
+	std::condition_variable m_read_ahead_event;
+	std::vector<u8> m_read_ahead_buffer;
+	// blocks still to read ahead
+	u64 m_read_ahead_next;
+	u64 m_read_ahead_end;
+	bool m_stop;
+};
+
+}  // namespace
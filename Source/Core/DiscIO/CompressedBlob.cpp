@@ -9,14 +9,19 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <zlib.h>
 
 #include "Common/Common.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
+#include "Common/Timer.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
@@ -140,26 +145,48 @@ void CompressedBlobReader::GetBlock(u64 block_num, u8 *out_ptr)
 	}
 }
 
-bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u32 sub_type,
-						int block_size, CompressCB callback, void* arg)
+namespace
+{
+
+// A block on its way through the pipeline. Block i uses slot i % number of
+// slots, so a slot is only read into again after its block was written.
+struct CompressSlot
 {
-	bool scrubbing = false;
+	enum State
+	{
+		EMPTY,
+		READ,
+		COMPRESSED,
+	};
+
+	State state;
+	// not read because it holds no data, it gets filled with 0xFF instead
+	bool scrubbed;
+	bool stored;
+	u32 size;
+	u32 hash;
+	std::vector<u8> in;
+	std::vector<u8> out;
+};
 
+}  // namespace
+
+bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u32 sub_type,
+						int block_size, CompressCB callback, void* arg, int num_threads, CompressStats* stats)
+{
 	if (IsCompressedBlob(infile))
 	{
 		PanicAlertT("%s is already compressed! Cannot compress it further.", infile.c_str());
 		return false;
 	}
 
-	if (sub_type == 1)
+	// Partitions are parsed once up front, so blocks can be scrubbed in any order
+	std::vector<bool> used_blocks;
+	const bool scrubbing = sub_type == 1;
+	if (scrubbing && !DiscScrubber::GetUsedBlocks(infile, block_size, &used_blocks))
 	{
-		if (!DiscScrubber::SetupScrub(infile, block_size))
-		{
-			PanicAlertT("%s failed to be scrubbed. Probably the image is corrupt.", infile.c_str());
-			return false;
-		}
-
-		scrubbing = true;
+		PanicAlertT("%s failed to be scrubbed. Probably the image is corrupt.", infile.c_str());
+		return false;
 	}
 
 	File::IOFile inf(infile, "rb");
@@ -168,7 +195,10 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 	if (!f || !inf)
 		return false;
 
-	callback("Files opened, ready to compress.", 0, arg);
+	if (callback)
+		callback("Files opened, ready to compress.", 0, arg);
+
+	const u64 start = Common::Timer::GetTimeUs();
 
 	CompressedBlobHeader header;
 	header.magic_cookie = kBlobCookie;
@@ -179,27 +209,165 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 	// round upwards!
 	header.num_blocks = (u32)((header.data_size + (block_size - 1)) / block_size);
 
-	u64* offsets = new u64[header.num_blocks];
-	u32* hashes = new u32[header.num_blocks];
-	u8* out_buf = new u8[block_size];
-	u8* in_buf = new u8[block_size];
+	std::vector<u64> offsets(header.num_blocks);
+	std::vector<u32> hashes(header.num_blocks);
 
 	// seek past the header (we will write it at the end)
 	f.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
 	// seek past the offset and hash tables (we will write them at the end)
 	f.Seek((sizeof(u64) + sizeof(u32)) * header.num_blocks, SEEK_CUR);
 
+	if (num_threads <= 0)
+		num_threads = std::max<int>(1, std::thread::hardware_concurrency());
+
+	std::vector<CompressSlot> slots(num_threads * 4);
+	for (CompressSlot& slot : slots)
+	{
+		slot.state = CompressSlot::EMPTY;
+		slot.in.resize(block_size);
+		slot.out.resize(block_size);
+	}
+
+	std::mutex lock;
+	std::condition_variable slot_written, block_read, block_compressed;
+	u32 num_read = 0;
+	u32 num_taken = 0;
+	bool failed = false;
+	u64 read_us = 0;
+	u64 compress_us = 0;
+
+	auto reader = [&] {
+		bool sequential = true;
+		for (u32 i = 0; i < header.num_blocks; i++)
+		{
+			CompressSlot& slot = slots[i % slots.size()];
+			{
+				std::unique_lock<std::mutex> lk(lock);
+				slot_written.wait(lk, [&] { return failed || slot.state == CompressSlot::EMPTY; });
+				if (failed)
+					return;
+			}
+
+			const u64 read_start = Common::Timer::GetTimeUs();
+			slot.scrubbed = scrubbing && i < used_blocks.size() && !used_blocks[i];
+			bool success = true;
+			if (slot.scrubbed)
+			{
+				DEBUG_LOG(DISCIO, "Freeing 0x%016" PRIx64, (u64)i * block_size);
+				sequential = false;
+			}
+			else
+			{
+				const u64 offset = (u64)i * block_size;
+				const u32 size = (u32)std::min<u64>(block_size, header.data_size - offset);
+				if (!sequential)
+					success = inf.Seek(offset, SEEK_SET);
+				sequential = true;
+				success = success && inf.ReadBytes(&slot.in[0], size);
+				std::fill(slot.in.begin() + size, slot.in.end(), 0);
+			}
+			read_us += Common::Timer::GetTimeUs() - read_start;
+
+			std::lock_guard<std::mutex> lk(lock);
+			if (!success)
+			{
+				ERROR_LOG(DISCIO, "Failed to read block %u of %s", i, infile.c_str());
+				failed = true;
+				block_read.notify_all();
+				block_compressed.notify_all();
+				return;
+			}
+			slot.state = CompressSlot::READ;
+			num_read++;
+			// the last block wakes up everyone, so those without one finish
+			if (num_read == header.num_blocks)
+				block_read.notify_all();
+			else
+				block_read.notify_one();
+		}
+	};
+
+	auto compressor = [&] {
+		z_stream z;
+		memset(&z, 0, sizeof(z));
+		z.zalloc = Z_NULL;
+		z.zfree  = Z_NULL;
+		z.opaque = Z_NULL;
+		const bool initialized = deflateInit(&z, 9) == Z_OK;
+		u64 busy_us = 0;
+
+		std::unique_lock<std::mutex> lk(lock);
+		if (!initialized)
+		{
+			ERROR_LOG(DISCIO, "Deflate failed");
+			failed = true;
+			slot_written.notify_all();
+			block_read.notify_all();
+			block_compressed.notify_all();
+		}
+		while (!failed && num_taken < header.num_blocks)
+		{
+			if (num_taken == num_read)
+			{
+				block_read.wait(lk);
+				continue;
+			}
+
+			const u32 i = num_taken++;
+			CompressSlot& slot = slots[i % slots.size()];
+			lk.unlock();
+
+			const u64 compress_start = Common::Timer::GetTimeUs();
+			if (slot.scrubbed)
+				std::fill(slot.in.begin(), slot.in.end(), 0xFF);
+
+			// a reset stream compresses exactly like a new one
+			deflateReset(&z);
+			z.next_in   = &slot.in[0];
+			z.avail_in  = block_size;
+			z.next_out  = &slot.out[0];
+			z.avail_out = block_size;
+			int status = deflate(&z, Z_FINISH);
+			slot.stored = (status != Z_STREAM_END) || (z.avail_out < 10);
+			if (slot.stored)
+			{
+				// Store uncompressed
+				slot.size = block_size;
+				slot.hash = HashAdler32(&slot.in[0], block_size);
+			}
+			else
+			{
+				slot.size = block_size - z.avail_out;
+				slot.hash = HashAdler32(&slot.out[0], slot.size);
+			}
+			busy_us += Common::Timer::GetTimeUs() - compress_start;
+
+			lk.lock();
+			slot.state = CompressSlot::COMPRESSED;
+			block_compressed.notify_one();
+		}
+		compress_us += busy_us;
+		lk.unlock();
+
+		if (initialized)
+			deflateEnd(&z);
+	};
+
+	std::vector<std::thread> threads;
+	threads.emplace_back(reader);
+	for (int i = 0; i < num_threads; i++)
+		threads.emplace_back(compressor);
+
 	// Now we are ready to write compressed data!
 	u64 position = 0;
-	int num_compressed = 0;
-	int num_stored = 0;
+	u64 write_us = 0;
 	int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
 
 	for (u32 i = 0; i < header.num_blocks; i++)
 	{
-		if (i % progress_monitor == 0)
+		if (callback && i % progress_monitor == 0)
 		{
-			const u64 inpos = inf.Tell();
+			const u64 inpos = (u64)i * block_size;
 			int ratio = 0;
 			if (inpos != 0)
 				ratio = (int)(100 * position / inpos);
@@ -208,54 +376,42 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 			callback(temp, (float)i / (float)header.num_blocks, arg);
 		}
 
-		offsets[i] = position;
-		// u64 start = i * header.block_size;
-		// u64 size = header.block_size;
-		std::fill(in_buf, in_buf + header.block_size, 0);
-		if (scrubbing)
-			DiscScrubber::GetNextBlock(inf, in_buf);
-		else
-			inf.ReadBytes(in_buf, header.block_size);
-		z_stream z;
-		memset(&z, 0, sizeof(z));
-		z.zalloc = Z_NULL;
-		z.zfree  = Z_NULL;
-		z.opaque = Z_NULL;
-		z.next_in   = in_buf;
-		z.avail_in  = header.block_size;
-		z.next_out  = out_buf;
-		z.avail_out = block_size;
-		int retval = deflateInit(&z, 9);
-
-		if (retval != Z_OK)
+		CompressSlot& slot = slots[i % slots.size()];
 		{
-			ERROR_LOG(DISCIO, "Deflate failed");
-			goto cleanup;
+			std::unique_lock<std::mutex> lk(lock);
+			block_compressed.wait(lk, [&] { return failed || slot.state == CompressSlot::COMPRESSED; });
+			if (failed)
+				break;
 		}
 
-		int status = deflate(&z, Z_FINISH);
-		int comp_size = block_size - z.avail_out;
-		if ((status != Z_STREAM_END) || (z.avail_out < 10))
-		{
-			//PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-			// let's store uncompressed
+		const u64 write_start = Common::Timer::GetTimeUs();
+		offsets[i] = position;
+		if (slot.stored)
 			offsets[i] |= 0x8000000000000000ULL;
-			f.WriteBytes(in_buf, block_size);
-			hashes[i] = HashAdler32(in_buf, block_size);
-			position += block_size;
-			num_stored++;
-		}
-		else
+		hashes[i] = slot.hash;
+		bool success = f.WriteBytes(slot.stored ? &slot.in[0] : &slot.out[0], slot.size);
+		position += slot.size;
+		write_us += Common::Timer::GetTimeUs() - write_start;
+
+		std::lock_guard<std::mutex> lk(lock);
+		if (!success)
 		{
-			// let's store compressed
-			//PanicAlert("Comp %i to %i", block_size, comp_size);
-			f.WriteBytes(out_buf, comp_size);
-			hashes[i] = HashAdler32(out_buf, comp_size);
-			position += comp_size;
-			num_compressed++;
+			ERROR_LOG(DISCIO, "Failed to write %s", outfile.c_str());
+			failed = true;
+			block_read.notify_all();
 		}
+		slot.state = CompressSlot::EMPTY;
+		slot_written.notify_one();
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
 
-		deflateEnd(&z);
+	if (failed)
+	{
+		f.Close();
+		File::Delete(outfile);
+		return false;
 	}
 
 	header.compressed_data_size = position;
@@ -263,19 +419,30 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 	// Okay, go back and fill in headers
 	f.Seek(0, SEEK_SET);
 	f.WriteArray(&header, 1);
-	f.WriteArray(offsets, header.num_blocks);
-	f.WriteArray(hashes, header.num_blocks);
-
-cleanup:
-	// Cleanup
-	delete[] in_buf;
-	delete[] out_buf;
-	delete[] offsets;
-	delete[] hashes;
-
-	DiscScrubber::Cleanup();
-	callback("Done compressing disc image.", 1.0f, arg);
-	return true;
+	if (header.num_blocks)
+	{
+		f.WriteArray(&offsets[0], header.num_blocks);
+		f.WriteArray(&hashes[0], header.num_blocks);
+	}
+
+	const u64 time_us = std::max<u64>(Common::Timer::GetTimeUs() - start, 1);
+	CompressStats result;
+	result.time_us = time_us;
+	result.data_size = header.data_size;
+	result.compressed_size = sizeof(header) + (sizeof(u64) + sizeof(u32)) * header.num_blocks + position;
+	result.threads = num_threads;
+	result.read_busy = (float)read_us / time_us;
+	result.compress_busy = (float)compress_us / num_threads / time_us;
+	result.write_busy = (float)write_us / time_us;
+	NOTICE_LOG(DISCIO, "Compressed %s at %.1f MB/s with %d threads, busy reading %d%%, compressing %d%%, writing %d%%",
+		infile.c_str(), (double)header.data_size / time_us, num_threads,
+		(int)(100 * result.read_busy), (int)(100 * result.compress_busy), (int)(100 * result.write_busy));
+	if (stats)
+		*stats = result;
+
+	if (callback)
+		callback("Done compressing disc image.", 1.0f, arg);
+	return f.IsGood();
 }
 
 bool DecompressBlobToFile(const std::string& infile, const std::string& outfile, CompressCB callback, void* arg)
@@ -0,0 +1,111 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/DVDTrace.h"
+
+namespace DiscIO
+{
+
+// A header, then the entries as they are in memory
+static const u32 TRACE_MAGIC = 0x54445644; // "DVDT"
+static const u32 TRACE_VERSION = 1;
+
+struct TraceHeader
+{
+	u32 magic;
+	u32 version;
+	u64 ticks_per_second;
+	u64 count;
+};
+
+// Entries are written out in batches of this many, so recording doesn't touch
+// the file on every read
+static const size_t FLUSH_ENTRIES = 4096;
+
+TraceWriter::TraceWriter()
+	: m_count(0)
+{
+}
+
+TraceWriter::~TraceWriter()
+{
+	Close();
+}
+
+bool TraceWriter::Open(const std::string& filename, u64 ticks_per_second)
+{
+	Close();
+
+	File::CreateFullPath(filename);
+	if (!m_file.Open(filename, "wb"))
+	{
+		ERROR_LOG(DISCIO, "Failed to create the DVD trace %s", filename.c_str());
+		return false;
+	}
+
+	// the count gets filled in when closing
+	TraceHeader header = { TRACE_MAGIC, TRACE_VERSION, ticks_per_second, 0 };
+	m_file.WriteArray(&header, 1);
+	m_entries.reserve(FLUSH_ENTRIES);
+	m_count = 0;
+	NOTICE_LOG(DISCIO, "Recording DVD trace to %s", filename.c_str());
+	return true;
+}
+
+void TraceWriter::Close()
+{
+	std::lock_guard<std::mutex> lk(m_lock);
+	if (!m_file.IsOpen())
+		return;
+
+	Flush();
+	m_file.Seek(offsetof(TraceHeader, count), SEEK_SET);
+	m_file.WriteArray(&m_count, 1);
+	m_file.Close();
+	NOTICE_LOG(DISCIO, "Recorded %llu DVD reads", (unsigned long long)m_count);
+}
+
+void TraceWriter::Record(u64 ticks, u64 offset, u32 length, TraceEntry::Kind kind)
+{
+	std::lock_guard<std::mutex> lk(m_lock);
+	if (!m_file.IsOpen())
+		return;
+
+	TraceEntry entry = { ticks, offset, length, (u8)kind, { 0, 0, 0 } };
+	m_entries.push_back(entry);
+	if (m_entries.size() >= FLUSH_ENTRIES)
+		Flush();
+}
+
+void TraceWriter::Flush()
+{
+	if (!m_entries.empty())
+		m_file.WriteArray(&m_entries[0], m_entries.size());
+	m_count += m_entries.size();
+	m_entries.clear();
+}
+
+bool LoadTrace(const std::string& filename, std::vector<TraceEntry>* entries, u64* ticks_per_second)
+{
+	File::IOFile file(filename, "rb");
+	TraceHeader header;
+	if (!file.ReadArray(&header, 1) || header.magic != TRACE_MAGIC || header.version != TRACE_VERSION)
+		return false;
+
+	// a trace that wasn't closed properly has no count, but still its entries
+	const u64 count = (file.GetSize() - sizeof(header)) / sizeof(TraceEntry);
+	entries->resize((size_t)(header.count ? std::min(header.count, count) : count));
+	*ticks_per_second = header.ticks_per_second;
+	return entries->empty() || file.ReadArray(&(*entries)[0], entries->size());
+}
+
+}  // namespace
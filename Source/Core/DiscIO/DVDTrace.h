@@ -0,0 +1,63 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// DVD access traces: every disc read the emulated console makes, with when it
+// happened, so disc I/O can be replayed and measured offline against other
+// image formats and reader settings.
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+
+namespace DiscIO
+{
+
+struct TraceEntry
+{
+	enum Kind
+	{
+		// Data of the volume, which is the opened partition on Wii discs
+		VOLUME = 0,
+		// Raw disc offsets
+		RAW,
+	};
+
+	// Emulated CPU ticks
+	u64 ticks;
+	u64 offset;
+	u32 length;
+	u8 kind;
+	u8 padding[3];
+};
+
+class TraceWriter
+{
+public:
+	TraceWriter();
+	~TraceWriter();
+
+	bool Open(const std::string& filename, u64 ticks_per_second);
+	void Close();
+	bool IsOpen() { return m_file.IsOpen(); }
+
+	// Thread safe
+	void Record(u64 ticks, u64 offset, u32 length, TraceEntry::Kind kind);
+
+private:
+	void Flush();
+
+	File::IOFile m_file;
+	std::mutex m_lock;
+	std::vector<TraceEntry> m_entries;
+	u64 m_count;
+};
+
+bool LoadTrace(const std::string& filename, std::vector<TraceEntry>* entries, u64* ticks_per_second);
+
+}  // namespace
@@ -6,6 +6,7 @@
 #include <cinttypes>
 #include <cstddef>
 #include <cstdio>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -26,10 +27,8 @@ namespace DiscScrubber
 
 u8* m_FreeTable = nullptr;
 u64 m_FileSize;
-u64 m_BlockCount;
 u32 m_BlockSize;
 int m_BlocksPerCluster;
-bool m_isScrubbing = false;
 
 std::string m_Filename;
 IVolume* m_Disc = nullptr;
@@ -79,9 +78,10 @@ void ReadFromVolume(u64 _Offset, u64 _Length, u64& _Buffer);
 bool ParseDisc();
 bool ParsePartitionData(SPartition& _rPartition);
 u32 GetDOLSize(u64 _DOLOffset);
+static void Cleanup();
 
 
-bool SetupScrub(const std::string& filename, int block_size)
+static bool SetupScrub(const std::string& filename, int block_size)
 {
 	bool success = true;
 	m_Filename = filename;
@@ -96,6 +96,8 @@ bool SetupScrub(const std::string& filename, int block_size)
 	m_BlocksPerCluster = CLUSTER_SIZE / m_BlockSize;
 
 	m_Disc = CreateVolumeFromFilename(filename);
+	if (!m_Disc)
+		return false;
 	m_FileSize = m_Disc->GetSize();
 
 	u32 numClusters = (u32)(m_FileSize / CLUSTER_SIZE);
@@ -113,45 +115,38 @@ bool SetupScrub(const std::string& filename, int block_size)
 	// Done with it; need it closed for the next part
 	delete m_Disc;
 	m_Disc = nullptr;
-	m_BlockCount = 0;
 
 	// Let's not touch the file if we've failed up to here :p
 	if (!success)
 		Cleanup();
 
-	m_isScrubbing = success;
 	return success;
 }
 
-void GetNextBlock(File::IOFile& in, u8* buffer)
-{
-	u64 CurrentOffset = m_BlockCount * m_BlockSize;
-	u64 i = CurrentOffset / CLUSTER_SIZE;
-
-	if (m_isScrubbing && m_FreeTable[i])
-	{
-		DEBUG_LOG(DISCIO, "Freeing 0x%016" PRIx64, CurrentOffset);
-		std::fill(buffer, buffer + m_BlockSize, 0xFF);
-		in.Seek(m_BlockSize, SEEK_CUR);
-	}
-	else
-	{
-		DEBUG_LOG(DISCIO, "Used    0x%016" PRIx64, CurrentOffset);
-		in.ReadBytes(buffer, m_BlockSize);
-	}
-
-	m_BlockCount++;
-}
-
-void Cleanup()
+static void Cleanup()
 {
 	if (m_FreeTable) delete[] m_FreeTable;
 	m_FreeTable = nullptr;
 	m_FileSize = 0;
-	m_BlockCount = 0;
 	m_BlockSize = 0;
 	m_BlocksPerCluster = 0;
-	m_isScrubbing = false;
+}
+
+bool GetUsedBlocks(const std::string& filename, int block_size, std::vector<bool>* used)
+{
+	// the parsing state is global
+	static std::mutex s_lock;
+	std::lock_guard<std::mutex> lk(s_lock);
+
+	if (!SetupScrub(filename, block_size))
+		return false;
+
+	used->resize((size_t)(m_FileSize / CLUSTER_SIZE * m_BlocksPerCluster));
+	for (size_t i = 0; i < used->size(); i++)
+		(*used)[i] = !m_FreeTable[i / m_BlocksPerCluster];
+
+	Cleanup();
+	return true;
 }
 
 void MarkAsUsed(u64 _Offset, u64 _Size)
@@ -218,6 +213,7 @@ bool ParseDisc()
 
 	for (int x = 0; x < 4; x++)
 	{
+		PartitionGroup[x].PartitionsVec.clear();
 		ReadFromDisc(0x40000 + (x * 8) + 0, 4, PartitionGroup[x].numPartitions);
 		ReadFromDisc(0x40000 + (x * 8) + 4, 4, PartitionGroup[x].PartitionsOffset);
 
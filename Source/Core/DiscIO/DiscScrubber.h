@@ -14,19 +14,19 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "Common/CommonTypes.h"
 
-namespace File { class IOFile; }
-
 namespace DiscIO
 {
 
 namespace DiscScrubber
 {
 
-bool SetupScrub(const std::string& filename, int block_size);
-void GetNextBlock(File::IOFile& in, u8* buffer);
-void Cleanup();
+// Parses all partitions of the image and marks which blocks of block_size
+// hold data. Blocks that aren't used can be replaced by 0xFF. Blocks past the
+// end of the table are always used.
+bool GetUsedBlocks(const std::string& filename, int block_size, std::vector<bool>* used);
 
 } // namespace DiscScrubber
 
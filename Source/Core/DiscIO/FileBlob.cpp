@@ -2,20 +2,41 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include "DiscIO/FileBlob.h"
 
 namespace DiscIO
 {
 
+// How far ahead of sequential reads the image gets fetched
+static const u64 READ_AHEAD = 2 * 1024 * 1024;
+
 PlainFileReader::PlainFileReader(std::FILE* file)
 	: m_file(file)
+	, m_last_end(0)
+	, m_prefetched_end(0)
 {
 	m_size = m_file.GetSize();
 }
 
+PlainFileReader::PlainFileReader()
+	: m_last_end(0)
+	, m_prefetched_end(0)
+{
+}
+
 PlainFileReader* PlainFileReader::Create(const std::string& filename)
 {
+	PlainFileReader* reader = new PlainFileReader();
+	if (reader->m_mapping.Open(filename))
+	{
+		reader->m_size = reader->m_mapping.GetSize();
+		return reader;
+	}
+	delete reader;
+
 	File::IOFile f(filename, "rb");
 	if (f)
 		return new PlainFileReader(f.ReleaseHandle());
@@ -25,8 +46,37 @@ PlainFileReader* PlainFileReader::Create(const std::string& filename)
 
 bool PlainFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
-	m_file.Seek(offset, SEEK_SET);
-	return m_file.ReadBytes(out_ptr, nbytes);
+	if (!m_mapping.IsOpen())
+	{
+		m_file.Seek(offset, SEEK_SET);
+		return m_file.ReadBytes(out_ptr, nbytes);
+	}
+
+	// Streamed audio and video, and files loaded in several parts, read one
+	// piece after another. Keep the kernel fetching ahead of them, the read
+	// around it does on page faults alone is much smaller.
+	const u64 end = offset + nbytes;
+	if (offset != m_last_end)
+		m_prefetched_end = end;
+	else if (end + READ_AHEAD / 2 > m_prefetched_end)
+	{
+		const u64 start = std::max(end, m_prefetched_end);
+		m_prefetched_end = end + READ_AHEAD;
+		m_mapping.Prefetch(start, m_prefetched_end - start);
+	}
+	m_last_end = end;
+
+	// like a short fread, copy what there is but fail
+	if (offset >= (u64)m_size)
+		return nbytes == 0;
+	const u64 available = std::min<u64>(nbytes, m_size - offset);
+	memcpy(out_ptr, m_mapping.GetData() + offset, (size_t)available);
+	return available == nbytes;
+}
+
+void PlainFileReader::Prefetch(u64 offset, u64 size)
+{
+	m_mapping.Prefetch(offset, size);
 }
 
 }  // namespace
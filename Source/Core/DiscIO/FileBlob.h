@@ -9,24 +9,38 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
 {
 
+// Reads are copied straight out of a mapping of the whole image, so reading
+// into emulated memory doesn't go through any intermediate buffer or system
+// call. Images that can't be mapped (too big for a 32-bit address space) are
+// read with plain file I/O.
 class PlainFileReader : public IBlobReader
 {
 	PlainFileReader(std::FILE* file);
+	PlainFileReader();
 
 	File::IOFile m_file;
+	File::MappedFile m_mapping;
 	s64 m_size;
 
+	// for the sequential read-ahead
+	u64 m_last_end;
+	u64 m_prefetched_end;
+
 public:
 	static PlainFileReader* Create(const std::string& filename);
 
 	u64 GetDataSize() const override { return m_size; }
 	u64 GetRawSize() const override { return m_size; }
 	bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
+	void Prefetch(u64 offset, u64 size) override;
+
+	bool IsMapped() const { return m_mapping.IsOpen(); }
 };
 
 }  // namespace
@@ -0,0 +1,378 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/Common.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Timer.h"
+
+#include "DiscIO/BannerLoader.h"
+#include "DiscIO/CompressedBlob.h"
+#include "DiscIO/Filesystem.h"
+#include "DiscIO/GameLibrary.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeCreator.h"
+
+namespace DiscIO
+{
+
+// The index file is a header, a table with the position of each entry and
+// the entries themselves, which start with their key so it can be read
+// without reading the rest.
+static const u32 INDEX_MAGIC = 0x494c4744; // "DGLI"
+// Revision 2: revision 1 could hold Wii names and banners garbled by parallel decryption
+static const u32 INDEX_REVISION = 2;
+
+struct IndexHeader
+{
+	u32 magic;
+	u32 revision;
+	u32 count;
+	u32 padding;
+	// GetMultiStreamHash of everything after the header
+	u64 checksum;
+};
+
+struct IndexTableEntry
+{
+	u64 offset;
+	u64 size;
+};
+
+GameMetadata::GameMetadata()
+	: disk_size(0)
+	, disk_mtime(0)
+	, valid(false)
+	, platform(GAMECUBE_DISC)
+	, file_size(0)
+	, volume_size(0)
+	, country(IVolume::COUNTRY_UNKNOWN)
+	, compressed(false)
+	, is_disc_two(false)
+	, revision(0)
+	, banner_width(0)
+	, banner_height(0)
+{
+}
+
+void GameMetadata::DoState(PointerWrap& p)
+{
+	p.Do(path);
+	p.Do(disk_size);
+	p.Do(disk_mtime);
+
+	p.Do(valid);
+	p.Do(platform);
+	p.Do(volume_names);
+	p.Do(company);
+	p.Do(names);
+	p.Do(descriptions);
+	p.Do(unique_id);
+	p.Do(file_size);
+	p.Do(volume_size);
+	p.Do(country);
+	p.Do(compressed);
+	p.Do(is_disc_two);
+	p.Do(revision);
+	p.Do(banner);
+	p.Do(banner_width);
+	p.Do(banner_height);
+}
+
+void ReadGameMetadata(const std::string& path, GameMetadata* metadata)
+{
+	IVolume* pVolume = CreateVolumeFromFilename(path);
+	if (pVolume == nullptr)
+		return;
+
+	if (!IsVolumeWadFile(pVolume))
+		metadata->platform = IsVolumeWiiDisc(pVolume) ? GameMetadata::WII_DISC : GameMetadata::GAMECUBE_DISC;
+	else
+		metadata->platform = GameMetadata::WII_WAD;
+
+	metadata->volume_names = pVolume->GetNames();
+
+	metadata->country = pVolume->GetCountry();
+	metadata->file_size = pVolume->GetRawSize();
+	metadata->volume_size = pVolume->GetSize();
+
+	metadata->unique_id = pVolume->GetUniqueID();
+	metadata->compressed = IsCompressedBlob(path);
+	metadata->is_disc_two = pVolume->IsDiscTwo();
+	metadata->revision = pVolume->GetRevision();
+
+	// check if we can get some info from the banner file too
+	IFileSystem* pFileSystem = CreateFileSystem(pVolume);
+
+	if (pFileSystem != nullptr || metadata->platform == GameMetadata::WII_WAD)
+	{
+		IBannerLoader* pBannerLoader = CreateBannerLoader(*pFileSystem, pVolume);
+
+		if (pBannerLoader != nullptr)
+		{
+			if (pBannerLoader->IsValid())
+			{
+				if (metadata->platform != GameMetadata::WII_WAD)
+					metadata->names = pBannerLoader->GetNames();
+				metadata->company = pBannerLoader->GetCompany();
+				metadata->descriptions = pBannerLoader->GetDescriptions();
+
+				int width, height;
+				std::vector<u32> Buffer = pBannerLoader->GetBanner(&width, &height);
+				metadata->banner_width = width;
+				metadata->banner_height = height;
+				metadata->banner.resize(width * height * 3);
+
+				for (int i = 0; i < width * height; i++)
+				{
+					metadata->banner[i * 3 + 0] = (Buffer[i] & 0xFF0000) >> 16;
+					metadata->banner[i * 3 + 1] = (Buffer[i] & 0x00FF00) >>  8;
+					metadata->banner[i * 3 + 2] = (Buffer[i] & 0x0000FF) >>  0;
+				}
+			}
+			delete pBannerLoader;
+		}
+
+		delete pFileSystem;
+	}
+
+	delete pVolume;
+
+	metadata->valid = true;
+}
+
+GameLibrary::GameLibrary(const std::string& index_filename)
+	: m_index_filename(index_filename)
+	, m_dirty(false)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+	LoadIndex();
+}
+
+GameLibrary::~GameLibrary()
+{
+}
+
+void GameLibrary::LoadIndex()
+{
+	m_entries.clear();
+	if (!m_index.Open(m_index_filename))
+		return;
+
+	const u8* data = m_index.GetData();
+	const u64 size = m_index.GetSize();
+
+	// Verifying the checksum touches the whole index, but that is still much
+	// cheaper than the one read per entry it replaces.
+	IndexHeader header;
+	if (size < sizeof(header) || size > (u64)std::numeric_limits<int>::max())
+	{
+		m_index.Close();
+		return;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	const u64 table_size = (u64)header.count * sizeof(IndexTableEntry);
+	if (header.magic != INDEX_MAGIC || header.revision != INDEX_REVISION ||
+	    size - sizeof(header) < table_size ||
+	    header.checksum != GetMultiStreamHash(data + sizeof(header), (int)(size - sizeof(header)), 0))
+	{
+		WARN_LOG(DISCIO, "Ignoring outdated or damaged game library index %s", m_index_filename.c_str());
+		m_index.Close();
+		return;
+	}
+
+	for (u32 i = 0; i < header.count; i++)
+	{
+		IndexTableEntry table_entry;
+		memcpy(&table_entry, data + sizeof(header) + i * sizeof(table_entry), sizeof(table_entry));
+		if (table_entry.offset > size || table_entry.size > size - table_entry.offset)
+			continue;
+
+		GameMetadata key;
+		u8* ptr = const_cast<u8*>(data + table_entry.offset);
+		PointerWrap p(&ptr, PointerWrap::MODE_READ);
+		p.Do(key.path);
+		p.Do(key.disk_size);
+		p.Do(key.disk_mtime);
+
+		IndexEntry& entry = m_entries[key.path];
+		entry.offset = table_entry.offset;
+		entry.size = table_entry.size;
+		entry.disk_size = key.disk_size;
+		entry.disk_mtime = key.disk_mtime;
+	}
+}
+
+bool GameLibrary::IsIndexed(const GameMetadata& game) const
+{
+	return game.valid && !game.banner.empty();
+}
+
+void GameLibrary::Update(const std::vector<std::string>& paths, int max_threads, const ProgressCallback& progress)
+{
+	const u64 start = Common::Timer::GetTimeUs();
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	m_games.clear();
+	m_games.resize(paths.size());
+
+	std::vector<size_t> pending;
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		GameMetadata& game = m_games[i];
+		game.path = paths[i];
+		game.disk_size = File::GetSize(game.path);
+		game.disk_mtime = File::GetModificationTime(game.path);
+
+		auto entry = m_entries.find(game.path);
+		if (entry != m_entries.end() && entry->second.disk_size == game.disk_size && entry->second.disk_mtime == game.disk_mtime)
+		{
+			u8* ptr = const_cast<u8*>(m_index.GetData() + entry->second.offset);
+			PointerWrap p(&ptr, PointerWrap::MODE_READ);
+			game.DoState(p);
+			m_stats.cached++;
+		}
+		else
+		{
+			pending.push_back(i);
+		}
+	}
+
+	// Workers take the next image to read from pending, while this thread
+	// reports their progress
+	std::mutex lock;
+	std::condition_variable read;
+	size_t next = 0;
+	size_t done = 0;
+	bool stop = false;
+	std::string last_path;
+
+	auto worker = [&] {
+		std::unique_lock<std::mutex> lk(lock);
+		while (!stop && next < pending.size())
+		{
+			GameMetadata& game = m_games[pending[next++]];
+			lk.unlock();
+			ReadGameMetadata(game.path, &game);
+			lk.lock();
+			done++;
+			last_path = game.path;
+			read.notify_one();
+		}
+	};
+
+	const int num_threads = (int)std::min<size_t>(std::max(max_threads, 1), pending.size());
+	std::vector<std::thread> threads;
+	for (int i = 0; i < num_threads; i++)
+		threads.emplace_back(worker);
+
+	{
+		std::unique_lock<std::mutex> lk(lock);
+		size_t reported = 0;
+		// once stopped, only wait for the images already being read
+		while (done < (stop ? next : pending.size()))
+		{
+			read.wait(lk, [&] { return done != reported; });
+			reported = done;
+			if (progress && !stop)
+			{
+				const std::string path = last_path;
+				lk.unlock();
+				const bool keep_going = progress(m_stats.cached + (u32)reported, (u32)paths.size(), path);
+				lk.lock();
+				if (!keep_going)
+					stop = true;
+			}
+		}
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	m_stats.scanned = (u32)done;
+	m_stats.scan_time_us = Common::Timer::GetTimeUs() - start;
+
+	// anything new to store, or anything in the index that isn't used anymore?
+	m_dirty = m_stats.cached != m_entries.size();
+	for (size_t i : pending)
+		m_dirty |= IsIndexed(m_games[i]);
+}
+
+bool GameLibrary::Save()
+{
+	if (!m_dirty)
+		return true;
+
+	std::vector<GameMetadata*> games;
+	for (GameMetadata& game : m_games)
+	{
+		if (IsIndexed(game))
+			games.push_back(&game);
+	}
+
+	IndexHeader header;
+	header.magic = INDEX_MAGIC;
+	header.revision = INDEX_REVISION;
+	header.count = (u32)games.size();
+	header.padding = 0;
+
+	std::vector<IndexTableEntry> table(games.size());
+	u64 offset = sizeof(header) + table.size() * sizeof(IndexTableEntry);
+	for (size_t i = 0; i < games.size(); i++)
+	{
+		u8* ptr = nullptr;
+		PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+		games[i]->DoState(p);
+		table[i].offset = offset;
+		table[i].size = (u64)(size_t)ptr;
+		offset += table[i].size;
+	}
+
+	std::vector<u8> buffer((size_t)offset);
+	if (!table.empty())
+		memcpy(&buffer[sizeof(header)], &table[0], table.size() * sizeof(IndexTableEntry));
+	for (size_t i = 0; i < games.size(); i++)
+	{
+		u8* ptr = &buffer[(size_t)table[i].offset];
+		PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+		games[i]->DoState(p);
+	}
+	header.checksum = GetMultiStreamHash(&buffer[sizeof(header)], (int)(buffer.size() - sizeof(header)), 0);
+	memcpy(&buffer[0], &header, sizeof(header));
+
+	// the old index may not be replaced while it is mapped
+	m_index.Close();
+	m_entries.clear();
+
+	const std::string temp_filename = m_index_filename + ".tmp";
+	bool success;
+	File::CreateFullPath(m_index_filename);
+	{
+		File::IOFile file(temp_filename, "wb");
+		success = file.WriteBytes(&buffer[0], buffer.size());
+	}
+	success = success && File::Rename(temp_filename, m_index_filename);
+	if (!success)
+	{
+		ERROR_LOG(DISCIO, "Failed to write the game library index %s", m_index_filename.c_str());
+		File::Delete(temp_filename);
+	}
+
+	LoadIndex();
+	m_dirty = !success;
+	return success;
+}
+
+}  // namespace
@@ -0,0 +1,120 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Game library indexer: reads the metadata shown in game lists (names, IDs,
+// sizes, banner) from disc images and WADs, with several images being opened
+// at a time, and keeps it in a single index file so unchanged images don't
+// have to be opened at all the next time.
+// The index is keyed by path, size and modification time of each image.
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/MappedFile.h"
+#include "DiscIO/Volume.h"
+
+class PointerWrap;
+
+namespace DiscIO
+{
+
+struct GameMetadata
+{
+	enum Platform
+	{
+		GAMECUBE_DISC = 0,
+		WII_DISC,
+		WII_WAD,
+	};
+
+	GameMetadata();
+	void DoState(PointerWrap& p);
+
+	std::string path;
+	// Key of the index entry
+	u64 disk_size;
+	u64 disk_mtime;
+
+	bool valid;
+	int platform;
+	std::vector<std::string> volume_names;
+
+	// From the banner
+	std::string company;
+	std::vector<std::string> names;
+	std::vector<std::string> descriptions;
+
+	std::string unique_id;
+	u64 file_size;
+	u64 volume_size;
+	IVolume::ECountry country;
+	bool compressed;
+	bool is_disc_two;
+	int revision;
+
+	// RGB8
+	std::vector<u8> banner;
+	int banner_width;
+	int banner_height;
+};
+
+// Opens the image at path and fills in everything but the index key
+void ReadGameMetadata(const std::string& path, GameMetadata* metadata);
+
+class GameLibrary
+{
+public:
+	// Called on the thread running Update() whenever images have been read.
+	// Returning false stops the scan; the images not read yet are left invalid.
+	typedef std::function<bool(u32 done, u32 total, const std::string& last_path)> ProgressCallback;
+
+	struct Stats
+	{
+		u32 cached;
+		u32 scanned;
+		u64 scan_time_us;
+	};
+
+	explicit GameLibrary(const std::string& index_filename);
+	~GameLibrary();
+
+	// Gets the metadata of the given images, in the same order. The ones whose
+	// index entry is out of date are read with up to max_threads threads.
+	void Update(const std::vector<std::string>& paths, int max_threads, const ProgressCallback& progress = nullptr);
+
+	// Writes the index if Update() changed it: the images of the last update
+	// that had a banner. Wii discs get their banner from the save data, so they
+	// are read again until one exists, like before there was an index.
+	bool Save();
+
+	const std::vector<GameMetadata>& GetGames() const { return m_games; }
+	const Stats& GetStats() const { return m_stats; }
+
+private:
+	struct IndexEntry
+	{
+		u64 offset;
+		u64 size;
+		u64 disk_size;
+		u64 disk_mtime;
+	};
+
+	void LoadIndex();
+	bool IsIndexed(const GameMetadata& game) const;
+
+	std::string m_index_filename;
+	File::MappedFile m_index;
+	std::unordered_map<std::string, IndexEntry> m_entries;
+
+	std::vector<GameMetadata> m_games;
+	Stats m_stats;
+	bool m_dirty;
+};
+
+}  // namespace
@@ -19,6 +19,8 @@ public:
 
 	virtual bool Read(u64 _Offset, u64 _Length, u8* _pBuffer) const = 0;
 	virtual bool RAWRead(u64 _Offset, u64 _Length, u8* _pBuffer) const = 0;
+	// Hint that the range is going to be read soon, see IBlobReader::Prefetch
+	virtual void Prefetch(u64 _Offset, u64 _Length) const {}
 	virtual bool GetTitleID(u8*) const { return false; }
 	virtual void GetTMD(u8*, u32 *_sz) const { *_sz=0; }
 	virtual std::string GetUniqueID() const = 0;
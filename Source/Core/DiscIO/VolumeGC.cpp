@@ -40,6 +40,12 @@ bool CVolumeGC::RAWRead(u64 _Offset, u64 _Length, u8* _pBuffer) const
 	return Read(_Offset, _Length, _pBuffer);
 }
 
+void CVolumeGC::Prefetch(u64 _Offset, u64 _Length) const
+{
+	if (m_pReader != nullptr)
+		m_pReader->Prefetch(_Offset, _Length);
+}
+
 std::string CVolumeGC::GetUniqueID() const
 {
 	static const std::string NO_UID("NO_UID");
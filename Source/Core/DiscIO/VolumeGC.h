@@ -24,6 +24,7 @@ public:
 	~CVolumeGC();
 	bool Read(u64 _Offset, u64 _Length, u8* _pBuffer) const override;
 	bool RAWRead(u64 _Offset, u64 _Length, u8* _pBuffer) const override;
+	void Prefetch(u64 _Offset, u64 _Length) const override;
 	std::string GetUniqueID() const override;
 	std::string GetRevisionSpecificUniqueID() const override;
 	std::string GetMakerID() const override;
@@ -63,7 +63,8 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer) const
 
 	while (_Length > 0)
 	{
-		static unsigned char IV[16];
+		// aes_crypt_cbc overwrites the IV, so it must not be shared between volumes read on different threads
+		unsigned char IV[16];
 
 		// math block offset
 		u64 Block  = _ReadOffset / 0x7C00;
@@ -97,6 +98,17 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer) const
 	return(true);
 }
 
+void CVolumeWiiCrypted::Prefetch(u64 _Offset, u64 _Length) const
+{
+	if (m_pReader == nullptr || _Length == 0)
+		return;
+
+	// all the encrypted blocks holding the range
+	u64 FirstBlock = _Offset / 0x7C00;
+	u64 LastBlock  = (_Offset + _Length - 1) / 0x7C00;
+	m_pReader->Prefetch(m_VolumeOffset + dataOffset + FirstBlock * 0x8000, (LastBlock - FirstBlock + 1) * 0x8000);
+}
+
 bool CVolumeWiiCrypted::GetTitleID(u8* _pBuffer) const
 {
 	// Tik is at m_VolumeOffset size 0x2A4
@@ -25,6 +25,7 @@ public:
 	~CVolumeWiiCrypted();
 	bool Read(u64 _Offset, u64 _Length, u8* _pBuffer) const override;
 	bool RAWRead(u64 _Offset, u64 _Length, u8* _pBuffer) const override;
+	void Prefetch(u64 _Offset, u64 _Length) const override;
 	bool GetTitleID(u8* _pBuffer) const override;
 	void GetTMD(u8* _pBuffer, u32* _sz) const override;
 	std::string GetUniqueID() const override;
@@ -197,6 +197,8 @@ void CFrame::CreateMenu()
 	loadMenu->Append(IDM_LOADSTATEFILE,  GetMenuLabel(HK_LOAD_STATE_FILE));
 
 	loadMenu->Append(IDM_UNDOLOADSTATE, GetMenuLabel(HK_UNDO_LOAD_STATE));
+	loadMenu->Append(IDM_REWIND, GetMenuLabel(HK_REWIND));
+	loadMenu->Append(IDM_CLEARREWIND, _("Clear Rewind History"));
 	loadMenu->AppendSeparator();
 
 	for (unsigned int i = 1; i <= State::NUM_STATES; i++)
@@ -478,6 +480,7 @@ wxString CFrame::GetMenuLabel(int Id)
 		case HK_SAVE_FIRST_STATE: Label = _("Save Oldest State"); break;
 		case HK_UNDO_LOAD_STATE: Label = _("Undo Load State"); break;
 		case HK_UNDO_SAVE_STATE: Label = _("Undo Save State"); break;
+		case HK_REWIND: Label = _("Rewind"); break;
 
 		default:
 			Label = wxString::Format(_("Undefined %i"), Id);
@@ -1583,6 +1586,18 @@ void CFrame::OnUndoSaveState(wxCommandEvent& WXUNUSED (event))
 		State::UndoSaveState();
 }
 
+void CFrame::OnRewind(wxCommandEvent& WXUNUSED (event))
+{
+	if (Core::IsRunningAndStarted())
+		State::Rewind();
+}
+
+void CFrame::OnClearRewind(wxCommandEvent& WXUNUSED (event))
+{
+	if (Core::IsRunningAndStarted())
+		State::ClearRewindHistory();
+}
+
 
 void CFrame::OnLoadState(wxCommandEvent& event)
 {
@@ -1847,6 +1862,7 @@ void CFrame::GameListChanged(wxCommandEvent& event)
 		Directories.push_back(File::GetUserPath(D_CACHE_IDX));
 		CFileSearch::XStringVector Extensions;
 		Extensions.push_back("*.cache");
+		Extensions.push_back("*.idx");
 
 		CFileSearch FileSearch(Extensions, Directories);
 		const CFileSearch::XStringVector& rFilenames = FileSearch.GetFileNames();
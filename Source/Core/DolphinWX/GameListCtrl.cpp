@@ -9,6 +9,7 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <wx/app.h>
 #include <wx/bitmap.h>
@@ -54,6 +55,7 @@
 #include "Core/Boot/Boot.h"
 #include "Core/HW/DVDInterface.h"
 #include "DiscIO/Blob.h"
+#include "DiscIO/GameLibrary.h"
 #include "DiscIO/Volume.h"
 #include "DiscIO/VolumeCreator.h"
 #include "DolphinWX/Frame.h"
@@ -558,18 +560,28 @@ void CGameListCtrl::ScanForISOs()
 			wxPD_SMOOTH // - makes updates as small as possible (down to 1px)
 			);
 
-		for (u32 i = 0; i < rFilenames.size(); i++)
-		{
-			std::string FileName;
-			SplitPath(rFilenames[i], nullptr, &FileName, nullptr);
+		// Only the images that changed since the last scan are opened, several
+		// at a time
+		DiscIO::GameLibrary library(File::GetUserPath(D_CACHE_IDX) + "gamelist.idx");
+		library.Update(rFilenames, std::max<int>(std::thread::hardware_concurrency(), 1),
+			[&](u32 done, u32 total, const std::string& last_path) {
+				std::string FileName;
+				SplitPath(last_path, nullptr, &FileName, nullptr);
+
+				// Update with the progress and the message
+				dialog.Update(std::min<int>(done, (int)total - 1), wxString::Format(_("Scanning %s"),
+					StrToWxStr(FileName)));
+				return !dialog.WasCancelled();
+			});
+
+		library.Save();
 
-			// Update with the progress (i) and the message
-			dialog.Update(i, wxString::Format(_("Scanning %s"),
-				StrToWxStr(FileName)));
-			if (dialog.WasCancelled())
-				break;
+		for (const DiscIO::GameMetadata& metadata : library.GetGames())
+		{
+			if (!metadata.valid)
+				continue;
 
-			auto iso_file = std::make_unique<GameListItem>(rFilenames[i]);
+			auto iso_file = std::make_unique<GameListItem>(metadata);
 
 			if (iso_file->IsValid())
 			{
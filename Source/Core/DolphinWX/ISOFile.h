@@ -14,11 +14,13 @@
 #include <wx/image.h>
 #endif
 
-class PointerWrap;
+namespace DiscIO { struct GameMetadata; }
+
 class GameListItem : NonCopyable
 {
 public:
 	GameListItem(const std::string& _rFileName);
+	explicit GameListItem(const DiscIO::GameMetadata& metadata);
 	~GameListItem();
 
 	bool IsValid() const {return m_Valid;}
@@ -43,8 +45,6 @@ public:
 	const wxBitmap& GetBitmap() const {return m_Bitmap;}
 #endif
 
-	void DoState(PointerWrap &p);
-
 	enum
 	{
 		GAMECUBE_DISC = 0,
@@ -85,8 +85,5 @@ private:
 	int m_ImageWidth, m_ImageHeight;
 	bool m_IsDiscTwo;
 
-	bool LoadFromCache();
-	void SaveToCache();
-
-	std::string CreateCacheFilename();
+	void Load(const DiscIO::GameMetadata& metadata);
 };
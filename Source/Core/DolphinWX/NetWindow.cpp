@@ -125,6 +125,12 @@ NetPlaySetupDiag::NetPlaySetupDiag(wxWindow* const parent, const CGameListCtrl*
 	netplay_section.Get("ConnectPort", &port, "2626");
 	m_connect_port_text = new wxTextCtrl(connect_tab, wxID_ANY, StrToWxStr(port));
 
+	bool use_udp;
+	netplay_section.Get("UseUDP", &use_udp, false);
+	m_connect_udp_chk = new wxCheckBox(connect_tab, wxID_ANY, _("Also send pad data over UDP"));
+	m_connect_udp_chk->SetValue(use_udp);
+	m_connect_udp_chk->SetToolTip(_("Lowers input latency on lossy connections. Needs the same port open for UDP on the host."));
+
 	wxButton* const connect_btn = new wxButton(connect_tab, wxID_ANY, _("Connect"));
 	connect_btn->Bind(wxEVT_BUTTON, &NetPlaySetupDiag::OnJoin, this);
 
@@ -151,6 +157,7 @@ NetPlaySetupDiag::NetPlaySetupDiag(wxWindow* const parent, const CGameListCtrl*
 
 	wxBoxSizer* const con_szr = new wxBoxSizer(wxVERTICAL);
 	con_szr->Add(top_szr, 0, wxALL | wxEXPAND, 5);
+	con_szr->Add(m_connect_udp_chk, 0, wxLEFT | wxRIGHT, 5);
 	con_szr->AddStretchSpacer(1);
 	con_szr->Add(alert_lbl, 0, wxLEFT | wxRIGHT | wxEXPAND, 5);
 	con_szr->AddStretchSpacer(1);
@@ -225,6 +232,7 @@ NetPlaySetupDiag::~NetPlaySetupDiag()
 	netplay_section.Set("Address", WxStrToStr(m_connect_ip_text->GetValue()));
 	netplay_section.Set("ConnectPort", WxStrToStr(m_connect_port_text->GetValue()));
 	netplay_section.Set("HostPort", WxStrToStr(m_host_port_text->GetValue()));
+	netplay_section.Set("UseUDP", m_connect_udp_chk->GetValue());
 
 	inifile.Save(dolphin_ini);
 	main_frame->g_NetPlaySetupDiag = nullptr;
@@ -234,13 +242,19 @@ void NetPlaySetupDiag::MakeNetPlayDiag(int port, const std::string &game, bool i
 {
 	NetPlayDiag *&npd = NetPlayDiag::GetInstance();
 	std::string ip;
+	bool use_udp = false;
 	npd = new NetPlayDiag(m_parent, m_game_list, game, is_hosting);
 	if (is_hosting)
+	{
 		ip = "127.0.0.1";
+	}
 	else
+	{
 		ip = WxStrToStr(m_connect_ip_text->GetValue());
+		use_udp = m_connect_udp_chk->GetValue();
+	}
 
-	netplay_client = new NetPlayClient(ip, (u16)port, npd, WxStrToStr(m_nickname_text->GetValue()));
+	netplay_client = new NetPlayClient(ip, (u16)port, npd, WxStrToStr(m_nickname_text->GetValue()), use_udp);
 	if (netplay_client->is_connected)
 	{
 		npd->Show();
@@ -46,6 +46,7 @@ private:
 	wxTextCtrl* m_host_port_text;
 	wxTextCtrl* m_connect_port_text;
 	wxTextCtrl* m_connect_ip_text;
+	wxCheckBox* m_connect_udp_chk;
 
 	wxListBox*  m_game_lbox;
 #ifdef USE_UPNP
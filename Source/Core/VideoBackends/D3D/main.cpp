@@ -187,7 +187,7 @@ void VideoBackend::Video_Prepare()
 	// VideoCommon
 	BPInit();
 	Fifo_Init();
-	IndexGenerator::Init();
+	IndexGenerator::Init(g_Config.backend_info.bSupportsPrimitiveRestart);
 	VertexLoaderManager::Init();
 	OpcodeDecoder_Init();
 	VertexShaderManager::Init();
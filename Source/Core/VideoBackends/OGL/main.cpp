@@ -213,7 +213,7 @@ void VideoBackend::Video_Prepare()
 	g_perf_query = new PerfQuery;
 	Fifo_Init(); // must be done before OpcodeDecoder_Init()
 	OpcodeDecoder_Init();
-	IndexGenerator::Init();
+	IndexGenerator::Init(g_Config.backend_info.bSupportsPrimitiveRestart);
 	VertexShaderManager::Init();
 	PixelShaderManager::Init();
 	ProgramShaderCache::Init();
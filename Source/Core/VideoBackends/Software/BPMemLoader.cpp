@@ -10,6 +10,7 @@
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/Rasterizer.h"
 #include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TextureSampler.h"
 
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -31,6 +32,10 @@ void SWLoadBPReg(u32 value)
 
 	((u32*)&bpmem)[address] = newval;
 
+	// the sampler caches texels decoded with the texture registers
+	if (address >= BPMEM_TX_SETMODE0 && address < BPMEM_TX_SETTLUT_4 + 4 && newval != oldval)
+		TextureSampler::InvalidateCache();
+
 	//reset the mask register
 	if (address != 0xFE)
 		bpmem.bpMask = 0xFFFFFF;
@@ -70,6 +75,7 @@ void SWBPWritten(int address, int newvalue)
 		break;
 	case BPMEM_TRIGGER_EFB_COPY:
 		EfbCopy::CopyEfb();
+		TextureSampler::InvalidateCache();
 		break;
 	case BPMEM_CLEARBBOX1:
 		PixelEngine::bbox[0] = newvalue >> 10;
@@ -102,6 +108,7 @@ void SWBPWritten(int address, int newvalue)
 				memcpy(texMem + tlutTMemAddr, ptr, tlutXferCount);
 			else
 				PanicAlert("Invalid palette pointer %08x %08x %08x", bpmem.tmem_config.tlut_src, bpmem.tmem_config.tlut_src << 5, (bpmem.tmem_config.tlut_src & 0xFFFFF)<< 5);
+			TextureSampler::InvalidateCache();
 			break;
 		}
 
@@ -141,6 +148,7 @@ void SWBPWritten(int address, int newvalue)
 					src_ptr += TMEM_LINE_SIZE * 2;
 				}
 			}
+			TextureSampler::InvalidateCache();
 		}
 		break;
 
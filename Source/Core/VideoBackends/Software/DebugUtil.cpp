@@ -99,6 +99,9 @@ s32 GetMaxTextureLod(u32 texmap)
 
 void DumpActiveTextures()
 {
+	// runs before the primitive that checks textures in RAM for writes
+	TextureSampler::InvalidateCache();
+
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
 	{
 		u32 texmap = bpmem.tevindref.getTexMap(stageNum);
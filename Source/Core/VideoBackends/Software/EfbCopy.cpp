@@ -66,8 +66,10 @@ namespace EfbCopy
 		if (!g_SWVideoConfig.bHwRasterizer)
 		{
 			u8 *dest_ptr = Memory::GetPointer(bpmem.copyTexDest << 5);
+			bool bFromZBuffer = bpmem.zcontrol.pixel_format == PEControl::Z24;
+			u8 *src = EfbInterface::GetPixelPointer(bpmem.copyTexSrcXY.x, bpmem.copyTexSrcXY.y, bFromZBuffer);
 
-			TextureEncoder::Encode(dest_ptr);
+			TextureEncoder::Encode(dest_ptr, src);
 		}
 	}
 
@@ -14,6 +14,7 @@
 #endif
 
 typedef void (LOADERDECL *TPipelineFunction)();
+typedef void (LOADERDECL *TBatchFunction)(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index);
 
 struct Vec4
 {
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/Common.h"
 #include "Core/HW/Memmap.h"
 #include "VideoBackends/Software/BPMemLoader.h"
@@ -12,6 +14,7 @@
 #include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVertexLoader.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
+#include "VideoBackends/Software/TextureSampler.h"
 #include "VideoBackends/Software/XFMemLoader.h"
 #include "VideoCommon/DataReader.h"
 
@@ -62,12 +65,9 @@ void DecodePrimitiveStream(u32 iBufferSize)
 	}
 	else
 	{
-		while (streamSize > 0 && iBufferSize >= vertexSize)
-		{
-			vertexLoader.LoadVertex();
-			iBufferSize -= vertexSize;
-			streamSize--;
-		}
+		u32 count = vertexSize ? std::min<u32>(streamSize, iBufferSize / vertexSize) : streamSize;
+		vertexLoader.LoadVertices(count);
+		streamSize -= count;
 	}
 
 	if (streamSize == 0)
@@ -207,6 +207,9 @@ void DecodeStandard(u32 bufferSize)
 			u8 primitiveType = (Cmd & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
 			vertexLoader.SetFormat(vatIndex, primitiveType);
 
+			// Textures in RAM can have been written since the last primitive
+			TextureSampler::NewPrimitive();
+
 			// switch to primitive processing
 			streamSize = DataReadU16();
 			currentFunction = DecodePrimitiveStream;
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/Common.h"
 
 #include "VideoBackends/Software/CPMemLoader.h"
@@ -248,28 +250,47 @@ void SWVertexLoader::SetFormat(u8 attributeIndex, u8 primitiveType)
 }
 
 
-void SWVertexLoader::LoadVertex()
+void SWVertexLoader::LoadVertices(u32 count)
 {
-	for (int i = 0; i < m_NumAttributeLoaders; i++)
-		m_AttributeLoaders[i].loader(this, &m_Vertex, m_AttributeLoaders[i].index);
+	while (count > 0)
+	{
+		const int batchSize = std::min<u32>(count, BATCH_SIZE);
 
-	OutputVertexData* outVertex = m_SetupUnit->GetVertex();
+		for (int v = 0; v < batchSize; v++)
+		{
+			for (int i = 0; i < m_NumAttributeLoaders; i++)
+				m_AttributeLoaders[i].loader(this, &m_Vertex, m_AttributeLoaders[i].index);
+			m_InputBatch[v] = m_Vertex;
+		}
 
-	// transform input data
-	TransformUnit::TransformPosition(&m_Vertex, outVertex);
+		// transform input data
+		TransformUnit::TransformPositions(m_InputBatch, m_OutputBatch, batchSize);
 
-	if (g_VtxDesc.Normal != NOT_PRESENT)
-	{
-		TransformUnit::TransformNormal(&m_Vertex, m_CurrentVat->g0.NormalElements, outVertex);
-	}
+		if (g_VtxDesc.Normal != NOT_PRESENT)
+		{
+			TransformUnit::TransformNormals(m_InputBatch, m_CurrentVat->g0.NormalElements, m_OutputBatch, batchSize);
+		}
+		else
+		{
+			// Don't let lighting use the normals of whichever vertex last went through this batch slot
+			for (int v = 0; v < batchSize; v++)
+				for (Vec3& normal : m_OutputBatch[v].normal)
+					normal = Vec3(0, 0, 0);
+		}
 
-	TransformUnit::TransformColor(&m_Vertex, outVertex);
+		TransformUnit::TransformColors(m_InputBatch, m_OutputBatch, batchSize);
 
-	TransformUnit::TransformTexCoord(&m_Vertex, outVertex, m_TexGenSpecialCase);
+		for (int v = 0; v < batchSize; v++)
+		{
+			TransformUnit::TransformTexCoord(&m_InputBatch[v], &m_OutputBatch[v], m_TexGenSpecialCase);
 
-	m_SetupUnit->SetupVertex();
+			*m_SetupUnit->GetVertex() = m_OutputBatch[v];
+			m_SetupUnit->SetupVertex();
+		}
 
-	INCSTAT(swstats.thisFrame.numVerticesLoaded)
+		ADDSTAT(swstats.thisFrame.numVerticesLoaded, batchSize);
+		count -= batchSize;
+	}
 }
 
 void SWVertexLoader::AddAttributeLoader(AttributeLoader loader, u8 index)
@@ -23,8 +23,15 @@ class SWVertexLoader
 	TPipelineFunction m_colorLoader[2];
 	TPipelineFunction m_texCoordLoader[8];
 
+	// The vertex being loaded. Attributes that are not present keep their
+	// values from the previous vertex.
 	InputVertexData m_Vertex;
 
+	// Vertices are loaded into these and then transformed together
+	enum { BATCH_SIZE = 16 };
+	InputVertexData m_InputBatch[BATCH_SIZE];
+	OutputVertexData m_OutputBatch[BATCH_SIZE];
+
 	typedef void (*AttributeLoader)(SWVertexLoader*, InputVertexData*, u8);
 	struct AttrLoaderCall
 	{
@@ -55,6 +62,7 @@ public:
 
 	u32 GetVertexSize() { return m_VertexSize; }
 
-	void LoadVertex();
+	// Loads, transforms and sets up count vertices
+	void LoadVertices(u32 count);
 	void DoState(PointerWrap &p);
 };
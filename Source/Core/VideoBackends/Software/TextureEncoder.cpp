@@ -2,13 +2,23 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+
 #include "VideoBackends/Software/BPMemLoader.h"
-#include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/TextureEncoder.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/TextureDecoder.h"
 
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 namespace TextureEncoder
 {
@@ -1384,10 +1394,9 @@ void EncodeZ24halfscale(u8 *dst, u8 *src, u32 format)
 	}
 }
 
-void Encode(u8 *dest_ptr)
+static u32 GetCopyFormat()
 {
-	auto pixelformat = bpmem.zcontrol.pixel_format;
-	bool bFromZBuffer = pixelformat == PEControl::Z24;
+	bool bFromZBuffer = bpmem.zcontrol.pixel_format == PEControl::Z24;
 	bool bIsIntensityFmt = bpmem.triggerEFBCopy.intensity_fmt > 0;
 	u32 copyfmt = ((bpmem.triggerEFBCopy.target_pixel_format / 2) + ((bpmem.triggerEFBCopy.target_pixel_format & 1) * 8));
 
@@ -1405,7 +1414,13 @@ void Encode(u8 *dest_ptr)
 		if (copyfmt > GX_TF_RGBA8 || (copyfmt < GX_TF_RGB565 && !bIsIntensityFmt))
 			format |= _GX_TF_CTF;
 
-	u8 *src = EfbInterface::GetPixelPointer(bpmem.copyTexSrcXY.x, bpmem.copyTexSrcXY.y, bFromZBuffer);
+	return format;
+}
+
+void EncodeReference(u8 *dest_ptr, u8 *src)
+{
+	auto pixelformat = bpmem.zcontrol.pixel_format;
+	u32 format = GetCopyFormat();
 
 	if (bpmem.triggerEFBCopy.half_scale)
 	{
@@ -1431,5 +1446,496 @@ void Encode(u8 *dest_ptr)
 	}
 }
 
+#ifdef _M_X86
+
+// The vectorized encoder works on one row of texels at a time. DecodeRow
+// converts the EFB pixels of the row to 8 bit components, one plane each, and
+// PackRow combines the planes into the texture format. The results match the
+// per-texel encoders above bit for bit, quirks included.
+
+enum
+{
+	// Copies are at most 1024 texels wide, rounded up to whole blocks and
+	// padded for the packing, which works on 16 texels at a time
+	MAX_ROW_TEXELS = 1024 + 16,
+};
+
+// Red, green, blue and alpha for color. For depth the high, middle and low
+// byte followed by 0xff, which is what the copies see in place of alpha.
+enum
+{
+	PLANE_R = 0,
+	PLANE_G,
+	PLANE_B,
+	PLANE_A,
+	PLANE_I, // intensity, only computed for the formats that need it
+	NUM_PLANES
+};
+
+enum Layout
+{
+	LAYOUT_4,    // texel pairs of plane 0, top nibbles
+	LAYOUT_44,   // top nibbles of plane 0 and 1
+	LAYOUT_8,    // plane 0
+	LAYOUT_88,   // plane 0 and 1
+	LAYOUT_565,  // planes 0 - 2 as RGB565
+	LAYOUT_5A3,  // planes 0 - 3 as RGB5A3
+	LAYOUT_8888, // plane 0 and 1 in the first 32 bytes of a block, plane 2 and 3 in the second
+};
+
+struct EncodeInfo
+{
+	int blkWidthLog2;
+	int blkHeightLog2;
+	Layout layout;
+	int planes[4];
+};
+
+static bool GetEncodeInfo(u32 format, bool depth, bool halfScale, EncodeInfo &info)
+{
+	info.planes[0] = info.planes[1] = info.planes[2] = info.planes[3] = PLANE_R;
+
+#define SET_INFO(w, h, l, p0, p1, p2, p3) \
+	info.blkWidthLog2 = w; info.blkHeightLog2 = h; info.layout = l; \
+	info.planes[0] = p0; info.planes[1] = p1; info.planes[2] = p2; info.planes[3] = p3;
+
+	if (depth)
+	{
+		// The half scale encoders store the depth bytes of the 16 and 24 bit
+		// formats the other way around
+		switch (format)
+		{
+		case GX_TF_Z8:    SET_INFO(3, 2, LAYOUT_8, PLANE_R, 0, 0, 0); break;
+		case GX_TF_Z16:
+			if (halfScale) { SET_INFO(2, 2, LAYOUT_88, PLANE_R, PLANE_G, 0, 0); }
+			else           { SET_INFO(2, 2, LAYOUT_88, PLANE_G, PLANE_R, 0, 0); }
+			break;
+		case GX_TF_Z24X8:
+			if (halfScale) { SET_INFO(2, 2, LAYOUT_8888, PLANE_A, PLANE_B, PLANE_G, PLANE_R); }
+			else           { SET_INFO(2, 2, LAYOUT_8888, PLANE_A, PLANE_R, PLANE_G, PLANE_B); }
+			break;
+		case GX_CTF_Z4:   SET_INFO(3, 3, LAYOUT_4, PLANE_R, 0, 0, 0); break;
+		case GX_CTF_Z8M:  SET_INFO(3, 2, LAYOUT_8, PLANE_G, 0, 0, 0); break;
+		case GX_CTF_Z8L:  SET_INFO(3, 2, LAYOUT_8, PLANE_B, 0, 0, 0); break;
+		case GX_CTF_Z16L:
+			if (halfScale) { SET_INFO(2, 2, LAYOUT_88, PLANE_G, PLANE_B, 0, 0); }
+			else           { SET_INFO(2, 2, LAYOUT_88, PLANE_B, PLANE_G, 0, 0); }
+			break;
+		default:
+			return false;
+		}
+	}
+	else
+	{
+		switch (format)
+		{
+		case GX_TF_I4:     SET_INFO(3, 3, LAYOUT_4, PLANE_I, 0, 0, 0); break;
+		case GX_TF_I8:     SET_INFO(3, 2, LAYOUT_8, PLANE_I, 0, 0, 0); break;
+		case GX_TF_IA4:    SET_INFO(3, 2, LAYOUT_44, PLANE_A, PLANE_I, 0, 0); break;
+		case GX_TF_IA8:    SET_INFO(2, 2, LAYOUT_88, PLANE_A, PLANE_I, 0, 0); break;
+		case GX_TF_RGB565: SET_INFO(2, 2, LAYOUT_565, PLANE_R, PLANE_G, PLANE_B, 0); break;
+		case GX_TF_RGB5A3: SET_INFO(2, 2, LAYOUT_5A3, PLANE_R, PLANE_G, PLANE_B, PLANE_A); break;
+		case GX_TF_RGBA8:  SET_INFO(2, 2, LAYOUT_8888, PLANE_A, PLANE_R, PLANE_G, PLANE_B); break;
+		case GX_CTF_R4:    SET_INFO(3, 3, LAYOUT_4, PLANE_R, 0, 0, 0); break;
+		case GX_CTF_RA4:   SET_INFO(3, 2, LAYOUT_44, PLANE_A, PLANE_R, 0, 0); break;
+		case GX_CTF_RA8:   SET_INFO(2, 2, LAYOUT_88, PLANE_A, PLANE_R, 0, 0); break;
+		case GX_CTF_A8:    SET_INFO(3, 2, LAYOUT_8, PLANE_A, 0, 0, 0); break;
+		case GX_CTF_R8:    SET_INFO(3, 2, LAYOUT_8, PLANE_R, 0, 0, 0); break;
+		case GX_CTF_G8:    SET_INFO(3, 2, LAYOUT_8, PLANE_G, 0, 0, 0); break;
+		case GX_CTF_B8:    SET_INFO(3, 2, LAYOUT_8, PLANE_B, 0, 0, 0); break;
+		case GX_CTF_RG8:   SET_INFO(2, 2, LAYOUT_88, PLANE_G, PLANE_R, 0, 0); break;
+		case GX_CTF_GB8:   SET_INFO(2, 2, LAYOUT_88, PLANE_B, PLANE_G, 0, 0); break;
+		default:
+			return false;
+		}
+	}
+
+#undef SET_INFO
+
+	return true;
+}
+
+// Four EFB pixels, one per 32 bit lane
+static inline __m128i LoadPixels(const u8 *src, int stride)
+{
+	const __m128i pixels = _mm_setr_epi32(*(u32*)src, *(u32*)(src + stride), *(u32*)(src + 2 * stride), *(u32*)(src + 3 * stride));
+	return _mm_and_si128(pixels, _mm_set1_epi32(0xffffff));
+}
+
+static inline __m128i Field(__m128i pixels, int shift, __m128i mask)
+{
+	return _mm_and_si128(_mm_srli_epi32(pixels, shift), mask);
+}
+
+// Stores the low byte of each 32 bit lane
+static inline void StoreLanes(u8 *dst, __m128i v)
+{
+	v = _mm_packs_epi32(v, v);
+	v = _mm_packus_epi16(v, v);
+	*(u32*)dst = _mm_cvtsi128_si32(v);
+}
+
+// The 8 bit components of four texels, one per 32 bit lane of each plane.
+// Alpha is left alone for RGB8, DecodeRow fills it in.
+template <bool rgba6, bool halfScale>
+static inline void DecodePixels(const u8 *src, __m128i *components)
+{
+	// shifts of red, green, blue and alpha in an RGBA6 pixel, or of the bytes
+	// that go into the first three planes otherwise
+	static const int rgba6Shifts[4] = { 18, 12, 6, 0 };
+	static const int rgb8Shifts[3] = { 16, 8, 0 };
+
+	const int stride = halfScale ? 6 : 3;
+	const __m128i mask6 = _mm_set1_epi32(0x3f);
+	const __m128i mask8 = _mm_set1_epi32(0xff);
+
+	if (halfScale)
+	{
+		// top left, top right, bottom left and bottom right of each box
+		const __m128i box[4] = {
+			LoadPixels(src, stride),
+			LoadPixels(src + 3, stride),
+			LoadPixels(src + 640 * 3, stride),
+			LoadPixels(src + 641 * 3, stride),
+		};
+
+		if (rgba6)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				const int shift = rgba6Shifts[c];
+				__m128i sum = _mm_add_epi32(_mm_add_epi32(Field(box[0], shift, mask6), Field(box[1], shift, mask6)),
+				                            _mm_add_epi32(Field(box[2], shift, mask6), Field(box[3], shift, mask6)));
+				components[c] = _mm_add_epi32(sum, _mm_srli_epi32(sum, 6));
+			}
+		}
+		else
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				const int shift = rgb8Shifts[c];
+				__m128i sum = _mm_add_epi32(_mm_add_epi32(Field(box[0], shift, mask8), Field(box[1], shift, mask8)),
+				                            _mm_add_epi32(Field(box[2], shift, mask8), Field(box[3], shift, mask8)));
+				components[c] = _mm_srli_epi32(sum, 2);
+			}
+		}
+	}
+	else
+	{
+		const __m128i pixels = LoadPixels(src, stride);
+
+		if (rgba6)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				// Convert6To8
+				const __m128i v = Field(pixels, rgba6Shifts[c], mask6);
+				components[c] = _mm_or_si128(_mm_slli_epi32(v, 2), _mm_srli_epi32(v, 4));
+			}
+		}
+		else
+		{
+			for (int c = 0; c < 3; c++)
+				components[c] = Field(pixels, rgb8Shifts[c], mask8);
+		}
+	}
+}
+
+// count texels starting at src, a multiple of four
+template <bool rgba6, bool halfScale>
+static void DecodeRow(const u8 *src, int count, u8 **planes)
+{
+	const int stride = halfScale ? 6 : 3;
+	const int numComponents = rgba6 ? 4 : 3;
+	int s = 0;
+
+	// Sixteen texels at a time while the row lasts, so each plane gets a
+	// whole vector stored
+	for (; s + 16 <= count; s += 16, src += 16 * stride)
+	{
+		__m128i components[4][4];
+		for (int group = 0; group < 4; group++)
+			DecodePixels<rgba6, halfScale>(src + group * 4 * stride, components[group]);
+
+		for (int c = 0; c < numComponents; c++)
+		{
+			const __m128i lo = _mm_packs_epi32(components[0][c], components[1][c]);
+			const __m128i hi = _mm_packs_epi32(components[2][c], components[3][c]);
+			_mm_store_si128((__m128i*)(planes[c] + s), _mm_packus_epi16(lo, hi));
+		}
+		if (!rgba6)
+			_mm_store_si128((__m128i*)(planes[PLANE_A] + s), _mm_set1_epi8((char)0xff));
+	}
+
+	for (; s < count; s += 4, src += 4 * stride)
+	{
+		__m128i components[4];
+		DecodePixels<rgba6, halfScale>(src, components);
+
+		for (int c = 0; c < numComponents; c++)
+			StoreLanes(planes[c] + s, components[c]);
+		if (!rgba6)
+			*(u32*)(planes[PLANE_A] + s) = 0xffffffff;
+	}
+}
+
+static void DecodeRow(const u8 *src, bool rgba6, bool halfScale, int count, u8 **planes)
+{
+	if (rgba6)
+	{
+		if (halfScale)
+			DecodeRow<true, true>(src, count, planes);
+		else
+			DecodeRow<true, false>(src, count, planes);
+	}
+	else
+	{
+		if (halfScale)
+			DecodeRow<false, true>(src, count, planes);
+		else
+			DecodeRow<false, false>(src, count, planes);
+	}
+}
+
+// RGB8_to_I
+static void ComputeIntensity(u8 **planes, int count)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int s = 0; s < count; s += 16)
+	{
+		const __m128i r = _mm_load_si128((const __m128i*)(planes[PLANE_R] + s));
+		const __m128i g = _mm_load_si128((const __m128i*)(planes[PLANE_G] + s));
+		const __m128i b = _mm_load_si128((const __m128i*)(planes[PLANE_B] + s));
+
+		__m128i intensity[2];
+		for (int half = 0; half < 2; half++)
+		{
+			const __m128i r16 = half ? _mm_unpackhi_epi8(r, zero) : _mm_unpacklo_epi8(r, zero);
+			const __m128i g16 = half ? _mm_unpackhi_epi8(g, zero) : _mm_unpacklo_epi8(g, zero);
+			const __m128i b16 = half ? _mm_unpackhi_epi8(b, zero) : _mm_unpacklo_epi8(b, zero);
+
+			__m128i val = _mm_set1_epi16(4096);
+			val = _mm_add_epi16(val, _mm_mullo_epi16(r16, _mm_set1_epi16(66)));
+			val = _mm_add_epi16(val, _mm_mullo_epi16(g16, _mm_set1_epi16(129)));
+			val = _mm_add_epi16(val, _mm_mullo_epi16(b16, _mm_set1_epi16(25)));
+			intensity[half] = _mm_srli_epi16(val, 8);
+		}
+
+		_mm_store_si128((__m128i*)(planes[PLANE_I] + s), _mm_packus_epi16(intensity[0], intensity[1]));
+	}
+}
+
+static inline __m128i ByteSwap16(__m128i v)
+{
+	return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+// Packs count texels, a multiple of 16, into a linear row. LAYOUT_8888 writes
+// a second row to out2.
+static void PackRow(const EncodeInfo &info, u8 **planes, int count, u8 *out, u8 *out2)
+{
+	const u8 *p0 = planes[info.planes[0]];
+	const u8 *p1 = planes[info.planes[1]];
+	const u8 *p2 = planes[info.planes[2]];
+	const u8 *p3 = planes[info.planes[3]];
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int s = 0; s < count; s += 16)
+	{
+		const __m128i v0 = _mm_load_si128((const __m128i*)(p0 + s));
+		const __m128i v1 = _mm_load_si128((const __m128i*)(p1 + s));
+
+		switch (info.layout)
+		{
+		case LAYOUT_4:
+			{
+				// (even & 0xf0) | (odd >> 4) in each 16 bit lane
+				const __m128i packed = _mm_or_si128(_mm_and_si128(v0, _mm_set1_epi16(0xf0)), _mm_srli_epi16(v0, 12));
+				_mm_storel_epi64((__m128i*)(out + s / 2), _mm_packus_epi16(packed, packed));
+			}
+			break;
+
+		case LAYOUT_44:
+			{
+				const __m128i hi = _mm_and_si128(v0, _mm_set1_epi8((char)0xf0));
+				const __m128i lo = _mm_and_si128(_mm_srli_epi16(v1, 4), _mm_set1_epi8(0x0f));
+				_mm_storeu_si128((__m128i*)(out + s), _mm_or_si128(hi, lo));
+			}
+			break;
+
+		case LAYOUT_8:
+			_mm_storeu_si128((__m128i*)(out + s), v0);
+			break;
+
+		case LAYOUT_88:
+			_mm_storeu_si128((__m128i*)(out + s * 2), _mm_unpacklo_epi8(v0, v1));
+			_mm_storeu_si128((__m128i*)(out + s * 2 + 16), _mm_unpackhi_epi8(v0, v1));
+			break;
+
+		case LAYOUT_565:
+		case LAYOUT_5A3:
+			{
+				const __m128i v2 = _mm_load_si128((const __m128i*)(p2 + s));
+				const __m128i v3 = _mm_load_si128((const __m128i*)(p3 + s));
+
+				for (int half = 0; half < 2; half++)
+				{
+					const __m128i r = half ? _mm_unpackhi_epi8(v0, zero) : _mm_unpacklo_epi8(v0, zero);
+					const __m128i g = half ? _mm_unpackhi_epi8(v1, zero) : _mm_unpacklo_epi8(v1, zero);
+					const __m128i b = half ? _mm_unpackhi_epi8(v2, zero) : _mm_unpacklo_epi8(v2, zero);
+					__m128i val;
+
+					if (info.layout == LAYOUT_565)
+					{
+						val = _mm_or_si128(_mm_or_si128(
+							_mm_and_si128(_mm_slli_epi16(r, 8), _mm_set1_epi16((s16)0xf800)),
+							_mm_and_si128(_mm_slli_epi16(g, 3), _mm_set1_epi16(0x07e0))),
+							_mm_and_si128(_mm_srli_epi16(b, 3), _mm_set1_epi16(0x001e)));
+					}
+					else
+					{
+						const __m128i a = half ? _mm_unpackhi_epi8(v3, zero) : _mm_unpacklo_epi8(v3, zero);
+
+						// 5551
+						const __m128i val555 = _mm_or_si128(_mm_or_si128(_mm_set1_epi16((s16)0x8000),
+							_mm_and_si128(_mm_slli_epi16(r, 7), _mm_set1_epi16(0x7c00))),
+							_mm_or_si128(_mm_and_si128(_mm_slli_epi16(g, 2), _mm_set1_epi16(0x03e0)),
+							_mm_and_si128(_mm_srli_epi16(b, 3), _mm_set1_epi16(0x001e))));
+						// 4443
+						const __m128i val4443 = _mm_or_si128(_mm_or_si128(
+							_mm_and_si128(_mm_slli_epi16(a, 7), _mm_set1_epi16(0x7000)),
+							_mm_and_si128(_mm_slli_epi16(r, 4), _mm_set1_epi16(0x0f00))),
+							_mm_or_si128(_mm_and_si128(g, _mm_set1_epi16(0x00f0)),
+							_mm_and_si128(_mm_srli_epi16(b, 4), _mm_set1_epi16(0x000f))));
+
+						const __m128i opaque = _mm_cmpgt_epi16(a, _mm_set1_epi16(223));
+						val = _mm_or_si128(_mm_and_si128(opaque, val555), _mm_andnot_si128(opaque, val4443));
+					}
+
+					_mm_storeu_si128((__m128i*)(out + s * 2 + half * 16), ByteSwap16(val));
+				}
+			}
+			break;
+
+		case LAYOUT_8888:
+			{
+				const __m128i v2 = _mm_load_si128((const __m128i*)(p2 + s));
+				const __m128i v3 = _mm_load_si128((const __m128i*)(p3 + s));
+				_mm_storeu_si128((__m128i*)(out + s * 2), _mm_unpacklo_epi8(v0, v1));
+				_mm_storeu_si128((__m128i*)(out + s * 2 + 16), _mm_unpackhi_epi8(v0, v1));
+				_mm_storeu_si128((__m128i*)(out2 + s * 2), _mm_unpacklo_epi8(v2, v3));
+				_mm_storeu_si128((__m128i*)(out2 + s * 2 + 16), _mm_unpackhi_epi8(v2, v3));
+			}
+			break;
+		}
+	}
+}
+
+// Bits per texel in each linear row written by PackRow
+static int GetRowBits(Layout layout)
+{
+	switch (layout)
+	{
+	case LAYOUT_4:
+		return 4;
+	case LAYOUT_44:
+	case LAYOUT_8:
+		return 8;
+	default:
+		return 16;
+	}
+}
+
+static void EncodeBlockRow(u8 *dst, const u8 *src, const EncodeInfo &info, bool rgba6, bool halfScale,
+                           int sBlkCount, int tBlk, s32 writeStride)
+{
+	GC_ALIGNED16(u8 planeData[NUM_PLANES][MAX_ROW_TEXELS]);
+	GC_ALIGNED16(u8 rows[2][MAX_ROW_TEXELS * 2]);
+	u8 *planes[NUM_PLANES];
+	for (int i = 0; i < NUM_PLANES; i++)
+		planes[i] = planeData[i];
+
+	const bool intensity = info.planes[0] == PLANE_I || info.planes[1] == PLANE_I;
+	const int blkWidth = 1 << info.blkWidthLog2;
+	const int blkHeight = 1 << info.blkHeightLog2;
+	const int texels = sBlkCount * blkWidth;
+	const int rowBytes = (blkWidth * GetRowBits(info.layout)) / 8;
+	const int blockBytes = info.layout == LAYOUT_8888 ? 64 : 32;
+	const int srcRowStride = 640 * (halfScale ? 6 : 3);
+
+	u8 *dstBlockStart = dst + tBlk * writeStride;
+
+	for (int t = 0; t < blkHeight; t++)
+	{
+		DecodeRow(src + (tBlk * blkHeight + t) * srcRowStride, rgba6, halfScale, texels, planes);
+		if (intensity)
+			ComputeIntensity(planes, texels);
+		PackRow(info, planes, (texels + 15) & ~15, rows[0], rows[1]);
+
+		// Block rows are four or eight bytes, copying them with a fixed size
+		// keeps a call to memcpy per block out of the loop
+		u8 *blockRow = dstBlockStart + t * rowBytes;
+		if (info.layout == LAYOUT_8888)
+		{
+			for (int sBlk = 0; sBlk < sBlkCount; sBlk++, blockRow += blockBytes)
+			{
+				memcpy(blockRow, &rows[0][sBlk * 8], 8);
+				memcpy(blockRow + 32, &rows[1][sBlk * 8], 8);
+			}
+		}
+		else if (rowBytes == 8)
+		{
+			for (int sBlk = 0; sBlk < sBlkCount; sBlk++, blockRow += blockBytes)
+				memcpy(blockRow, &rows[0][sBlk * 8], 8);
+		}
+		else
+		{
+			for (int sBlk = 0; sBlk < sBlkCount; sBlk++, blockRow += blockBytes)
+				memcpy(blockRow, &rows[0][sBlk * 4], 4);
+		}
+	}
+}
+
+#endif
+
+void Encode(u8 *dest_ptr, u8 *src)
+{
+#ifdef _M_X86
+	auto pixelformat = bpmem.zcontrol.pixel_format;
+	if (pixelformat != PEControl::RGBA6_Z24 && pixelformat != PEControl::RGB8_Z24 &&
+	    pixelformat != PEControl::RGB565_Z16 && pixelformat != PEControl::Z24)
+		return;
+
+	const bool halfScale = bpmem.triggerEFBCopy.half_scale != 0;
+	const u32 format = GetCopyFormat();
+
+	EncodeInfo info;
+	if (!GetEncodeInfo(format, pixelformat == PEControl::Z24, halfScale, info))
+	{
+		PanicAlert("Unknown texture copy format: 0x%x\n", format);
+		return;
+	}
+
+	u16 sBlkCount, tBlkCount, sBlkSize, tBlkSize;
+	s32 tSpan, sBlkSpan, tBlkSpan, writeStride;
+	SetBlockDimensions(info.blkWidthLog2, info.blkHeightLog2, sBlkCount, tBlkCount, sBlkSize, tBlkSize);
+	SetSpans(sBlkSize, tBlkSize, tSpan, sBlkSpan, tBlkSpan, writeStride);
+
+	const bool rgba6 = pixelformat == PEControl::RGBA6_Z24;
+
+#ifdef _OPENMP
+	// Only split copies that are big enough to be worth waking up other threads,
+	// and don't take too many cores away from the rest of the emulator
+	const int texels = (sBlkCount * sBlkSize) * (tBlkCount * tBlkSize);
+	const int threads = texels >= 128 * 128 ? std::min<int>(tBlkCount, (omp_get_num_procs() + 2) / 3) : 1;
+	#pragma omp parallel for num_threads(threads)
+#endif
+	for (int tBlk = 0; tBlk < tBlkCount; tBlk++)
+		EncodeBlockRow(dest_ptr, src, info, rgba6, halfScale, sBlkCount, tBlk, writeStride);
+#else
+	EncodeReference(dest_ptr, src);
+#endif
+}
 
 }
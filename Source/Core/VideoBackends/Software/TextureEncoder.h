@@ -8,5 +8,8 @@
 
 namespace TextureEncoder
 {
-	void Encode(u8 *dest_ptr);
+	// Encode the copy set up in bpmem from the EFB pixels at src, with the
+	// vectorized encoders or the original per-texel ones respectively
+	void Encode(u8 *dest_ptr, u8 *src);
+	void EncodeReference(u8 *dest_ptr, u8 *src);
 }
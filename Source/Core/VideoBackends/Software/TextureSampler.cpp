@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 #include "Core/HW/Memmap.h"
 #include "VideoBackends/Software/BPMemLoader.h"
@@ -35,6 +37,9 @@ inline void WrapCoord(int &coord, int wrapMode, int imageSize)
 				coord = (div&1)?imageSize - coord:coord;
 			}
 			break;
+		default: // reserved, clamp to stay inside the decoded texture
+			coord = (coord>imageSize)?imageSize:(coord<0)?0:coord;
+			break;
 	}
 }
 
@@ -98,17 +103,76 @@ void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample)
 	}
 }
 
-void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
+// Decoded texels of one mip level of one texmap. Tiles of 8x8 texels are
+// decoded the first time they are sampled during the current generation.
+// Levels decoded from RAM also remember the range they came from, which is
+// checked for writes once per primitive.
+struct CachedMip
+{
+	CachedMip() : generation(0), inRam(false) {}
+
+	u32 generation;
+
+	// in texels minus one, like TexImage0
+	int width;
+	int height;
+	int tilesPerRow;
+
+	u8 *imageSrc;
+	u8 *imageSrcOdd;
+	bool rgba8FromTmem;
+	int format;
+	int tlutAddress;
+	int tlutFormat;
+
+	bool inRam;
+	u32 ramAddress;
+	u32 ramSize;
+	u64 ramGeneration;
+	u32 checkedPrimitive;
+
+	std::vector<u32> texels;
+	std::vector<u32> tileGeneration;
+};
+
+static std::vector<CachedMip> s_cache[8];
+static u32 s_generation = 1;
+static u32 s_primitive = 0;
+
+void InvalidateCache()
+{
+	// start over rather than mistake very old tiles for current ones
+	if (++s_generation == 0)
+	{
+		for (std::vector<CachedMip> &levels : s_cache)
+			levels.clear();
+		s_generation = 1;
+	}
+}
+
+void NewPrimitive()
+{
+	s_primitive++;
+}
+
+static void TrackRam(CachedMip &cached)
+{
+	cached.ramGeneration = Memory::TrackRange(cached.ramAddress, cached.ramSize);
+	cached.checkedPrimitive = s_primitive;
+}
+
+static void SetupMip(CachedMip &cached, u8 texmap, s32 mip)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
 
-	TexMode0& tm0 = texUnit.texMode0[subTexmap];
 	TexImage0& ti0 = texUnit.texImage0[subTexmap];
 	TexTLUT& texTlut = texUnit.texTlut[subTexmap];
 
 	u8 *imageSrc, *imageSrcOdd = nullptr;
-	if (texUnit.texImage1[subTexmap].image_type)
+	u32 imageBase = 0;
+	const bool inRam = !texUnit.texImage1[subTexmap].image_type;
+	if (!inRam)
 	{
 		imageSrc = &texMem[texUnit.texImage1[subTexmap].tmem_even * TMEM_LINE_SIZE];
 		if (ti0.format == GX_TF_RGBA8)
@@ -116,30 +180,27 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 	}
 	else
 	{
-		u32 imageBase = texUnit.texImage3[subTexmap].image_base << 5;
+		imageBase = texUnit.texImage3[subTexmap].image_base << 5;
 		imageSrc = Memory::GetPointer(imageBase);
 	}
 
 	int imageWidth = ti0.width;
 	int imageHeight = ti0.height;
 
-	int tlutAddress = texTlut.tmem_offset << 9;
+	const int fmtWidth = TexDecoder_GetBlockWidthInTexels(ti0.format);
+	const int fmtHeight = TexDecoder_GetBlockHeightInTexels(ti0.format);
 
-	// reduce sample location and texture size to mip level
+	// reduce texture size to mip level
 	// move texture pointer to mip location
 	if (mip)
 	{
 		int mipWidth = imageWidth + 1;
 		int mipHeight = imageHeight + 1;
 
-		int fmtWidth = TexDecoder_GetBlockWidthInTexels(ti0.format);
-		int fmtHeight = TexDecoder_GetBlockHeightInTexels(ti0.format);
 		int fmtDepth = TexDecoder_GetTexelSizeInNibbles(ti0.format);
 
 		imageWidth >>= mip;
 		imageHeight >>= mip;
-		s >>= mip;
-		t >>= mip;
 
 		while (mip)
 		{
@@ -148,12 +209,109 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 			u32 size = (mipWidth * mipHeight * fmtDepth) >> 1;
 
 			imageSrc += size;
+			imageBase += size;
 			mipWidth >>= 1;
 			mipHeight >>= 1;
 			mip--;
 		}
 	}
 
+	cached.generation = s_generation;
+	cached.width = imageWidth;
+	cached.height = imageHeight;
+	cached.tilesPerRow = (imageWidth >> 3) + 1;
+	cached.imageSrc = imageSrc;
+	cached.imageSrcOdd = imageSrcOdd;
+	cached.rgba8FromTmem = ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type;
+	cached.format = ti0.format;
+	cached.tlutAddress = texTlut.tmem_offset << 9;
+	cached.tlutFormat = texTlut.tlut_format;
+
+	cached.inRam = inRam;
+	if (inRam)
+	{
+		// whole blocks, the last ones only partly hold the level
+		const int expandedWidth = (imageWidth + fmtWidth) & ~(fmtWidth - 1);
+		const int expandedHeight = (imageHeight + fmtHeight) & ~(fmtHeight - 1);
+		cached.ramAddress = imageBase;
+		cached.ramSize = TexDecoder_GetTextureSizeInBytes(expandedWidth, expandedHeight, ti0.format);
+		TrackRam(cached);
+	}
+
+	// stale tile generations are all older than s_generation
+	cached.texels.resize((imageWidth + 1) * (imageHeight + 1));
+	cached.tileGeneration.resize(cached.tilesPerRow * ((imageHeight >> 3) + 1));
+}
+
+static CachedMip &GetMip(u8 texmap, s32 mip)
+{
+	std::vector<CachedMip> &levels = s_cache[texmap];
+	if ((u32)mip >= levels.size())
+		levels.resize(mip + 1);
+
+	CachedMip &cached = levels[mip];
+	if (cached.generation != s_generation)
+	{
+		SetupMip(cached, texmap, mip);
+	}
+	else if (cached.inRam && cached.checkedPrimitive != s_primitive)
+	{
+		cached.checkedPrimitive = s_primitive;
+		if (Memory::HasRangeChanged(cached.ramAddress, cached.ramSize, cached.ramGeneration))
+		{
+			// decode the level again, from after the write
+			TrackRam(cached);
+			std::fill(cached.tileGeneration.begin(), cached.tileGeneration.end(), 0);
+		}
+	}
+	return cached;
+}
+
+static void DecodeTile(CachedMip &cached, int tileS, int tileT)
+{
+	const int rowLength = cached.width + 1;
+	const int endS = std::min(tileS + 8, cached.width + 1);
+	const int endT = std::min(tileT + 8, cached.height + 1);
+
+	for (int t = tileT; t < endT; t++)
+	{
+		u32 *dst = &cached.texels[t * rowLength];
+		for (int s = tileS; s < endS; s++)
+		{
+			if (cached.rgba8FromTmem)
+				TexDecoder_DecodeTexelRGBA8FromTmem((u8*)&dst[s], cached.imageSrc, cached.imageSrcOdd, s, t, cached.width);
+			else
+				TexDecoder_DecodeTexel((u8*)&dst[s], cached.imageSrc, s, t, cached.width, cached.format, cached.tlutAddress, cached.tlutFormat);
+		}
+	}
+}
+
+// s and t must already be wrapped into the mip level
+static inline u8 *GetTexel(CachedMip &cached, int s, int t)
+{
+	u32 &tileGeneration = cached.tileGeneration[(t >> 3) * cached.tilesPerRow + (s >> 3)];
+	if (tileGeneration != s_generation)
+	{
+		DecodeTile(cached, s & ~7, t & ~7);
+		tileGeneration = s_generation;
+	}
+
+	return (u8*)&cached.texels[t * (cached.width + 1) + s];
+}
+
+void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
+{
+	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
+	TexMode0& tm0 = texUnit.texMode0[texmap & 3];
+
+	CachedMip &cached = GetMip(texmap, mip);
+	int imageWidth = cached.width;
+	int imageHeight = cached.height;
+
+	// reduce sample location to mip level
+	s >>= mip;
+	t >>= mip;
+
 	if (linear)
 	{
 		// offset linear sampling
@@ -171,7 +329,6 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		int imageTPlus1 = imageT + 1;
 		int fractT = t & 0x7f;
 
-		u8 sampledTex[4];
 		u32 texel[4];
 
 		WrapCoord(imageS, tm0.wrap_s, imageWidth);
@@ -179,34 +336,10 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(imageSPlus1, tm0.wrap_s, imageWidth);
 		WrapCoord(imageTPlus1, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-		{
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageT, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageT, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageTPlus1, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageTPlus1, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
-		else
-		{
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageT, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
+		SetTexel(GetTexel(cached, imageS, imageT), texel, (128 - fractS) * (128 - fractT));
+		AddTexel(GetTexel(cached, imageSPlus1, imageT), texel, (fractS) * (128 - fractT));
+		AddTexel(GetTexel(cached, imageS, imageTPlus1), texel, (128 - fractS) * (fractT));
+		AddTexel(GetTexel(cached, imageSPlus1, imageTPlus1), texel, (fractS) * (fractT));
 
 		sample[0] = (u8)(texel[0] >> 14);
 		sample[1] = (u8)(texel[1] >> 14);
@@ -223,10 +356,7 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(imageS, tm0.wrap_s, imageWidth);
 		WrapCoord(imageT, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-			TexDecoder_DecodeTexel(sample, imageSrc, imageS, imageT, imageWidth, ti0.format, tlutAddress, texTlut.tlut_format);
-		else
-			TexDecoder_DecodeTexelRGBA8FromTmem(sample, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
+		memcpy(sample, GetTexel(cached, imageS, imageT), 4);
 	}
 }
 
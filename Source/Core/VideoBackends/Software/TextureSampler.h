@@ -8,6 +8,14 @@
 
 namespace TextureSampler
 {
+	// Texels are decoded when they're first sampled and cached. Must be
+	// called whenever texture state or TMEM may have changed.
+	void InvalidateCache();
+
+	// Textures in RAM are checked for writes once per primitive, call this
+	// before drawing each one.
+	void NewPrimitive();
+
 	void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample);
 
 	void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample);
@@ -15,6 +15,9 @@
 #include "VideoBackends/Software/Vec3.h"
 #include "VideoBackends/Software/XFMemLoader.h"
 
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
 
 namespace TransformUnit
 {
@@ -372,6 +375,40 @@ void LightAlpha(const Vec3 &pos, const Vec3 &normal, u8 lightNum, const LitChann
 	}
 }
 
+// Material and ambient colors of a channel, abgr
+static void GetChannelColors(const InputVertexData *src, u32 chan, u8 *matcolor, float *ambient)
+{
+	const LitChannel &colorchan = xfmem.color[chan];
+	const LitChannel &alphachan = xfmem.alpha[chan];
+
+	if (colorchan.matsource)
+		*(u32*)matcolor = *(u32*)src->color[chan];  // vertex
+	else
+		*(u32*)matcolor = xfmem.matColor[chan];
+
+	if (alphachan.matsource)
+		matcolor[0] = src->color[chan][0];  // vertex
+	else
+		matcolor[0] = xfmem.matColor[chan] & 0xff;
+
+	const u8 *ambColor = colorchan.ambsource ? src->color[chan] : (u8*)&xfmem.ambColor[chan];
+	ambient[1] = ambColor[1];
+	ambient[2] = ambColor[2];
+	ambient[3] = ambColor[3];
+
+	if (alphachan.ambsource)
+		ambient[0] = src->color[chan][0]; // vertex
+	else
+		ambient[0] = (float)(xfmem.ambColor[chan] & 0xff);
+}
+
+static inline u8 ApplyLight(u8 matcolor, float lightCol)
+{
+	int light = int(lightCol);
+	MathUtil::Clamp(&light, 0, 255);
+	return (matcolor * (light + (light >> 7))) >> 8;
+}
+
 void TransformColor(const InputVertexData *src, OutputVertexData *dst)
 {
 	for (u32 chan = 0; chan < xfmem.numChan.numColorChans; chan++)
@@ -379,31 +416,14 @@ void TransformColor(const InputVertexData *src, OutputVertexData *dst)
 		// abgr
 		u8 matcolor[4];
 		u8 chancolor[4];
+		float ambient[4];
+		GetChannelColors(src, chan, matcolor, ambient);
 
 		// color
 		LitChannel &colorchan = xfmem.color[chan];
-		if (colorchan.matsource)
-			*(u32*)matcolor = *(u32*)src->color[chan];  // vertex
-		else
-			*(u32*)matcolor = xfmem.matColor[chan];
-
 		if (colorchan.enablelighting)
 		{
-			Vec3 lightCol;
-			if (colorchan.ambsource)
-			{
-				// vertex
-				lightCol.x = src->color[chan][1];
-				lightCol.y = src->color[chan][2];
-				lightCol.z = src->color[chan][3];
-			}
-			else
-			{
-				u8 *ambColor = (u8*)&xfmem.ambColor[chan];
-				lightCol.x = ambColor[1];
-				lightCol.y = ambColor[2];
-				lightCol.z = ambColor[3];
-			}
+			Vec3 lightCol(ambient[1], ambient[2], ambient[3]);
 
 			u8 mask = colorchan.GetFullLightMask();
 			for (int i = 0; i < 8; ++i)
@@ -412,15 +432,9 @@ void TransformColor(const InputVertexData *src, OutputVertexData *dst)
 					LightColor(dst->mvPosition, dst->normal[0], i, colorchan, lightCol);
 			}
 
-			int light_x = int(lightCol.x);
-			int light_y = int(lightCol.y);
-			int light_z = int(lightCol.z);
-			MathUtil::Clamp(&light_x, 0, 255);
-			MathUtil::Clamp(&light_y, 0, 255);
-			MathUtil::Clamp(&light_z, 0, 255);
-			chancolor[1] = (matcolor[1] * (light_x + (light_x >> 7))) >> 8;
-			chancolor[2] = (matcolor[2] * (light_y + (light_y >> 7))) >> 8;
-			chancolor[3] = (matcolor[3] * (light_z + (light_z >> 7))) >> 8;
+			chancolor[1] = ApplyLight(matcolor[1], lightCol.x);
+			chancolor[2] = ApplyLight(matcolor[2], lightCol.y);
+			chancolor[3] = ApplyLight(matcolor[3], lightCol.z);
 		}
 		else
 		{
@@ -429,18 +443,9 @@ void TransformColor(const InputVertexData *src, OutputVertexData *dst)
 
 		// alpha
 		LitChannel &alphachan = xfmem.alpha[chan];
-		if (alphachan.matsource)
-			matcolor[0] = src->color[chan][0];  // vertex
-		else
-			matcolor[0] = xfmem.matColor[chan] & 0xff;
-
-		if (xfmem.alpha[chan].enablelighting)
+		if (alphachan.enablelighting)
 		{
-			float lightCol;
-			if (alphachan.ambsource)
-				lightCol = src->color[chan][0]; // vertex
-			else
-				lightCol = (float)(xfmem.ambColor[chan] & 0xff);
+			float lightCol = ambient[0];
 
 			u8 mask = alphachan.GetFullLightMask();
 			for (int i = 0; i < 8; ++i)
@@ -449,9 +454,7 @@ void TransformColor(const InputVertexData *src, OutputVertexData *dst)
 					LightAlpha(dst->mvPosition, dst->normal[0], i, alphachan, lightCol);
 			}
 
-			int light_a = int(lightCol);
-			MathUtil::Clamp(&light_a, 0, 255);
-			chancolor[0] = (matcolor[0] * (light_a + (light_a >> 7))) >> 8;
+			chancolor[0] = ApplyLight(matcolor[0], lightCol);
 		}
 		else
 		{
@@ -513,4 +516,409 @@ void TransformTexCoord(const InputVertexData *src, OutputVertexData *dst, bool s
 	}
 }
 
+
+// The batched versions keep the exact operation order of the scalar code
+// above, one vertex per SSE lane, so they round the same way. Lanes past the
+// end of a batch repeat its last vertex and are not stored.
+
+#ifdef _M_X86
+
+struct Vec3x4
+{
+	__m128 x, y, z;
+};
+
+static inline Vec3x4 LoadVec3(const Vec3 *const v[4])
+{
+	Vec3x4 r;
+	r.x = _mm_setr_ps(v[0]->x, v[1]->x, v[2]->x, v[3]->x);
+	r.y = _mm_setr_ps(v[0]->y, v[1]->y, v[2]->y, v[3]->y);
+	r.z = _mm_setr_ps(v[0]->z, v[1]->z, v[2]->z, v[3]->z);
+	return r;
+}
+
+static inline void StoreVec3(const Vec3x4 &v, Vec3 *const dst[4], int count)
+{
+	float x[4], y[4], z[4];
+	_mm_storeu_ps(x, v.x);
+	_mm_storeu_ps(y, v.y);
+	_mm_storeu_ps(z, v.z);
+	for (int i = 0; i < count; i++)
+		dst[i]->set(x[i], y[i], z[i]);
+}
+
+// Element k of the matrix of lane i ends up in lane i of m[k]
+static inline void LoadMatrices(const float *const mats[4], int size, __m128 *m)
+{
+	if (mats[0] == mats[1] && mats[0] == mats[2] && mats[0] == mats[3])
+	{
+		for (int k = 0; k < size; k++)
+			m[k] = _mm_set1_ps(mats[0][k]);
+	}
+	else
+	{
+		for (int k = 0; k < size; k++)
+			m[k] = _mm_setr_ps(mats[0][k], mats[1][k], mats[2][k], mats[3][k]);
+	}
+}
+
+static inline __m128 Dot(const Vec3x4 &a, const Vec3x4 &b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+static inline __m128 Dot(const Vec3 &a, const Vec3x4 &b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a.x), b.x), _mm_mul_ps(_mm_set1_ps(a.y), b.y)), _mm_mul_ps(_mm_set1_ps(a.z), b.z));
+}
+
+static inline Vec3x4 Scale(const Vec3x4 &v, __m128 f)
+{
+	Vec3x4 r;
+	r.x = _mm_mul_ps(v.x, f);
+	r.y = _mm_mul_ps(v.y, f);
+	r.z = _mm_mul_ps(v.z, f);
+	return r;
+}
+
+// Vec3::normalized()
+static inline Vec3x4 Normalized(const Vec3x4 &v)
+{
+	return Scale(v, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(Dot(v, v))));
+}
+
+// std::max(0.0f, v), which also turns NaN into 0
+static inline __m128 MaxZero(__m128 v)
+{
+	return _mm_max_ps(v, _mm_setzero_ps());
+}
+
+static inline __m128 SafeDivide(__m128 n, __m128 d)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 dzero = _mm_cmpeq_ps(d, zero);
+	const __m128 sign = _mm_and_ps(_mm_cmpgt_ps(n, zero), _mm_set1_ps(1.0f));
+	return _mm_or_ps(_mm_and_ps(dzero, sign), _mm_andnot_ps(dzero, _mm_div_ps(n, d)));
+}
+
+// v > t with v widened to double, like the scalar comparison against a double literal
+static inline __m128 GreaterThan(__m128 v, double t)
+{
+	const __m128d td = _mm_set1_pd(t);
+	const __m128d lo = _mm_cmpgt_pd(_mm_cvtps_pd(v), td);
+	const __m128d hi = _mm_cmpgt_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), td);
+	return _mm_shuffle_ps(_mm_castpd_ps(lo), _mm_castpd_ps(hi), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+// LightColor and LightAlpha for four vertices. lightCol holds the blue, green
+// and red sums for color, or just the alpha sum.
+static void LightVertices(const Vec3x4 &pos, const Vec3x4 &normal, u8 lightNum, const LitChannel &chan, bool alpha, __m128 *lightCol)
+{
+	const LightPointer *light = (const LightPointer*)&xfmem.lights[0x10*lightNum];
+	const int numComponents = alpha ? 1 : 3;
+	const u8 *color = alpha ? &light->color[0] : &light->color[1];
+
+	if (!(chan.attnfunc & 1))
+	{
+		// atten disabled
+		if (chan.diffusefunc == LIGHTDIF_NONE)
+		{
+			for (int c = 0; c < numComponents; c++)
+				lightCol[c] = _mm_add_ps(lightCol[c], _mm_set1_ps(color[c]));
+			return;
+		}
+
+		Vec3x4 ldir;
+		ldir.x = _mm_sub_ps(_mm_set1_ps(light->pos.x), pos.x);
+		ldir.y = _mm_sub_ps(_mm_set1_ps(light->pos.y), pos.y);
+		ldir.z = _mm_sub_ps(_mm_set1_ps(light->pos.z), pos.z);
+		__m128 diffuse = Dot(Normalized(ldir), normal);
+		if (chan.diffusefunc == LIGHTDIF_CLAMP)
+			diffuse = MaxZero(diffuse);
+
+		for (int c = 0; c < numComponents; c++)
+			lightCol[c] = _mm_add_ps(lightCol[c], _mm_mul_ps(_mm_set1_ps(color[c]), diffuse));
+		return;
+	}
+
+	// spec and spot
+	Vec3x4 ldir;
+	__m128 attn;
+
+	if (chan.attnfunc == 3) // spot
+	{
+		ldir.x = _mm_sub_ps(_mm_set1_ps(light->pos.x), pos.x);
+		ldir.y = _mm_sub_ps(_mm_set1_ps(light->pos.y), pos.y);
+		ldir.z = _mm_sub_ps(_mm_set1_ps(light->pos.z), pos.z);
+		const __m128 dist2 = Dot(ldir, ldir);
+		const __m128 dist = _mm_sqrt_ps(dist2);
+		ldir = Scale(ldir, _mm_div_ps(_mm_set1_ps(1.0f), dist));
+		attn = MaxZero(Dot(light->dir, ldir));
+
+		const __m128 cosAtt = _mm_add_ps(_mm_add_ps(_mm_set1_ps(light->cosatt.x), _mm_mul_ps(_mm_set1_ps(light->cosatt.y), attn)),
+		                                 _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(light->cosatt.z), attn), attn));
+		const __m128 distAtt = _mm_add_ps(_mm_add_ps(_mm_set1_ps(light->distatt.x), _mm_mul_ps(_mm_set1_ps(light->distatt.y), dist)),
+		                                  _mm_mul_ps(_mm_set1_ps(light->distatt.z), dist2));
+		attn = SafeDivide(MaxZero(cosAtt), distAtt);
+	}
+	else // specular
+	{
+		const __m128 facing = GreaterThan(Dot(light->pos, normal), -655.36);
+		attn = _mm_and_ps(facing, MaxZero(Dot(light->dir, normal)));
+		ldir.x = _mm_set1_ps(1.0f);
+		ldir.y = attn;
+		ldir.z = _mm_mul_ps(attn, attn);
+
+		// LightColor clamps cosAtt twice, which changes nothing
+		const __m128 cosAtt = Dot(light->cosatt, ldir);
+		const __m128 distAtt = Dot(light->distatt, ldir);
+		attn = SafeDivide(MaxZero(cosAtt), distAtt);
+	}
+
+	if (chan.diffusefunc == LIGHTDIF_NONE)
+	{
+		for (int c = 0; c < numComponents; c++)
+			lightCol[c] = _mm_add_ps(lightCol[c], _mm_mul_ps(_mm_set1_ps(color[c]), attn));
+		return;
+	}
+
+	__m128 difAttn = Dot(ldir, normal);
+	if (chan.diffusefunc == LIGHTDIF_CLAMP)
+		difAttn = MaxZero(difAttn);
+
+	if (alpha)
+	{
+		lightCol[0] = _mm_add_ps(lightCol[0], _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(color[0]), attn), difAttn));
+	}
+	else
+	{
+		const __m128 scale = _mm_mul_ps(attn, difAttn);
+		for (int c = 0; c < numComponents; c++)
+			lightCol[c] = _mm_add_ps(lightCol[c], _mm_mul_ps(_mm_set1_ps(color[c]), scale));
+	}
+}
+
+// Vertices of the group starting at first, the last one repeated to fill all lanes
+template <typename T>
+static inline void GetLanes(T *v, int first, int count, T *lanes[4])
+{
+	for (int i = 0; i < 4; i++)
+		lanes[i] = &v[std::min(first + i, count - 1)];
+}
+
+#endif
+
+void TransformPositions(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+#ifdef _M_X86
+	const float *proj = xfmem.projection.rawProjection;
+	const bool perspective = xfmem.projection.type == GX_PERSPECTIVE;
+
+	for (int i = 0; i < count; i += 4)
+	{
+		const InputVertexData *in[4];
+		OutputVertexData *out[4];
+		GetLanes(src, i, count, in);
+		GetLanes(dst, i, count, out);
+		const int lanes = std::min(count - i, 4);
+
+		const float *mats[4];
+		const Vec3 *positions[4];
+		Vec3 *mvPositions[4];
+		for (int l = 0; l < 4; l++)
+		{
+			mats[l] = (const float*)&xfmem.posMatrices[in[l]->posMtx * 4];
+			positions[l] = &in[l]->position;
+			mvPositions[l] = &out[l]->mvPosition;
+		}
+
+		__m128 m[12];
+		LoadMatrices(mats, 12, m);
+		const Vec3x4 p = LoadVec3(positions);
+
+		// MultiplyVec3Mat34
+		Vec3x4 mv;
+		mv.x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], p.x), _mm_mul_ps(m[1], p.y)), _mm_mul_ps(m[2], p.z)), m[3]);
+		mv.y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[4], p.x), _mm_mul_ps(m[5], p.y)), _mm_mul_ps(m[6], p.z)), m[7]);
+		mv.z = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[8], p.x), _mm_mul_ps(m[9], p.y)), _mm_mul_ps(m[10], p.z)), m[11]);
+		StoreVec3(mv, mvPositions, lanes);
+
+		__m128 projected[4];
+		if (perspective)
+		{
+			// MultipleVec3Perspective
+			projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv.x), _mm_mul_ps(_mm_set1_ps(proj[1]), mv.z));
+			projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv.y), _mm_mul_ps(_mm_set1_ps(proj[3]), mv.z));
+			projected[2] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv.z), _mm_set1_ps(proj[5])),
+			                          _mm_set1_ps(1.0f - (float)1e-7));
+			projected[3] = _mm_xor_ps(mv.z, _mm_set1_ps(-0.0f));
+		}
+		else
+		{
+			// MultipleVec3Ortho
+			projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv.x), _mm_set1_ps(proj[1]));
+			projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv.y), _mm_set1_ps(proj[3]));
+			projected[2] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv.z), _mm_set1_ps(proj[5]));
+			projected[3] = _mm_set1_ps(1.0f);
+		}
+
+		// transpose to one Vec4 per vertex
+		_MM_TRANSPOSE4_PS(projected[0], projected[1], projected[2], projected[3]);
+		for (int l = 0; l < lanes; l++)
+			_mm_storeu_ps(&out[l]->projectedPosition.x, projected[l]);
+	}
+#else
+	for (int i = 0; i < count; i++)
+		TransformPosition(&src[i], &dst[i]);
+#endif
+}
+
+void TransformNormals(const InputVertexData *src, bool nbt, OutputVertexData *dst, int count)
+{
+#ifdef _M_X86
+	const int numNormals = nbt ? 3 : 1;
+
+	for (int i = 0; i < count; i += 4)
+	{
+		const InputVertexData *in[4];
+		OutputVertexData *out[4];
+		GetLanes(src, i, count, in);
+		GetLanes(dst, i, count, out);
+		const int lanes = std::min(count - i, 4);
+
+		const float *mats[4];
+		for (int l = 0; l < 4; l++)
+			mats[l] = (const float*)&xfmem.normalMatrices[(in[l]->posMtx & 31) * 3];
+
+		__m128 m[9];
+		LoadMatrices(mats, 9, m);
+
+		for (int n = 0; n < numNormals; n++)
+		{
+			const Vec3 *normals[4];
+			Vec3 *transformed[4];
+			for (int l = 0; l < 4; l++)
+			{
+				normals[l] = &in[l]->normal[n];
+				transformed[l] = &out[l]->normal[n];
+			}
+
+			// MultiplyVec3Mat33
+			const Vec3x4 v = LoadVec3(normals);
+			Vec3x4 r;
+			r.x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], v.x), _mm_mul_ps(m[1], v.y)), _mm_mul_ps(m[2], v.z));
+			r.y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[3], v.x), _mm_mul_ps(m[4], v.y)), _mm_mul_ps(m[5], v.z));
+			r.z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[6], v.x), _mm_mul_ps(m[7], v.y)), _mm_mul_ps(m[8], v.z));
+
+			// only the normal gets normalized, not the binormals
+			if (n == 0)
+				r = Normalized(r);
+
+			StoreVec3(r, transformed, lanes);
+		}
+	}
+#else
+	for (int i = 0; i < count; i++)
+		TransformNormal(&src[i], nbt, &dst[i]);
+#endif
+}
+
+void TransformColors(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+#ifdef _M_X86
+	// Leave reserved diffuse functions to the scalar code and its assert
+	bool supported = true;
+	for (u32 chan = 0; chan < xfmem.numChan.numColorChans; chan++)
+	{
+		if ((xfmem.color[chan].enablelighting && xfmem.color[chan].diffusefunc > LIGHTDIF_CLAMP) ||
+		    (xfmem.alpha[chan].enablelighting && xfmem.alpha[chan].diffusefunc > LIGHTDIF_CLAMP))
+			supported = false;
+	}
+
+	if (supported)
+	{
+		for (int i = 0; i < count; i += 4)
+		{
+			const InputVertexData *in[4];
+			OutputVertexData *out[4];
+			GetLanes(src, i, count, in);
+			GetLanes(dst, i, count, out);
+			const int lanes = std::min(count - i, 4);
+
+			const Vec3 *positions[4];
+			const Vec3 *normals[4];
+			for (int l = 0; l < 4; l++)
+			{
+				positions[l] = &out[l]->mvPosition;
+				normals[l] = &out[l]->normal[0];
+			}
+			const Vec3x4 pos = LoadVec3(positions);
+			const Vec3x4 normal = LoadVec3(normals);
+
+			for (u32 chan = 0; chan < xfmem.numChan.numColorChans; chan++)
+			{
+				// abgr
+				u8 matcolor[4][4];
+				float ambient[4][4];
+				for (int l = 0; l < 4; l++)
+					GetChannelColors(in[l], chan, matcolor[l], ambient[l]);
+
+				// lit alpha, blue, green and red of each lane
+				float lit[4][4];
+
+				const LitChannel &colorchan = xfmem.color[chan];
+				if (colorchan.enablelighting)
+				{
+					__m128 lightCol[3];
+					for (int c = 0; c < 3; c++)
+						lightCol[c] = _mm_setr_ps(ambient[0][c + 1], ambient[1][c + 1], ambient[2][c + 1], ambient[3][c + 1]);
+
+					u8 mask = colorchan.GetFullLightMask();
+					for (int n = 0; n < 8; ++n)
+					{
+						if (mask&(1<<n))
+							LightVertices(pos, normal, n, colorchan, false, lightCol);
+					}
+
+					for (int c = 0; c < 3; c++)
+						_mm_storeu_ps(lit[c + 1], lightCol[c]);
+				}
+
+				const LitChannel &alphachan = xfmem.alpha[chan];
+				if (alphachan.enablelighting)
+				{
+					__m128 lightCol = _mm_setr_ps(ambient[0][0], ambient[1][0], ambient[2][0], ambient[3][0]);
+
+					u8 mask = alphachan.GetFullLightMask();
+					for (int n = 0; n < 8; ++n)
+					{
+						if (mask&(1<<n))
+							LightVertices(pos, normal, n, alphachan, true, &lightCol);
+					}
+
+					_mm_storeu_ps(lit[0], lightCol);
+				}
+
+				for (int l = 0; l < lanes; l++)
+				{
+					u8 chancolor[4];
+					for (int c = 0; c < 4; c++)
+					{
+						const bool lighting = c == 0 ? alphachan.enablelighting : colorchan.enablelighting;
+						chancolor[c] = lighting ? ApplyLight(matcolor[l][c], lit[c][l]) : matcolor[l][c];
+					}
+
+					// abgr -> rgba
+					*(u32*)out[l]->color[chan] = Common::swap32(*(u32*)chancolor);
+				}
+			}
+		}
+		return;
+	}
+#endif
+
+	for (int i = 0; i < count; i++)
+		TransformColor(&src[i], &dst[i]);
+}
+
 }
@@ -18,4 +18,10 @@ namespace TransformUnit
 	void TransformNormal(const InputVertexData *src, bool nbt, OutputVertexData *dst);
 	void TransformColor(const InputVertexData *src, OutputVertexData *dst);
 	void TransformTexCoord(const InputVertexData *src, OutputVertexData *dst, bool specialCase);
+
+	// Same as the functions above for count vertices at once. The SSE versions
+	// work on four vertices at a time and give bit-identical results.
+	void TransformPositions(const InputVertexData *src, OutputVertexData *dst, int count);
+	void TransformNormals(const InputVertexData *src, bool nbt, OutputVertexData *dst, int count);
+	void TransformColors(const InputVertexData *src, OutputVertexData *dst, int count);
 }
@@ -16,6 +16,7 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexLoader.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -263,6 +264,8 @@ static void BPWritten(const BPCmd& bp)
 		return;
 	case BPMEM_LOADTLUT1: // Load a Texture Look Up Table
 		{
+			TextureCache::InvalidateBoundTextures();
+
 			u32 tlutTMemAddr = (bp.newvalue & 0x3FF) << 9;
 			u32 tlutXferCount = (bp.newvalue & 0x1FFC00) >> 5;
 
@@ -386,6 +389,8 @@ static void BPWritten(const BPCmd& bp)
 		return;
 	case BPMEM_TEXINVALIDATE:
 		// TODO: Needs some restructuring in TextureCacheBase.
+		// For now, just make sure the next draw rehashes all of its textures.
+		TextureCache::InvalidateBoundTextures();
 		return;
 
 	case BPMEM_ZCOMPARE:      // Set the Z-Compare and EFB pixel format
@@ -445,6 +450,8 @@ static void BPWritten(const BPCmd& bp)
 		// if this is different from 0, manual TMEM management is used (GX_PreloadEntireTexture).
 		if (bp.newvalue != 0)
 		{
+			TextureCache::InvalidateBoundTextures();
+
 			// TODO: Not quite sure if this is completely correct (likely not)
 			// NOTE: libogc's implementation of GX_PreloadEntireTexture seems flawed, so it's not necessarily a good reference for RE'ing this feature.
 
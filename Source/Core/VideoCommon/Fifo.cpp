@@ -2,6 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+
 #include "Common/Atomic.h"
 #include "Common/ChunkFile.h"
 #include "Common/FPURoundMode.h"
@@ -12,6 +15,7 @@
 #include "Core/CoreTiming.h"
 #include "Core/HW/Memmap.h"
 
+#include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -29,6 +33,9 @@ static std::mutex m_csHWVidOccupied;
 // STATE_TO_SAVE
 static u8 *videoBuffer;
 static int size = 0;
+
+// Upper bound on how much FIFO data the GPU thread decodes between status updates.
+static const u32 READ_AHEAD_SIZE = 1024;
 }  // namespace
 
 void Fifo_DoState(PointerWrap &p)
@@ -133,6 +140,60 @@ void ResetVideoBuffer()
 }
 
 
+// A PE token or finish write makes the CPU wait for it, so the GPU shouldn't decode past it.
+// Commands can't be told apart from vertex data without decoding them, so this matches the
+// bytes of such a BP write anywhere. A false match only makes the read-ahead shorter.
+static bool IsPEInterruptWrite(u8 opcode, u8 reg)
+{
+	return opcode == GX_LOAD_BP_REG &&
+	       (reg == BPMEM_SETDRAWDONE || reg == BPMEM_PE_TOKEN_ID || reg == BPMEM_PE_TOKEN_INT_ID);
+}
+
+// Ends len at the block that completes the first PE token or finish write, the same point
+// where decoding one block at a time stopped. prev holds the 4 bytes before data, for a write
+// that started in the previous read.
+static u32 StopAtPEInterrupt(const u8 *prev, const u8 *data, u32 len)
+{
+	const u32 BP_COMMAND_SIZE = 5;
+	u8 head[2 * (BP_COMMAND_SIZE - 1)];
+	memcpy(head, prev, BP_COMMAND_SIZE - 1);
+	memcpy(head + BP_COMMAND_SIZE - 1, data, BP_COMMAND_SIZE - 1);
+	for (u32 i = 0; i < BP_COMMAND_SIZE - 1; i++)
+	{
+		if (IsPEInterruptWrite(head[i], head[i + 1]))
+			return 32;
+	}
+
+	for (u32 i = 0; i + 1 < len; i++)
+	{
+		if (IsPEInterruptWrite(data[i], data[i + 1]))
+			return std::min(len, ((i + BP_COMMAND_SIZE - 1) & ~31) + 32);
+	}
+	return len;
+}
+
+// Decoding one 32 byte block per iteration pays for the CP status update, async request
+// check and read pointer atomics on every block. Unless something has to observe the read
+// pointer at block granularity (sync GPU, breakpoints, watermark interrupts), decode all
+// contiguous data up to READ_AHEAD_SIZE at once, but no further than a PE token or finish.
+static u32 GetReadAheadSize(const SCPFifoStruct &fifo)
+{
+	if (Core::g_CoreStartupParameter.bSyncGPU || fifo.bFF_BPEnable ||
+	    fifo.bFF_HiWatermarkInt || fifo.bFF_LoWatermarkInt || fifo.CPReadPointer > fifo.CPEnd)
+		return 32;
+
+	const u32 distance = fifo.CPReadWriteDistance;
+	const u32 to_end = fifo.CPEnd - fifo.CPReadPointer + 32;
+	u32 len = std::min(std::min(distance, to_end), READ_AHEAD_SIZE);
+	len &= ~31;
+	if (len <= 32)
+		return 32;
+
+	// the FIFO wraps from CPEnd's block back to CPBase
+	const u32 prev = fifo.CPReadPointer == fifo.CPBase ? fifo.CPEnd + 32 - 4 : fifo.CPReadPointer - 4;
+	return StopAtPEInterrupt(Memory::GetPointer(prev), Memory::GetPointer(fifo.CPReadPointer), len);
+}
+
 // Description: Main FIFO update loop
 // Purpose: Keep the Core HW updated about the CPU-GPU distance
 void RunGpuLoop()
@@ -162,16 +223,17 @@ void RunGpuLoop()
 			{
 				u32 readPtr = fifo.CPReadPointer;
 				u8 *uData = Memory::GetPointer(readPtr);
+				u32 len = GetReadAheadSize(fifo);
 
-				if (readPtr == fifo.CPEnd)
+				if (readPtr + len - 32 == fifo.CPEnd)
 					readPtr = fifo.CPBase;
 				else
-					readPtr += 32;
+					readPtr += len;
 
-				_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - 32 >= 0 ,
-					"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - 32);
+				_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - (s32)len >= 0 ,
+					"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - len);
 
-				ReadDataFromFifo(uData, 32);
+				ReadDataFromFifo(uData, len);
 
 				cyclesExecuted = OpcodeDecoder_Run(g_bSkipCurrentFrame);
 
@@ -179,7 +241,7 @@ void RunGpuLoop()
 					Common::AtomicAdd(CommandProcessor::VITicks, -(s32)cyclesExecuted);
 
 				Common::AtomicStore(fifo.CPReadPointer, readPtr);
-				Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
+				Common::AtomicAdd(fifo.CPReadWriteDistance, -(s32)len);
 				if ((GetVideoBufferEndPtr() - g_pVideoData) == 0)
 					Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
 			}
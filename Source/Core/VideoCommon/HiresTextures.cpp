@@ -3,81 +3,304 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cctype>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <list>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 #include <SOIL/SOIL.h>
 
 #include "Common/CommonPaths.h"
-#include "Common/FileSearch.h"
+#include "Common/CPUDetect.h"
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Timer.h"
 
 #include "VideoCommon/HiresTextures.h"
 
 namespace HiresTextures
 {
 
-std::map<std::string, std::string> textureMap;
+struct PackEntry
+{
+	std::string name;
+	std::string path;
+};
+
+// The textures of the pack sorted by path. Packs keep the textures of an area
+// or a scene together in a directory, so neighbours tend to be needed together.
+static std::vector<PackEntry> s_pack;
+// Texture file name without extension -> index into s_pack
+static std::unordered_map<std::string, size_t> textureMap;
+
+// Textures prefetched around a miss, on either side in path order
+static const size_t NEIGHBOURS = 8;
 
-void Init(const std::string& gameCode)
+// A decoded RGBA image, kept until the memory budget runs out
+struct CachedImage
 {
-	textureMap.clear();
+	u8* data;
+	int width;
+	int height;
+	size_t size;
+	// decoded ahead of time and not asked for yet
+	bool prefetched;
+	std::list<std::string>::iterator lru;
+};
+
+enum InsertMode
+{
+	INSERT_REQUESTED,
+	// the initial prefetch in path order, which only uses up free space
+	INSERT_PREFETCH,
+	// neighbours of a miss, which may replace prefetched images nobody asked for
+	INSERT_NEIGHBOUR,
+};
+
+// Everything below is protected by s_lock. s_loading holds the textures being
+// decoded by the loader threads, which notify s_loaded when they are done.
+// The loaders wait on s_work for something to prefetch.
+static std::mutex s_lock;
+static std::condition_variable s_loaded;
+static std::condition_variable s_work;
+static std::unordered_map<std::string, CachedImage> s_cache;
+// Most recently used first
+static std::list<std::string> s_lru;
+static size_t s_cache_size;
+static size_t s_cache_budget;
+static std::unordered_set<std::string> s_loading;
+static std::deque<std::string> s_prefetch;
+static std::deque<std::string> s_neighbours;
+// Loaders with an index of at least this stop
+static int s_max_loaders;
+static bool s_stop;
+
+static std::vector<std::thread> s_loaders;
 
-	CFileSearch::XStringVector Directories;
+// Telemetry
+static u32 s_hits;
+static u32 s_misses;
+static u32 s_waits;
+static u32 s_loads;
+static u64 s_load_time;
+static u64 s_max_load_time;
 
-	std::string szDir = StringFromFormat("%s%s", File::GetUserPath(D_HIRESTEXTURES_IDX).c_str(), gameCode.c_str());
-	Directories.push_back(szDir);
+static const char* const EXTENSIONS[] = {
+	".png",
+	".bmp",
+	".tga",
+	".dds",
+	".jpg" // Why not? Could be useful for large photo-like textures
+};
 
-	for (u32 i = 0; i < Directories.size(); i++)
+// Rank of the extension, files with a lower one win when names clash
+static int GetExtensionRank(const std::string& extension)
+{
+	std::string lower = extension;
+	std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+	for (int i = 0; i < (int)ArraySize(EXTENSIONS); i++)
+	{
+		if (lower == EXTENSIONS[i])
+			return i;
+	}
+	return -1;
+}
+
+// Collects texture name -> extension rank and path
+static void IndexDirectory(const File::FSTEntry& directory, const std::string& code, std::unordered_map<std::string, std::pair<int, std::string>>& found)
+{
+	for (const File::FSTEntry& entry : directory.children)
 	{
-		File::FSTEntry FST_Temp;
-		File::ScanDirectoryTree(Directories[i], FST_Temp);
-		for (auto& entry : FST_Temp.children)
+		if (entry.isDirectory)
 		{
-			if (entry.isDirectory)
-			{
-				bool duplicate = false;
-
-				for (auto& Directory : Directories)
-				{
-					if (Directory == entry.physicalName)
-					{
-						duplicate = true;
-						break;
-					}
-				}
-
-				if (!duplicate)
-					Directories.push_back(entry.physicalName);
-			}
+			IndexDirectory(entry, code, found);
+			continue;
 		}
+
+		std::string name, extension;
+		SplitPath(entry.virtualName, nullptr, &name, &extension);
+		const int rank = GetExtensionRank(extension);
+		if (rank < 0 || name.compare(0, code.length(), code) != 0)
+			continue;
+
+		auto it = found.find(name);
+		if (it == found.end() || rank < it->second.first)
+			found[name] = std::make_pair(rank, entry.physicalName);
+	}
+}
+
+static bool DecodeImage(const std::string& path, CachedImage* image)
+{
+	const u64 start = Common::Timer::GetTimeUs();
+	int channels;
+	image->data = SOIL_load_image(path.c_str(), &image->width, &image->height, &channels, SOIL_LOAD_RGBA);
+	const u64 elapsed = Common::Timer::GetTimeUs() - start;
+	if (image->data == nullptr)
+		return false;
+
+	image->size = (size_t)image->width * image->height * 4;
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	s_loads++;
+	s_load_time += elapsed;
+	s_max_load_time = std::max(s_max_load_time, elapsed);
+	return true;
+}
+
+// s_lock must be held. Returns false if the image is bigger than the budget,
+// got decoded by another thread in the meantime, or there's no room it may
+// take according to mode.
+static bool InsertImage(const std::string& filename, CachedImage& image, InsertMode mode)
+{
+	if (image.size > s_cache_budget || s_cache.count(filename))
+		return false;
+
+	while (s_cache_size + image.size > s_cache_budget)
+	{
+		auto victim = s_cache.find(s_lru.back());
+		if (mode == INSERT_PREFETCH || (mode == INSERT_NEIGHBOUR && !victim->second.prefetched))
+			return false;
+
+		SOIL_free_image_data(victim->second.data);
+		s_cache_size -= victim->second.size;
+		s_cache.erase(victim);
+		s_lru.pop_back();
 	}
 
-	CFileSearch::XStringVector Extensions = {
-		"*.png",
-		"*.bmp",
-		"*.tga",
-		"*.dds",
-		"*.jpg" // Why not? Could be useful for large photo-like textures
-	};
+	// the initial prefetch is the first to go, until it gets used
+	image.prefetched = mode != INSERT_REQUESTED;
+	image.lru = mode == INSERT_PREFETCH ? s_lru.insert(s_lru.end(), filename) : s_lru.insert(s_lru.begin(), filename);
+	s_cache_size += image.size;
+	s_cache.insert(std::make_pair(filename, image));
+	return true;
+}
 
-	CFileSearch FileSearch(Extensions, Directories);
-	const CFileSearch::XStringVector& rFilenames = FileSearch.GetFileNames();
+// s_lock must be held
+static void QueueNeighbours(size_t index)
+{
+	if (s_loaders.empty())
+		return;
 
-	const std::string code = StringFromFormat("%s_", gameCode.c_str());
+	// only the latest miss matters, the game has moved on from earlier ones
+	s_neighbours.clear();
+	for (size_t distance = 1; distance <= NEIGHBOURS; distance++)
+	{
+		if (index + distance < s_pack.size())
+			s_neighbours.push_back(s_pack[index + distance].name);
+		if (index >= distance)
+			s_neighbours.push_back(s_pack[index - distance].name);
+	}
+	s_work.notify_all();
+}
 
-	if (rFilenames.size() > 0)
+static void LoaderThread(int index)
+{
+	std::unique_lock<std::mutex> lk(s_lock);
+	while (true)
 	{
-		for (auto& rFilename : rFilenames)
-		{
-			std::string FileName;
-			SplitPath(rFilename, nullptr, &FileName, nullptr);
+		s_work.wait(lk, [&] { return s_stop || index >= s_max_loaders || !s_neighbours.empty() || !s_prefetch.empty(); });
+		if (s_stop || index >= s_max_loaders)
+			return;
+
+		const bool neighbour = !s_neighbours.empty();
+		std::deque<std::string>& queue = neighbour ? s_neighbours : s_prefetch;
+		const std::string filename = std::move(queue.front());
+		queue.pop_front();
+		if (s_cache.count(filename) || s_loading.count(filename))
+			continue;
+
+		s_loading.insert(filename);
+		lk.unlock();
 
-			if (FileName.substr(0, code.length()).compare(code) == 0 && textureMap.find(FileName) == textureMap.end())
-				textureMap.insert(std::map<std::string, std::string>::value_type(FileName, rFilename));
+		CachedImage image;
+		const bool loaded = DecodeImage(s_pack[textureMap.at(filename)].path, &image);
+
+		lk.lock();
+		s_loading.erase(filename);
+		if (loaded && !InsertImage(filename, image, neighbour ? INSERT_NEIGHBOUR : INSERT_PREFETCH))
+		{
+			SOIL_free_image_data(image.data);
+			// the initial prefetch must not push out anything, it stops once the budget is used up
+			if (!neighbour && s_cache_size + image.size > s_cache_budget)
+				s_prefetch.clear();
 		}
+		s_loaded.notify_all();
+	}
+}
+
+void Init(const std::string& gameCode, size_t cache_size)
+{
+	Shutdown();
+
+	File::FSTEntry root;
+	File::ScanDirectoryTree(File::GetUserPath(D_HIRESTEXTURES_IDX) + gameCode, root);
+
+	std::unordered_map<std::string, std::pair<int, std::string>> found;
+	IndexDirectory(root, StringFromFormat("%s_", gameCode.c_str()), found);
+
+	s_pack.reserve(found.size());
+	for (auto& entry : found)
+	{
+		PackEntry pack_entry = { entry.first, std::move(entry.second.second) };
+		s_pack.push_back(std::move(pack_entry));
 	}
+	std::sort(s_pack.begin(), s_pack.end(), [](const PackEntry& a, const PackEntry& b) { return a.path < b.path; });
+	for (size_t i = 0; i < s_pack.size(); i++)
+		textureMap[s_pack[i].name] = i;
+
+	INFO_LOG(VIDEO, "Found %u custom textures", (u32)textureMap.size());
+
+	s_cache_budget = cache_size;
+	if (cache_size == 0)
+		return;
+
+	s_stop = false;
+	for (const PackEntry& entry : s_pack)
+		s_prefetch.push_back(entry.name);
+
+	// All the loaders can run while the game boots, GetHiresTex cuts them down
+	// to one once it runs
+	s_max_loaders = std::max(1, std::min(4, cpu_info.num_cores - 1));
+	for (int i = 0; i < s_max_loaders; i++)
+		s_loaders.emplace_back(LoaderThread, i);
+}
+
+void Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		s_stop = true;
+		s_prefetch.clear();
+		s_neighbours.clear();
+	}
+	s_work.notify_all();
+	for (std::thread& loader : s_loaders)
+		loader.join();
+	s_loaders.clear();
+
+	if (s_hits || s_misses)
+	{
+		NOTICE_LOG(VIDEO, "Custom textures: %u cache hits (%u waited for), %u misses, %u decoded in %u ms on average, at most %u ms",
+			s_hits, s_waits, s_misses, s_loads, s_loads ? (u32)(s_load_time / s_loads / 1000) : 0, (u32)(s_max_load_time / 1000));
+	}
+
+	for (auto& entry : s_cache)
+		SOIL_free_image_data(entry.second.data);
+	s_cache.clear();
+	s_lru.clear();
+	s_cache_size = 0;
+	textureMap.clear();
+	s_pack.clear();
+
+	s_hits = s_misses = s_waits = s_loads = 0;
+	s_load_time = s_max_load_time = 0;
 }
 
 bool HiresTexExists(const std::string& filename)
@@ -87,22 +310,54 @@ bool HiresTexExists(const std::string& filename)
 
 PC_TexFormat GetHiresTex(const std::string& filename, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, int texformat, unsigned int data_size, u8* data)
 {
-	if (textureMap.find(filename) == textureMap.end())
+	auto index = textureMap.find(filename);
+	if (index == textureMap.end())
 		return PC_TEX_FMT_NONE;
+	const std::string& path = s_pack[index->second].path;
 
-	int width;
-	int height;
-	int channels;
+	std::unique_lock<std::mutex> lk(s_lock);
 
-	u8 *temp = SOIL_load_image(textureMap[filename].c_str(), &width, &height, &channels, SOIL_LOAD_RGBA);
-	if (temp == nullptr)
+	// The game asks for textures once it runs, from then on the loaders
+	// shouldn't take cores away from the CPU and GPU threads
+	if (s_max_loaders > 1)
 	{
-		ERROR_LOG(VIDEO, "Custom texture %s failed to load", textureMap[filename].c_str());
-		return PC_TEX_FMT_NONE;
+		s_max_loaders = 1;
+		s_work.notify_all();
+	}
+
+	if (s_loading.count(filename))
+	{
+		s_waits++;
+		s_loaded.wait(lk, [&] { return !s_loading.count(filename); });
+	}
+
+	CachedImage image;
+	bool cached = false;
+	auto it = s_cache.find(filename);
+	if (it != s_cache.end())
+	{
+		s_hits++;
+		s_lru.splice(s_lru.begin(), s_lru, it->second.lru);
+		it->second.prefetched = false;
+		image = it->second;
+		cached = true;
+	}
+	else
+	{
+		s_misses++;
+		QueueNeighbours(index->second);
+		lk.unlock();
+		if (!DecodeImage(path, &image))
+		{
+			ERROR_LOG(VIDEO, "Custom texture %s failed to load", path.c_str());
+			return PC_TEX_FMT_NONE;
+		}
+		lk.lock();
+		cached = InsertImage(filename, image, INSERT_REQUESTED);
 	}
 
-	*pWidth = width;
-	*pHeight = height;
+	*pWidth = image.width;
+	*pHeight = image.height;
 
 	//int offset = 0;
 	PC_TexFormat returnTex = PC_TEX_FMT_NONE;
@@ -118,33 +373,34 @@ PC_TexFormat GetHiresTex(const std::string& filename, unsigned int* pWidth, unsi
 	case GX_TF_I8:
 	case GX_TF_IA4:
 	case GX_TF_IA8:
-		*required_size = width * height * 8;
+		*required_size = image.width * image.height * 8;
 		if (data_size < *required_size)
 			goto cleanup;
 
-		for (int i = 0; i < width * height * 4; i += 4)
+		for (int i = 0; i < image.width * image.height * 4; i += 4)
 		{
 			// Rather than use a luminosity function, just use the most intense color for luminance
 			// TODO(neobrain): Isn't this kind of.. stupid?
-			data[offset++] = *std::max_element(temp+i, temp+i+3);
-			data[offset++] = temp[i+3];
+			data[offset++] = *std::max_element(image.data+i, image.data+i+3);
+			data[offset++] = image.data[i+3];
 		}
 		returnTex = PC_TEX_FMT_IA8;
 		break;
 #endif
 	default:
-		*required_size = width * height * 4;
+		*required_size = image.width * image.height * 4;
 		if (data_size < *required_size)
 			goto cleanup;
 
-		memcpy(data, temp, width * height * 4);
+		memcpy(data, image.data, image.width * image.height * 4);
 		returnTex = PC_TEX_FMT_RGBA32;
 		break;
 	}
 
-	INFO_LOG(VIDEO, "Loading custom texture from %s", textureMap[filename].c_str());
+	INFO_LOG(VIDEO, "Loading custom texture from %s", path.c_str());
 cleanup:
-	SOIL_free_image_data(temp);
+	if (!cached)
+		SOIL_free_image_data(image.data);
 	return returnTex;
 }
 
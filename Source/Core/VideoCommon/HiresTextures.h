@@ -4,14 +4,17 @@
 
 #pragma once
 
-#include <map>
 #include <string>
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
 
 namespace HiresTextures
 {
-void Init(const std::string& gameCode);
+// Indexes the custom textures of the game and starts decoding them in the
+// background, keeping up to cache_size bytes of decoded images around
+void Init(const std::string& gameCode, size_t cache_size);
+// Stops the loader threads and frees all decoded images
+void Shutdown();
 bool HiresTexExists(const std::string& filename);
 PC_TexFormat GetHiresTex(const std::string& fileName, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, int texformat, unsigned int data_size, u8* data);
 
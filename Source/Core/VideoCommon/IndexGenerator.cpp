@@ -4,10 +4,13 @@
 
 #include <cstddef>
 
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
+
 #include "Common/Common.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
-#include "VideoCommon/VideoConfig.h"
 
 //Init
 u16 *IndexGenerator::index_buffer_current;
@@ -18,27 +21,90 @@ static const u16 s_primitive_restart = -1;
 
 static u16* (*primitive_table[8])(u16*, u32, u32);
 
-void IndexGenerator::Init()
+// One repetition of a primitive's index pattern, relative to its first vertex. Generated
+// by the scalar code in Init, so the batched writers can't disagree with it.
+struct IndexPattern
+{
+	u16 indices[40];
+	u32 num_indices; // always a multiple of 8
+	u32 num_verts;   // how far the vertex index advances per repetition
+};
+
+static IndexPattern s_list_pattern[2];
+static IndexPattern s_strip_pattern;
+static IndexPattern s_quads_pattern[2];
+static IndexPattern s_points_pattern;
+
+static void BuildPattern(IndexPattern &pattern, u16* (*generate)(u16*, u32, u32), u32 gen_verts, u32 num_verts)
+{
+	pattern.num_indices = (u32)(generate(pattern.indices, gen_verts, 0) - pattern.indices);
+	pattern.num_verts = num_verts;
+	_assert_(pattern.num_indices % 8 == 0 && pattern.num_indices <= ArraySize(pattern.indices));
+}
+
+// Writes count repetitions of pattern, starting at vertex index.
+static u16* WritePattern(u16 *Iptr, const IndexPattern &pattern, u32 count, u32 index)
+{
+#ifdef _M_X86
+	const __m128i step = _mm_set1_epi16((s16)pattern.num_verts);
+	__m128i base = _mm_set1_epi16((s16)index);
+	for (u32 n = 0; n < count; ++n)
+	{
+		for (u32 i = 0; i < pattern.num_indices; i += 8)
+		{
+			const __m128i rel = _mm_loadu_si128((const __m128i*)&pattern.indices[i]);
+			// Keep primitive restart markers as they are.
+			const __m128i restart = _mm_cmpeq_epi16(rel, _mm_set1_epi16((s16)s_primitive_restart));
+			_mm_storeu_si128((__m128i*)Iptr, _mm_or_si128(_mm_add_epi16(rel, base), restart));
+			Iptr += 8;
+		}
+		base = _mm_add_epi16(base, step);
+	}
+#else
+	for (u32 n = 0; n < count; ++n, index += pattern.num_verts)
+	{
+		for (u32 i = 0; i < pattern.num_indices; ++i)
+		{
+			const u16 rel = pattern.indices[i];
+			*Iptr++ = rel == s_primitive_restart ? s_primitive_restart : (u16)(index + rel);
+		}
+	}
+#endif
+	return Iptr;
+}
+
+void IndexGenerator::Init(bool primitive_restart)
 {
-	if (g_Config.backend_info.bSupportsPrimitiveRestart)
+	if (primitive_restart)
 	{
-		primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuads<true>;
+		primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuadsBatched<true>;
 		primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard<true>;
-		primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddList<true>;
-		primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip<true>;
+		primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddListBatched<true>;
+		primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStripBatched<true>;
 		primitive_table[GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan<true>;
 	}
 	else
 	{
-		primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuads<false>;
+		primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuadsBatched<false>;
 		primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard<false>;
-		primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddList<false>;
-		primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip<false>;
+		primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddListBatched<false>;
+		primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStripBatched<false>;
 		primitive_table[GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan<false>;
 	}
 	primitive_table[GX_DRAW_LINES] = &IndexGenerator::AddLineList;
 	primitive_table[GX_DRAW_LINE_STRIP] = &IndexGenerator::AddLineStrip;
-	primitive_table[GX_DRAW_POINTS] = &IndexGenerator::AddPoints;
+	primitive_table[GX_DRAW_POINTS] = &IndexGenerator::AddPointsBatched;
+
+	// Lists: 8 triangles without restart (24 indices), 2 with (8 indices).
+	BuildPattern(s_list_pattern[false], AddList<false>, 24, 24);
+	BuildPattern(s_list_pattern[true], AddList<true>, 6, 6);
+	// Strips without restart alternate winding, so a repetition is an even number of triangles.
+	BuildPattern(s_strip_pattern, AddStrip<false>, 10, 8);
+	// Quads: 4 quads without restart (24 indices), 8 with (40 indices).
+	BuildPattern(s_quads_pattern[false], AddQuads<false>, 16, 16);
+	BuildPattern(s_quads_pattern[true], AddQuads<true>, 32, 32);
+	// Points, and strips with restart, are plain runs of vertex indices.
+	BuildPattern(s_points_pattern, AddPoints, 8, 8);
 }
 
 void IndexGenerator::Start(u16* Indexptr)
@@ -198,10 +264,45 @@ template <bool pr> u16* IndexGenerator::AddQuads(u16 *Iptr, u32 numVerts, u32 in
 	return Iptr;
 }
 
+template <bool pr> u16* IndexGenerator::AddListBatched(u16 *Iptr, u32 numVerts, u32 index)
+{
+	const IndexPattern &pattern = s_list_pattern[pr];
+	const u32 count = numVerts / pattern.num_verts;
+	const u32 done = count * pattern.num_verts;
+	Iptr = WritePattern(Iptr, pattern, count, index);
+	return AddList<pr>(Iptr, numVerts - done, index + done);
+}
+
+template <bool pr> u16* IndexGenerator::AddStripBatched(u16 *Iptr, u32 numVerts, u32 index)
+{
+	if (pr)
+	{
+		Iptr = AddPointsBatched(Iptr, numVerts, index);
+		*Iptr++ = s_primitive_restart;
+		return Iptr;
+	}
+
+	// The pattern holds the triangles of vertices 0..9, the tail restarts winding at an even triangle.
+	const IndexPattern &pattern = s_strip_pattern;
+	const u32 count = numVerts > 2 ? (numVerts - 2) / pattern.num_verts : 0;
+	const u32 done = count * pattern.num_verts;
+	Iptr = WritePattern(Iptr, pattern, count, index);
+	return AddStrip<pr>(Iptr, numVerts - done, index + done);
+}
+
+template <bool pr> u16* IndexGenerator::AddQuadsBatched(u16 *Iptr, u32 numVerts, u32 index)
+{
+	const IndexPattern &pattern = s_quads_pattern[pr];
+	const u32 count = numVerts / pattern.num_verts;
+	const u32 done = count * pattern.num_verts;
+	Iptr = WritePattern(Iptr, pattern, count, index);
+	return AddQuads<pr>(Iptr, numVerts - done, index + done);
+}
+
 template <bool pr> u16* IndexGenerator::AddQuads_nonstandard(u16 *Iptr, u32 numVerts, u32 index)
 {
 	WARN_LOG(VIDEO, "Non-standard primitive drawing command GL_DRAW_QUADS_2");
-	return AddQuads<pr>(Iptr, numVerts, index);
+	return AddQuadsBatched<pr>(Iptr, numVerts, index);
 }
 
 // Lines
@@ -238,6 +339,13 @@ u16* IndexGenerator::AddPoints(u16 *Iptr, u32 numVerts, u32 index)
 	return Iptr;
 }
 
+u16* IndexGenerator::AddPointsBatched(u16 *Iptr, u32 numVerts, u32 index)
+{
+	const u32 count = numVerts / s_points_pattern.num_verts;
+	const u32 done = count * s_points_pattern.num_verts;
+	Iptr = WritePattern(Iptr, s_points_pattern, count, index);
+	return AddPoints(Iptr, numVerts - done, index + done);
+}
 
 u32 IndexGenerator::GetRemainingIndices()
 {
@@ -13,7 +13,7 @@ class IndexGenerator
 {
 public:
 	// Init
-	static void Init();
+	static void Init(bool primitive_restart);
 	static void Start(u16 *Indexptr);
 
 	static void AddIndices(int primitive, u32 numVertices);
@@ -33,12 +33,19 @@ private:
 	template <bool pr> static u16* AddQuads(u16 *Iptr, u32 numVerts, u32 index);
 	template <bool pr> static u16* AddQuads_nonstandard(u16 *Iptr, u32 numVerts, u32 index);
 
+	// Same output as the above, but whole repetitions of the index pattern are written
+	// 8 indices at a time. The tail goes through the scalar versions.
+	template <bool pr> static u16* AddListBatched(u16 *Iptr, u32 numVerts, u32 index);
+	template <bool pr> static u16* AddStripBatched(u16 *Iptr, u32 numVerts, u32 index);
+	template <bool pr> static u16* AddQuadsBatched(u16 *Iptr, u32 numVerts, u32 index);
+
 	// Lines
 	static u16* AddLineList(u16 *Iptr, u32 numVerts, u32 index);
 	static u16* AddLineStrip(u16 *Iptr, u32 numVerts, u32 index);
 
 	// Points
 	static u16* AddPoints(u16 *Iptr, u32 numVerts, u32 index);
+	static u16* AddPointsBatched(u16 *Iptr, u32 numVerts, u32 index);
 
 	template <bool pr> static u16* WriteTriangle(u16 *Iptr, u32 index1, u32 index2, u32 index3);
 
@@ -49,6 +49,10 @@ enum
 
 typedef void (LOADERDECL *TPipelineFunction)();
 
+// Converts one attribute for count vertices at once. src and dst point at the attribute
+// inside the first vertex; index selects the color/texcoord channel.
+typedef void (LOADERDECL *TBatchFunction)(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index);
+
 enum VarType
 {
 	VAR_UNSIGNED_BYTE,  // GX_U8  = 0
@@ -41,6 +41,8 @@ std::string Statistics::ToString()
 	str += StringFromFormat("Draw calls:       %i\n",stats.thisFrame.numDrawCalls);
 	str += StringFromFormat("Indexed draw calls: %i\n",stats.thisFrame.numIndexedDrawCalls);
 	str += StringFromFormat("Buffer splits:    %i\n",stats.thisFrame.numBufferSplits);
+	str += StringFromFormat("Texture binds reused: %i/%i\n",stats.thisFrame.numTextureBindHits,
+		stats.thisFrame.numTextureBindHits + stats.thisFrame.numTextureBindMisses);
 	str += StringFromFormat("Primitives: %i\n",stats.thisFrame.numPrims);
 	str += StringFromFormat("Primitives (DL): %i\n",stats.thisFrame.numDLPrims);
 	str += StringFromFormat("XF loads: %i\n",stats.thisFrame.numXFLoads);
@@ -60,6 +60,9 @@ struct Statistics
 		int numIndexedDrawCalls;
 		int numBufferSplits;
 
+		int numTextureBindHits;
+		int numTextureBindMisses;
+
 		int numDListsCalled;
 
 		int bytesVertexStreamed;
@@ -32,6 +32,9 @@ unsigned int TextureCache::temp_size;
 
 TextureCache::TexCache TextureCache::textures;
 
+TextureCache::BoundTexture TextureCache::bound_textures[8];
+u32 TextureCache::bound_generation;
+
 TextureCache::BackupConfig TextureCache::backup_config;
 
 bool invalidate_texture_cache_requested;
@@ -49,7 +52,7 @@ TextureCache::TextureCache()
 	TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
 
 	if (g_ActiveConfig.bHiresTextures && !g_ActiveConfig.bDumpTextures)
-		HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID);
+		HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID, (size_t)g_ActiveConfig.iHiresTexturesCacheSize << 20);
 
 	SetHash64Function(g_ActiveConfig.bHiresTextures || g_ActiveConfig.bDumpTextures);
 
@@ -63,6 +66,8 @@ void TextureCache::RequestInvalidateTextureCache()
 
 void TextureCache::Invalidate()
 {
+	InvalidateBoundTextures();
+
 	for (auto& tex : textures)
 	{
 		delete tex.second;
@@ -70,8 +75,14 @@ void TextureCache::Invalidate()
 	textures.clear();
 }
 
+void TextureCache::InvalidateBoundTextures()
+{
+	++bound_generation;
+}
+
 TextureCache::~TextureCache()
 {
+	HiresTextures::Shutdown();
 	Invalidate();
 	FreeAlignedMemory(temp);
 	temp = nullptr;
@@ -91,7 +102,9 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 			g_texture_cache->Invalidate();
 
 			if (g_ActiveConfig.bHiresTextures)
-				HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID);
+				HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID, (size_t)g_ActiveConfig.iHiresTexturesCacheSize << 20);
+			else
+				HiresTextures::Shutdown();
 
 			SetHash64Function(g_ActiveConfig.bHiresTextures || g_ActiveConfig.bDumpTextures);
 			TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
@@ -131,6 +144,7 @@ void TextureCache::Cleanup()
             // EFB copies living on the host GPU are unrecoverable and thus shouldn't be deleted
 		    !iter->second->IsEfbCopy())
 		{
+			InvalidateBoundTextures();
 			delete iter->second;
 			textures.erase(iter++);
 		}
@@ -143,6 +157,8 @@ void TextureCache::Cleanup()
 
 void TextureCache::InvalidateRange(u32 start_address, u32 size)
 {
+	InvalidateBoundTextures();
+
 	TexCache::iterator
 		iter = textures.begin(),
 		tcend = textures.end();
@@ -163,6 +179,8 @@ void TextureCache::InvalidateRange(u32 start_address, u32 size)
 
 void TextureCache::MakeRangeDynamic(u32 start_address, u32 size)
 {
+	InvalidateBoundTextures();
+
 	TexCache::iterator
 		iter = textures.lower_bound(start_address),
 		tcend = textures.upper_bound(start_address + size);
@@ -203,6 +221,8 @@ int TextureCache::TCacheEntryBase::IntersectsMemoryRange(u32 range_address, u32
 
 void TextureCache::ClearRenderTargets()
 {
+	InvalidateBoundTextures();
+
 	TexCache::iterator
 		iter = textures.begin(),
 		tcend = textures.end();
@@ -320,8 +340,11 @@ static u32 CalculateLevelSize(u32 level_0_size, u32 level)
 }
 
 // Used by TextureCache::Load
-static TextureCache::TCacheEntryBase* ReturnEntry(unsigned int stage, TextureCache::TCacheEntryBase* entry)
+TextureCache::TCacheEntryBase* TextureCache::ReturnEntry(unsigned int stage, TCacheEntryBase* entry)
 {
+	bound_textures[stage].entry = entry;
+	bound_textures[stage].generation = bound_generation;
+
 	entry->frameCount = frameCount;
 	entry->Bind(stage);
 
@@ -337,6 +360,43 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	if (0 == address)
 		return nullptr;
 
+	// Skip hashing if this stage is still bound to the same texture and nothing could have modified it since.
+	// TMEM only changes through preloads and TLUT loads, which invalidate all bound textures. RAM can be
+	// written by the CPU at any time, so textures read from RAM are guarded by write tracking.
+	const u32 tmem_even = bpmem.tex[stage / 4].texImage1[stage % 4].tmem_even;
+	const u32 tmem_odd = bpmem.tex[stage / 4].texImage2[stage % 4].tmem_odd;
+	BoundTexture& bound = bound_textures[stage];
+	if (bound.entry && bound.generation == bound_generation &&
+		bound.address == address && bound.width == width && bound.height == height &&
+		bound.format == texformat && bound.tlutaddr == tlutaddr && bound.tlutfmt == tlutfmt &&
+		bound.use_mipmaps == use_mipmaps && bound.maxlevel == maxlevel && bound.from_tmem == from_tmem &&
+		(from_tmem ? (bound.tmem_even == tmem_even && bound.tmem_odd == tmem_odd) :
+		 (bound.ram_tracked && !Memory::HasRangeChanged(address, bound.ram_size, bound.ram_generation))))
+	{
+		INCSTAT(stats.thisFrame.numTextureBindHits);
+		return ReturnEntry(stage, bound.entry);
+	}
+	INCSTAT(stats.thisFrame.numTextureBindMisses);
+
+	// Textures which the CPU keeps rewriting would take a page fault per page on every upload,
+	// so they aren't tracked again for a while once they have been seen changing.
+	if (!from_tmem && bound.ram_tracked && bound.address == address &&
+		Memory::HasRangeChanged(address, bound.ram_size, bound.ram_generation))
+		bound.retrack_frame = frameCount + RETRACK_DELAY;
+
+	bound.entry = nullptr;
+	bound.address = address;
+	bound.width = width;
+	bound.height = height;
+	bound.format = texformat;
+	bound.tlutaddr = tlutaddr;
+	bound.tlutfmt = tlutfmt;
+	bound.use_mipmaps = use_mipmaps;
+	bound.maxlevel = maxlevel;
+	bound.from_tmem = from_tmem;
+	bound.tmem_even = tmem_even;
+	bound.tmem_odd = tmem_odd;
+
 	// TexelSizeInNibbles(format) * width * height / 16;
 	const unsigned int bsw = TexDecoder_GetBlockWidthInTexels(texformat) - 1;
 	const unsigned int bsh = TexDecoder_GetBlockHeightInTexels(texformat) - 1;
@@ -360,6 +420,15 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 
 	const u32 texture_size = TexDecoder_GetTextureSizeInBytes(expandedWidth, expandedHeight, texformat);
 
+	// Has to start before hashing so that no write in between is missed. The TLUT is hashed from TMEM,
+	// and a TLUT load invalidates all bound textures, so later writes to its source in RAM don't matter.
+	bound.ram_tracked = !from_tmem && frameCount >= bound.retrack_frame && Memory::IsWriteTrackingEnabled();
+	if (bound.ram_tracked)
+	{
+		bound.ram_size = texture_size;
+		bound.ram_generation = Memory::TrackRange(address, texture_size);
+	}
+
 	const u8* src_data;
 	if (from_tmem)
 		src_data = &texMem[bpmem.tex[stage / 4].texImage1[stage % 4].tmem_even * TMEM_LINE_SIZE];
@@ -436,6 +505,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		else
 		{
 			// delete the texture and make a new one
+			InvalidateBoundTextures();
 			delete entry;
 			entry = nullptr;
 		}
@@ -457,6 +527,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 				// If we thought we could reuse the texture before, make sure to pool it now!
 				if (entry)
 				{
+					InvalidateBoundTextures();
 					delete entry;
 					entry = nullptr;
 				}
@@ -619,6 +690,8 @@ void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat
 	//
 	// For historical reasons, Dolphin doesn't actually implement "pure" EFB to RAM emulation, but only EFB to texture and hybrid EFB copies.
 
+	InvalidateBoundTextures();
+
 	float colmat[28] = {0};
 	float *const fConstAdd = colmat + 16;
 	float *const ColorMask = colmat + 20;
@@ -92,6 +92,7 @@ public:
 	static void Cleanup();
 
 	static void Invalidate();
+	static void InvalidateBoundTextures();
 	static void InvalidateRange(u32 start_address, u32 size);
 	static void MakeRangeDynamic(u32 start_address, u32 size);
 	static void ClearRenderTargets(); // currently only used by OGL
@@ -118,11 +119,45 @@ private:
 	static bool CheckForCustomTextureLODs(u64 tex_hash, int texformat, unsigned int levels);
 	static PC_TexFormat LoadCustomTexture(u64 tex_hash, int texformat, unsigned int level, unsigned int& width, unsigned int& height);
 	static void DumpTexture(TCacheEntryBase* entry, unsigned int level);
+	static TCacheEntryBase* ReturnEntry(unsigned int stage, TCacheEntryBase* entry);
 
 	typedef std::map<u32, TCacheEntryBase*> TexCache;
 
 	static TexCache textures;
 
+	// Parameters of the last Load() call for each texture stage.
+	// If neither these nor texture memory have changed since, the entry is reused without rehashing.
+	// Textures in RAM are only reused while Memory's write tracking shows no writes to them.
+	struct BoundTexture
+	{
+		TCacheEntryBase* entry;
+		u32 generation;
+
+		u32 address;
+		unsigned int width, height;
+		int format;
+		unsigned int tlutaddr;
+		int tlutfmt;
+		bool use_mipmaps;
+		unsigned int maxlevel;
+		bool from_tmem;
+		u32 tmem_even, tmem_odd;
+
+		bool ram_tracked;
+		u32 ram_size;
+		u64 ram_generation;
+		int retrack_frame;
+	};
+
+	// Number of frames a texture which was seen changing isn't tracked for
+	enum { RETRACK_DELAY = 60 };
+
+	static BoundTexture bound_textures[8];
+
+	// Incremented whenever RAM/TMEM contents backing a bound texture may have changed
+	// or whenever a cache entry gets deleted.
+	static u32 bound_generation;
+
 	// Backup configuration values
 	static struct BackupConfig
 	{
@@ -478,6 +478,7 @@ VertexLoader::VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr)
 	WriteProtect();
 	#else
 	m_numPipelineStages = 0;
+	m_numBatchStages = 0;
 	CompileVertexTranslator();
 	#endif
 
@@ -525,6 +526,7 @@ void VertexLoader::CompileVertexTranslator()
 #else
 	// Reset pipeline
 	m_numPipelineStages = 0;
+	m_numBatchStages = 0;
 #endif
 
 	// Colors
@@ -573,6 +575,7 @@ void VertexLoader::CompileVertexTranslator()
 	{
 		WriteCall(VertexLoader_Position::GetFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
 	}
+	WriteBatchCall(VertexLoader_Position::GetBatchFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements), m_VertexSize, 0, 0);
 	m_VertexSize += VertexLoader_Position::GetSize(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements);
 	nat_offset += 12;
 	vtx_decl.position.components = 3;
@@ -584,6 +587,7 @@ void VertexLoader::CompileVertexTranslator()
 	// Normals
 	if (m_VtxDesc.Normal != NOT_PRESENT)
 	{
+		const int src_offset = m_VertexSize;
 		m_VertexSize += VertexLoader_Normal::GetSize(m_VtxDesc.Normal,
 			m_VtxAttr.NormalFormat, m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3);
 
@@ -598,6 +602,7 @@ void VertexLoader::CompileVertexTranslator()
 				m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3).c_str());
 		}
 		WriteCall(pFunc);
+		WriteBatchCall(nullptr, src_offset, nat_offset, 0);
 
 		for (int i = 0; i < (vtx_attr.NormalElements ? 3 : 1); i++)
 		{
@@ -619,6 +624,8 @@ void VertexLoader::CompileVertexTranslator()
 		vtx_decl.colors[i].components = 4;
 		vtx_decl.colors[i].type = VAR_UNSIGNED_BYTE;
 		vtx_decl.colors[i].integer = false;
+		const int src_offset = m_VertexSize;
+		TBatchFunction batch = nullptr;
 		switch (col[i])
 		{
 		case NOT_PRESENT:
@@ -631,7 +638,7 @@ void VertexLoader::CompileVertexTranslator()
 			case FORMAT_32B_888x: m_VertexSize += 4; WriteCall(Color_ReadDirect_32b_888x); break;
 			case FORMAT_16B_4444: m_VertexSize += 2; WriteCall(Color_ReadDirect_16b_4444); break;
 			case FORMAT_24B_6666: m_VertexSize += 3; WriteCall(Color_ReadDirect_24b_6666); break;
-			case FORMAT_32B_8888: m_VertexSize += 4; WriteCall(Color_ReadDirect_32b_8888); break;
+			case FORMAT_32B_8888: m_VertexSize += 4; WriteCall(Color_ReadDirect_32b_8888); batch = Color_ReadDirect_32b_8888_Batch; break;
 			default: _assert_(0); break;
 			}
 			break;
@@ -644,7 +651,7 @@ void VertexLoader::CompileVertexTranslator()
 			case FORMAT_32B_888x: WriteCall(Color_ReadIndex8_32b_888x); break;
 			case FORMAT_16B_4444: WriteCall(Color_ReadIndex8_16b_4444); break;
 			case FORMAT_24B_6666: WriteCall(Color_ReadIndex8_24b_6666); break;
-			case FORMAT_32B_8888: WriteCall(Color_ReadIndex8_32b_8888); break;
+			case FORMAT_32B_8888: WriteCall(Color_ReadIndex8_32b_8888); batch = Color_ReadIndex8_32b_8888_Batch; break;
 			default: _assert_(0); break;
 			}
 			break;
@@ -657,7 +664,7 @@ void VertexLoader::CompileVertexTranslator()
 			case FORMAT_32B_888x: WriteCall(Color_ReadIndex16_32b_888x); break;
 			case FORMAT_16B_4444: WriteCall(Color_ReadIndex16_16b_4444); break;
 			case FORMAT_24B_6666: WriteCall(Color_ReadIndex16_24b_6666); break;
-			case FORMAT_32B_8888: WriteCall(Color_ReadIndex16_32b_8888); break;
+			case FORMAT_32B_8888: WriteCall(Color_ReadIndex16_32b_8888); batch = Color_ReadIndex16_32b_8888_Batch; break;
 			default: _assert_(0); break;
 			}
 			break;
@@ -666,6 +673,7 @@ void VertexLoader::CompileVertexTranslator()
 		if (col[i] != NOT_PRESENT)
 		{
 			components |= VB_HAS_COL0 << i;
+			WriteBatchCall(batch, src_offset, nat_offset, i);
 			vtx_decl.colors[i].offset = nat_offset;
 			vtx_decl.colors[i].enable = true;
 			nat_offset += 4;
@@ -694,6 +702,7 @@ void VertexLoader::CompileVertexTranslator()
 
 			components |= VB_HAS_UV0 << i;
 			WriteCall(VertexLoader_TextCoord::GetFunction(tc[i], format, elements));
+			WriteBatchCall(nullptr, m_VertexSize, nat_offset, i);
 			m_VertexSize += VertexLoader_TextCoord::GetSize(tc[i], format, elements);
 		}
 
@@ -760,6 +769,13 @@ void VertexLoader::CompileVertexTranslator()
 	native_stride = nat_offset;
 	vtx_decl.stride = native_stride;
 
+#ifndef USE_VERTEX_LOADER_JIT
+	// Matrix indices are carried from the start of the vertex to the end of it and
+	// bounding box needs each position right after it's loaded, so keep those per vertex.
+	if (m_VtxDesc.PosMatIdx || (components & VB_HAS_TEXMTXIDXALL) || g_ActiveConfig.bUseBBox)
+		m_numBatchStages = 0;
+#endif
+
 #ifdef USE_VERTEX_LOADER_JIT
 	// End loop here
 #if _M_X86_64
@@ -791,6 +807,19 @@ void VertexLoader::WriteCall(TPipelineFunction func)
 	m_PipelineStages[m_numPipelineStages++] = func;
 #endif
 }
+
+// Registers the attribute converted by the preceding WriteCall for batched loading.
+void VertexLoader::WriteBatchCall(TBatchFunction batch, int src_offset, int dst_offset, int index)
+{
+#ifndef USE_VERTEX_LOADER_JIT
+	BatchStage &stage = m_BatchStages[m_numBatchStages++];
+	stage.batch = batch;
+	stage.func = m_PipelineStages[m_numPipelineStages - 1];
+	stage.src_offset = src_offset;
+	stage.dst_offset = dst_offset;
+	stage.index = index;
+#endif
+}
 // ARMTODO: This should be done in a better way
 #ifndef _M_GENERIC
 void VertexLoader::WriteGetVariable(int bits, OpArg dest, void *address)
@@ -867,6 +896,39 @@ void VertexLoader::ConvertVertices ( int count )
 		((void (*)())(void*)m_compiledCode)();
 	}
 #else
+	if (m_numBatchStages > 0)
+	{
+		u8* const src = g_pVideoData;
+		u8* const dst = VertexManager::s_pCurBufferPointer;
+
+		// Attributes without a batch kernel go first. Some of their SIMD loaders store past
+		// the end of the attribute, which the exact-width batch kernels then overwrite.
+		for (int s = 0; s < count; s++)
+		{
+			for (int i = 0; i < m_numBatchStages; i++)
+			{
+				const BatchStage &stage = m_BatchStages[i];
+				if (stage.batch)
+					continue;
+				g_pVideoData = src + s * m_VertexSize + stage.src_offset;
+				VertexManager::s_pCurBufferPointer = dst + s * native_stride + stage.dst_offset;
+				tcIndex = colIndex = stage.index;
+				stage.func();
+			}
+		}
+
+		for (int i = 0; i < m_numBatchStages; i++)
+		{
+			const BatchStage &stage = m_BatchStages[i];
+			if (stage.batch)
+				stage.batch(src + stage.src_offset, m_VertexSize, dst + stage.dst_offset, native_stride, count, stage.index);
+		}
+
+		g_pVideoData = src + count * m_VertexSize;
+		VertexManager::s_pCurBufferPointer = dst + count * native_stride;
+		return;
+	}
+
 	for (int s = 0; s < count; s++)
 	{
 		tcIndex = 0;
@@ -121,6 +121,19 @@ private:
 	// Pipeline.
 	TPipelineFunction m_PipelineStages[64];  // TODO - figure out real max. it's lower.
 	int m_numPipelineStages;
+
+	// Batched pipeline, one stage per attribute. Stages without a batch kernel
+	// run their pipeline function once per vertex.
+	struct BatchStage
+	{
+		TBatchFunction batch;
+		TPipelineFunction func;
+		int src_offset;
+		int dst_offset;
+		int index;
+	};
+	BatchStage m_BatchStages[16];
+	int m_numBatchStages;
 #endif
 
 	const u8 *m_compiledCode;
@@ -133,6 +146,7 @@ private:
 	void ConvertVertices(int count);
 
 	void WriteCall(TPipelineFunction);
+	void WriteBatchCall(TBatchFunction batch, int src_offset, int dst_offset, int index);
 
 #ifndef _M_GENERIC
 	void WriteGetVariable(int bits, Gen::OpArg dest, void *address);
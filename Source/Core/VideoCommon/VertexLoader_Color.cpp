@@ -179,3 +179,29 @@ void LOADERDECL Color_ReadIndex16_32b_888x() { Color_ReadIndex_32b_888x<u16>();
 void LOADERDECL Color_ReadIndex16_16b_4444() { Color_ReadIndex_16b_4444<u16>(); }
 void LOADERDECL Color_ReadIndex16_24b_6666() { Color_ReadIndex_24b_6666<u16>(); }
 void LOADERDECL Color_ReadIndex16_32b_8888() { Color_ReadIndex_32b_8888<u16>(); }
+
+void LOADERDECL Color_ReadDirect_32b_8888_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	const u32 alpha = colElements[index] ? 0 : AMASK;
+	for (int v = 0; v < count; ++v, src += src_stride, dst += dst_stride)
+		*(u32*)dst = _Read32(src) | alpha;
+}
+
+template <typename I>
+void Color_ReadIndex_32b_8888_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	const u8* const base = cached_arraybases[ARRAY_COLOR+index];
+	const u32 stride = arraystrides[ARRAY_COLOR+index];
+	for (int v = 0; v < count; ++v, src += src_stride, dst += dst_stride)
+		*(u32*)dst = _Read32(base + Common::FromBigEndian(*(const I*)src) * stride);
+}
+
+void LOADERDECL Color_ReadIndex8_32b_8888_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	Color_ReadIndex_32b_8888_Batch<u8>(src, src_stride, dst, dst_stride, count, index);
+}
+
+void LOADERDECL Color_ReadIndex16_32b_8888_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	Color_ReadIndex_32b_8888_Batch<u16>(src, src_stride, dst, dst_stride, count, index);
+}
@@ -24,3 +24,7 @@ void LOADERDECL Color_ReadIndex16_32b_888x();
 void LOADERDECL Color_ReadIndex16_16b_4444();
 void LOADERDECL Color_ReadIndex16_24b_6666();
 void LOADERDECL Color_ReadIndex16_32b_8888();
+
+void LOADERDECL Color_ReadDirect_32b_8888_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index);
+void LOADERDECL Color_ReadIndex8_32b_8888_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index);
+void LOADERDECL Color_ReadIndex16_32b_8888_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index);
@@ -12,6 +12,10 @@
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoCommon.h"
 
+#if _M_SSSE3_FUNCTIONS
+#include <tmmintrin.h>
+#endif
+
 extern float posScale;
 extern TVtxAttr *pVtxAttr;
 
@@ -104,12 +108,12 @@ void LOADERDECL Pos_ReadIndex()
 	LOG_VTX();
 }
 
-#if _M_SSE >= 0x301
+#if _M_SSSE3_FUNCTIONS
 static const __m128i kMaskSwap32_3 = _mm_set_epi32(0xFFFFFFFFL, 0x08090A0BL, 0x04050607L, 0x00010203L);
 static const __m128i kMaskSwap32_2 = _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x04050607L, 0x00010203L);
 
 template <typename I, bool three>
-void LOADERDECL Pos_ReadIndex_Float_SSSE3()
+FUNCTION_TARGET_SSSE3 void LOADERDECL Pos_ReadIndex_Float_SSSE3()
 {
 	auto const index = DataRead<I>();
 	const u32* pData = (const u32 *)(cached_arraybases[ARRAY_POSITION] + (index * arraystrides[ARRAY_POSITION]));
@@ -121,6 +125,102 @@ void LOADERDECL Pos_ReadIndex_Float_SSSE3()
 }
 #endif
 
+template <typename T, int N>
+__forceinline void Pos_Convert(const T* src, u8* dst, float scale)
+{
+	float* const out = reinterpret_cast<float*>(dst);
+	for (int i = 0; i < 3; ++i)
+		out[i] = i<N ? PosScale(Common::FromBigEndian(src[i]), scale) : 0.f;
+}
+
+template <typename T, int N>
+void LOADERDECL Pos_ReadDirect_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	auto const scale = posScale;
+	for (int v = 0; v < count; ++v, src += src_stride, dst += dst_stride)
+		Pos_Convert<T, N>(reinterpret_cast<const T*>(src), dst, scale);
+}
+
+template <typename I, typename T, int N>
+void LOADERDECL Pos_ReadIndex_Batch(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	auto const base = cached_arraybases[ARRAY_POSITION];
+	auto const stride = arraystrides[ARRAY_POSITION];
+	auto const scale = posScale;
+	for (int v = 0; v < count; ++v, src += src_stride, dst += dst_stride)
+	{
+		auto const idx = Common::FromBigEndian(*reinterpret_cast<const I*>(src));
+		Pos_Convert<T, N>(reinterpret_cast<const T*>(base + idx * stride), dst, scale);
+	}
+}
+
+#if _M_SSSE3_FUNCTIONS
+// Byte swap to native order. s16 values land in the high half of each 32-bit lane so
+// an arithmetic shift sign-extends them; missing components become zero.
+static const __m128i kMaskSwap16_3 = _mm_set_epi32(0xFFFFFFFFL, 0x0405FFFFL, 0x0203FFFFL, 0x0001FFFFL);
+static const __m128i kMaskSwap16_2 = _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0x0203FFFFL, 0x0001FFFFL);
+
+// Loads exactly the bytes of one position, so reads never run past the vertex data.
+template <typename T, int N>
+__forceinline __m128i Pos_Load(const u8* src)
+{
+	if (sizeof(T) == sizeof(float))
+	{
+		__m128i a = _mm_loadl_epi64((const __m128i*)src);
+		if (N == 3)
+			a = _mm_unpacklo_epi64(a, _mm_cvtsi32_si128(*(const u32*)(src + 8)));
+		return a;
+	}
+	__m128i a = _mm_cvtsi32_si128(*(const u32*)src);
+	if (N == 3)
+		a = _mm_insert_epi16(a, *(const u16*)(src + 4), 2);
+	return a;
+}
+
+// Writes exactly three floats, like the scalar loaders.
+__forceinline void Pos_Store(u8* dst, __m128i v)
+{
+	_mm_storel_epi64((__m128i*)dst, v);
+	*(u32*)(dst + 8) = _mm_cvtsi128_si32(_mm_unpackhi_epi64(v, v));
+}
+
+template <typename T, int N>
+FUNCTION_TARGET_SSSE3 __forceinline void Pos_Convert_SSSE3(const u8* src, u8* dst, __m128 scale)
+{
+	const __m128i a = Pos_Load<T, N>(src);
+	if (sizeof(T) == sizeof(float))
+	{
+		Pos_Store(dst, _mm_shuffle_epi8(a, N == 3 ? kMaskSwap32_3 : kMaskSwap32_2));
+	}
+	else
+	{
+		const __m128i b = _mm_srai_epi32(_mm_shuffle_epi8(a, N == 3 ? kMaskSwap16_3 : kMaskSwap16_2), 16);
+		Pos_Store(dst, _mm_castps_si128(_mm_mul_ps(_mm_cvtepi32_ps(b), scale)));
+	}
+}
+
+template <typename T, int N>
+FUNCTION_TARGET_SSSE3 void LOADERDECL Pos_ReadDirect_Batch_SSSE3(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	const __m128 scale = _mm_set1_ps(posScale);
+	for (int v = 0; v < count; ++v, src += src_stride, dst += dst_stride)
+		Pos_Convert_SSSE3<T, N>(src, dst, scale);
+}
+
+template <typename I, typename T, int N>
+FUNCTION_TARGET_SSSE3 void LOADERDECL Pos_ReadIndex_Batch_SSSE3(const u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	auto const base = cached_arraybases[ARRAY_POSITION];
+	auto const stride = arraystrides[ARRAY_POSITION];
+	const __m128 scale = _mm_set1_ps(posScale);
+	for (int v = 0; v < count; ++v, src += src_stride, dst += dst_stride)
+	{
+		auto const idx = Common::FromBigEndian(*reinterpret_cast<const I*>(src));
+		Pos_Convert_SSSE3<T, N>(base + idx * stride, dst, scale);
+	}
+}
+#endif
+
 static TPipelineFunction tableReadPosition[4][8][2] = {
 	{
 		{nullptr, nullptr,},
@@ -152,6 +252,37 @@ static TPipelineFunction tableReadPosition[4][8][2] = {
 	},
 };
 
+static TBatchFunction tableReadPositionBatch[4][8][2] = {
+	{
+		{nullptr, nullptr,},
+		{nullptr, nullptr,},
+		{nullptr, nullptr,},
+		{nullptr, nullptr,},
+		{nullptr, nullptr,},
+	},
+	{
+		{Pos_ReadDirect_Batch<u8, 2>, Pos_ReadDirect_Batch<u8, 3>,},
+		{Pos_ReadDirect_Batch<s8, 2>, Pos_ReadDirect_Batch<s8, 3>,},
+		{Pos_ReadDirect_Batch<u16, 2>, Pos_ReadDirect_Batch<u16, 3>,},
+		{Pos_ReadDirect_Batch<s16, 2>, Pos_ReadDirect_Batch<s16, 3>,},
+		{Pos_ReadDirect_Batch<float, 2>, Pos_ReadDirect_Batch<float, 3>,},
+	},
+	{
+		{Pos_ReadIndex_Batch<u8, u8, 2>, Pos_ReadIndex_Batch<u8, u8, 3>,},
+		{Pos_ReadIndex_Batch<u8, s8, 2>, Pos_ReadIndex_Batch<u8, s8, 3>,},
+		{Pos_ReadIndex_Batch<u8, u16, 2>, Pos_ReadIndex_Batch<u8, u16, 3>,},
+		{Pos_ReadIndex_Batch<u8, s16, 2>, Pos_ReadIndex_Batch<u8, s16, 3>,},
+		{Pos_ReadIndex_Batch<u8, float, 2>, Pos_ReadIndex_Batch<u8, float, 3>,},
+	},
+	{
+		{Pos_ReadIndex_Batch<u16, u8, 2>, Pos_ReadIndex_Batch<u16, u8, 3>,},
+		{Pos_ReadIndex_Batch<u16, s8, 2>, Pos_ReadIndex_Batch<u16, s8, 3>,},
+		{Pos_ReadIndex_Batch<u16, u16, 2>, Pos_ReadIndex_Batch<u16, u16, 3>,},
+		{Pos_ReadIndex_Batch<u16, s16, 2>, Pos_ReadIndex_Batch<u16, s16, 3>,},
+		{Pos_ReadIndex_Batch<u16, float, 2>, Pos_ReadIndex_Batch<u16, float, 3>,},
+	},
+};
+
 static int tableReadPositionVertexSize[4][8][2] = {
 	{
 		{0, 0,}, {0, 0,}, {0, 0,}, {0, 0,}, {0, 0,},
@@ -171,7 +302,7 @@ static int tableReadPositionVertexSize[4][8][2] = {
 void VertexLoader_Position::Init(void)
 {
 
-#if _M_SSE >= 0x301
+#if _M_SSSE3_FUNCTIONS
 
 	if (cpu_info.bSSSE3)
 	{
@@ -179,6 +310,19 @@ void VertexLoader_Position::Init(void)
 		tableReadPosition[2][4][1] = Pos_ReadIndex_Float_SSSE3<u8, true>;
 		tableReadPosition[3][4][0] = Pos_ReadIndex_Float_SSSE3<u16, false>;
 		tableReadPosition[3][4][1] = Pos_ReadIndex_Float_SSSE3<u16, true>;
+
+		tableReadPositionBatch[1][3][0] = Pos_ReadDirect_Batch_SSSE3<s16, 2>;
+		tableReadPositionBatch[1][3][1] = Pos_ReadDirect_Batch_SSSE3<s16, 3>;
+		tableReadPositionBatch[1][4][0] = Pos_ReadDirect_Batch_SSSE3<float, 2>;
+		tableReadPositionBatch[1][4][1] = Pos_ReadDirect_Batch_SSSE3<float, 3>;
+		tableReadPositionBatch[2][3][0] = Pos_ReadIndex_Batch_SSSE3<u8, s16, 2>;
+		tableReadPositionBatch[2][3][1] = Pos_ReadIndex_Batch_SSSE3<u8, s16, 3>;
+		tableReadPositionBatch[2][4][0] = Pos_ReadIndex_Batch_SSSE3<u8, float, 2>;
+		tableReadPositionBatch[2][4][1] = Pos_ReadIndex_Batch_SSSE3<u8, float, 3>;
+		tableReadPositionBatch[3][3][0] = Pos_ReadIndex_Batch_SSSE3<u16, s16, 2>;
+		tableReadPositionBatch[3][3][1] = Pos_ReadIndex_Batch_SSSE3<u16, s16, 3>;
+		tableReadPositionBatch[3][4][0] = Pos_ReadIndex_Batch_SSSE3<u16, float, 2>;
+		tableReadPositionBatch[3][4][1] = Pos_ReadIndex_Batch_SSSE3<u16, float, 3>;
 	}
 
 #endif
@@ -194,3 +338,8 @@ TPipelineFunction VertexLoader_Position::GetFunction(unsigned int _type, unsigne
 {
 	return tableReadPosition[_type][_format][_elements];
 }
+
+TBatchFunction VertexLoader_Position::GetBatchFunction(unsigned int _type, unsigned int _format, unsigned int _elements)
+{
+	return tableReadPositionBatch[_type][_format][_elements];
+}
@@ -59,6 +59,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	iniFile.Get("Settings", "ShowEFBCopyRegions", &bShowEFBCopyRegions, false);
 	iniFile.Get("Settings", "DumpTextures", &bDumpTextures, 0);
 	iniFile.Get("Settings", "HiresTextures", &bHiresTextures, 0);
+	iniFile.Get("Settings", "HiresTexturesCacheSize", &iHiresTexturesCacheSize, 512);
 	iniFile.Get("Settings", "DumpEFBTarget", &bDumpEFBTarget, 0);
 	iniFile.Get("Settings", "DumpFrames", &bDumpFrames, 0);
 	iniFile.Get("Settings", "FreeLook", &bFreeLook, 0);
@@ -230,6 +231,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	iniFile.Set("Settings", "OverlayProjStats", bOverlayProjStats);
 	iniFile.Set("Settings", "DumpTextures", bDumpTextures);
 	iniFile.Set("Settings", "HiresTextures", bHiresTextures);
+	iniFile.Set("Settings", "HiresTexturesCacheSize", iHiresTexturesCacheSize);
 	iniFile.Set("Settings", "DumpEFBTarget", bDumpEFBTarget);
 	iniFile.Set("Settings", "DumpFrames", bDumpFrames);
 	iniFile.Set("Settings", "FreeLook", bFreeLook);
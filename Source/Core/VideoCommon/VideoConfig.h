@@ -93,6 +93,7 @@ struct VideoConfig final
 	// Utility
 	bool bDumpTextures;
 	bool bHiresTextures;
+	int iHiresTexturesCacheSize; // in MB, 0 to decode custom textures only when they are used
 	bool bDumpEFBTarget;
 	bool bDumpFrames;
 	bool bUseFFV1;
@@ -0,0 +1,346 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/CachedBlob.h"
+#include "DiscIO/DVDTrace.h"
+#include "DiscIO/GameLibrary.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeCreator.h"
+
+// Stub out the little DiscIO asks of the core, this tool never runs a game.
+SConfig* SConfig::m_Instance;
+Core::EState Core::GetState() { return Core::CORE_UNINITIALIZED; }
+
+static const char* PLATFORM_NAMES[] = { "GC", "Wii", "WAD" };
+
+// Finds the images in the given directories and their subdirectories, files
+// are taken as they are
+static std::vector<std::string> FindImages(const std::vector<std::string>& paths)
+{
+	CFileSearch::XStringVector files, directories;
+	for (const std::string& path : paths)
+	{
+		if (File::IsDirectory(path))
+			directories.push_back(path);
+		else
+			files.push_back(path);
+	}
+
+	for (u32 i = 0; i < directories.size(); i++)
+	{
+		File::FSTEntry FST_Temp;
+		File::ScanDirectoryTree(directories[i], FST_Temp);
+		for (auto& Entry : FST_Temp.children)
+		{
+			if (Entry.isDirectory && std::find(directories.begin(), directories.end(), Entry.physicalName) == directories.end())
+				directories.push_back(Entry.physicalName);
+		}
+	}
+
+	CFileSearch::XStringVector extensions;
+	for (const char* extension : { "*.gcm", "*.iso", "*.ciso", "*.gcz", "*.wbfs", "*.wad" })
+		extensions.push_back(extension);
+
+	CFileSearch search(extensions, directories);
+	files.insert(files.end(), search.GetFileNames().begin(), search.GetFileNames().end());
+	return files;
+}
+
+static int Scan(int argc, const char* argv[])
+{
+	std::string index_filename = "gamelist.idx";
+	int threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+	bool quiet = false;
+	std::vector<std::string> paths;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-i") && i + 1 < argc)
+			index_filename = argv[++i];
+		else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+			threads = std::max(atoi(argv[++i]), 1);
+		else if (!strcmp(argv[i], "-q"))
+			quiet = true;
+		else
+			paths.push_back(argv[i]);
+	}
+
+	if (paths.empty())
+	{
+		printf("ERROR: Nothing to scan.\n");
+		return 1;
+	}
+
+	const std::vector<std::string> images = FindImages(paths);
+
+	DiscIO::GameLibrary library(index_filename);
+	library.Update(images, threads, [quiet](u32 done, u32 total, const std::string& last_path) {
+		if (!quiet)
+			fprintf(stderr, "\r%u/%u", done, total);
+		return true;
+	});
+	if (!quiet && library.GetStats().scanned)
+		fprintf(stderr, "\n");
+
+	if (!library.Save())
+		printf("ERROR: Could not write %s.\n", index_filename.c_str());
+
+	u32 valid = 0;
+	for (const DiscIO::GameMetadata& game : library.GetGames())
+	{
+		if (!game.valid)
+		{
+			if (!quiet)
+				printf("?      ?    %s\n", game.path.c_str());
+			continue;
+		}
+
+		valid++;
+		if (quiet)
+			continue;
+
+		std::string name;
+		if (!game.names.empty())
+			name = game.names[0];
+		else if (!game.volume_names.empty())
+			name = game.volume_names[0];
+		printf("%-6s %-4s %s  %s\n", game.unique_id.c_str(), PLATFORM_NAMES[game.platform], name.c_str(), game.path.c_str());
+	}
+
+	const DiscIO::GameLibrary::Stats& stats = library.GetStats();
+	printf("%u images, %u valid: %u from the index, %u read with %d threads in %u ms\n",
+		(u32)images.size(), valid, stats.cached, stats.scanned, threads, (u32)(stats.scan_time_us / 1000));
+	return 0;
+}
+
+// Reads what the trace read, from an image through a volume like the emulator
+// does, or straight from the blob reader
+static bool ReplayImage(const std::vector<DiscIO::TraceEntry>& trace, const std::string& image, bool blob, u32 cache_mb)
+{
+	DiscIO::IVolume* volume = nullptr;
+	DiscIO::IBlobReader* reader = nullptr;
+	DiscIO::CachedBlobReader* cache = nullptr;
+	if (blob)
+	{
+		// uncached, so that without -c this measures the format itself and
+		// with -c there is only the cache of the given size
+		reader = DiscIO::CreateBlobReader(image, false);
+		if (reader && cache_mb)
+			reader = cache = new DiscIO::CachedBlobReader(reader, DiscIO::CachedBlobReader::DEFAULT_BLOCK_SIZE,
+				(u32)(((u64)cache_mb << 20) / DiscIO::CachedBlobReader::DEFAULT_BLOCK_SIZE));
+	}
+	else
+	{
+		volume = DiscIO::CreateVolumeFromFilename(image);
+	}
+	if (!volume && !reader)
+	{
+		printf("ERROR: Could not open %s.\n", image.c_str());
+		return false;
+	}
+
+	u32 max_length = 0;
+	for (const DiscIO::TraceEntry& entry : trace)
+		max_length = std::max(max_length, entry.length);
+	std::vector<u8> buffer(std::max<u32>(max_length, 1));
+
+	std::vector<u64> latencies;
+	latencies.reserve(trace.size());
+	u64 bytes = 0;
+	u32 failed = 0;
+	const u64 start = Common::Timer::GetTimeUs();
+	for (const DiscIO::TraceEntry& entry : trace)
+	{
+		const u64 read_start = Common::Timer::GetTimeUs();
+		bool success;
+		if (reader)
+			success = reader->Read(entry.offset, entry.length, &buffer[0]);
+		else if (entry.kind == DiscIO::TraceEntry::RAW)
+			success = volume->RAWRead(entry.offset, entry.length, &buffer[0]);
+		else
+			success = volume->Read(entry.offset, entry.length, &buffer[0]);
+		latencies.push_back(Common::Timer::GetTimeUs() - read_start);
+		bytes += entry.length;
+		failed += !success;
+	}
+	const u64 total_us = std::max<u64>(Common::Timer::GetTimeUs() - start, 1);
+
+	std::sort(latencies.begin(), latencies.end());
+	auto percentile = [&](double p) { return latencies.empty() ? 0 : (u32)latencies[(size_t)((latencies.size() - 1) * p)]; };
+	printf("%s: %.1f MB/s, latency mean %u us, p50 %u us, p99 %u us, p99.9 %u us, max %u us%s\n",
+		image.c_str(), (double)bytes / total_us, (u32)(latencies.empty() ? 0 : total_us / latencies.size()),
+		percentile(0.5), percentile(0.99), percentile(0.999), percentile(1.0),
+		failed ? StringFromFormat(", %u reads failed", failed).c_str() : "");
+
+	if (cache)
+	{
+		const DiscIO::CachedBlobReader::Stats stats = cache->GetStats();
+		printf("    cache: %.1f%% of blocks hit, %llu read ahead, %llu host reads, %llu MiB read\n",
+			100.0 * stats.hits / std::max<u64>(stats.hits + stats.misses, 1), (unsigned long long)stats.read_ahead,
+			(unsigned long long)stats.host_reads, (unsigned long long)(stats.host_bytes >> 20));
+	}
+
+	delete volume;
+	delete reader;
+	return failed == 0;
+}
+
+static int Replay(int argc, const char* argv[])
+{
+	bool blob = false;
+	u32 cache_mb = 0;
+	std::vector<std::string> files;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-b"))
+			blob = true;
+		else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+			cache_mb = atoi(argv[++i]);
+		else
+			files.push_back(argv[i]);
+	}
+
+	if (files.size() < 2)
+	{
+		printf("ERROR: Need a trace and at least one image.\n");
+		return 1;
+	}
+
+	std::vector<DiscIO::TraceEntry> trace;
+	u64 ticks_per_second;
+	if (!DiscIO::LoadTrace(files[0], &trace, &ticks_per_second))
+	{
+		printf("ERROR: %s is not a DVD trace.\n", files[0].c_str());
+		return 1;
+	}
+
+	u64 bytes = 0;
+	for (const DiscIO::TraceEntry& entry : trace)
+		bytes += entry.length;
+	const double seconds = trace.empty() ? 0.0 : (double)(trace.back().ticks - trace.front().ticks) / ticks_per_second;
+	printf("%u reads of %llu MiB over %.1f emulated seconds\n", (u32)trace.size(), (unsigned long long)(bytes >> 20), seconds);
+
+	int result = 0;
+	for (size_t i = 1; i < files.size(); i++)
+		result |= ReplayImage(trace, files[i], blob, cache_mb) ? 0 : 1;
+	return result;
+}
+
+static void CompressProgress(const char* text, float percent, void* arg)
+{
+	if (!*(bool*)arg)
+		fprintf(stderr, "\r%3d%% %s", (int)(percent * 100), text);
+}
+
+static int Compress(int argc, const char* argv[])
+{
+	int threads = 0;
+	int block_size = 16384;
+	bool quiet = false;
+	std::vector<std::string> files;
+
+	for (int i = 0; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-j") && i + 1 < argc)
+			threads = std::max(atoi(argv[++i]), 1);
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+			block_size = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-q"))
+			quiet = true;
+		else
+			files.push_back(argv[i]);
+	}
+
+	if (files.size() != 2 || block_size <= 0)
+	{
+		printf("ERROR: Need an image and the file to compress it to.\n");
+		return 1;
+	}
+
+	// Wii discs are scrubbed, like the game list does
+	DiscIO::IVolume* volume = DiscIO::CreateVolumeFromFilename(files[0]);
+	if (!volume)
+	{
+		printf("ERROR: Could not open %s.\n", files[0].c_str());
+		return 1;
+	}
+	const u32 sub_type = DiscIO::IsVolumeWiiDisc(volume) ? 1 : 0;
+	delete volume;
+
+	DiscIO::CompressStats stats;
+	const bool success = DiscIO::CompressFileToBlob(files[0], files[1], sub_type, block_size,
+		&CompressProgress, &quiet, threads, &stats);
+	if (!quiet)
+		fprintf(stderr, "\n");
+	if (!success)
+	{
+		printf("ERROR: Could not compress %s.\n", files[0].c_str());
+		return 1;
+	}
+
+	printf("%s: %llu MiB to %llu MiB in %.1f s, %.1f MB/s with %d threads\n", files[1].c_str(),
+		(unsigned long long)(stats.data_size >> 20), (unsigned long long)(stats.compressed_size >> 20),
+		stats.time_us / 1000000.0, (double)stats.data_size / stats.time_us, stats.threads);
+	printf("    busy reading %d%%, compressing %d%%, writing %d%%\n",
+		(int)(100 * stats.read_busy), (int)(100 * stats.compress_busy), (int)(100 * stats.write_busy));
+	return 0;
+}
+
+// Usage:
+// Index the game images in some directories (recursively) or files:
+//   disctool scan [-i gamelist.idx] [-j threads] [-q] <paths>
+// Replay a DVD trace (recorded with DVDTrace = True in the Core section of
+// Dolphin.ini) against images:
+//   disctool replay [-b] [-c cache_mb] <trace> <images>
+// Compress an image to GCZ, scrubbing Wii discs:
+//   disctool compress [-j threads] [-s block_size] [-q] <image> <gcz>
+int main(int argc, const char* argv[])
+{
+	if (argc < 2 || !strcmp(argv[1], "--help") || !strcmp(argv[1], "-?"))
+	{
+		printf("USAGE: DiscTool <command> [options]\n");
+		printf("scan [-i <INDEX FILE>] [-j <THREADS>] [-q] <DIRECTORY/IMAGE>...\n");
+		printf("     Reads the game list metadata of images, the ones unchanged since the\n");
+		printf("     last scan come from the index file (default gamelist.idx)\n");
+		printf("replay [-b] [-c <CACHE MB>] <TRACE> <IMAGE>...\n");
+		printf("     Reads what a DVD trace read from each image, and prints the throughput\n");
+		printf("     and latencies. -b reads the offsets straight from the image file instead\n");
+		printf("     of through the volume (for GameCube images), -c puts a block cache of\n");
+		printf("     that size in between. Run it twice to measure with the OS file cache warm.\n");
+		printf("compress [-j <THREADS>] [-s <BLOCK SIZE>] [-q] <IMAGE> <GCZ>\n");
+		printf("     Compresses an image like the game list does, scrubbing Wii discs, and\n");
+		printf("     prints the throughput and how busy each stage was\n");
+		return 0;
+	}
+
+	SetEnableAlert(false);
+
+	if (!strcmp(argv[1], "scan"))
+		return Scan(argc - 2, argv + 2);
+	if (!strcmp(argv[1], "replay"))
+		return Replay(argc - 2, argv + 2);
+	if (!strcmp(argv[1], "compress"))
+		return Compress(argc - 2, argv + 2);
+
+	printf("ERROR: Unknown command %s.\n", argv[1]);
+	return 1;
+}
@@ -0,0 +1,189 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "AudioCommon/Resampler.h"
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+
+namespace
+{
+
+const Resampler::Volume UNITY = { 256, 256 };
+
+std::vector<s16> RandomFrames(u32 frames)
+{
+	std::vector<s16> in(frames * 2);
+	srand(1234);
+	for (s16& sample : in)
+		sample = (s16)(rand() & 0xFFFF);
+	return in;
+}
+
+// The interpolation CMixer::Mix used to do inline, with a 16 bit fraction.
+u32 ReferenceLinear(std::vector<s16>& out, const std::vector<s16>& in, u32 step)
+{
+	u32 frac = 0;
+	u32 index = 0;
+	u32 i = 0;
+	for (; i < out.size() / 2 && index + 1 < in.size() / 2; i++)
+	{
+		s16 l1 = in[index * 2], l2 = in[index * 2 + 2];
+		s16 r1 = in[index * 2 + 1], r2 = in[index * 2 + 3];
+		out[i * 2] = ((l1 << 16) + (l2 - l1) * (u16)frac) >> 16;
+		out[i * 2 + 1] = ((r1 << 16) + (r2 - r1) * (u16)frac) >> 16;
+
+		frac += step;
+		index += frac >> 16;
+		frac &= 0xFFFF;
+	}
+	return i;
+}
+
+}
+
+TEST(Resampler, LinearMatchesOldMixer)
+{
+	const std::vector<s16> in = RandomFrames(1000);
+
+	// 32 kHz and 48 kHz input to 48 kHz output, plus an odd ratio
+	for (u32 step : { 0x10000u, 0xAAAAu, 0x8123u })
+	{
+		std::vector<s16> expected(2 * 1023);
+		const u32 expected_frames = ReferenceLinear(expected, in, step);
+
+		std::vector<s16> out(2 * 1023);
+		u32 pos = 0;
+		const u32 frames = Resampler::MixLinear(out.data(), 1023, in.data(), 1000, pos, step, UNITY);
+
+		// The SIMD path weights with a 14 bit fraction, which is a few LSB off
+		// for full scale steps between neighbouring samples.
+		EXPECT_EQ(expected_frames, frames);
+		for (u32 i = 0; i < frames * 2; i++)
+			EXPECT_NEAR(expected[i], out[i], 4) << "step " << step << " sample " << i;
+	}
+}
+
+TEST(Resampler, LinearStopsAtEndOfInput)
+{
+	const std::vector<s16> in = RandomFrames(10);
+	std::vector<s16> out(2 * 100);
+	u32 pos = 0;
+
+	// Interpolating needs the frame after the position
+	EXPECT_EQ(18u, Resampler::MixLinear(out.data(), 100, in.data(), 10, pos, 0x8000, UNITY));
+	EXPECT_EQ(9u << 16, pos);
+}
+
+TEST(Resampler, VolumeAndSaturation)
+{
+	std::vector<s16> in(2 * 16);
+	for (u32 i = 0; i < 16; i++)
+	{
+		in[i * 2] = 20000;
+		in[i * 2 + 1] = -20000;
+	}
+
+	std::vector<s16> out(2 * 8);
+	const Resampler::Volume half = { 128, 64 };
+	u32 pos = 0;
+	Resampler::MixLinear(out.data(), 8, in.data(), 16, pos, 0x10000, half);
+	for (u32 i = 0; i < 8; i++)
+	{
+		EXPECT_EQ(10000, out[i * 2]);
+		EXPECT_EQ(-5000, out[i * 2 + 1]);
+	}
+
+	// Mixing adds to the buffer and clamps
+	pos = 0;
+	Resampler::MixLinear(out.data(), 8, in.data(), 16, pos, 0x10000, UNITY);
+	pos = 0;
+	Resampler::MixLinear(out.data(), 8, in.data(), 16, pos, 0x10000, UNITY);
+	for (u32 i = 0; i < 8; i++)
+	{
+		EXPECT_EQ(32767, out[i * 2]);
+		EXPECT_EQ(-32768, out[i * 2 + 1]);
+	}
+}
+
+TEST(Resampler, SincReconstructsSine)
+{
+	// A 1 kHz tone at 32 kHz upsampled to 48 kHz. The history before in[0]
+	// is part of the same tone.
+	const u32 frames = 512;
+	const u32 history = Resampler::SINC_HISTORY;
+	std::vector<s16> buffer((frames + history) * 2);
+	for (u32 i = 0; i < frames + history; i++)
+	{
+		const double t = ((double)i - history) / 32000.0;
+		buffer[i * 2] = buffer[i * 2 + 1] = (s16)(16000.0 * sin(2.0 * M_PI * 1000.0 * t));
+	}
+	const s16* in = &buffer[history * 2];
+
+	Resampler::SincTable table;
+	Resampler::BuildSincTable(table, 1.0f);
+
+	const u32 step = 0xAAAA;
+	std::vector<s16> out(2 * 1000);
+	u32 pos = 0;
+	const u32 produced = Resampler::MixSinc(out.data(), 1000, in, frames, pos, step, UNITY, table);
+	// Stops where the taps after the position would run past the input
+	EXPECT_EQ(frames - (Resampler::SINC_TAPS - history) + 1, pos >> 16);
+
+	int max_error = 0;
+	for (u32 i = 0; i < produced; i++)
+	{
+		const double t = (double)i * step / 65536.0 / 32000.0;
+		const int expected = (int)(16000.0 * sin(2.0 * M_PI * 1000.0 * t));
+		max_error = std::max(max_error, abs(expected - out[i * 2]));
+		EXPECT_EQ(out[i * 2], out[i * 2 + 1]);
+	}
+	// Linear interpolation is off by up to ~75 here
+	EXPECT_LT(max_error, 20);
+}
+
+// What mixing 1024 output frames costs with the scalar loop CMixer used to
+// have and with each kernel, for 32 and 48 kHz input into 48 kHz. Every
+// kernel has to produce all the frames from the 2048 input frames.
+TEST(Resampler, MixCost)
+{
+	const u32 OUT_FRAMES = 1024;
+	const u32 BLOCKS = Benchmark::Size(20000u, 20u);
+	const std::vector<s16> in = RandomFrames(2048 + Resampler::SINC_HISTORY);
+	std::vector<s16> out(2 * OUT_FRAMES);
+	Resampler::SincTable table;
+
+	for (u32 step : { 0xAAAAu, 0x10000u })
+	{
+		Resampler::BuildSincTable(table, 1.0f);
+
+		for (int kernel = 0; kernel < 3; kernel++)
+		{
+			u32 frames = 0, pos = 0;
+			const u64 elapsed = Benchmark::Time([&] {
+				for (u32 block = 0; block < BLOCKS; block++)
+				{
+					pos = 0;
+					if (kernel == 0)
+						frames = ReferenceLinear(out, in, step);
+					else if (kernel == 1)
+						frames = Resampler::MixLinear(out.data(), OUT_FRAMES, in.data(), 2048, pos, step, UNITY);
+					else
+						frames = Resampler::MixSinc(out.data(), OUT_FRAMES, in.data() + 2 * Resampler::SINC_HISTORY, 2048, pos, step, UNITY, table);
+				}
+			});
+
+			static const char* const names[] = { "old scalar", "linear", "sinc" };
+			EXPECT_EQ(OUT_FRAMES, frames) << names[kernel] << ", step " << step;
+			if (kernel != 0)
+				EXPECT_EQ(OUT_FRAMES * step, pos) << names[kernel] << ", step " << step;
+			Benchmark::Report("MIXER", "%s kHz %-10s %6.2f us per 1024 frames",
+				step == 0x10000 ? "48" : "32", names[kernel], elapsed / (double)BLOCKS);
+		}
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Common/CommonTypes.h"
+#include "Common/Timer.h"
+
+// Tests that also measure how fast the code they check is. They always run
+// and check their results on a workload small enough for ctest. With
+// DOLPHIN_BENCHMARK set in the environment they use the full workload and
+// print their timings.
+namespace Benchmark
+{
+
+inline bool IsEnabled()
+{
+	static const bool enabled = getenv("DOLPHIN_BENCHMARK") != nullptr;
+	return enabled;
+}
+
+// The full workload when benchmarking, the small one otherwise
+template <typename T>
+inline T Size(T benchmark, T test)
+{
+	return IsEnabled() ? benchmark : test;
+}
+
+// How long func takes in microseconds, never 0 so it can be divided by
+template <typename Func>
+inline u64 Time(Func func)
+{
+	const u64 start = Common::Timer::GetTimeUs();
+	func();
+	const u64 elapsed = Common::Timer::GetTimeUs() - start;
+	return elapsed ? elapsed : 1;
+}
+
+// Prints one row of timings after a gtest style tag, only when benchmarking
+inline void Report(const char* tag, const char* format, ...)
+{
+	if (!IsEnabled())
+		return;
+
+	char line[512];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	printf("[ %-8s ] %s\n", tag, line);
+}
+
+}  // namespace Benchmark
@@ -0,0 +1,115 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "Common/StringUtil.h"
+
+namespace
+{
+
+std::vector<u8> RandomData(size_t size)
+{
+	std::mt19937 rng(5678);
+	std::vector<u8> data(size);
+	for (u8& b : data)
+		b = (u8)rng();
+	return data;
+}
+
+}  // namespace
+
+TEST(Hash, MultiStreamVersionsMatch)
+{
+	const std::vector<u8> data = RandomData(70000);
+
+	// every tail length, and enough stripes to need scrambling
+	for (int len = 0; len < 2200; len++)
+	{
+		for (u32 samples : { 0, 1, 7, 128 })
+			ASSERT_EQ(GetMultiStreamHash(data.data(), len, samples), GetMultiStreamHashSSE2(data.data(), len, samples)) << "length " << len << ", samples " << samples;
+	}
+
+	for (int len : { 65536, 65536 + 17, 70000 })
+	{
+		for (u32 samples : { 0, 128, 512 })
+			ASSERT_EQ(GetMultiStreamHash(data.data(), len, samples), GetMultiStreamHashSSE2(data.data(), len, samples)) << "length " << len << ", samples " << samples;
+	}
+}
+
+TEST(Hash, MultiStreamSeesEveryByte)
+{
+	std::vector<u8> data = RandomData(4096 + 33);
+	const int len = (int)data.size();
+	const u64 hash = GetMultiStreamHash(data.data(), len, 0);
+
+	for (int i = 0; i < len; i++)
+	{
+		data[i] ^= 0x10;
+		ASSERT_NE(hash, GetMultiStreamHash(data.data(), len, 0)) << "byte " << i;
+		data[i] ^= 0x10;
+	}
+	EXPECT_NE(hash, GetMultiStreamHash(data.data(), len - 1, 0));
+}
+
+// Custom textures are looked up by this hash, it must never change
+TEST(Hash, HiresTextureHashIsStable)
+{
+	const std::vector<u8> data = RandomData(4096 + 5);
+	EXPECT_EQ(0x68683029b933ac90ULL, GetHashHiresTexture(data.data(), 4096 + 5, 0));
+	EXPECT_EQ(0x0103195ab2e9e465ULL, GetHashHiresTexture(data.data(), 4096, 128));
+	EXPECT_EQ(0x7cdcb9c16eb37958ULL, GetHashHiresTexture(data.data(), 3, 0));
+
+	SetHash64Function(true);
+	EXPECT_EQ(0x68683029b933ac90ULL, GetHash64(data.data(), 4096 + 5, 0));
+	SetHash64Function(false);
+}
+
+// Throughput table of each full hash function over texture sized buffers. A
+// hash has to come out the same every time the same data is hashed.
+TEST(Hash, Throughput)
+{
+	const std::vector<u8> data = RandomData(4 << 20);
+	const struct
+	{
+		const char* name;
+		u64 (*function)(const u8*, int, u32);
+	} functions[] = {
+		{ "murmur3", GetMurmurHash3 },
+		{ "hires", GetHashHiresTexture },
+		{ "multistream", GetMultiStreamHash },
+		{ "multistream sse2", GetMultiStreamHashSSE2 },
+	};
+
+	std::string header;
+	for (int size = 1 << 10; size <= 4 << 20; size <<= 2)
+		header += StringFromFormat(" %8dK", size >> 10);
+	Benchmark::Report("HASH", "%-16s%s", "MB/s", header.c_str());
+
+	for (const auto& f : functions)
+	{
+		std::string row;
+		for (int size = 1 << 10; size <= 4 << 20; size <<= 2)
+		{
+			// hash about 64MB in total for each size
+			const int runs = std::max(Benchmark::Size(64 << 20, 4 << 20) / size, 2);
+			const u64 hash = f.function(data.data(), size, 0);
+			int changed = 0;
+			const u64 elapsed = Benchmark::Time([&] {
+				for (int i = 0; i < runs; i++)
+					changed += f.function(data.data(), size, 0) != hash;
+			});
+			EXPECT_EQ(0, changed) << f.name << ", " << size << " bytes";
+			row += StringFromFormat(" %9.0f", (double)size * runs / elapsed);
+		}
+		Benchmark::Report("HASH", "%-16s%s", f.name, row.c_str());
+	}
+}
@@ -0,0 +1,126 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/ChunkFile.h"
+
+namespace
+{
+
+struct TestState
+{
+	u32 value;
+	std::string name;
+	std::vector<u16> list;
+	u8 blob[3000];
+	u8 big[2 * 1024 * 1024];
+
+	void DoState(PointerWrap& p)
+	{
+		p.Do(value);
+		p.Do(name);
+		p.Do(list);
+		p.DoArray(blob, sizeof(blob));
+		p.DoMarker("TestState");
+
+		PointerWrapSink* sink = p.GetSink();
+		if (sink)
+		{
+			const u8* data = big;
+			sink->AppendReference(sizeof(big), [data](u8* dst, size_t offset, size_t size) {
+				memcpy(dst, data + offset, size);
+			});
+		}
+		else
+		{
+			p.DoArray(big, sizeof(big));
+		}
+		p.Do(value);
+	}
+};
+
+void Fill(TestState* state)
+{
+	state->value = 0x12345678;
+	state->name = "Dolphin";
+	for (u16 i = 0; i < 100; ++i)
+		state->list.push_back(i * 3);
+	for (u32 i = 0; i < sizeof(state->blob); ++i)
+		state->blob[i] = (u8)(i * 7);
+	for (u32 i = 0; i < sizeof(state->big); ++i)
+		state->big[i] = (u8)(i >> 5);
+}
+
+std::vector<u8> SaveTwoPass(TestState* state)
+{
+	u8* ptr = nullptr;
+	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+	state->DoState(p);
+
+	std::vector<u8> buffer((size_t)ptr);
+	ptr = &buffer[0];
+	p.SetMode(PointerWrap::MODE_WRITE);
+	state->DoState(p);
+	EXPECT_EQ(&buffer[0] + buffer.size(), ptr);
+	return buffer;
+}
+
+}  // namespace
+
+TEST(PointerWrap, SinkMatchesTwoPassWrite)
+{
+	TestState* state = new TestState;
+	Fill(state);
+	const std::vector<u8> expected = SaveTwoPass(state);
+
+	bool released = false;
+	PointerWrapSink sink;
+	PointerWrap p(&sink);
+	state->DoState(p);
+	sink.AddReleaseCallback([&released]() { released = true; });
+	EXPECT_EQ(PointerWrap::MODE_WRITE, p.GetMode());
+	ASSERT_EQ(expected.size(), sink.Size());
+
+	std::vector<u8> whole(sink.Size());
+	sink.Read(0, whole.size(), &whole[0]);
+	EXPECT_EQ(expected, whole);
+
+	// Reads at arbitrary offsets span chunk boundaries.
+	for (size_t offset = 0; offset < expected.size(); offset += 100003)
+	{
+		const size_t len = std::min<size_t>(131072, expected.size() - offset);
+		std::vector<u8> part(len);
+		sink.Read(offset, len, &part[0]);
+		EXPECT_TRUE(std::equal(part.begin(), part.end(), expected.begin() + offset));
+	}
+
+	sink.Clear();
+	EXPECT_TRUE(released);
+	EXPECT_EQ(0u, sink.Size());
+	delete state;
+}
+
+TEST(PointerWrap, ReadBack)
+{
+	TestState* state = new TestState;
+	Fill(state);
+	std::vector<u8> buffer = SaveTwoPass(state);
+
+	TestState* loaded = new TestState;
+	u8* ptr = &buffer[0];
+	PointerWrap p(&ptr, PointerWrap::MODE_READ);
+	loaded->DoState(p);
+
+	EXPECT_EQ(PointerWrap::MODE_READ, p.GetMode());
+	EXPECT_EQ(state->value, loaded->value);
+	EXPECT_EQ(state->name, loaded->name);
+	EXPECT_EQ(state->list, loaded->list);
+	EXPECT_EQ(0, memcmp(state->blob, loaded->blob, sizeof(state->blob)));
+	EXPECT_EQ(0, memcmp(state->big, loaded->big, sizeof(state->big)));
+	delete loaded;
+	delete state;
+}
@@ -0,0 +1,101 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "Common/RingBuffer.h"
+
+using Common::RingBuffer;
+
+TEST(RingBuffer, Simple)
+{
+	RingBuffer<u32, 8> ring;
+	u32 values[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+	EXPECT_EQ(0u, ring.Size());
+	EXPECT_EQ(8u, ring.Space());
+
+	EXPECT_TRUE(ring.Push(values, 6));
+	EXPECT_FALSE(ring.Push(values, 3));
+	EXPECT_EQ(6u, ring.Size());
+
+	EXPECT_EQ(0u, ring.Peek(0));
+	EXPECT_EQ(5u, ring.Peek(5));
+	ring.Pop(4);
+	EXPECT_EQ(4u, ring.Peek(0));
+	EXPECT_EQ(3u, ring.Peek(-1));
+
+	// Wraps around the end of the storage
+	EXPECT_TRUE(ring.Push(values, 6));
+	EXPECT_EQ(8u, ring.Size());
+	EXPECT_EQ(0u, ring.Space());
+	for (u32 i = 0; i < 6; i++)
+		EXPECT_EQ(i, ring.Peek(2 + i));
+
+	EXPECT_FALSE(ring.WaitForSpace(1, std::chrono::milliseconds(1)));
+}
+
+// A throttled producer and a consumer pulling differently sized chunks at a
+// fixed rate, like the emulation thread feeding the audio thread. Every value
+// has to arrive in order, and once the ring has been primed the consumer must
+// never find it empty.
+static u32 RunProducerConsumer(u32 produce_delay_us, u32 consume_delay_us, u32 total)
+{
+	RingBuffer<u32, 256> ring;
+	u32 underruns = 0;
+
+	std::thread producer([&]() {
+		u32 chunk[24];
+		for (u32 next = 0; next < total;)
+		{
+			u32 count = std::min<u32>(24, total - next);
+			for (u32 i = 0; i < count; i++)
+				chunk[i] = next + i;
+
+			while (!ring.WaitForSpace(count, std::chrono::milliseconds(1)))
+				;
+			EXPECT_TRUE(ring.Push(chunk, count));
+			next += count;
+
+			if (produce_delay_us)
+				std::this_thread::sleep_for(std::chrono::microseconds(produce_delay_us));
+		}
+	});
+
+	while (ring.Size() < ring.Capacity() / 2)
+		std::this_thread::yield();
+
+	u32 expected = 0;
+	for (u32 request = 0; expected < total; request = (request + 1) % 3)
+	{
+		u32 wanted = std::min<u32>(32 + request * 16, total - expected);
+		u32 size = ring.Size();
+		if (size < wanted)
+			underruns++;
+
+		u32 count = std::min(size, wanted);
+		for (u32 i = 0; i < count; i++)
+			EXPECT_EQ(expected + i, ring.Peek(i));
+		ring.Pop(count);
+		expected += count;
+
+		std::this_thread::sleep_for(std::chrono::microseconds(consume_delay_us));
+	}
+
+	producer.join();
+	EXPECT_EQ(0u, ring.Size());
+	return underruns;
+}
+
+TEST(RingBuffer, FastProducer)
+{
+	EXPECT_EQ(0u, RunProducerConsumer(0, 1000, 24 * 200));
+}
+
+TEST(RingBuffer, SlowProducer)
+{
+	EXPECT_LT(0u, RunProducerConsumer(20000, 100, 24 * 20));
+}
@@ -0,0 +1,173 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/MemoryUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/MemTools.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+
+// Write tracking on a RAM buffer of its own, without the rest of the memory
+// map. Stores go straight to the host pages like the JIT's fastmem stores, so
+// writes to tracked pages fault into the exception handler.
+//
+// The write tracking and the exception handler only use these from the rest
+// of the core, defining them here keeps the core out of the test. Only RAM
+// has a view, and nothing here is JIT code.
+namespace Memory
+{
+u8* base;
+u8* m_pRAM;
+u8* m_pEXRAM;
+u8* m_pPhysicalRAM;
+u8* m_pVirtualCachedRAM;
+u8* m_pVirtualUncachedRAM;
+u8* m_pPhysicalEXRAM;
+u8* m_pVirtualCachedEXRAM;
+u8* m_pVirtualUncachedEXRAM;
+}
+SConfig* SConfig::m_Instance;
+class JitBase;
+JitBase* jit;
+bool JitInterface::IsInCodeSpace(u8* ptr)
+{
+	return false;
+}
+
+namespace
+{
+
+const u32 PAGE_SIZE = 0x1000;
+
+class MemmapTest : public testing::Test
+{
+protected:
+	static void SetUpTestCase()
+	{
+		Memory::m_pRAM = (u8*)AllocateMemoryPages(Memory::RAM_SIZE);
+		EMM::InstallExceptionHandler();
+		Memory::EnableWriteTracking();
+	}
+
+	static void TearDownTestCase()
+	{
+		Memory::MarkRangeWritten(0, Memory::RAM_SIZE);
+		FreeMemoryPages(Memory::m_pRAM, Memory::RAM_SIZE);
+		Memory::m_pRAM = nullptr;
+	}
+
+	virtual void TearDown()
+	{
+		// leave every page writable for the next test
+		Memory::MarkRangeWritten(0, Memory::RAM_SIZE);
+	}
+
+	static void Store(u32 address, u32 value)
+	{
+		*(volatile u32*)(Memory::m_pRAM + address) = value;
+	}
+
+	static u32 Load(u32 address)
+	{
+		return *(volatile u32*)(Memory::m_pRAM + address);
+	}
+};
+
+}  // namespace
+
+TEST_F(MemmapTest, StoresToTrackedPagesAreSeen)
+{
+	const u32 address = 0x10020, size = 3 * PAGE_SIZE;
+	const u64 generation = Memory::TrackRange(address, size);
+	EXPECT_FALSE(Memory::HasRangeChanged(address, size, generation));
+
+	// the store faults, the page is made writable and the store retried
+	Store(address + PAGE_SIZE + 8, 0x12345678);
+	EXPECT_EQ(0x12345678u, Load(address + PAGE_SIZE + 8));
+	EXPECT_TRUE(Memory::HasRangeChanged(address, size, generation));
+	// through the cached and uncached mirrors' addresses as well
+	EXPECT_TRUE(Memory::HasRangeChanged(0x80000000 | address, size, generation));
+	EXPECT_TRUE(Memory::HasRangeChanged(address + PAGE_SIZE, 4, generation));
+	EXPECT_FALSE(Memory::HasRangeChanged(address, 4, generation));
+
+	// tracking again starts clean
+	const u64 again = Memory::TrackRange(address, size);
+	EXPECT_LT(generation, again);
+	EXPECT_FALSE(Memory::HasRangeChanged(address, size, again));
+	Store(address + PAGE_SIZE + 8, 0x9abcdef0);
+	EXPECT_TRUE(Memory::HasRangeChanged(address, size, again));
+}
+
+TEST_F(MemmapTest, MarkRangeWritten)
+{
+	const u32 address = 0x200000, size = 8 * PAGE_SIZE;
+	const u64 generation = Memory::TrackRange(address, size);
+
+	// what code has to do before the kernel writes to RAM
+	Memory::MarkRangeWritten(address + size - 1, 1);
+	EXPECT_TRUE(Memory::HasRangeChanged(address, size, generation));
+	EXPECT_TRUE(Memory::HasRangeChanged(address + size - PAGE_SIZE, PAGE_SIZE, generation));
+	EXPECT_FALSE(Memory::HasRangeChanged(address, size - PAGE_SIZE, generation));
+
+	// the page is writable again without a fault
+	Store(address + size - 4, 1);
+	EXPECT_EQ(1u, Load(address + size - 4));
+}
+
+TEST_F(MemmapTest, UntouchedRangesStayClean)
+{
+	const u32 first = 0x300000, second = first + 4 * PAGE_SIZE;
+	const u64 first_generation = Memory::TrackRange(first, 2 * PAGE_SIZE);
+	const u64 second_generation = Memory::TrackRange(second, 2 * PAGE_SIZE);
+
+	Store(first + 4, 5);
+	Memory::MarkRangeWritten(first + PAGE_SIZE, PAGE_SIZE);
+	// outside both
+	Store(first + 2 * PAGE_SIZE, 6);
+	Memory::MarkRangeWritten(second + 2 * PAGE_SIZE, 16);
+
+	EXPECT_TRUE(Memory::HasRangeChanged(first, 2 * PAGE_SIZE, first_generation));
+	EXPECT_FALSE(Memory::HasRangeChanged(second, 2 * PAGE_SIZE, second_generation));
+
+	// reading doesn't count as a write
+	EXPECT_EQ(0u, Load(second));
+	EXPECT_FALSE(Memory::HasRangeChanged(second, 2 * PAGE_SIZE, second_generation));
+}
+
+// What tracking adds to the store path: stores to untracked pages are plain
+// stores, the first store to a tracked page takes a fault, later stores to
+// it are plain again. With DOLPHIN_BENCHMARK set it prints the cost of each.
+TEST_F(MemmapTest, StorePathTiming)
+{
+	const u32 pages = Benchmark::Size(4096u, 256u);
+	const u32 stores = Benchmark::Size(1u << 26, 1u << 20);
+	const u32 base = 0x400000;
+	const u32 span = pages * PAGE_SIZE;
+
+	auto store_all = [&] {
+		for (u32 i = 0; i < stores; i++)
+			Store(base + (i * 68) % span, i);
+	};
+
+	const u64 untracked_us = Benchmark::Time(store_all);
+
+	const u64 generation = Memory::TrackRange(base, span);
+	const u64 fault_us = Benchmark::Time([&] {
+		for (u32 page = 0; page < pages; page++)
+			Store(base + page * PAGE_SIZE, page);
+	});
+	EXPECT_TRUE(Memory::HasRangeChanged(base, span, generation));
+	for (u32 page = 0; page < pages; page++)
+		ASSERT_EQ(page, Load(base + page * PAGE_SIZE)) << "page " << page;
+
+	const u64 written_us = Benchmark::Time(store_all);
+	EXPECT_EQ(stores - 1, Load(base + ((stores - 1) * 68) % span));
+
+	Benchmark::Report("STORES", "untracked %.2f ns, first to a tracked page %.2f us, later %.2f ns per store",
+		untracked_us * 1000.0 / stores, fault_us / (double)pages, written_us * 1000.0 / stores);
+}
@@ -0,0 +1,356 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SFML/Network.hpp>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/MsgHandler.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
+#include "Core/NetPlayProto.h"
+#include "Core/NetPlayServer.h"
+
+// Runs a server and two players over localhost, with the players speaking the
+// protocol directly so the test controls what goes out over which transport.
+// Player 1 sends pad states for in-game pad 0, player 2 records when each
+// state first arrives, which gives the relay latency and jitter.
+
+namespace
+{
+
+const u32 NUM_STATES = 200;
+
+#ifdef _WIN32
+typedef int socklen_t;
+#define close closesocket
+#endif
+
+// SFML can't tell which port it bound to, so ask the OS for a free one by
+// binding to port 0, for both TCP and UDP since the server listens on both.
+// Fixed ports would collide when ctest runs several tests at once.
+u16 FindFreePort()
+{
+	for (int attempt = 0; attempt < 10; attempt++)
+	{
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t len = sizeof(addr);
+
+		const int udp = (int)socket(AF_INET, SOCK_DGRAM, 0);
+		const int tcp = (int)socket(AF_INET, SOCK_STREAM, 0);
+		const bool found = bind(udp, (sockaddr*)&addr, sizeof(addr)) == 0 &&
+			getsockname(udp, (sockaddr*)&addr, &len) == 0 &&
+			bind(tcp, (sockaddr*)&addr, sizeof(addr)) == 0;
+		close(udp);
+		close(tcp);
+		if (found)
+			return ntohs(addr.sin_port);
+	}
+	return 0;
+}
+
+class RawPlayer
+{
+public:
+	RawPlayer() : m_stop(false), m_tcp_states(0), m_udp_datagrams(0), m_pending(NUM_STATES)
+	{
+		m_arrival.resize(NUM_STATES, 0);
+	}
+
+	~RawPlayer()
+	{
+		m_stop = true;
+		if (m_tcp_thread.joinable())
+			m_tcp_thread.join();
+		if (m_udp_thread.joinable())
+			m_udp_thread.join();
+		m_tcp.Close();
+		m_udp.Close();
+	}
+
+	bool Connect(u16 port)
+	{
+		m_port = port;
+		if (m_tcp.Connect(port, "127.0.0.1", 5) != sf::Socket::Done)
+			return false;
+
+		sf::Packet spac;
+		spac << NETPLAY_VERSION << netplay_dolphin_ver << "player";
+		m_tcp.Send(spac);
+
+		sf::Packet rpac;
+		MessageId error = 1;
+		m_tcp.Receive(rpac);
+		rpac >> error >> m_pid;
+		return error == 0 && m_udp.Bind(FindFreePort());
+	}
+
+	void SendUDPHello()
+	{
+		sf::Packet spac;
+		spac << (MessageId)NP_MSG_UDP_HELLO << m_pid;
+		m_udp.Send(spac, sf::IPAddress::LocalHost, m_port);
+	}
+
+	// Skips everything up to the start message and acknowledges it
+	void WaitForStart()
+	{
+		MessageId mid = 0;
+		while (mid != NP_MSG_START_GAME)
+		{
+			sf::Packet rpac;
+			ASSERT_EQ(sf::Socket::Done, m_tcp.Receive(rpac));
+			rpac >> mid;
+			if (mid == NP_MSG_START_GAME)
+				rpac >> m_game;
+		}
+
+		sf::Packet spac;
+		spac << (MessageId)NP_MSG_START_GAME << m_game;
+		m_tcp.Send(spac);
+	}
+
+	void SendTCP(PadMapping map, const NetPadState& state)
+	{
+		sf::Packet spac;
+		spac << (MessageId)NP_MSG_PAD_DATA << map << state.seq << state.hi << state.lo;
+		m_tcp.Send(spac);
+	}
+
+	// Sends the last NETPLAY_UDP_REDUNDANCY states. With drop, only updates
+	// the history, as if the datagram got lost.
+	void SendUDP(PadMapping map, const NetPadState& state, bool drop)
+	{
+		m_history.push_back(state);
+		if (m_history.size() > NETPLAY_UDP_REDUNDANCY)
+			m_history.pop_front();
+		if (drop)
+			return;
+
+		sf::Packet spac;
+		spac << (MessageId)NP_MSG_PAD_DATA << m_pid << m_game << map << (u8)m_history.size();
+		for (const NetPadState& s : m_history)
+			spac << s.seq << s.hi << s.lo;
+		m_udp.Send(spac, sf::IPAddress::LocalHost, m_port);
+	}
+
+	// Records the pad states relayed by the server from now on
+	void StartReceiving(bool udp)
+	{
+		m_tcp_thread = std::thread([this] {
+			sf::SelectorTCP selector;
+			selector.Add(m_tcp);
+			while (!m_stop)
+			{
+				sf::Packet rpac;
+				if (!selector.Wait(0.01f) || m_tcp.Receive(rpac) != sf::Socket::Done)
+					continue;
+
+				MessageId mid;
+				rpac >> mid;
+				if (mid != NP_MSG_PAD_DATA)
+					continue;
+
+				PadMapping map;
+				NetPadState state;
+				rpac >> map >> state.seq >> state.hi >> state.lo;
+
+				// the server relays every state exactly once over TCP, in order
+				EXPECT_EQ(m_tcp_states, state.seq);
+				m_tcp_states++;
+				OnState(state);
+			}
+		});
+
+		if (!udp)
+			return;
+
+		m_udp_thread = std::thread([this] {
+			sf::SelectorUDP selector;
+			selector.Add(m_udp);
+			while (!m_stop)
+			{
+				sf::Packet rpac;
+				sf::IPAddress sender;
+				unsigned short port;
+				if (!selector.Wait(0.01f) || m_udp.Receive(rpac, sender, port) != sf::Socket::Done)
+					continue;
+
+				MessageId mid;
+				PlayerId pid;
+				u32 game;
+				PadMapping map;
+				u8 count;
+				rpac >> mid >> pid >> game >> map >> count;
+				if (mid != NP_MSG_PAD_DATA)
+					continue;
+
+				EXPECT_EQ(m_game, game);
+				EXPECT_LE(count, NETPLAY_UDP_REDUNDANCY);
+				m_udp_datagrams++;
+				for (u8 i = 0; i < count; i++)
+				{
+					NetPadState state;
+					rpac >> state.seq >> state.hi >> state.lo;
+					OnState(state);
+				}
+			}
+		});
+	}
+
+	bool WaitForAllStates() { return m_all_received.WaitFor(std::chrono::seconds(5)); }
+
+	const std::vector<u64>& Arrival() const { return m_arrival; }
+	u32 UDPDatagrams() const { return m_udp_datagrams; }
+
+private:
+	void OnState(const NetPadState& state)
+	{
+		const u64 now = Common::Timer::GetTimeUs();
+		ASSERT_LT(state.seq, NUM_STATES);
+		EXPECT_EQ(0x00800000 | state.seq, state.hi);
+		EXPECT_EQ(~state.seq, state.lo);
+
+		std::lock_guard<std::mutex> lk(m_lock);
+		if (m_arrival[state.seq])
+			return;
+		m_arrival[state.seq] = now;
+		if (--m_pending == 0)
+			m_all_received.Set();
+	}
+
+	sf::SocketTCP m_tcp;
+	sf::SocketUDP m_udp;
+	u16 m_port;
+	PlayerId m_pid;
+	u32 m_game;
+	std::deque<NetPadState> m_history;
+
+	std::thread m_tcp_thread;
+	std::thread m_udp_thread;
+	volatile bool m_stop;
+	u32 m_tcp_states;
+	volatile u32 m_udp_datagrams;
+
+	std::mutex m_lock;
+	std::vector<u64> m_arrival;
+	u32 m_pending;
+	Common::Event m_all_received;
+};
+
+enum Transport
+{
+	SEND_TCP = 1,
+	SEND_UDP = 2,
+};
+
+// Every fourth UDP datagram is dropped on purpose when sending over UDP only,
+// the redundant states in the following datagram have to make up for it.
+// The relay latency and jitter get printed when benchmarking.
+void RunPadRelay(const char* name, int transport, bool receive_udp)
+{
+	SetEnableAlert(false);
+#ifndef _WIN32
+	// the server may still write to a player's socket after the test closed it
+	signal(SIGPIPE, SIG_IGN);
+#endif
+
+	const u16 port = FindFreePort();
+	ASSERT_NE(0, port);
+	NetPlayServer server(port);
+	ASSERT_TRUE(server.is_connected);
+
+	// the first player to connect gets in-game pad 0
+	RawPlayer sender, receiver;
+	ASSERT_TRUE(sender.Connect(port));
+	ASSERT_TRUE(receiver.Connect(port));
+
+	server.StartGame("");
+	sender.WaitForStart();
+	receiver.WaitForStart();
+
+	if (transport & SEND_UDP)
+		sender.SendUDPHello();
+	if (receive_udp)
+		receiver.SendUDPHello();
+	// the server registers UDP hellos on its own thread
+	Common::SleepCurrentThread(100);
+
+	receiver.StartReceiving(receive_udp);
+
+	std::vector<u64> sent(NUM_STATES);
+	for (u32 i = 0; i < NUM_STATES; i++)
+	{
+		NetPadState state;
+		state.seq = i;
+		state.hi = 0x00800000 | i;
+		state.lo = ~i;
+
+		sent[i] = Common::Timer::GetTimeUs();
+		if (transport & SEND_TCP)
+			sender.SendTCP(0, state);
+		if (transport & SEND_UDP)
+			sender.SendUDP(0, state, transport == SEND_UDP && i % 4 == 1);
+
+		Common::SleepCurrentThread(1);
+	}
+
+	ASSERT_TRUE(receiver.WaitForAllStates());
+	if (receive_udp)
+	{
+		EXPECT_LT(0u, receiver.UDPDatagrams());
+	}
+
+	if (!Benchmark::IsEnabled())
+		return;
+
+	const std::vector<u64>& arrival = receiver.Arrival();
+	double sum = 0.0, sum_sq = 0.0, max = 0.0;
+	for (u32 i = 0; i < NUM_STATES; i++)
+	{
+		const double latency = (double)(arrival[i] - sent[i]);
+		sum += latency;
+		sum_sq += latency * latency;
+		max = std::max(max, latency);
+	}
+	const double mean = sum / NUM_STATES;
+	const double jitter = sqrt(std::max(0.0, sum_sq / NUM_STATES - mean * mean));
+	Benchmark::Report("LATENCY", "%s: mean %.0f us, jitter %.0f us, max %.0f us", name, mean, jitter, max);
+}
+
+}  // namespace
+
+TEST(NetPlay, PadRelayTCP)
+{
+	RunPadRelay("tcp", SEND_TCP, false);
+}
+
+TEST(NetPlay, PadRelayUDPWithLoss)
+{
+	RunPadRelay("udp, 25% sent datagrams lost", SEND_UDP, true);
+}
+
+TEST(NetPlay, PadRelayBoth)
+{
+	RunPadRelay("tcp+udp", SEND_TCP | SEND_UDP, true);
+}
@@ -0,0 +1,248 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <lzo/lzo1x.h>
+
+#include "Benchmark.h"
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Common/MsgHandler.h"
+#include "Core/State.h"
+#include "Core/StateCompression.h"
+
+// Round trips of states through PointerWrap and the chunked container, like
+// saving and loading a state file does after its StateHeader.
+
+namespace
+{
+
+// Stands in for the emulator state: a few small fields and a large block
+// which is referenced by the sink instead of being copied, like RAM
+struct TestState
+{
+	u32 cookie;
+	std::vector<u16> small;
+	std::vector<u8> ram;
+
+	void DoState(PointerWrap& p)
+	{
+		p.Do(cookie);
+		p.Do(small);
+
+		u32 size = (u32)ram.size();
+		p.Do(size);
+		PointerWrapSink* sink = p.GetSink();
+		if (sink)
+		{
+			const u8* data = ram.data();
+			sink->AppendReference(size, [data](u8* dst, size_t offset, size_t len) { memcpy(dst, data + offset, len); });
+		}
+		else
+		{
+			ram.resize(size);
+			if (size)
+				p.DoArray(&ram[0], size);
+		}
+		p.DoMarker("TestState");
+	}
+};
+
+// Some noise, long runs of zeroes and patterns, so chunks compress differently
+TestState MakeState(size_t ram_size)
+{
+	std::mt19937 rng((u32)ram_size);
+	TestState state;
+	state.cookie = 0xBAADBABE;
+	for (u16 i = 0; i < 77; i++)
+		state.small.push_back(i * 5);
+	state.ram.resize(ram_size);
+	for (size_t i = 0; i < ram_size; i++)
+	{
+		switch ((i / 40000) % 3)
+		{
+		case 0: state.ram[i] = (u8)rng(); break;
+		case 1: state.ram[i] = 0; break;
+		case 2: state.ram[i] = (u8)(i / 9); break;
+		}
+	}
+	return state;
+}
+
+class StateCompressionTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		SetEnableAlert(false);
+		ASSERT_EQ(LZO_E_OK, lzo_init());
+	}
+
+	std::vector<u8> Serialize(TestState& state, PointerWrapSink& sink)
+	{
+		PointerWrap p(&sink);
+		state.DoState(p);
+		EXPECT_EQ(PointerWrap::MODE_WRITE, p.GetMode());
+
+		std::vector<u8> data(sink.Size());
+		if (!data.empty())
+			sink.Read(0, data.size(), &data[0]);
+		return data;
+	}
+
+	void ExpectLoads(const std::vector<u8>& compressed, const std::vector<u8>& expected, const TestState& state)
+	{
+		std::vector<u8> data;
+		ASSERT_TRUE(State::DecompressStateData(compressed, (u32)expected.size(), data));
+		ASSERT_TRUE(expected == data);
+
+		TestState loaded;
+		u8* ptr = &data[0];
+		PointerWrap p(&ptr, PointerWrap::MODE_READ);
+		loaded.DoState(p);
+		EXPECT_EQ(PointerWrap::MODE_READ, p.GetMode());
+		EXPECT_EQ(state.cookie, loaded.cookie);
+		EXPECT_EQ(state.small, loaded.small);
+		EXPECT_TRUE(state.ram == loaded.ram);
+	}
+
+	void RoundTrip(u32 codec, size_t ram_size)
+	{
+		SCOPED_TRACE(testing::Message() << "codec " << codec << ", " << ram_size << " bytes of RAM");
+
+		TestState state = MakeState(ram_size);
+		PointerWrapSink sink;
+		const std::vector<u8> expected = Serialize(state, sink);
+
+		std::vector<u8> compressed;
+		ASSERT_TRUE(State::CompressStateData(codec, sink.Size(),
+			[&sink](size_t offset, size_t size, u8* dst) { sink.Read(offset, size, dst); }, compressed));
+		ExpectLoads(compressed, expected, state);
+	}
+
+	// What states were before the container: LZO compressed IN_LEN chunks, each
+	// after its compressed size, and an empty last chunk if the size is a
+	// multiple of IN_LEN
+	std::vector<u8> CompressOldFormat(const std::vector<u8>& data)
+	{
+		std::vector<u8> out;
+		std::vector<u64> wrkmem((LZO1X_1_MEM_COMPRESS + sizeof(u64) - 1) / sizeof(u64));
+		std::vector<u8> chunk(State::IN_LEN + State::IN_LEN / 16 + 64 + 3);
+		size_t i = 0;
+		while (true)
+		{
+			const u32 cur_len = (u32)std::min<size_t>(State::IN_LEN, data.size() - i);
+			lzo_uint out_len = 0;
+			EXPECT_EQ(LZO_E_OK, lzo1x_1_compress(&data[i], cur_len, &chunk[0], &out_len, &wrkmem[0]));
+
+			const u32 len = (u32)out_len;
+			out.insert(out.end(), (const u8*)&len, (const u8*)&len + sizeof(len));
+			out.insert(out.end(), chunk.begin(), chunk.begin() + out_len);
+
+			if (cur_len != State::IN_LEN)
+				break;
+			i += cur_len;
+		}
+		return out;
+	}
+};
+
+}  // namespace
+
+TEST_F(StateCompressionTest, MultipleChunks)
+{
+	for (u32 codec : { State::COMPRESSION_LZO, State::COMPRESSION_ZLIB })
+		RoundTrip(codec, 5 * State::IN_LEN + 12345);
+}
+
+// Sizes around the chunk boundaries, the state itself is a little larger than
+// its RAM
+TEST_F(StateCompressionTest, OddSizes)
+{
+	for (u32 codec : { State::COMPRESSION_LZO, State::COMPRESSION_ZLIB })
+	{
+		for (size_t size : { (size_t)0, (size_t)1, (size_t)State::IN_LEN - 200, (size_t)State::IN_LEN,
+		                     (size_t)State::IN_LEN + 1, (size_t)3 * State::IN_LEN - 173, (size_t)3 * State::IN_LEN + 4097 })
+		{
+			RoundTrip(codec, size);
+		}
+	}
+}
+
+TEST_F(StateCompressionTest, OldFormatStillLoads)
+{
+	// the first state serializes to exactly two chunks, so it ends with an
+	// empty one
+	for (size_t ram_size : { (size_t)2 * State::IN_LEN - 175, (size_t)2 * State::IN_LEN + 5000 })
+	{
+		TestState state = MakeState(ram_size);
+		PointerWrapSink sink;
+		const std::vector<u8> expected = Serialize(state, sink);
+		SCOPED_TRACE(testing::Message() << expected.size() << " byte state");
+
+		ExpectLoads(CompressOldFormat(expected), expected, state);
+	}
+}
+
+TEST_F(StateCompressionTest, DamagedStatesAreRejected)
+{
+	TestState state = MakeState(3 * State::IN_LEN);
+	PointerWrapSink sink;
+	const std::vector<u8> expected = Serialize(state, sink);
+	std::vector<u8> compressed;
+	ASSERT_TRUE(State::CompressStateData(State::COMPRESSION_LZO, expected.size(),
+		[&expected](size_t offset, size_t size, u8* dst) { memcpy(dst, &expected[offset], size); }, compressed));
+
+	std::vector<u8> data;
+	std::vector<u8> truncated(compressed.begin(), compressed.end() - 100);
+	EXPECT_FALSE(State::DecompressStateData(truncated, (u32)expected.size(), data));
+
+	// LZO can't tell damaged literals apart, but it notices when the chunk
+	// table no longer lines up with the data
+	std::vector<u8> misaligned = compressed;
+	u32 first_chunk_size;
+	memcpy(&first_chunk_size, &misaligned[20], sizeof(u32));
+	first_chunk_size++;
+	memcpy(&misaligned[20], &first_chunk_size, sizeof(u32));
+	EXPECT_FALSE(State::DecompressStateData(misaligned, (u32)expected.size(), data));
+
+	// a state claiming to be larger than its chunks
+	EXPECT_FALSE(State::DecompressStateData(compressed, (u32)expected.size() + State::IN_LEN, data));
+}
+
+// Saves and loads a state a few chunks long with each codec, or a 100 MB one
+// when benchmarking and prints how long that takes.
+TEST_F(StateCompressionTest, Throughput)
+{
+	TestState state = MakeState(Benchmark::Size(100 * 1000 * 1000, 4 * 1000 * 1000));
+	PointerWrapSink sink;
+	const std::vector<u8> expected = Serialize(state, sink);
+
+	for (u32 codec : { State::COMPRESSION_LZO, State::COMPRESSION_ZLIB })
+	{
+		std::vector<u8> compressed;
+		bool compressed_ok = false;
+		const u64 compress_us = Benchmark::Time([&] {
+			compressed_ok = State::CompressStateData(codec, sink.Size(),
+				[&sink](size_t offset, size_t size, u8* dst) { sink.Read(offset, size, dst); }, compressed);
+		});
+		ASSERT_TRUE(compressed_ok);
+
+		std::vector<u8> data;
+		bool decompressed_ok = false;
+		const u64 decompress_us = Benchmark::Time([&] {
+			decompressed_ok = State::DecompressStateData(compressed, (u32)expected.size(), data);
+		});
+		ASSERT_TRUE(decompressed_ok);
+		EXPECT_TRUE(expected == data);
+
+		Benchmark::Report("STATE", "%s: %u MB to %u MB, compressed in %u ms, decompressed in %u ms",
+			codec == State::COMPRESSION_ZLIB ? "zlib" : "lzo", (u32)(expected.size() / 1000000),
+			(u32)(compressed.size() / 1000000), (u32)(compress_us / 1000), (u32)(decompress_us / 1000));
+	}
+}
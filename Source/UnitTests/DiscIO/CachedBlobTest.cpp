@@ -0,0 +1,223 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/MsgHandler.h"
+#include "Common/Timer.h"
+#include "DiscIO/CachedBlob.h"
+
+namespace
+{
+
+// An image in memory, which can take its time for every read like a disk
+// seeking would
+class MemoryReader : public DiscIO::IBlobReader
+{
+public:
+	MemoryReader(const std::vector<u8>& data, u32 latency_us = 0)
+		: m_reads(0), m_data(data), m_latency_us(latency_us)
+	{
+	}
+
+	u64 GetDataSize() const override { return m_data.size(); }
+	u64 GetRawSize() const override { return m_data.size(); }
+
+	bool Read(u64 offset, u64 nbytes, u8* out_ptr) override
+	{
+		m_reads++;
+		if (m_latency_us)
+			std::this_thread::sleep_for(std::chrono::microseconds(m_latency_us));
+		if (offset + nbytes > m_data.size())
+			return false;
+		memcpy(out_ptr, &m_data[(size_t)offset], (size_t)nbytes);
+		return true;
+	}
+
+	u32 m_reads;
+
+private:
+	const std::vector<u8>& m_data;
+	u32 m_latency_us;
+};
+
+struct TraceEntry
+{
+	u64 offset;
+	u64 size;
+};
+
+class CachedBlobReaderTest : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		SetEnableAlert(false);
+
+		std::mt19937 rng(3);
+		m_data.resize(64 * 1024 * 1024 + 1000);
+		for (size_t i = 0; i < m_data.size(); i += 4)
+			*(u32*)&m_data[i] = rng();
+	}
+
+	void ExpectRead(DiscIO::IBlobReader* reader, u64 offset, u64 size)
+	{
+		std::vector<u8> buffer((size_t)size);
+		ASSERT_TRUE(reader->Read(offset, size, &buffer[0]));
+		ASSERT_EQ(0, memcmp(&buffer[0], &m_data[(size_t)offset], (size_t)size)) << "offset " << offset << ", size " << size;
+	}
+
+	// Polls the stats until the read-ahead thread has done what the test
+	// waits for, or gives up after a few seconds
+	template <typename Predicate>
+	void WaitForStats(DiscIO::CachedBlobReader* reader, Predicate done)
+	{
+		const u32 start = Common::Timer::GetTimeMs();
+		while (!done(reader->GetStats()) && Common::Timer::GetTimeMs() - start < 5000)
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	// What a game streaming music from one file while loading others does: a
+	// 32 KiB read of the stream every so often, and loads of a few hundred KiB
+	// in Wii cluster sized pieces in between
+	std::vector<TraceEntry> MakeTrace()
+	{
+		std::mt19937 rng(11);
+		std::vector<TraceEntry> trace;
+		u64 stream = 48 * 1024 * 1024;
+		for (int i = 0; i < 300; i++)
+		{
+			trace.push_back({ stream, 0x8000 });
+			stream += 0x8000;
+			if (i % 10 == 0)
+			{
+				u64 load = (rng() % (40 * 1024 * 1024)) & ~0x7fffull;
+				for (u32 j = rng() % 16 + 4; j > 0; j--, load += 0x8000)
+					trace.push_back({ load, 0x8000 });
+			}
+		}
+		return trace;
+	}
+
+	std::vector<u8> m_data;
+};
+
+}  // namespace
+
+TEST_F(CachedBlobReaderTest, RandomReads)
+{
+	// small enough to evict all the time
+	DiscIO::CachedBlobReader reader(new MemoryReader(m_data), 0x8000, 16);
+	EXPECT_EQ(m_data.size(), reader.GetDataSize());
+
+	std::mt19937 rng(42);
+	for (int i = 0; i < 2000; i++)
+	{
+		const u64 size = rng() % 0x30000 + 1;
+		ExpectRead(&reader, rng() % (m_data.size() - size), size);
+	}
+	// the last block is shorter than the others
+	ExpectRead(&reader, m_data.size() - 10, 10);
+	ExpectRead(&reader, m_data.size() - 0x9000, 0x9000);
+
+	const DiscIO::CachedBlobReader::Stats stats = reader.GetStats();
+	EXPECT_EQ(2002u, stats.reads);
+	EXPECT_LT(0u, stats.hits);
+}
+
+TEST_F(CachedBlobReaderTest, MissesAreReadAtOnce)
+{
+	MemoryReader* memory = new MemoryReader(m_data);
+	DiscIO::CachedBlobReader reader(memory, 0x8000, 64);
+
+	ExpectRead(&reader, 0x8000 * 3, 0x8000);
+	// blocks 0 to 2 and 4 to 9 are missing
+	ExpectRead(&reader, 0x10, 0x8000 * 10 - 0x20);
+
+	const DiscIO::CachedBlobReader::Stats stats = reader.GetStats();
+	EXPECT_EQ(1u, stats.hits);
+	EXPECT_EQ(10u, stats.misses);
+	// neither read continues the one before, so nothing is read ahead
+	EXPECT_EQ(0u, stats.read_ahead);
+	EXPECT_EQ(3u, stats.host_reads);
+	EXPECT_EQ(3u, memory->m_reads);
+	EXPECT_EQ(0x8000u * 10, stats.host_bytes);
+}
+
+TEST_F(CachedBlobReaderTest, SequentialReadAhead)
+{
+	DiscIO::CachedBlobReader reader(new MemoryReader(m_data, 200), 0x20000, 64);
+
+	for (u64 offset = 0; offset < 16 * 1024 * 1024; offset += 0x8000)
+	{
+		// once reading is sequential, let the read-ahead thread fetch the
+		// next block before it is needed
+		const u64 block = offset / 0x20000;
+		if (offset % 0x20000 == 0 && block >= 2)
+		{
+			WaitForStats(&reader, [block](const DiscIO::CachedBlobReader::Stats& stats)
+			{
+				return stats.misses + stats.read_ahead > block;
+			});
+		}
+		ExpectRead(&reader, offset, 0x8000);
+	}
+
+	const DiscIO::CachedBlobReader::Stats stats = reader.GetStats();
+	EXPECT_LT(0u, stats.read_ahead);
+	EXPECT_LT(stats.misses * 4, stats.hits);
+}
+
+TEST_F(CachedBlobReaderTest, PrefetchAndReadPastEnd)
+{
+	DiscIO::CachedBlobReader reader(new MemoryReader(m_data), 0x20000, 64);
+	reader.Prefetch(0x100000, 0x200000);
+	WaitForStats(&reader, [](const DiscIO::CachedBlobReader::Stats& stats) { return stats.read_ahead >= 16; });
+	EXPECT_EQ(16u, reader.GetStats().read_ahead);
+
+	ExpectRead(&reader, 0x100000, 0x200000);
+	EXPECT_EQ(0u, reader.GetStats().misses);
+
+	u8 buffer[0x20];
+	EXPECT_FALSE(reader.Read(m_data.size() - 0x10, sizeof(buffer), buffer));
+}
+
+// A typical access pattern on a slow disk, with and without the cache. Both
+// have to read the same data, the cache with fewer and larger host reads.
+TEST_F(CachedBlobReaderTest, Replay)
+{
+	const std::vector<TraceEntry> trace = MakeTrace();
+
+	MemoryReader uncached(m_data, 100);
+	const u64 uncached_us = Benchmark::Time([&] {
+		for (const TraceEntry& entry : trace)
+			ExpectRead(&uncached, entry.offset, entry.size);
+	});
+
+	MemoryReader* memory = new MemoryReader(m_data, 100);
+	DiscIO::CachedBlobReader cached(memory);
+	const u64 cached_us = Benchmark::Time([&] {
+		for (const TraceEntry& entry : trace)
+			ExpectRead(&cached, entry.offset, entry.size);
+	});
+
+	const DiscIO::CachedBlobReader::Stats stats = cached.GetStats();
+	EXPECT_EQ(trace.size(), stats.reads);
+	EXPECT_LT(0u, stats.hits);
+	EXPECT_GT(uncached.m_reads, memory->m_reads);
+
+	Benchmark::Report("REPLAY", "%u reads, 100 us per host read: uncached %u ms, cached %u ms",
+		(u32)trace.size(), (u32)(uncached_us / 1000), (u32)(cached_us / 1000));
+	Benchmark::Report("REPLAY", "%.1f%% of blocks cached, %u read ahead, %u host reads, %u MiB read",
+		100.0 * stats.hits / (stats.hits + stats.misses), (u32)stats.read_ahead,
+		(u32)stats.host_reads, (u32)(stats.host_bytes >> 20));
+}
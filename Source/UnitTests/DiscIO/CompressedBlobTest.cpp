@@ -0,0 +1,206 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <polarssl/md5.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/CompressedBlob.h"
+
+// DiscIO asks a little of the core, which these tests don't run
+SConfig* SConfig::m_Instance;
+Core::EState Core::GetState() { return Core::CORE_UNINITIALIZED; }
+
+namespace
+{
+
+class CompressedBlobTest : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		SetEnableAlert(false);
+
+		m_filename = TempFile();
+		m_output = TempFile();
+
+		// Blocks of noise, zeroes and patterns, so some are stored and some
+		// compressed, and a last block that isn't full
+		std::mt19937 rng(11);
+		m_data.resize(2 * 1024 * 1024 + 777);
+		for (size_t i = 0; i < m_data.size(); i++)
+		{
+			switch ((i / 50000) % 3)
+			{
+			case 0: m_data[i] = (u8)rng(); break;
+			case 1: m_data[i] = 0; break;
+			case 2: m_data[i] = (u8)(i / 13); break;
+			}
+		}
+		File::IOFile file(m_filename, "wb");
+		ASSERT_TRUE(file.WriteBytes(&m_data[0], m_data.size()));
+	}
+
+	virtual void TearDown()
+	{
+		File::Delete(m_filename);
+		File::Delete(m_output);
+	}
+
+	std::string TempFile()
+	{
+		char filename[] = "/tmp/CompressedBlobTestXXXXXX";
+		int fd = mkstemp(filename);
+		EXPECT_NE(-1, fd);
+		close(fd);
+		return filename;
+	}
+
+	std::vector<u8> ReadFile(const std::string& filename)
+	{
+		std::vector<u8> data((size_t)File::GetSize(filename));
+		File::IOFile file(filename, "rb");
+		EXPECT_TRUE(data.empty() || file.ReadBytes(&data[0], data.size()));
+		return data;
+	}
+
+	std::string MD5(const std::string& filename)
+	{
+		const std::vector<u8> data = ReadFile(filename);
+		u8 hash[16];
+		md5(data.empty() ? nullptr : &data[0], data.size(), hash);
+		std::string hex;
+		for (u8 b : hash)
+			hex += StringFromFormat("%02x", b);
+		return hex;
+	}
+
+	// Turns the image into a GameCube disc as far as the scrubber cares: the
+	// magic word and an empty Wii partition table, so everything past the
+	// 0x50000 byte header counts as unused. Discs are made of whole 32 KiB
+	// clusters, the old scrubber read past its table for a partial one.
+	void MakeDisc()
+	{
+		const u8 magic[] = { 0xC2, 0x33, 0x9F, 0x3D };
+		memcpy(&m_data[0x1C], magic, sizeof(magic));
+		memset(&m_data[0x40000], 0, 0x20);
+		m_data.resize(2 * 1024 * 1024);
+		File::IOFile file(m_filename, "wb");
+		ASSERT_TRUE(file.WriteBytes(&m_data[0], m_data.size()));
+	}
+
+	std::string m_filename;
+	std::string m_output;
+	std::vector<u8> m_data;
+};
+
+}  // namespace
+
+TEST_F(CompressedBlobTest, RoundTrip)
+{
+	DiscIO::CompressStats stats;
+	ASSERT_TRUE(DiscIO::CompressFileToBlob(m_filename, m_output, 0, 16384, nullptr, nullptr, 4, &stats));
+	EXPECT_EQ(m_data.size(), stats.data_size);
+	EXPECT_EQ(File::GetSize(m_output), stats.compressed_size);
+	EXPECT_LT(stats.compressed_size, stats.data_size);
+	EXPECT_EQ(4, stats.threads);
+
+	std::unique_ptr<DiscIO::CompressedBlobReader> reader(DiscIO::CompressedBlobReader::Create(m_output));
+	ASSERT_TRUE(reader != nullptr);
+	EXPECT_EQ(m_data.size(), reader->GetDataSize());
+
+	std::vector<u8> buffer(m_data.size());
+	ASSERT_TRUE(reader->Read(0, buffer.size(), &buffer[0]));
+	EXPECT_EQ(0, memcmp(&buffer[0], &m_data[0], buffer.size()));
+}
+
+// Blocks are compressed independently, so the threads don't change the file
+TEST_F(CompressedBlobTest, SameWithAnyNumberOfThreads)
+{
+	for (int block_size : { 16384, 0x8000 })
+	{
+		ASSERT_TRUE(DiscIO::CompressFileToBlob(m_filename, m_output, 0, block_size, nullptr, nullptr, 1));
+		const std::vector<u8> expected = ReadFile(m_output);
+
+		for (int threads : { 2, 3, 8 })
+		{
+			ASSERT_TRUE(DiscIO::CompressFileToBlob(m_filename, m_output, 0, block_size, nullptr, nullptr, threads));
+			EXPECT_TRUE(expected == ReadFile(m_output)) << "block size " << block_size << ", " << threads << " threads";
+		}
+	}
+}
+
+TEST_F(CompressedBlobTest, AlreadyCompressed)
+{
+	ASSERT_TRUE(DiscIO::CompressFileToBlob(m_filename, m_output, 0, 16384, nullptr, nullptr, 2));
+	EXPECT_FALSE(DiscIO::CompressFileToBlob(m_output, m_filename, 0, 16384, nullptr, nullptr, 2));
+}
+
+// The files the single threaded compressor wrote before the pipeline (user-050)
+// replaced it. Existing .gcz files have to stay byte for byte the same.
+TEST_F(CompressedBlobTest, MatchesTheOldCompressor)
+{
+	const struct
+	{
+		int block_size;
+		const char* md5;
+	} golden[] = {
+		{ 16384, "b08a3488812c585f57c89d99f30514f3" },
+		{ 0x8000, "367dd424ee7c7bf7defdd7090d7bca6c" },
+	};
+
+	for (const auto& g : golden)
+	{
+		ASSERT_TRUE(DiscIO::CompressFileToBlob(m_filename, m_output, 0, g.block_size, nullptr, nullptr, 3));
+		EXPECT_EQ(g.md5, MD5(m_output)) << "block size " << g.block_size;
+	}
+}
+
+TEST_F(CompressedBlobTest, Scrubbed)
+{
+	MakeDisc();
+
+	const struct
+	{
+		int block_size;
+		const char* md5;
+	} golden[] = {
+		{ 16384, "a8ad17704f0aa1dbd4a9a8f2a87b60e1" },
+		{ 0x8000, "ff296e333f8047398ba56735d5e09480" },
+	};
+
+	for (const auto& g : golden)
+	{
+		ASSERT_TRUE(DiscIO::CompressFileToBlob(m_filename, m_output, 1, g.block_size, nullptr, nullptr, 3));
+		EXPECT_EQ(g.md5, MD5(m_output)) << "block size " << g.block_size;
+	}
+
+	// the header is kept, the rest reads back as 0xFF
+	std::unique_ptr<DiscIO::CompressedBlobReader> reader(DiscIO::CompressedBlobReader::Create(m_output));
+	ASSERT_TRUE(reader != nullptr);
+	std::vector<u8> buffer(m_data.size());
+	ASSERT_TRUE(reader->Read(0, buffer.size(), &buffer[0]));
+	EXPECT_EQ(0, memcmp(&buffer[0], &m_data[0], 0x50000));
+	for (size_t i = 0x50000; i < buffer.size(); i++)
+	{
+		if (buffer[i] != 0xFF)
+		{
+			ADD_FAILURE() << "byte " << i << " wasn't scrubbed";
+			break;
+		}
+	}
+}
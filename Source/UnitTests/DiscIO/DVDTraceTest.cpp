@@ -0,0 +1,111 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/DVDTrace.h"
+
+namespace
+{
+
+class DVDTraceTest : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		char filename[] = "/tmp/DVDTraceTestXXXXXX";
+		int fd = mkstemp(filename);
+		ASSERT_NE(-1, fd);
+		close(fd);
+		m_filename = filename;
+	}
+
+	virtual void TearDown()
+	{
+		File::Delete(m_filename);
+	}
+
+	// More than one batch, so the trace is written in several parts
+	void Record(u32 count)
+	{
+		DiscIO::TraceWriter writer;
+		ASSERT_TRUE(writer.Open(m_filename, 486000000));
+		for (u32 i = 0; i < count; i++)
+			writer.Record(i * 1000, (u64)i * 0x8000 + 0x100000000ULL, 0x20 + i, i % 3 ? DiscIO::TraceEntry::VOLUME : DiscIO::TraceEntry::RAW);
+	}
+
+	void ExpectEntries(const std::vector<DiscIO::TraceEntry>& entries, u32 count)
+	{
+		ASSERT_EQ(count, entries.size());
+		for (u32 i = 0; i < count; i++)
+		{
+			EXPECT_EQ(i * 1000, entries[i].ticks);
+			EXPECT_EQ((u64)i * 0x8000 + 0x100000000ULL, entries[i].offset);
+			EXPECT_EQ(0x20 + i, entries[i].length);
+			EXPECT_EQ(i % 3 ? DiscIO::TraceEntry::VOLUME : DiscIO::TraceEntry::RAW, entries[i].kind);
+		}
+	}
+
+	std::string m_filename;
+};
+
+}  // namespace
+
+TEST_F(DVDTraceTest, RoundTrip)
+{
+	Record(10000);
+
+	std::vector<DiscIO::TraceEntry> entries;
+	u64 ticks_per_second = 0;
+	ASSERT_TRUE(DiscIO::LoadTrace(m_filename, &entries, &ticks_per_second));
+	EXPECT_EQ(486000000u, ticks_per_second);
+	ExpectEntries(entries, 10000);
+}
+
+TEST_F(DVDTraceTest, Empty)
+{
+	Record(0);
+
+	std::vector<DiscIO::TraceEntry> entries;
+	u64 ticks_per_second;
+	ASSERT_TRUE(DiscIO::LoadTrace(m_filename, &entries, &ticks_per_second));
+	EXPECT_TRUE(entries.empty());
+}
+
+TEST_F(DVDTraceTest, NotClosed)
+{
+	Record(5000);
+
+	// what a trace looks like when the emulator went away while recording
+	u64 count = 0;
+	{
+		File::IOFile file(m_filename, "r+b");
+		ASSERT_TRUE(file.Seek(16, SEEK_SET));
+		ASSERT_TRUE(file.WriteArray(&count, 1));
+	}
+
+	std::vector<DiscIO::TraceEntry> entries;
+	u64 ticks_per_second;
+	ASSERT_TRUE(DiscIO::LoadTrace(m_filename, &entries, &ticks_per_second));
+	ExpectEntries(entries, 5000);
+}
+
+TEST_F(DVDTraceTest, NotATrace)
+{
+	{
+		File::IOFile file(m_filename, "wb");
+		ASSERT_TRUE(file.WriteBytes("not a trace at all", 18));
+	}
+
+	std::vector<DiscIO::TraceEntry> entries;
+	u64 ticks_per_second;
+	EXPECT_FALSE(DiscIO::LoadTrace(m_filename, &entries, &ticks_per_second));
+	EXPECT_FALSE(DiscIO::LoadTrace(m_filename + ".missing", &entries, &ticks_per_second));
+}
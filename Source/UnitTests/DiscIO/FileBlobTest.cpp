@@ -0,0 +1,109 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/MsgHandler.h"
+#include "DiscIO/FileBlob.h"
+
+namespace
+{
+
+class PlainFileReaderTest : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		SetEnableAlert(false);
+
+		char filename[] = "/tmp/PlainFileReaderTestXXXXXX";
+		int fd = mkstemp(filename);
+		ASSERT_NE(-1, fd);
+		close(fd);
+		m_filename = filename;
+
+		std::mt19937 rng(7);
+		m_data.resize(5 * 1024 * 1024 + 123);
+		for (u8& b : m_data)
+			b = (u8)rng();
+		File::IOFile file(m_filename, "wb");
+		ASSERT_TRUE(file.WriteBytes(&m_data[0], m_data.size()));
+	}
+
+	virtual void TearDown()
+	{
+		File::Delete(m_filename);
+	}
+
+	void ExpectRead(DiscIO::IBlobReader* reader, u64 offset, u64 size)
+	{
+		std::vector<u8> buffer(size);
+		ASSERT_TRUE(reader->Read(offset, size, &buffer[0]));
+		EXPECT_EQ(0, memcmp(&buffer[0], &m_data[offset], size)) << "offset " << offset << ", size " << size;
+	}
+
+	std::string m_filename;
+	std::vector<u8> m_data;
+};
+
+}  // namespace
+
+TEST_F(PlainFileReaderTest, RandomReads)
+{
+	std::unique_ptr<DiscIO::PlainFileReader> reader(DiscIO::PlainFileReader::Create(m_filename));
+	ASSERT_TRUE(reader != nullptr);
+	EXPECT_TRUE(reader->IsMapped());
+	EXPECT_EQ(m_data.size(), reader->GetDataSize());
+
+	std::mt19937 rng(42);
+	for (int i = 0; i < 1000; i++)
+	{
+		const u64 size = rng() % 0x10000 + 1;
+		ExpectRead(reader.get(), rng() % (m_data.size() - size), size);
+	}
+	ExpectRead(reader.get(), m_data.size() - 1, 1);
+}
+
+TEST_F(PlainFileReaderTest, SequentialReads)
+{
+	std::unique_ptr<DiscIO::PlainFileReader> reader(DiscIO::PlainFileReader::Create(m_filename));
+	ASSERT_TRUE(reader != nullptr);
+
+	// like streamed audio, running into the end of the image with read-ahead
+	u64 offset = 0x1234;
+	while (offset + 0x8000 <= m_data.size())
+	{
+		ExpectRead(reader.get(), offset, 0x8000);
+		offset += 0x8000;
+	}
+	reader->Prefetch(0, m_data.size() * 2);
+	ExpectRead(reader.get(), 0, m_data.size());
+}
+
+TEST_F(PlainFileReaderTest, ReadPastEnd)
+{
+	std::unique_ptr<DiscIO::PlainFileReader> reader(DiscIO::PlainFileReader::Create(m_filename));
+	ASSERT_TRUE(reader != nullptr);
+
+	// what exists gets copied, like with a short fread
+	std::vector<u8> buffer(0x100, 0xcd);
+	const u64 offset = m_data.size() - 0x10;
+	EXPECT_FALSE(reader->Read(offset, buffer.size(), &buffer[0]));
+	EXPECT_EQ(0, memcmp(&buffer[0], &m_data[offset], 0x10));
+	EXPECT_FALSE(reader->Read(m_data.size() + 1, 1, &buffer[0]));
+}
+
+TEST_F(PlainFileReaderTest, MissingFile)
+{
+	EXPECT_EQ(nullptr, DiscIO::PlainFileReader::Create(m_filename + ".missing"));
+}
@@ -0,0 +1,288 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "DiscIO/GameLibrary.h"
+
+// Builds a library of synthetic GameCube images, each with a file system
+// holding nothing but a banner, and indexes it.
+
+// DiscIO only asks the core whether a game is running, for the file monitor
+SConfig* SConfig::m_Instance;
+Core::EState Core::GetState() { return Core::CORE_UNINITIALIZED; }
+
+namespace
+{
+
+const u32 FST_OFFSET = 0x8000;
+const u32 BANNER_OFFSET = 0x9000;
+const u32 BANNER_SIZE = 0x1960; // BNR1
+
+void Write32(std::vector<u8>& image, u32 offset, u32 value)
+{
+	for (int i = 0; i < 4; i++)
+		image[offset + i] = (u8)(value >> (24 - i * 8));
+}
+
+std::string GameID(int n)
+{
+	return StringFromFormat("G%c%cE01", 'A' + n / 26 % 26, 'A' + n % 26);
+}
+
+std::string GameName(int n, int version)
+{
+	return StringFromFormat("Synthetic game %d v%d", n, version);
+}
+
+std::vector<u8> MakeImage(int n, int version, u32 size)
+{
+	std::vector<u8> image(size);
+	const std::string id = GameID(n);
+	memcpy(&image[0], id.data(), 6);
+	Write32(image, 0x1c, 0xc2339f3d);
+	const std::string name = GameName(n, version);
+	memcpy(&image[0x20], name.data(), name.size());
+
+	// root directory and opening.bnr
+	Write32(image, 0x424, FST_OFFSET);
+	Write32(image, 0x428, 0x24);
+	Write32(image, FST_OFFSET + 0x0, 0x01000000);
+	Write32(image, FST_OFFSET + 0x8, 2);
+	Write32(image, FST_OFFSET + 0x10, BANNER_OFFSET);
+	Write32(image, FST_OFFSET + 0x14, BANNER_SIZE);
+	strcpy((char*)&image[FST_OFFSET + 0x18], "opening.bnr");
+
+	memcpy(&image[BANNER_OFFSET], "BNR1", 4);
+	for (u32 i = 0x20; i < 0x1820; i++)
+		image[BANNER_OFFSET + i] = (u8)(i * n);
+	strcpy((char*)&image[BANNER_OFFSET + 0x1820], name.c_str());
+	strcpy((char*)&image[BANNER_OFFSET + 0x1840], "Dolphin");
+	return image;
+}
+
+class GameLibraryTest : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		SetEnableAlert(false);
+
+		char dir[] = "/tmp/GameLibraryTestXXXXXX";
+		ASSERT_NE(nullptr, mkdtemp(dir));
+		m_root = dir;
+		m_index = m_root + "/gamelist.idx";
+	}
+
+	virtual void TearDown()
+	{
+		File::DeleteDirRecursively(m_root);
+	}
+
+	void WriteImage(int n, int version, u32 size = 0x10000)
+	{
+		const std::vector<u8> image = MakeImage(n, version, size);
+		File::IOFile file(Path(n), "wb");
+		ASSERT_TRUE(file.WriteBytes(&image[0], image.size()));
+	}
+
+	std::string Path(int n) const
+	{
+		return StringFromFormat("%s/game%d.iso", m_root.c_str(), n);
+	}
+
+	std::vector<std::string> WriteLibrary(int count)
+	{
+		std::vector<std::string> paths;
+		for (int n = 0; n < count; n++)
+		{
+			WriteImage(n, 0);
+			paths.push_back(Path(n));
+		}
+		return paths;
+	}
+
+	static void ExpectGame(const DiscIO::GameMetadata& game, int n, int version)
+	{
+		ASSERT_TRUE(game.valid);
+		EXPECT_EQ(GameID(n), game.unique_id);
+		EXPECT_EQ(DiscIO::GameMetadata::GAMECUBE_DISC, game.platform);
+		EXPECT_EQ(DiscIO::IVolume::COUNTRY_USA, game.country);
+		ASSERT_FALSE(game.volume_names.empty());
+		EXPECT_EQ(GameName(n, version), game.volume_names[0]);
+		ASSERT_FALSE(game.names.empty());
+		EXPECT_EQ(GameName(n, version), game.names[0]);
+		EXPECT_EQ("Dolphin", game.company);
+		EXPECT_EQ(96, game.banner_width);
+		EXPECT_EQ(32, game.banner_height);
+		EXPECT_EQ(96u * 32 * 3, game.banner.size());
+	}
+
+	std::string m_root;
+	std::string m_index;
+};
+
+}  // namespace
+
+TEST_F(GameLibraryTest, IncrementalUpdates)
+{
+	const int COUNT = 12;
+	std::vector<std::string> paths = WriteLibrary(COUNT);
+
+	{
+		DiscIO::GameLibrary library(m_index);
+		library.Update(paths, 4);
+		EXPECT_EQ(0u, library.GetStats().cached);
+		EXPECT_EQ((u32)COUNT, library.GetStats().scanned);
+		ASSERT_EQ((size_t)COUNT, library.GetGames().size());
+		for (int n = 0; n < COUNT; n++)
+			ExpectGame(library.GetGames()[n], n, 0);
+		ASSERT_TRUE(library.Save());
+	}
+
+	// nothing changed, nothing is opened
+	{
+		DiscIO::GameLibrary library(m_index);
+		library.Update(paths, 4);
+		EXPECT_EQ((u32)COUNT, library.GetStats().cached);
+		EXPECT_EQ(0u, library.GetStats().scanned);
+		for (int n = 0; n < COUNT; n++)
+			ExpectGame(library.GetGames()[n], n, 0);
+		ASSERT_TRUE(library.Save());
+	}
+
+	// one image is replaced, one removed from the library
+	WriteImage(3, 1, 0x18000);
+	paths.erase(paths.begin() + 7);
+	{
+		DiscIO::GameLibrary library(m_index);
+		library.Update(paths, 4);
+		EXPECT_EQ((u32)COUNT - 2, library.GetStats().cached);
+		EXPECT_EQ(1u, library.GetStats().scanned);
+		ExpectGame(library.GetGames()[3], 3, 1);
+		ExpectGame(library.GetGames()[7], 8, 0);
+		ASSERT_TRUE(library.Save());
+	}
+
+	{
+		DiscIO::GameLibrary library(m_index);
+		library.Update(paths, 1);
+		EXPECT_EQ((u32)COUNT - 1, library.GetStats().cached);
+		EXPECT_EQ(0u, library.GetStats().scanned);
+		ExpectGame(library.GetGames()[3], 3, 1);
+	}
+}
+
+TEST_F(GameLibraryTest, InvalidImagesAreNotIndexed)
+{
+	std::vector<std::string> paths = WriteLibrary(2);
+	paths.push_back(m_root + "/junk.iso");
+	File::WriteStringToFile("not a disc image", paths.back());
+	paths.push_back(m_root + "/missing.iso");
+
+	DiscIO::GameLibrary library(m_index);
+	library.Update(paths, 2);
+	EXPECT_TRUE(library.GetGames()[1].valid);
+	EXPECT_FALSE(library.GetGames()[2].valid);
+	EXPECT_FALSE(library.GetGames()[3].valid);
+	ASSERT_TRUE(library.Save());
+
+	DiscIO::GameLibrary reopened(m_index);
+	reopened.Update(paths, 2);
+	EXPECT_EQ(2u, reopened.GetStats().cached);
+	EXPECT_EQ(2u, reopened.GetStats().scanned);
+}
+
+TEST_F(GameLibraryTest, DamagedIndexIsIgnored)
+{
+	const std::vector<std::string> paths = WriteLibrary(3);
+	{
+		DiscIO::GameLibrary library(m_index);
+		library.Update(paths, 2);
+		ASSERT_TRUE(library.Save());
+	}
+
+	std::string index;
+	ASSERT_TRUE(File::ReadFileToString(m_index, index));
+	index[index.size() / 2] ^= 1;
+	ASSERT_TRUE(File::WriteStringToFile(index, m_index));
+
+	DiscIO::GameLibrary library(m_index);
+	library.Update(paths, 2);
+	EXPECT_EQ(0u, library.GetStats().cached);
+	EXPECT_EQ(3u, library.GetStats().scanned);
+	for (int n = 0; n < 3; n++)
+		ExpectGame(library.GetGames()[n], n, 0);
+}
+
+TEST_F(GameLibraryTest, Cancel)
+{
+	const std::vector<std::string> paths = WriteLibrary(8);
+
+	DiscIO::GameLibrary library(m_index);
+	int calls = 0;
+	library.Update(paths, 1, [&](u32 done, u32 total, const std::string& path) {
+		EXPECT_EQ(8u, total);
+		calls++;
+		return false;
+	});
+	EXPECT_EQ(1, calls);
+
+	// the worker may have read more images before the progress got reported,
+	// whatever it didn't get to is left out
+	u32 valid = 0;
+	for (const DiscIO::GameMetadata& game : library.GetGames())
+		valid += game.valid;
+	EXPECT_LE(1u, library.GetStats().scanned);
+	EXPECT_EQ(library.GetStats().scanned, valid);
+	EXPECT_TRUE(library.GetGames()[0].valid);
+}
+
+// Scans a library with different numbers of threads, and loads it back from
+// the index. With DOLPHIN_BENCHMARK set it writes 200 MB of images and prints
+// how long each scan takes.
+TEST_F(GameLibraryTest, Throughput)
+{
+	const int COUNT = Benchmark::Size(200, 16);
+	const u32 size = Benchmark::Size(1u << 20, 0x10000u);
+	std::vector<std::string> paths;
+	for (int n = 0; n < COUNT; n++)
+	{
+		WriteImage(n, 0, size);
+		paths.push_back(Path(n));
+	}
+
+	for (int threads : { 1, 2, 4, 8 })
+	{
+		File::Delete(m_index);
+		DiscIO::GameLibrary library(m_index);
+		library.Update(paths, threads);
+		EXPECT_EQ((u32)COUNT, library.GetStats().scanned) << threads << " threads";
+		ASSERT_EQ((size_t)COUNT, library.GetGames().size());
+		for (int n = 0; n < COUNT; n++)
+			ExpectGame(library.GetGames()[n], n, 0);
+		ASSERT_TRUE(library.Save());
+		Benchmark::Report("SCAN", "%d images, %d threads: %u ms", COUNT, threads, (u32)(library.GetStats().scan_time_us / 1000));
+	}
+
+	DiscIO::GameLibrary library(m_index);
+	const u64 elapsed = Benchmark::Time([&] { library.Update(paths, 4); });
+	EXPECT_EQ((u32)COUNT, library.GetStats().cached);
+	EXPECT_EQ(0u, library.GetStats().scanned);
+	for (int n = 0; n < COUNT; n++)
+		ExpectGame(library.GetGames()[n], n, 0);
+	Benchmark::Report("SCAN", "%d images from the index, including loading it: %u ms", COUNT, (u32)(elapsed / 1000));
+}
@@ -0,0 +1,165 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/MsgHandler.h"
+#include "VideoBackends/Software/TextureEncoder.h"
+#include "VideoCommon/BPMemory.h"
+
+// Conformance test of the vectorized EFB copy encoders against the original
+// per-texel ones: every pixel format, scale, copy format and a range of copy
+// sizes, from random EFB contents, have to give the same texture bit for bit.
+
+namespace
+{
+
+// Big enough for the tallest half scale copy reading up to 1024 texel rows
+const u32 EFB_ROW_BYTES = 640 * 3;
+const u32 EFB_SIZE = EFB_ROW_BYTES * 2 * 1040 + 64;
+
+const PEControl::PixelFormat PIXEL_FORMATS[] = {
+	PEControl::RGBA6_Z24,
+	PEControl::RGB8_Z24,
+	PEControl::RGB565_Z16,
+	PEControl::Z24,
+};
+
+class EFBCopyEncoder : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		SetEnableAlert(false);
+
+		std::mt19937 rng(42);
+		m_efb.resize(EFB_SIZE);
+		for (u8& b : m_efb)
+			b = (u8)rng();
+	}
+
+	// Runs both encoders for all copy formats with the given size, which is
+	// one less than the number of EFB pixels copied like in the registers
+	void CheckAllFormats(u32 width, u32 height, u32 x, u32 y)
+	{
+		bpmem.copyTexSrcWH.x = width;
+		bpmem.copyTexSrcWH.y = height;
+		// a whole number of RGBA8 blocks per row, plus a gap
+		bpmem.copyMipMapStrideChannels = ((width >> 2) + 2) * 2;
+		u8* src = &m_efb[(y * 640 + x) * 3];
+
+		// blocks are at least four texels high
+		const u32 dest_size = bpmem.copyMipMapStrideChannels * 32 * ((height >> 2) + 1);
+		m_expected.resize(dest_size);
+		m_actual.resize(dest_size);
+
+		for (PEControl::PixelFormat pixel_format : PIXEL_FORMATS)
+		{
+			for (u32 half_scale = 0; half_scale < 2; half_scale++)
+			{
+				for (u32 intensity = 0; intensity < 2; intensity++)
+				{
+					for (u32 target = 0; target < 16; target++)
+					{
+						bpmem.zcontrol.pixel_format = pixel_format;
+						bpmem.triggerEFBCopy.Hex = 0;
+						bpmem.triggerEFBCopy.half_scale = half_scale;
+						bpmem.triggerEFBCopy.intensity_fmt = intensity;
+						bpmem.triggerEFBCopy.target_pixel_format = target;
+
+						memset(m_expected.data(), 0xcd, dest_size);
+						memset(m_actual.data(), 0xcd, dest_size);
+						TextureEncoder::EncodeReference(m_expected.data(), src);
+						TextureEncoder::Encode(m_actual.data(), src);
+
+						ASSERT_TRUE(m_expected == m_actual)
+							<< "pixel format " << (u32)pixel_format << ", half scale " << half_scale
+							<< ", intensity " << intensity << ", target format " << target
+							<< ", size " << width + 1 << "x" << height + 1;
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<u8> m_efb;
+	std::vector<u8> m_expected;
+	std::vector<u8> m_actual;
+};
+
+}  // namespace
+
+TEST_F(EFBCopyEncoder, SmallCopies)
+{
+	for (u32 width = 0; width < 40; width++)
+	{
+		for (u32 height : { 0, 1, 3, 4, 7, 8, 17 })
+			CheckAllFormats(width, height, width * 7 % 13, height % 5);
+	}
+}
+
+TEST_F(EFBCopyEncoder, LargeCopies)
+{
+	CheckAllFormats(639, 527, 0, 0);
+	CheckAllFormats(319, 263, 320, 264);
+	CheckAllFormats(1023, 1023, 0, 0);
+	CheckAllFormats(255, 130, 17, 3);
+}
+
+// Times full 640x528 EFB copies to the formats games copy to most, with the
+// per-texel encoders and the vectorized ones.
+TEST_F(EFBCopyEncoder, Throughput)
+{
+	const int COPIES = Benchmark::Size(20, 1);
+	const struct
+	{
+		const char* name;
+		PEControl::PixelFormat pixel_format;
+		u32 intensity;
+		u32 target;
+	} copies[] = {
+		{ "RGBA8", PEControl::RGBA6_Z24, 0, 12 },
+		{ "RGB565", PEControl::RGB8_Z24, 0, 8 },
+		{ "RGB5A3", PEControl::RGBA6_Z24, 0, 10 },
+		{ "I8", PEControl::RGB8_Z24, 1, 2 },
+		{ "Z24", PEControl::Z24, 0, 12 },
+	};
+
+	bpmem.copyTexSrcWH.x = 639;
+	bpmem.copyTexSrcWH.y = 527;
+	bpmem.copyMipMapStrideChannels = (640 / 4) * 2;
+	m_expected.resize(640 * 528 * 4);
+	m_actual.resize(640 * 528 * 4);
+
+	for (const auto& copy : copies)
+	{
+		for (u32 half_scale = 0; half_scale < 2; half_scale++)
+		{
+			bpmem.zcontrol.pixel_format = copy.pixel_format;
+			bpmem.triggerEFBCopy.Hex = 0;
+			bpmem.triggerEFBCopy.half_scale = half_scale;
+			bpmem.triggerEFBCopy.intensity_fmt = copy.intensity;
+			bpmem.triggerEFBCopy.target_pixel_format = copy.target;
+
+			const u64 reference_us = Benchmark::Time([&] {
+				for (int i = 0; i < COPIES; i++)
+					TextureEncoder::EncodeReference(m_expected.data(), m_efb.data());
+			});
+
+			const u64 vectorized_us = Benchmark::Time([&] {
+				for (int i = 0; i < COPIES; i++)
+					TextureEncoder::Encode(m_actual.data(), m_efb.data());
+			});
+
+			EXPECT_TRUE(m_expected == m_actual) << copy.name << (half_scale ? " half" : " full");
+			Benchmark::Report("EFBCOPY", "%-6s %s: per texel %6.2f ms, vectorized %6.2f ms per copy",
+				copy.name, half_scale ? "half" : "full", reference_us / 1000.0 / COPIES, vectorized_us / 1000.0 / COPIES);
+		}
+	}
+}
@@ -0,0 +1,412 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/MsgHandler.h"
+#include "Core/HW/Memmap.h"
+#include "VideoBackends/Software/TextureSampler.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoConfig.h"
+
+// The sampler and texel decoders only use these from the rest of the core,
+// defining them here keeps the core out of the test. RAM is a small buffer
+// which tracks writes per page like Memmap does.
+namespace
+{
+
+const u32 RAM_SIZE = 0x100000;
+const u32 PAGE_SIZE = 0x1000;
+
+u8 s_ram[RAM_SIZE];
+u64 s_page_written[RAM_SIZE / PAGE_SIZE];
+u64 s_write_generation = 0;
+int s_tracked_ranges = 0;
+
+}  // namespace
+
+u8* Memory::GetPointer(const u32 _Address)
+{
+	return _Address < RAM_SIZE ? &s_ram[_Address] : nullptr;
+}
+
+u64 Memory::TrackRange(const u32 _Address, const u32 _iLength)
+{
+	s_tracked_ranges++;
+	return ++s_write_generation;
+}
+
+bool Memory::HasRangeChanged(const u32 _Address, const u32 _iLength, const u64 _Generation)
+{
+	for (u32 page = _Address / PAGE_SIZE; page <= (_Address + _iLength - 1) / PAGE_SIZE; page++)
+	{
+		if (s_page_written[page] > _Generation)
+			return true;
+	}
+	return false;
+}
+
+VideoConfig::VideoConfig() {}
+VideoConfig g_ActiveConfig;
+
+// The cached sampler against decoding every texel straight from TMEM or RAM
+// like SampleMip did before the cache, which has to give the same samples bit
+// for bit for every texture format, wrap mode and mip level.
+
+namespace
+{
+
+const int FORMATS[] = {
+	GX_TF_I4, GX_TF_I8, GX_TF_IA4, GX_TF_IA8, GX_TF_RGB565, GX_TF_RGB5A3,
+	GX_TF_RGBA8, GX_TF_C4, GX_TF_C8, GX_TF_C14X2, GX_TF_CMPR,
+};
+
+// The odd half of RGBA8 textures and the TLUTs are far enough from the image
+// for the largest texture used here
+const u32 TMEM_ODD_LINE = 0x4000;
+const u32 TLUT_OFFSET = 0x300;
+
+// where textures in RAM start, not on a page boundary
+const u32 RAM_IMAGE = 0x12360;
+
+const u8 TEXMAP = 5;
+
+FourTexUnits& TexUnit()
+{
+	return bpmem.tex[(TEXMAP >> 2) & 1];
+}
+
+void SetTexture(int format, u32 width, u32 height, u32 wrap_s, u32 wrap_t)
+{
+	FourTexUnits& unit = TexUnit();
+	const int sub = TEXMAP & 3;
+
+	unit.texMode0[sub].hex = 0;
+	unit.texMode0[sub].wrap_s = wrap_s;
+	unit.texMode0[sub].wrap_t = wrap_t;
+	unit.texImage0[sub].hex = 0;
+	unit.texImage0[sub].width = width - 1;
+	unit.texImage0[sub].height = height - 1;
+	unit.texImage0[sub].format = format;
+	unit.texImage1[sub].hex = 0;
+	unit.texImage1[sub].image_type = 1;
+	unit.texImage2[sub].hex = 0;
+	unit.texImage2[sub].tmem_odd = TMEM_ODD_LINE;
+	unit.texTlut[sub].hex = 0;
+	unit.texTlut[sub].tmem_offset = TLUT_OFFSET;
+	unit.texTlut[sub].tlut_format = format == GX_TF_C14X2 ? 2 : 1;
+
+	TextureSampler::InvalidateCache();
+}
+
+void SetRamTexture(int format, u32 width, u32 height, u32 wrap_s, u32 wrap_t)
+{
+	SetTexture(format, width, height, wrap_s, wrap_t);
+	FourTexUnits& unit = TexUnit();
+	const int sub = TEXMAP & 3;
+	unit.texImage1[sub].image_type = 0;
+	unit.texImage3[sub].hex = 0;
+	unit.texImage3[sub].image_base = RAM_IMAGE >> 5;
+	TextureSampler::InvalidateCache();
+}
+
+// Writes to RAM, in the pages the write tracking sees
+void WriteRam(u32 address, u8 value)
+{
+	s_ram[address] = value;
+	s_page_written[address / PAGE_SIZE] = ++s_write_generation;
+}
+
+// TextureSampler's wrapping for the defined wrap modes
+void WrapCoord(int& coord, int wrapMode, int imageSize)
+{
+	switch (wrapMode)
+	{
+	case 0:
+		coord = std::min(std::max(coord, 0), imageSize);
+		break;
+	case 1:
+		coord = coord % (imageSize + 1);
+		coord = coord < 0 ? imageSize + coord : coord;
+		break;
+	case 2:
+		{
+			int sizePlus1 = imageSize + 1;
+			int div = coord / sizePlus1;
+			coord = coord - div * sizePlus1;
+			coord = coord < 0 ? -coord : coord;
+			coord = (div & 1) ? imageSize - coord : coord;
+		}
+		break;
+	}
+}
+
+// SampleMip as it was before the decoded texel cache
+void ReferenceSampleMip(s32 s, s32 t, s32 mip, bool linear, u8* sample)
+{
+	FourTexUnits& unit = TexUnit();
+	const int sub = TEXMAP & 3;
+	const TexMode0& tm0 = unit.texMode0[sub];
+	const TexImage0& ti0 = unit.texImage0[sub];
+
+	const bool inRam = !unit.texImage1[sub].image_type;
+	u8* imageSrc = inRam ? Memory::GetPointer(unit.texImage3[sub].image_base << 5) : &texMem[unit.texImage1[sub].tmem_even * TMEM_LINE_SIZE];
+	u8* imageSrcOdd = &texMem[unit.texImage2[sub].tmem_odd * TMEM_LINE_SIZE];
+	const bool rgba8 = ti0.format == GX_TF_RGBA8 && !inRam;
+	const int tlutAddress = unit.texTlut[sub].tmem_offset << 9;
+	const int tlutFormat = unit.texTlut[sub].tlut_format;
+
+	int imageWidth = ti0.width;
+	int imageHeight = ti0.height;
+	if (mip)
+	{
+		int mipWidth = imageWidth + 1;
+		int mipHeight = imageHeight + 1;
+		const int fmtWidth = TexDecoder_GetBlockWidthInTexels(ti0.format);
+		const int fmtHeight = TexDecoder_GetBlockHeightInTexels(ti0.format);
+		const int fmtDepth = TexDecoder_GetTexelSizeInNibbles(ti0.format);
+
+		imageWidth >>= mip;
+		imageHeight >>= mip;
+		s >>= mip;
+		t >>= mip;
+
+		for (; mip; mip--)
+		{
+			mipWidth = std::max(mipWidth, fmtWidth);
+			mipHeight = std::max(mipHeight, fmtHeight);
+			imageSrc += (mipWidth * mipHeight * fmtDepth) >> 1;
+			mipWidth >>= 1;
+			mipHeight >>= 1;
+		}
+	}
+
+	auto decode = [&](int imageS, int imageT, u8* texel) {
+		if (rgba8)
+			TexDecoder_DecodeTexelRGBA8FromTmem(texel, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
+		else
+			TexDecoder_DecodeTexel(texel, imageSrc, imageS, imageT, imageWidth, ti0.format, tlutAddress, tlutFormat);
+	};
+
+	if (linear)
+	{
+		s -= 64;
+		t -= 64;
+		int imageS = s >> 7;
+		int imageT = t >> 7;
+		int imageSPlus1 = imageS + 1;
+		int imageTPlus1 = imageT + 1;
+		const u32 fractS = s & 0x7f;
+		const u32 fractT = t & 0x7f;
+
+		WrapCoord(imageS, tm0.wrap_s, imageWidth);
+		WrapCoord(imageT, tm0.wrap_t, imageHeight);
+		WrapCoord(imageSPlus1, tm0.wrap_s, imageWidth);
+		WrapCoord(imageTPlus1, tm0.wrap_t, imageHeight);
+
+		const struct
+		{
+			int s, t;
+			u32 weight;
+		} taps[] = {
+			{ imageS, imageT, (128 - fractS) * (128 - fractT) },
+			{ imageSPlus1, imageT, fractS * (128 - fractT) },
+			{ imageS, imageTPlus1, (128 - fractS) * fractT },
+			{ imageSPlus1, imageTPlus1, fractS * fractT },
+		};
+
+		u32 sum[4] = {};
+		for (const auto& tap : taps)
+		{
+			u8 texel[4];
+			decode(tap.s, tap.t, texel);
+			for (int c = 0; c < 4; c++)
+				sum[c] += texel[c] * tap.weight;
+		}
+		for (int c = 0; c < 4; c++)
+			sample[c] = (u8)(sum[c] >> 14);
+	}
+	else
+	{
+		int imageS = s >> 7;
+		int imageT = t >> 7;
+		WrapCoord(imageS, tm0.wrap_s, imageWidth);
+		WrapCoord(imageT, tm0.wrap_t, imageHeight);
+		decode(imageS, imageT, sample);
+	}
+}
+
+class SWTextureSampler : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		SetEnableAlert(false);
+
+		std::mt19937 rng(41);
+		for (u8& b : texMem)
+			b = (u8)rng();
+		for (u8& b : s_ram)
+			b = (u8)rng();
+	}
+};
+
+}  // namespace
+
+TEST_F(SWTextureSampler, CacheMatchesDirectDecoding)
+{
+	std::mt19937 rng(1234);
+
+	for (int format : FORMATS)
+	{
+		for (u32 wrap = 0; wrap < 3; wrap++)
+		{
+			// odd sizes leave partial 8x8 tiles and format blocks at the edges
+			const u32 width = format == GX_TF_RGBA8 ? 100 : 160;
+			const u32 height = 37 + wrap * 20;
+			SetTexture(format, width, height, wrap, 2 - wrap);
+
+			for (int i = 0; i < 3000; i++)
+			{
+				const s32 mip = rng() % 3;
+				const bool linear = (rng() & 1) != 0;
+				// up to two texture sizes outside on either side
+				const s32 s = (s32)(rng() % (width * 128 * 5)) - (s32)(width * 128 * 2);
+				const s32 t = (s32)(rng() % (height * 128 * 5)) - (s32)(height * 128 * 2);
+
+				u8 expected[4], actual[4];
+				ReferenceSampleMip(s, t, mip, linear, expected);
+				TextureSampler::SampleMip(s, t, mip, linear, TEXMAP, actual);
+				ASSERT_EQ(0, memcmp(expected, actual, 4)) << "format " << format << ", wrap " << wrap
+					<< ", mip " << mip << ", linear " << linear << ", s " << s << ", t " << t;
+
+				// a new primitive now and then, so tiles get decoded again
+				if (rng() % 500 == 0)
+					TextureSampler::InvalidateCache();
+			}
+		}
+	}
+}
+
+// Textures in RAM stay decoded across primitives until the pages they're in
+// are written
+TEST_F(SWTextureSampler, RamTexturesAreTrackedAcrossPrimitives)
+{
+	std::mt19937 rng(77);
+
+	for (int format : FORMATS)
+	{
+		const u32 width = 64, height = 40;
+		SetRamTexture(format, width, height, 1, 1);
+		const u32 size = TexDecoder_GetTextureSizeInBytes(width, height, format);
+
+		auto check_primitive = [&] {
+			TextureSampler::NewPrimitive();
+			for (int i = 0; i < 500; i++)
+			{
+				const s32 mip = rng() % 2;
+				const bool linear = (rng() & 1) != 0;
+				const s32 s = (s32)(rng() % (width * 128));
+				const s32 t = (s32)(rng() % (height * 128));
+
+				u8 expected[4], actual[4];
+				ReferenceSampleMip(s, t, mip, linear, expected);
+				TextureSampler::SampleMip(s, t, mip, linear, TEXMAP, actual);
+				ASSERT_EQ(0, memcmp(expected, actual, 4)) << "format " << format
+					<< ", mip " << mip << ", linear " << linear << ", s " << s << ", t " << t;
+			}
+		};
+
+		s_tracked_ranges = 0;
+		check_primitive();
+		// the image and its first mip
+		EXPECT_EQ(2, s_tracked_ranges) << "format " << format;
+
+		// nothing written, nothing decoded again
+		check_primitive();
+		WriteRam(RAM_IMAGE + size + 2 * PAGE_SIZE, 0x55);
+		check_primitive();
+		EXPECT_EQ(2, s_tracked_ranges) << "format " << format;
+
+		// a new texture in the same place, the first mip starts in the page
+		// where the image ends
+		for (u32 i = 0; i < size; i += 3)
+			WriteRam(RAM_IMAGE + i, (u8)rng());
+		check_primitive();
+		EXPECT_EQ(4, s_tracked_ranges) << "format " << format;
+	}
+}
+
+// Bilinearly samples a 256x256 texture over a frame, drawn as square
+// primitives of different sizes, with the cache and with direct decoding,
+// which have to sample the same. The texture is in RAM so every primitive
+// checks it for writes.
+TEST_F(SWTextureSampler, Throughput)
+{
+	const int FRAME_WIDTH = Benchmark::Size(640, 160);
+	const int FRAME_HEIGHT = Benchmark::Size(480, 120);
+	const int FRAMES = Benchmark::Size(5, 1);
+	const struct
+	{
+		const char* name;
+		int format;
+	} formats[] = {
+		{ "I8", GX_TF_I8 },
+		{ "RGB5A3", GX_TF_RGB5A3 },
+		{ "RGBA8", GX_TF_RGBA8 },
+		{ "CMPR", GX_TF_CMPR },
+	};
+
+	for (const auto& format : formats)
+	{
+		SetRamTexture(format.format, 256, 256, 1, 1);
+
+		for (int primitive_size : { 8, 32, 128 })
+		{
+			u64 elapsed[2];
+			u32 checksum[2] = {};
+			for (int cached = 0; cached < 2; cached++)
+			{
+				elapsed[cached] = Benchmark::Time([&] {
+					for (int frame = 0; frame < FRAMES; frame++)
+					{
+						for (int y0 = 0; y0 < FRAME_HEIGHT; y0 += primitive_size)
+						{
+							for (int x0 = 0; x0 < FRAME_WIDTH; x0 += primitive_size)
+							{
+								TextureSampler::NewPrimitive();
+								for (int y = y0; y < y0 + primitive_size && y < FRAME_HEIGHT; y++)
+								{
+									for (int x = x0; x < x0 + primitive_size && x < FRAME_WIDTH; x++)
+									{
+										// a bit less than a texel per pixel
+										const s32 s = x * 100 + frame * 37;
+										const s32 t = y * 100;
+										u8 sample[4];
+										if (cached)
+											TextureSampler::SampleMip(s, t, 0, true, TEXMAP, sample);
+										else
+											ReferenceSampleMip(s, t, 0, true, sample);
+										checksum[cached] += sample[0] + sample[1] + sample[2] + sample[3];
+									}
+								}
+							}
+						}
+					}
+				});
+			}
+
+			EXPECT_EQ(checksum[0], checksum[1]) << format.name << ", " << primitive_size << "x" << primitive_size;
+			const double samples = (double)FRAME_WIDTH * FRAME_HEIGHT * FRAMES;
+			Benchmark::Report("SAMPLER", "%-6s %3dx%-3d primitives: direct %6.2f ns, cached %6.2f ns per sample",
+				format.name, primitive_size, primitive_size, elapsed[0] * 1000.0 / samples, elapsed[1] * 1000.0 / samples);
+		}
+	}
+}
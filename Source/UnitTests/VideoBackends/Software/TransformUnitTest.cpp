@@ -0,0 +1,250 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "Common/MsgHandler.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/TransformUnit.h"
+#include "VideoCommon/XFMemory.h"
+
+// Golden vertex tests: random vertices and XF state go through the per vertex
+// transform functions and through the batched ones, and the results have to
+// match bit for bit.
+
+namespace
+{
+
+const int NUM_VERTICES = 23;
+
+std::mt19937 s_rng(1234);
+
+float RandomFloat(float min, float max)
+{
+	return std::uniform_real_distribution<float>(min, max)(s_rng);
+}
+
+u32 RandomU32()
+{
+	return std::uniform_int_distribution<u32>()(s_rng);
+}
+
+void SetFloat(u32* mem, float f)
+{
+	memcpy(mem, &f, sizeof(f));
+}
+
+void SetRandomMatrices(u32* mem, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+		SetFloat(&mem[i], RandomFloat(-2.0f, 2.0f));
+}
+
+// Same layout as the light registers read by the transform unit
+void SetRandomLight(int num)
+{
+	u32* light = &xfmem.lights[0x10 * num];
+	light[3] = RandomU32();
+	for (int i = 4; i < 10; i++)
+		SetFloat(&light[i], RandomFloat(0.0f, 1.0f)); // cosatt, distatt
+	for (int i = 10; i < 13; i++)
+		SetFloat(&light[i], RandomFloat(-20.0f, 20.0f)); // pos
+	for (int i = 13; i < 16; i++)
+		SetFloat(&light[i], RandomFloat(-1.0f, 1.0f)); // dir
+}
+
+void SetupXF(bool perspective)
+{
+	memset(&xfmem, 0, sizeof(xfmem));
+	SetRandomMatrices(xfmem.posMatrices, 256);
+	SetRandomMatrices(xfmem.normalMatrices, 96);
+	for (int i = 0; i < 8; i++)
+		SetRandomLight(i);
+
+	// light 7 sits on top of vertex 0 and has no distance attenuation at all
+	SetFloat(&xfmem.lights[0x10 * 7 + 7], 0.0f);
+	SetFloat(&xfmem.lights[0x10 * 7 + 8], 0.0f);
+	SetFloat(&xfmem.lights[0x10 * 7 + 9], 0.0f);
+
+	for (float& f : xfmem.projection.rawProjection)
+		f = RandomFloat(-2.0f, 2.0f);
+	xfmem.projection.type = perspective ? GX_PERSPECTIVE : GX_ORTHOGRAPHIC;
+
+	xfmem.numChan.numColorChans = 2;
+	xfmem.ambColor[0] = RandomU32();
+	xfmem.ambColor[1] = RandomU32();
+	xfmem.matColor[0] = RandomU32();
+	xfmem.matColor[1] = RandomU32();
+}
+
+void RandomVertices(InputVertexData* vertices, bool samePosMtx)
+{
+	for (int v = 0; v < NUM_VERTICES; v++)
+	{
+		InputVertexData& vertex = vertices[v];
+		vertex.posMtx = samePosMtx ? 9 : (RandomU32() % 21) * 3;
+		vertex.position = Vec3(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f));
+		for (Vec3& normal : vertex.normal)
+			normal = Vec3(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+		for (auto& color : vertex.color)
+			*(u32*)color = RandomU32();
+	}
+}
+
+// Runs count vertices through the per vertex functions into ref and through
+// the batched ones into out
+void Transform(const InputVertexData* in, OutputVertexData* ref, OutputVertexData* out, int count)
+{
+	for (int v = 0; v < count; v++)
+	{
+		TransformUnit::TransformPosition(&in[v], &ref[v]);
+		TransformUnit::TransformNormal(&in[v], true, &ref[v]);
+		TransformUnit::TransformColor(&in[v], &ref[v]);
+	}
+	TransformUnit::TransformPositions(in, out, count);
+	TransformUnit::TransformNormals(in, true, out, count);
+	TransformUnit::TransformColors(in, out, count);
+}
+
+void ExpectSame(const OutputVertexData& ref, const OutputVertexData& out, int v)
+{
+	EXPECT_EQ(0, memcmp(&ref.mvPosition, &out.mvPosition, sizeof(ref.mvPosition))) << "vertex " << v;
+	EXPECT_EQ(0, memcmp(&ref.projectedPosition, &out.projectedPosition, sizeof(ref.projectedPosition))) << "vertex " << v;
+	EXPECT_EQ(0, memcmp(ref.normal, out.normal, sizeof(ref.normal))) << "vertex " << v;
+	EXPECT_EQ(*(u32*)ref.color[0], *(u32*)out.color[0]) << "vertex " << v;
+	EXPECT_EQ(*(u32*)ref.color[1], *(u32*)out.color[1]) << "vertex " << v;
+}
+
+void CheckBatches(const InputVertexData* in)
+{
+	// every batch size, so all ways of filling the last group of lanes are covered
+	for (int count = 1; count <= NUM_VERTICES; count++)
+	{
+		OutputVertexData ref[NUM_VERTICES] = {}, out[NUM_VERTICES] = {};
+		Transform(in, ref, out, count);
+		for (int v = 0; v < count; v++)
+			ExpectSame(ref[v], out[v], v);
+		if (::testing::Test::HasFailure())
+			return;
+	}
+}
+
+}  // namespace
+
+TEST(SWTransformUnit, Positions)
+{
+	for (int perspective = 0; perspective < 2; perspective++)
+	{
+		for (int samePosMtx = 0; samePosMtx < 2; samePosMtx++)
+		{
+			SetupXF(perspective != 0);
+			InputVertexData in[NUM_VERTICES];
+			RandomVertices(in, samePosMtx != 0);
+			CheckBatches(in);
+		}
+	}
+}
+
+TEST(SWTransformUnit, Lighting)
+{
+	SetEnableAlert(false);
+
+	SetupXF(true);
+	InputVertexData in[NUM_VERTICES];
+	RandomVertices(in, false);
+
+	// put vertex 0 right onto light 7
+	OutputVertexData out;
+	TransformUnit::TransformPosition(&in[0], &out);
+	memcpy(&xfmem.lights[0x10 * 7 + 10], &out.mvPosition, sizeof(Vec3));
+
+	for (u32 attnfunc = 0; attnfunc < 4; attnfunc++)
+	{
+		for (u32 diffusefunc = LIGHTDIF_NONE; diffusefunc <= LIGHTDIF_CLAMP; diffusefunc++)
+		{
+			for (u32 sources = 0; sources < 4; sources++)
+			{
+				for (int chan = 0; chan < 2; chan++)
+				{
+					for (LitChannel* lit : { &xfmem.color[chan], &xfmem.alpha[chan] })
+					{
+						lit->hex = 0;
+						lit->matsource = sources & 1;
+						lit->ambsource = (sources >> 1) & 1;
+						lit->enablelighting = 1;
+						lit->diffusefunc = diffusefunc;
+						lit->attnfunc = attnfunc;
+						lit->lightMask0_3 = RandomU32() & 0xf;
+						lit->lightMask4_7 = (RandomU32() & 0x7) | 0x8;
+					}
+				}
+
+				SCOPED_TRACE(testing::Message() << "attnfunc " << attnfunc << ", diffusefunc " << diffusefunc << ", sources " << sources);
+				CheckBatches(in);
+			}
+		}
+	}
+
+	// unlit channels pass the material color through
+	xfmem.color[1].enablelighting = 0;
+	xfmem.alpha[0].enablelighting = 0;
+	CheckBatches(in);
+}
+
+// Times the per vertex and the batched transforms for 16 vertex batches, as
+// SWVertexLoader issues them, with both color channels lit by four spot
+// lights. The batched results have to match the per vertex ones.
+TEST(SWTransformUnit, Throughput)
+{
+	const int BATCH = 16;
+	const int ROUNDS = Benchmark::Size(100000, 100);
+
+	SetupXF(true);
+	InputVertexData in[NUM_VERTICES];
+	RandomVertices(in, false);
+	for (int chan = 0; chan < 2; chan++)
+	{
+		for (LitChannel* lit : { &xfmem.color[chan], &xfmem.alpha[chan] })
+		{
+			lit->hex = 0;
+			lit->enablelighting = 1;
+			lit->diffusefunc = LIGHTDIF_CLAMP;
+			lit->attnfunc = LIGHTATTN_SPOT;
+			lit->lightMask0_3 = 0xf;
+		}
+	}
+
+	OutputVertexData ref[BATCH] = {}, out[BATCH] = {};
+	const u64 scalar_us = Benchmark::Time([&] {
+		for (int round = 0; round < ROUNDS; round++)
+		{
+			for (int v = 0; v < BATCH; v++)
+			{
+				TransformUnit::TransformPosition(&in[v], &ref[v]);
+				TransformUnit::TransformNormal(&in[v], true, &ref[v]);
+				TransformUnit::TransformColor(&in[v], &ref[v]);
+			}
+		}
+	});
+
+	const u64 batched_us = Benchmark::Time([&] {
+		for (int round = 0; round < ROUNDS; round++)
+		{
+			TransformUnit::TransformPositions(in, out, BATCH);
+			TransformUnit::TransformNormals(in, true, out, BATCH);
+			TransformUnit::TransformColors(in, out, BATCH);
+		}
+	});
+
+	for (int v = 0; v < BATCH; v++)
+		ExpectSame(ref[v], out[v], v);
+
+	const double vertices = (double)ROUNDS * BATCH;
+	Benchmark::Report("VERTICES", "per vertex: %.1f ns/vertex, batched: %.1f ns/vertex",
+		scalar_us * 1000.0 / vertices, batched_us * 1000.0 / vertices);
+}
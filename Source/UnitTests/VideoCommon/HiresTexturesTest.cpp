@@ -0,0 +1,128 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SOIL/SOIL.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "VideoCommon/HiresTextures.h"
+
+// Writes a small texture pack into a temporary directory and loads it with
+// and without room for caching the decoded images.
+
+namespace
+{
+
+const int SIZE = 8;
+
+class HiresTexturesTest : public testing::Test
+{
+protected:
+	virtual void SetUp()
+	{
+		char dir[] = "/tmp/HiresTexturesTestXXXXXX";
+		ASSERT_NE(nullptr, mkdtemp(dir));
+		m_root = dir;
+		File::CreateFullPath(m_root + "/GTEST1/sub/deeper/");
+		File::GetUserPath(D_HIRESTEXTURES_IDX, m_root + "/");
+
+		for (int i = 0; i < 20; i++)
+		{
+			// spread over the directory tree
+			const char* sub = i % 3 == 0 ? "" : i % 3 == 1 ? "sub/" : "sub/deeper/";
+			WriteImage(StringFromFormat("%s/GTEST1/%sGTEST1_%08x_5.tga", m_root.c_str(), sub, i), i);
+		}
+		// the bmp one is preferred, whatever directory it is in
+		WriteImage(m_root + "/GTEST1/sub/deeper/GTEST1_00000000_5.bmp", 100);
+		// other games' textures are ignored
+		WriteImage(m_root + "/GTEST1/GOTHER_00000000_5.tga", 200);
+	}
+
+	virtual void TearDown()
+	{
+		HiresTextures::Shutdown();
+		File::DeleteDirRecursively(m_root);
+	}
+
+	// Every pixel is the same and opaque, so neither the row order of the files
+	// nor bmp dropping the alpha channel matter
+	static std::vector<u8> Pixels(int seed)
+	{
+		std::vector<u8> pixels(SIZE * SIZE * 4);
+		for (size_t i = 0; i < pixels.size(); i++)
+			pixels[i] = i % 4 == 3 ? 0xff : (u8)(i % 4 * 7 + seed * 13);
+		return pixels;
+	}
+
+	static void WriteImage(const std::string& path, int seed)
+	{
+		const int type = path.substr(path.size() - 3) == "bmp" ? SOIL_SAVE_TYPE_BMP : SOIL_SAVE_TYPE_TGA;
+		const std::vector<u8> pixels = Pixels(seed);
+		ASSERT_TRUE(SOIL_save_image(path.c_str(), type, SIZE, SIZE, 4, pixels.data()) != 0) << path;
+	}
+
+	void CheckAll()
+	{
+		std::vector<u8> data(SIZE * SIZE * 4);
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (int i = 0; i < 20; i++)
+			{
+				unsigned int width = 0, height = 0, required_size = 0;
+				const std::string name = StringFromFormat("GTEST1_%08x_5", i);
+				ASSERT_TRUE(HiresTextures::HiresTexExists(name));
+				ASSERT_EQ(PC_TEX_FMT_RGBA32, HiresTextures::GetHiresTex(name, &width, &height, &required_size, 5, (u32)data.size(), data.data()));
+				EXPECT_EQ((u32)SIZE, width);
+				EXPECT_EQ((u32)SIZE, height);
+				EXPECT_EQ(data.size(), required_size);
+
+				const std::vector<u8> expected = Pixels(i == 0 ? 100 : i);
+				for (size_t p = 0; p < data.size(); p++)
+					ASSERT_EQ(expected[p], data[p]) << name << ", byte " << p;
+			}
+		}
+
+		EXPECT_FALSE(HiresTextures::HiresTexExists("GOTHER_00000000_5"));
+		EXPECT_FALSE(HiresTextures::HiresTexExists("GTEST1_00000014_5"));
+	}
+
+	std::string m_root;
+};
+
+}  // namespace
+
+TEST_F(HiresTexturesTest, Uncached)
+{
+	HiresTextures::Init("GTEST1", 0);
+	CheckAll();
+}
+
+TEST_F(HiresTexturesTest, CacheSmallerThanPack)
+{
+	// five images fit, the rest keeps getting evicted and decoded again
+	HiresTextures::Init("GTEST1", SIZE * SIZE * 4 * 5);
+	CheckAll();
+}
+
+TEST_F(HiresTexturesTest, WholePackCached)
+{
+	HiresTextures::Init("GTEST1", 1 << 20);
+	CheckAll();
+}
+
+TEST_F(HiresTexturesTest, BufferTooSmall)
+{
+	HiresTextures::Init("GTEST1", 1 << 20);
+
+	std::vector<u8> data(16);
+	unsigned int width = 0, height = 0, required_size = 0;
+	EXPECT_EQ(PC_TEX_FMT_NONE, HiresTextures::GetHiresTex("GTEST1_00000003_5", &width, &height, &required_size, 5, (u32)data.size(), data.data()));
+	EXPECT_EQ((u32)(SIZE * SIZE * 4), required_size);
+	EXPECT_EQ(PC_TEX_FMT_NONE, HiresTextures::GetHiresTex("GTEST1_00000099_5", &width, &height, &required_size, 5, (u32)data.size(), data.data()));
+}
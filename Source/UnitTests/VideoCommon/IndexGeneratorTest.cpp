@@ -0,0 +1,241 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+namespace
+{
+
+const u16 RESTART = 0xFFFF;
+
+void Triangle(std::vector<u16>* out, bool pr, u32 a, u32 b, u32 c)
+{
+	out->push_back(a);
+	out->push_back(b);
+	out->push_back(c);
+	if (pr)
+		out->push_back(RESTART);
+}
+
+// Straightforward versions of the triangle, strip and quad index generators.
+std::vector<u16> Expected(int primitive, bool pr, u32 num_verts, u32 index)
+{
+	std::vector<u16> out;
+	switch (primitive)
+	{
+	case GX_DRAW_TRIANGLES:
+		for (u32 i = 2; i < num_verts; i += 3)
+			Triangle(&out, pr, index + i - 2, index + i - 1, index + i);
+		break;
+
+	case GX_DRAW_TRIANGLE_STRIP:
+		if (pr)
+		{
+			for (u32 i = 0; i < num_verts; ++i)
+				out.push_back(index + i);
+			out.push_back(RESTART);
+		}
+		else
+		{
+			for (u32 i = 2; i < num_verts; ++i)
+			{
+				if (i % 2 == 0)
+					Triangle(&out, pr, index + i - 2, index + i - 1, index + i);
+				else
+					Triangle(&out, pr, index + i - 2, index + i, index + i - 1);
+			}
+		}
+		break;
+
+	case GX_DRAW_QUADS:
+	{
+		u32 i = 3;
+		for (; i < num_verts; i += 4)
+		{
+			if (pr)
+			{
+				out.push_back(index + i - 2);
+				out.push_back(index + i - 1);
+				out.push_back(index + i - 3);
+				out.push_back(index + i);
+				out.push_back(RESTART);
+			}
+			else
+			{
+				Triangle(&out, pr, index + i - 3, index + i - 2, index + i - 1);
+				Triangle(&out, pr, index + i - 3, index + i - 1, index + i);
+			}
+		}
+		if (i == num_verts)
+			Triangle(&out, pr, index + num_verts - 3, index + num_verts - 2, index + num_verts - 1);
+		break;
+	}
+
+	case GX_DRAW_POINTS:
+		for (u32 i = 0; i < num_verts; ++i)
+			out.push_back(index + i);
+		break;
+	}
+	return out;
+}
+
+std::vector<u16> Generate(int primitive, u32 num_verts, u32 index)
+{
+	// Canary values past the end catch writes beyond the generated indices.
+	std::vector<u16> buffer(index + 4 * num_verts + 64, 0xCDCD);
+	IndexGenerator::Start(buffer.data());
+	if (index)
+		IndexGenerator::AddIndices(GX_DRAW_POINTS, index);
+	u16* start = buffer.data() + IndexGenerator::GetIndexLen();
+	IndexGenerator::AddIndices(primitive, num_verts);
+	u16* end = buffer.data() + IndexGenerator::GetIndexLen();
+
+	for (u16* p = end; p != buffer.data() + buffer.size(); ++p)
+		EXPECT_EQ(0xCDCD, *p);
+	return std::vector<u16>(start, end);
+}
+
+void CheckPrimitive(int primitive, bool pr)
+{
+	IndexGenerator::Init(pr);
+
+	for (u32 index : {0u, 5u, 1000u})
+	{
+		for (u32 num_verts = 0; num_verts < 200; ++num_verts)
+		{
+			SCOPED_TRACE(testing::Message() << "verts " << num_verts << " index " << index);
+			EXPECT_EQ(Expected(primitive, pr, num_verts, index), Generate(primitive, num_verts, index));
+		}
+	}
+}
+
+// What IndexGenerator did before the batched generators, one triangle at a
+// time, to time them against.
+u16* ScalarTriangle(u16* out, u32 a, u32 b, u32 c)
+{
+	*out++ = a;
+	*out++ = b;
+	*out++ = c;
+	return out;
+}
+
+u16* ScalarIndices(u16* out, int primitive, u32 num_verts, u32 index)
+{
+	switch (primitive)
+	{
+	case GX_DRAW_TRIANGLES:
+		for (u32 i = 2; i < num_verts; i += 3)
+			out = ScalarTriangle(out, index + i - 2, index + i - 1, index + i);
+		break;
+
+	case GX_DRAW_TRIANGLE_STRIP:
+	{
+		bool wind = false;
+		for (u32 i = 2; i < num_verts; ++i)
+		{
+			out = ScalarTriangle(out, index + i - 2, index + i - !wind, index + i - wind);
+			wind ^= true;
+		}
+		break;
+	}
+
+	case GX_DRAW_QUADS:
+		for (u32 i = 3; i < num_verts; i += 4)
+		{
+			out = ScalarTriangle(out, index + i - 3, index + i - 2, index + i - 1);
+			out = ScalarTriangle(out, index + i - 3, index + i - 1, index + i);
+		}
+		break;
+	}
+	return out;
+}
+
+}  // namespace
+
+TEST(IndexGenerator, Triangles)
+{
+	CheckPrimitive(GX_DRAW_TRIANGLES, false);
+	CheckPrimitive(GX_DRAW_TRIANGLES, true);
+}
+
+TEST(IndexGenerator, TriangleStrip)
+{
+	CheckPrimitive(GX_DRAW_TRIANGLE_STRIP, false);
+	CheckPrimitive(GX_DRAW_TRIANGLE_STRIP, true);
+}
+
+TEST(IndexGenerator, Quads)
+{
+	CheckPrimitive(GX_DRAW_QUADS, false);
+	CheckPrimitive(GX_DRAW_QUADS, true);
+}
+
+TEST(IndexGenerator, Points)
+{
+	CheckPrimitive(GX_DRAW_POINTS, false);
+}
+
+// Times triangles, strips and quads without primitive restart, like D3D draws
+// them, scalar and batched, for small and large draws. Both have to fill the
+// index buffer the same way.
+TEST(IndexGenerator, Throughput)
+{
+	IndexGenerator::Init(false);
+	const u32 total_verts = Benchmark::Size(1u << 24, 1u << 17);
+	std::vector<u16> scalar(65536 * 3), batched(65536 * 3);
+
+	const struct
+	{
+		const char* name;
+		int primitive;
+	} primitives[] = {
+		{ "triangles", GX_DRAW_TRIANGLES },
+		{ "strip", GX_DRAW_TRIANGLE_STRIP },
+		{ "quads", GX_DRAW_QUADS },
+	};
+
+	for (const auto& primitive : primitives)
+	{
+		for (u32 num_verts : { 24u, 96u, 1200u })
+		{
+			// Stay inside a u16 index buffer like VertexManager does
+			const u32 draws_per_buffer = 60000 / num_verts;
+			const u32 buffers = total_verts / (draws_per_buffer * num_verts);
+
+			u16* scalar_end = nullptr;
+			const u64 scalar_us = Benchmark::Time([&] {
+				for (u32 b = 0; b < buffers; b++)
+				{
+					scalar_end = scalar.data();
+					for (u32 d = 0; d < draws_per_buffer; d++)
+						scalar_end = ScalarIndices(scalar_end, primitive.primitive, num_verts, d * num_verts);
+				}
+			});
+
+			const u64 batched_us = Benchmark::Time([&] {
+				for (u32 b = 0; b < buffers; b++)
+				{
+					IndexGenerator::Start(batched.data());
+					for (u32 d = 0; d < draws_per_buffer; d++)
+						IndexGenerator::AddIndices(primitive.primitive, num_verts);
+				}
+			});
+
+			const u32 length = (u32)(scalar_end - scalar.data());
+			ASSERT_EQ(length, IndexGenerator::GetIndexLen()) << primitive.name << ", " << num_verts << " verts";
+			EXPECT_TRUE(std::equal(scalar.begin(), scalar.begin() + length, batched.begin())) << primitive.name << ", " << num_verts << " verts";
+
+			const double verts = (double)buffers * draws_per_buffer * num_verts;
+			Benchmark::Report("INDICES", "%-9s %4u verts/draw: scalar %5.2f ns, batched %5.2f ns per vertex",
+				primitive.name, num_verts, scalar_us * 1000.0 / verts, batched_us * 1000.0 / verts);
+		}
+	}
+}
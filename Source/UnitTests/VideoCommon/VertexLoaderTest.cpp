@@ -0,0 +1,304 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Benchmark.h"
+#include "Common/Common.h"
+#include "Common/CPUDetect.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexLoader_Color.h"
+#include "VideoCommon/VertexLoader_Position.h"
+#include "VideoCommon/VertexManagerBase.h"
+
+// The attribute loaders only share these with the rest of the vertex loader,
+// defining them here keeps the video backend out of the test
+float posScale;
+int colIndex;
+int colElements[2];
+u8* g_pVideoData;
+u8* VertexManager::s_pCurBufferPointer;
+
+// The batch kernels the non-JIT vertex loader uses against the per-vertex
+// loaders they replace.
+
+namespace
+{
+
+const unsigned int NUM_TYPES = 4, NUM_FORMATS = 5, NUM_ELEMENTS = 2;
+const int COMPONENT_SIZE[NUM_FORMATS] = { 1, 1, 2, 2, 4 };
+
+struct PositionLoaders
+{
+	TPipelineFunction per_vertex;
+	TBatchFunction batch;
+	TBatchFunction batch_ssse3;
+};
+
+// The tables only switch to the SSSE3 loaders in Init, so grab the plain
+// ones first.
+PositionLoaders s_position[NUM_TYPES][NUM_FORMATS][NUM_ELEMENTS];
+
+void InitLoaders()
+{
+	static bool s_initialized = false;
+	if (s_initialized)
+		return;
+
+	for (unsigned int type = DIRECT; type < NUM_TYPES; type++)
+	{
+		for (unsigned int format = 0; format < NUM_FORMATS; format++)
+		{
+			for (unsigned int elements = 0; elements < NUM_ELEMENTS; elements++)
+			{
+				s_position[type][format][elements].per_vertex = VertexLoader_Position::GetFunction(type, format, elements);
+				s_position[type][format][elements].batch = VertexLoader_Position::GetBatchFunction(type, format, elements);
+			}
+		}
+	}
+
+	VertexLoader_Position::Init();
+	for (unsigned int type = DIRECT; type < NUM_TYPES; type++)
+		for (unsigned int format = 0; format < NUM_FORMATS; format++)
+			for (unsigned int elements = 0; elements < NUM_ELEMENTS; elements++)
+				s_position[type][format][elements].batch_ssse3 = VertexLoader_Position::GetBatchFunction(type, format, elements);
+
+	s_initialized = true;
+}
+
+// Runs a per-vertex loader like the pipeline does, one attribute of count vertices
+void RunPerVertex(TPipelineFunction func, u8* src, int src_stride, u8* dst, int dst_stride, int count, int index)
+{
+	for (int v = 0; v < count; v++)
+	{
+		g_pVideoData = src + v * src_stride;
+		VertexManager::s_pCurBufferPointer = dst + v * dst_stride;
+		colIndex = index;
+		func();
+	}
+}
+
+template <typename T>
+void WriteBigEndian(u8* dst, T value)
+{
+	for (size_t i = 0; i < sizeof(T); i++)
+		dst[i] = (u8)(value >> (8 * (sizeof(T) - 1 - i)));
+}
+
+// Writes one component in the given position format. Floats stay in a range
+// the scaled formats could hold too, random bits might come out as NaNs.
+void WriteComponent(std::mt19937& rng, u8* dst, unsigned int format)
+{
+	if (format == FORMAT_FLOAT)
+	{
+		const float value = std::uniform_real_distribution<float>(-1000.f, 1000.f)(rng);
+		u32 bits;
+		memcpy(&bits, &value, sizeof(bits));
+		WriteBigEndian(dst, bits);
+	}
+	else
+	{
+		for (int i = 0; i < COMPONENT_SIZE[format]; i++)
+			dst[i] = (u8)rng();
+	}
+}
+
+class VertexLoaderTest : public testing::Test
+{
+protected:
+	VertexLoaderTest() : m_rng(0x5EED) {}
+
+	virtual void SetUp() override
+	{
+		InitLoaders();
+	}
+
+	// Fills the vertex data for count vertices, and the array they index into
+	// if the attribute isn't direct. Returns the size of one attribute.
+	int MakePositions(unsigned int type, unsigned int format, unsigned int elements, int count, int src_stride)
+	{
+		const int values = elements ? 3 : 2;
+		const int size = COMPONENT_SIZE[format] * values;
+		m_src.assign(count * src_stride, 0xAB);
+
+		if (type == DIRECT)
+		{
+			for (int v = 0; v < count; v++)
+				for (int c = 0; c < values; c++)
+					WriteComponent(m_rng, &m_src[v * src_stride + c * COMPONENT_SIZE[format]], format);
+			return size;
+		}
+
+		// array entries are padded like games often do
+		const u32 array_stride = size + m_rng() % 8;
+		const u32 array_count = type == INDEX8 ? 256 : 1000;
+		m_array.assign(array_count * array_stride, 0xCD);
+		for (u32 i = 0; i < array_count; i++)
+			for (int c = 0; c < values; c++)
+				WriteComponent(m_rng, &m_array[i * array_stride + c * COMPONENT_SIZE[format]], format);
+		cached_arraybases[ARRAY_POSITION] = &m_array[0];
+		arraystrides[ARRAY_POSITION] = array_stride;
+
+		for (int v = 0; v < count; v++)
+		{
+			if (type == INDEX8)
+				m_src[v * src_stride] = (u8)m_rng();
+			else
+				WriteBigEndian(&m_src[v * src_stride], (u16)(m_rng() % array_count));
+		}
+		return type == INDEX8 ? 1 : 2;
+	}
+
+	// Runs the loader over count vertices of the current data, into a buffer
+	// prefilled with a marker so writes outside the attribute show up.
+	std::vector<u8> Load(TPipelineFunction per_vertex, TBatchFunction batch, int src_stride, int dst_stride, int count, int index)
+	{
+		std::vector<u8> dst(count * dst_stride, 0xEE);
+		if (batch)
+			batch(&m_src[0], src_stride, &dst[0], dst_stride, count, index);
+		else
+			RunPerVertex(per_vertex, &m_src[0], src_stride, &dst[0], dst_stride, count, index);
+		return dst;
+	}
+
+	std::mt19937 m_rng;
+	std::vector<u8> m_src;
+	std::vector<u8> m_array;
+};
+
+}  // namespace
+
+TEST_F(VertexLoaderTest, PositionBatchesMatchPerVertexLoaders)
+{
+	for (int i = 0; i < 1000; i++)
+	{
+		const unsigned int type = DIRECT + m_rng() % (NUM_TYPES - DIRECT);
+		const unsigned int format = m_rng() % NUM_FORMATS;
+		const unsigned int elements = m_rng() % NUM_ELEMENTS;
+		const PositionLoaders& loaders = s_position[type][format][elements];
+		ASSERT_TRUE(loaders.per_vertex && loaders.batch && loaders.batch_ssse3);
+
+		const int count = 1 + m_rng() % 300;
+		const int src_stride = (int)VertexLoader_Position::GetSize(type, format, elements) + m_rng() % 16;
+		const int dst_stride = 12 + 4 * (m_rng() % 8);
+		posScale = 1.0f / (1u << (m_rng() % 32));
+
+		const int size = MakePositions(type, format, elements, count, src_stride);
+		ASSERT_EQ((int)VertexLoader_Position::GetSize(type, format, elements), size);
+		SCOPED_TRACE(testing::Message() << "type " << type << ", format " << format << ", elements " << elements
+			<< ", " << count << " vertices, strides " << src_stride << "/" << dst_stride);
+
+		const std::vector<u8> expected = Load(loaders.per_vertex, nullptr, src_stride, dst_stride, count, 0);
+		EXPECT_TRUE(expected == Load(nullptr, loaders.batch, src_stride, dst_stride, count, 0));
+		EXPECT_TRUE(expected == Load(nullptr, loaders.batch_ssse3, src_stride, dst_stride, count, 0));
+	}
+}
+
+// Byte swapped s16 and float positions are what the SSSE3 kernels exist for
+TEST_F(VertexLoaderTest, PositionsUseSSSE3WhenSupported)
+{
+	if (!cpu_info.bSSSE3)
+		return;
+
+	for (unsigned int type = DIRECT; type < NUM_TYPES; type++)
+	{
+		for (unsigned int elements = 0; elements < NUM_ELEMENTS; elements++)
+		{
+			EXPECT_NE(s_position[type][FORMAT_SHORT][elements].batch, s_position[type][FORMAT_SHORT][elements].batch_ssse3);
+			EXPECT_NE(s_position[type][FORMAT_FLOAT][elements].batch, s_position[type][FORMAT_FLOAT][elements].batch_ssse3);
+		}
+	}
+}
+
+TEST_F(VertexLoaderTest, ColorBatchesMatchPerVertexLoaders)
+{
+	const struct
+	{
+		int type;
+		TPipelineFunction per_vertex;
+		TBatchFunction batch;
+	} loaders[] = {
+		{ DIRECT, Color_ReadDirect_32b_8888, Color_ReadDirect_32b_8888_Batch },
+		{ INDEX8, Color_ReadIndex8_32b_8888, Color_ReadIndex8_32b_8888_Batch },
+		{ INDEX16, Color_ReadIndex16_32b_8888, Color_ReadIndex16_32b_8888_Batch },
+	};
+
+	for (int i = 0; i < 300; i++)
+	{
+		const auto& loader = loaders[m_rng() % ArraySize(loaders)];
+		const int index = m_rng() % 2;
+		colElements[index] = m_rng() % 2;
+
+		const int count = 1 + m_rng() % 300;
+		const int size = loader.type == DIRECT ? 4 : loader.type == INDEX8 ? 1 : 2;
+		const int src_stride = size + m_rng() % 16;
+		const int dst_stride = 16 + 4 * (m_rng() % 8);
+		SCOPED_TRACE(testing::Message() << "type " << loader.type << ", color " << index << ", " << count
+			<< " vertices, strides " << src_stride << "/" << dst_stride);
+
+		m_src.resize(count * src_stride);
+		for (u8& byte : m_src)
+			byte = (u8)m_rng();
+		m_array.resize(1000 * 8);
+		for (u8& byte : m_array)
+			byte = (u8)m_rng();
+		cached_arraybases[ARRAY_COLOR + index] = &m_array[0];
+		arraystrides[ARRAY_COLOR + index] = 4 + m_rng() % 5;
+		if (loader.type == INDEX16)
+		{
+			for (int v = 0; v < count; v++)
+				WriteBigEndian(&m_src[v * src_stride], (u16)(m_rng() % 1000));
+		}
+
+		const std::vector<u8> expected = Load(loader.per_vertex, nullptr, src_stride, dst_stride, count, index);
+		EXPECT_TRUE(expected == Load(nullptr, loader.batch, src_stride, dst_stride, count, index));
+	}
+}
+
+// Times s16 positions through an index16 array, the most common format in
+// games, per vertex and batched. Every run has to write the same vertices.
+TEST_F(VertexLoaderTest, PositionThroughput)
+{
+	const int count = Benchmark::Size(1 << 20, 1 << 12), src_stride = 2, dst_stride = 36;
+	const int passes = Benchmark::Size(20, 2);
+	posScale = 1.0f / 64;
+	MakePositions(INDEX16, FORMAT_SHORT, 1, count, src_stride);
+	const PositionLoaders& loaders = s_position[INDEX16][FORMAT_SHORT][1];
+	std::vector<u8> expected;
+
+	const struct
+	{
+		const char* name;
+		TBatchFunction batch;
+	} runs[] = {
+		{ "per vertex", nullptr },
+		{ "batched", loaders.batch },
+		{ cpu_info.bSSSE3 ? "SSSE3" : "SSSE3 (unsupported, batched)", loaders.batch_ssse3 },
+	};
+
+	for (const auto& run : runs)
+	{
+		std::vector<u8> dst(count * dst_stride);
+		const u64 elapsed = Benchmark::Time([&] {
+			for (int pass = 0; pass < passes; pass++)
+			{
+				if (run.batch)
+					run.batch(&m_src[0], src_stride, &dst[0], dst_stride, count, 0);
+				else
+					RunPerVertex(loaders.per_vertex, &m_src[0], src_stride, &dst[0], dst_stride, count, 0);
+			}
+		});
+
+		if (expected.empty())
+			expected = dst;
+		else
+			EXPECT_TRUE(expected == dst) << run.name;
+		Benchmark::Report("VERTEX", "%-30s %6.2f ns per vertex", run.name, elapsed * 1000.0 / ((double)count * passes));
+	}
+}